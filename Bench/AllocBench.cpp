@@ -0,0 +1,77 @@
+﻿// AllocBench.cpp
+// LOG_* 호출 1회당 힙 할당 횟수를 측정하는 벤치마크
+// 전역 operator new 를 대체하여 할당 횟수를 센다.
+// 콘솔 출력이 측정에 섞이지 않도록 stdout 을 /dev/null (Windows: NUL) 로 돌려서 실행한다.
+//   AllocBench > /dev/null
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+    std::atomic<unsigned long long> allocationCount(0);
+}
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    const int kWarmupCalls = 1000;
+    const int kMeasuredCalls = 100000;
+
+    void runCase(const char* caseName, bool async) {
+        auto& logger = CLogger::getInstance();
+        if (async) {
+            logger.enableAsyncLogging(1 << 14, EOverflowPolicy::BLOCK);
+        }
+        const std::string dynamicMessage = "dynamic message built by the caller beforehand";
+
+        // 스레드 버퍼, 큐 슬롯 등이 준비되도록 먼저 호출
+        for (int i = 0; i < kWarmupCalls; ++i) {
+            LOG_INFO("warm up message");
+            LOG_DEBUG(dynamicMessage);
+        }
+        logger.flush();
+
+        unsigned long long before = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kMeasuredCalls; ++i) {
+            LOG_INFO("string literal message for the allocation benchmark");
+            LOG_DEBUG(dynamicMessage);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        logger.flush();
+        unsigned long long allocations = allocationCount.load() - before;
+
+        double calls = 2.0 * kMeasuredCalls;
+        std::fprintf(stderr, "%-12s allocations/call = %.4f, ns/call = %.1f\n", caseName,
+            allocations / calls,
+            std::chrono::duration<double, std::nano>(elapsed).count() / calls);
+        if (async) {
+            logger.shutdown();
+        }
+    }
+}
+
+int main() {
+    CLogger::getInstance().configureLogging("alloc_bench.txt", true);
+    runCase("sync", false);
+    runCase("async", true);
+    return 0;
+}
@@ -0,0 +1,37 @@
+﻿// DisabledLogBench.cpp
+// 실행 중 최소 로그 레벨로 꺼진 LOG_* 호출 1회의 비용(ns)을 측정하는 벤치마크
+// 꺼진 호출은 메시지 인자를 계산하지 않으므로, 비싼 문자열 조립을 인자로 넣어도 비용이 늘지 않아야 한다.
+#include "Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace {
+    const int kCalls = 100000000;
+
+    double measureLoop(const char* caseName, bool expensiveArgument) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kCalls; ++i) {
+            if (expensiveArgument) {
+                LOG_DEBUG("value = " + std::to_string(i) + ", half = " + std::to_string(i / 2));
+            }
+            else {
+                LOG_DEBUG("disabled debug message");
+            }
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double nsPerCall = std::chrono::duration<double, std::nano>(elapsed).count() / kCalls;
+        std::printf("%-30s %.3f ns/call\n", caseName, nsPerCall);
+        return nsPerCall;
+    }
+}
+
+int main() {
+    auto& logger = CLogger::getInstance();
+    logger.configureLogging("disabled_bench.txt", false);
+    CLogger::setMinLogLevel(ELogLevel::LOG_WARNING);
+
+    measureLoop("disabled, literal message", false);
+    measureLoop("disabled, std::string message", true);
+    return 0;
+}
@@ -0,0 +1,345 @@
+﻿// LatencyBench.cpp
+// LOG_* 호출 1회의 지연 시간 분포(p50/p99/p99.9/max)와 전체 처리량(records/s)을 스레드 수별로 측정하는 벤치마크
+// 로그 레벨, 메시지 크기, 로그파일/콘솔 출력 유무, 동기(기존 방식, 기준값)/비동기 모드의 조합마다 측정하고
+// 결과를 JSON 또는 CSV 로 기록하여 변경 전후를 비교할 수 있게 한다.
+//   LatencyBench [옵션] > /dev/null     (콘솔 출력이 측정 결과와 섞이지 않도록 stdout 을 버린다)
+//   --format=json|csv            결과 형식 (기본 json)
+//   --output=파일                결과 파일 (기본 stderr)
+//   --threads=1,2,4,8            스레드 수 목록
+//   --sizes=16,128,1024,4096     메시지 크기(byte) 목록
+//   --levels=DEBUG,INFO,WARNING,ERROR
+//   --modes=sync,async
+//   --file=on,off  --console=on,off
+//   --records=N                  스레드당 로그 개수 (한 조합의 메시지 총량이 64MB 를 넘지 않도록 줄어든다)
+// 호출 전후로 steady_clock 을 읽으므로 지연 시간에는 시간 측정 비용(수십 ns)이 포함된다.
+#include "Logger.h"
+#include "LogSink.h"
+#include "LogFileSink.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char kBenchFile[] = "latency_bench.log";
+    const unsigned long long kMaxBytesPerCase = 64ULL * 1024 * 1024;
+
+    struct SBenchOptions {
+        std::string format = "json";
+        std::string output;
+        std::vector<int> threads{ 1, 2, 4, 8 };
+        std::vector<int> sizes{ 16, 128, 1024, 4096 };
+        std::vector<ELogLevel> levels{ ELogLevel::LOG_DEBUG, ELogLevel::LOG_INFO, ELogLevel::LOG_WARNING, ELogLevel::LOG_ERROR };
+        std::vector<bool> asyncModes{ false, true };
+        std::vector<bool> fileModes{ true, false };
+        std::vector<bool> consoleModes{ false, true };
+        int records = 10000;
+    };
+
+    struct SBenchCase {
+        bool async;
+        ELogLevel eLogLevel;
+        int messageSize;
+        bool file;
+        bool console;
+        int threads;
+    };
+
+    struct SBenchResult {
+        int recordsPerThread;
+        double seconds;
+        double recordsPerSecond;
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
+    };
+
+    const char* levelName(ELogLevel eLogLevel) {
+        switch (eLogLevel) {
+        case ELogLevel::LOG_DEBUG: return "DEBUG";
+        case ELogLevel::LOG_INFO: return "INFO";
+        case ELogLevel::LOG_WARNING: return "WARNING";
+        case ELogLevel::LOG_ERROR: return "ERROR";
+        }
+        return "UNKNOWN";
+    }
+
+    std::vector<std::string> splitList(const char* text) {
+        std::vector<std::string> items;
+        std::string item;
+        for (const char* p = text; ; ++p) {
+            if (*p == ',' || *p == '\0') {
+                if (!item.empty()) {
+                    items.push_back(item);
+                }
+                item.clear();
+                if (*p == '\0') {
+                    break;
+                }
+                continue;
+            }
+            item += *p;
+        }
+        return items;
+    }
+
+    std::vector<int> parseNumbers(const char* text) {
+        std::vector<int> numbers;
+        for (const auto& item : splitList(text)) {
+            int value = std::atoi(item.c_str());
+            if (value > 0) {
+                numbers.push_back(value);
+            }
+        }
+        return numbers;
+    }
+
+    // "on,off" 형식 (sync/async 도 같은 방식으로 처리)
+    std::vector<bool> parseSwitches(const char* text, const char* onName, const char* offName) {
+        std::vector<bool> switches;
+        for (const auto& item : splitList(text)) {
+            if (item == onName) {
+                switches.push_back(true);
+            }
+            else if (item == offName) {
+                switches.push_back(false);
+            }
+        }
+        return switches;
+    }
+
+    bool parseOptions(int argc, char* argv[], SBenchOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* value = std::strchr(arg, '=');
+            if (value == nullptr) {
+                return false;
+            }
+            std::string key(arg, value - arg);
+            ++value;
+            if (key == "--format") {
+                options.format = value;
+            }
+            else if (key == "--output") {
+                options.output = value;
+            }
+            else if (key == "--threads") {
+                options.threads = parseNumbers(value);
+            }
+            else if (key == "--sizes") {
+                options.sizes = parseNumbers(value);
+            }
+            else if (key == "--levels") {
+                options.levels.clear();
+                for (const auto& item : splitList(value)) {
+                    for (ELogLevel eLogLevel : { ELogLevel::LOG_DEBUG, ELogLevel::LOG_INFO, ELogLevel::LOG_WARNING, ELogLevel::LOG_ERROR }) {
+                        if (item == levelName(eLogLevel)) {
+                            options.levels.push_back(eLogLevel);
+                        }
+                    }
+                }
+            }
+            else if (key == "--modes") {
+                options.asyncModes = parseSwitches(value, "async", "sync");
+            }
+            else if (key == "--file") {
+                options.fileModes = parseSwitches(value, "on", "off");
+            }
+            else if (key == "--console") {
+                options.consoleModes = parseSwitches(value, "on", "off");
+            }
+            else if (key == "--records") {
+                options.records = std::atoi(value);
+            }
+            else {
+                return false;
+            }
+        }
+        return (options.format == "json" || options.format == "csv") && options.records > 0
+            && !options.threads.empty() && !options.sizes.empty() && !options.levels.empty()
+            && !options.asyncModes.empty() && !options.fileModes.empty() && !options.consoleModes.empty();
+    }
+
+    void logOnce(ELogLevel eLogLevel, const std::string& message) {
+        switch (eLogLevel) {
+        case ELogLevel::LOG_DEBUG: LOG_DEBUG(message); break;
+        case ELogLevel::LOG_INFO: LOG_INFO(message); break;
+        case ELogLevel::LOG_WARNING: LOG_WARNING(message); break;
+        case ELogLevel::LOG_ERROR: LOG_ERROR(message); break;
+        }
+    }
+
+    // p : 0 ~ 1, sortedLatencies 는 오름차순
+    uint64_t percentile(const std::vector<uint32_t>& sortedLatencies, double p) {
+        size_t rank = static_cast<size_t>(p * sortedLatencies.size() + 0.999999);
+        rank = (std::min)((std::max)(rank, static_cast<size_t>(1)), sortedLatencies.size());
+        return sortedLatencies[rank - 1];
+    }
+
+    SBenchResult runCase(const SBenchCase& benchCase, int records) {
+        auto& logger = CLogger::getInstance();
+        std::vector<std::shared_ptr<CLogSink>> sinks;
+        if (benchCase.file) {
+            sinks.push_back(std::make_shared<CFileLogSink>(kBenchFile));
+        }
+        if (benchCase.console) {
+            // configureLogging(파일이름) 의 기본 콘솔 sink 와 같은 구성
+            auto console = std::make_shared<CConsoleLogSink>();
+            console->enableDedicatedThread(4096, EOverflowPolicy::BLOCK);
+            sinks.push_back(console);
+        }
+        logger.configureLogging(sinks);
+        if (benchCase.async) {
+            logger.enableAsyncLogging(1 << 14, EOverflowPolicy::BLOCK);
+        }
+
+        unsigned long long caseBytes = static_cast<unsigned long long>(benchCase.messageSize) * benchCase.threads;
+        int recordsPerThread = static_cast<int>((std::min)(static_cast<unsigned long long>(records),
+            (std::max)(kMaxBytesPerCase / caseBytes, 1000ULL)));
+        const std::string message(static_cast<size_t>(benchCase.messageSize), 'm');
+        std::vector<std::vector<uint32_t>> latencies(benchCase.threads);
+        std::atomic<int> readyCount(0);
+        std::atomic<bool> go(false);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < benchCase.threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::vector<uint32_t>& threadLatencies = latencies[t];
+                threadLatencies.resize(recordsPerThread);
+                // 스레드 버퍼 등록 등 첫 호출 비용은 측정에서 제외
+                logOnce(benchCase.eLogLevel, message);
+                readyCount.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < recordsPerThread; ++i) {
+                    auto before = std::chrono::steady_clock::now();
+                    logOnce(benchCase.eLogLevel, message);
+                    auto after = std::chrono::steady_clock::now();
+                    long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count();
+                    threadLatencies[i] = static_cast<uint32_t>((std::min)(ns, static_cast<long long>(UINT32_MAX)));
+                }
+            });
+        }
+        while (readyCount.load() < benchCase.threads) {
+            std::this_thread::yield();
+        }
+        logger.flush();
+
+        // 모든 로그가 출력 대상에 기록될 때까지를 처리 시간으로 잰다.
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        logger.flush();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (benchCase.async) {
+            logger.shutdown();
+        }
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>());
+
+        std::vector<uint32_t> merged;
+        merged.reserve(static_cast<size_t>(recordsPerThread) * benchCase.threads);
+        for (const auto& threadLatencies : latencies) {
+            merged.insert(merged.end(), threadLatencies.begin(), threadLatencies.end());
+        }
+        std::sort(merged.begin(), merged.end());
+
+        SBenchResult result;
+        result.recordsPerThread = recordsPerThread;
+        result.seconds = std::chrono::duration<double>(elapsed).count();
+        result.recordsPerSecond = merged.size() / result.seconds;
+        result.p50 = percentile(merged, 0.50);
+        result.p99 = percentile(merged, 0.99);
+        result.p999 = percentile(merged, 0.999);
+        result.max = merged.back();
+        return result;
+    }
+
+    void writeResult(FILE* out, const std::string& format, bool first, const SBenchCase& benchCase,
+        const SBenchResult& result) {
+        const char* mode = benchCase.async ? "async" : "sync";
+        if (format == "csv") {
+            std::fprintf(out, "%s,%s,%d,%s,%s,%d,%d,%.6f,%.0f,%llu,%llu,%llu,%llu\n", mode,
+                levelName(benchCase.eLogLevel), benchCase.messageSize, benchCase.file ? "on" : "off",
+                benchCase.console ? "on" : "off", benchCase.threads, result.recordsPerThread, result.seconds,
+                result.recordsPerSecond, static_cast<unsigned long long>(result.p50),
+                static_cast<unsigned long long>(result.p99), static_cast<unsigned long long>(result.p999),
+                static_cast<unsigned long long>(result.max));
+            return;
+        }
+        std::fprintf(out, "%s    {\"mode\": \"%s\", \"level\": \"%s\", \"message_bytes\": %d, \"file\": %s, "
+            "\"console\": %s, \"threads\": %d, \"records_per_thread\": %d, \"seconds\": %.6f, "
+            "\"records_per_second\": %.0f, \"p50_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu}",
+            first ? "" : ",\n", mode, levelName(benchCase.eLogLevel), benchCase.messageSize,
+            benchCase.file ? "true" : "false", benchCase.console ? "true" : "false", benchCase.threads,
+            result.recordsPerThread, result.seconds, result.recordsPerSecond,
+            static_cast<unsigned long long>(result.p50), static_cast<unsigned long long>(result.p99),
+            static_cast<unsigned long long>(result.p999), static_cast<unsigned long long>(result.max));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    SBenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: LatencyBench [--format=json|csv] [--output=file] [--threads=1,2,4,8] "
+            "[--sizes=16,128,1024,4096] [--levels=DEBUG,INFO,WARNING,ERROR] [--modes=sync,async] "
+            "[--file=on,off] [--console=on,off] [--records=N]\n");
+        return 1;
+    }
+    FILE* out = stderr;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (out == nullptr) {
+            std::fprintf(stderr, "Unable to open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    if (options.format == "csv") {
+        std::fprintf(out, "mode,level,message_bytes,file,console,threads,records_per_thread,seconds,"
+            "records_per_second,p50_ns,p99_ns,p999_ns,max_ns\n");
+    }
+    else {
+        std::fprintf(out, "{\n  \"benchmark\": \"LatencyBench\",\n  \"hardware_threads\": %u,\n  \"results\": [\n",
+            std::thread::hardware_concurrency());
+    }
+
+    bool first = true;
+    for (bool async : options.asyncModes) {
+        for (bool file : options.fileModes) {
+            for (bool console : options.consoleModes) {
+                for (ELogLevel eLogLevel : options.levels) {
+                    for (int messageSize : options.sizes) {
+                        for (int threads : options.threads) {
+                            SBenchCase benchCase = { async, eLogLevel, messageSize, file, console, threads };
+                            SBenchResult result = runCase(benchCase, options.records);
+                            writeResult(out, options.format, first, benchCase, result);
+                            std::fflush(out);
+                            first = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (options.format == "json") {
+        std::fprintf(out, "\n  ]\n}\n");
+    }
+    if (out != stderr) {
+        std::fclose(out);
+    }
+    std::remove(kBenchFile);
+    return 0;
+}
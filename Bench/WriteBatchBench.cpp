@@ -0,0 +1,130 @@
+﻿// WriteBatchBench.cpp
+// 로그파일 기록 방식별 처리량과 로그 100만 개당 시스템 호출 횟수를 비교하는 벤치마크
+// 콘솔 sink 없이 로그파일 sink 하나만 구성하고, 마지막 로그가 파일에 기록될 때까지의 시간을 잰다.
+//   WriteBatchBench [로그 개수]
+// 시스템 호출 횟수는 Linux 의 /proc/self/io (syscw : write 계열 호출 횟수) 로 센다.
+// 로그마다 open/write/close 하는 방식은 open, close 를 로그마다 2회로 더하고,
+// io_uring 은 제출/완료 대기(io_uring_enter) 횟수를 CBatchedLogFile 통계로 센다. (LOGGER_WITH_IO_URING 빌드)
+#include "Logger.h"
+#include "LogSink.h"
+#include "LogFileSink.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+    const char kBenchFile[] = "write_batch_bench.log";
+
+    // 현재 프로세스의 write 계열 시스템 호출 횟수 (알 수 없으면 -1)
+    long long readWriteSyscalls() {
+#ifdef __linux__
+        std::ifstream io("/proc/self/io");
+        std::string key;
+        long long value = 0;
+        while (io >> key >> value) {
+            if (key == "syscw:") {
+                return value;
+            }
+        }
+#endif
+        return -1;
+    }
+
+    struct SBenchResult {
+        double seconds;
+        long long systemCalls;      // -1 이면 알 수 없음
+        unsigned long long bytes;
+    };
+
+    void printResult(const char* caseName, int records, const SBenchResult& result) {
+        double perMillion = 1000000.0 / records;
+        char syscalls[32] = "-";
+        if (result.systemCalls >= 0) {
+            std::snprintf(syscalls, sizeof(syscalls), "%.0f", result.systemCalls * perMillion);
+        }
+        std::fprintf(stderr, "%-30s records/s = %10.0f, MB/s = %7.1f, syscalls/1M records = %s\n", caseName,
+            records / result.seconds, result.bytes / result.seconds / (1024.0 * 1024.0), syscalls);
+    }
+
+    // 로그 호출부터 파일 기록 완료까지
+    SBenchResult runLogs(const std::shared_ptr<CLogSink>& sink, int records) {
+        auto& logger = CLogger::getInstance();
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ sink });
+
+        long long syscallsBefore = readWriteSyscalls();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < records; ++i) {
+            LOG_INFOF("request {} from worker {} took {} ms, status = {}", i, i % 8, i * 0.25, "ok");
+        }
+        logger.flush();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        long long syscallsAfter = readWriteSyscalls();
+
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>());
+        SBenchResult result;
+        result.seconds = std::chrono::duration<double>(elapsed).count();
+        result.systemCalls = syscallsBefore >= 0 ? syscallsAfter - syscallsBefore : -1;
+        std::ifstream written(kBenchFile, std::ios::binary | std::ios::ate);
+        result.bytes = static_cast<unsigned long long>(written.tellg());
+        return result;
+    }
+
+    // 이전 방식 : 로그마다 로그파일을 열어서 기록하고 닫는다.
+    void runPerRecordOpen(int records) {
+        std::remove(kBenchFile);
+        auto sink = std::make_shared<CCallbackLogSink>([](const SLogEvent&, const char* text, size_t size) {
+            std::ofstream logFile(kBenchFile, std::ios::app);
+            logFile.write(text, static_cast<std::streamsize>(size));
+        });
+        SBenchResult result = runLogs(sink, records);
+        if (result.systemCalls >= 0) {
+            result.systemCalls += 2LL * records;
+        }
+        printResult("open/write/close", records, result);
+    }
+
+    // flushThreshold : 0 이면 로그마다 flush (기본 정책), 아니면 이 byte 수마다 flush
+    void runFileSink(const char* caseName, int records, EFileWriteMode eWriteMode, unsigned long long flushThreshold) {
+        auto sink = std::make_shared<CFileLogSink>(kBenchFile);
+        if (flushThreshold > 0) {
+            sink->setFlushPolicy(EFlushPolicy::EVERY_N_BYTES, flushThreshold);
+        }
+        try {
+            sink->setWriteMode(eWriteMode);
+        }
+        catch (const std::runtime_error& e) {
+            std::fprintf(stderr, "%-30s skipped (%s)\n", caseName, e.what());
+            return;
+        }
+        SBenchResult result = runLogs(sink, records);
+        if (eWriteMode == EFileWriteMode::IO_URING) {
+            // 커널이 기록하므로 syscw 에 잡히지 않는다.
+            result.systemCalls = static_cast<long long>(sink->getWriteStats().systemCallCount);
+        }
+        printResult(caseName, records, result);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int records = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    if (records <= 0) {
+        records = 1000000;
+    }
+
+    // 로그마다 open/close 하는 방식은 느리므로 1/10 만 기록하고 같은 기준으로 환산
+    runPerRecordOpen((std::max)(records / 10, 1));
+    const unsigned long long kFlushBytes = 64 * 1024;
+    runFileSink("ofstream, flush every record", records, EFileWriteMode::STREAM, 0);
+    runFileSink("writev, flush every record", records, EFileWriteMode::WRITEV, 0);
+    runFileSink("io_uring, flush every record", records, EFileWriteMode::IO_URING, 0);
+    runFileSink("ofstream, flush every 64KB", records, EFileWriteMode::STREAM, kFlushBytes);
+    runFileSink("writev, flush every 64KB", records, EFileWriteMode::WRITEV, kFlushBytes);
+    runFileSink("io_uring, flush every 64KB", records, EFileWriteMode::IO_URING, kFlushBytes);
+    std::remove(kBenchFile);
+    return 0;
+}
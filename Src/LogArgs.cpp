@@ -0,0 +1,190 @@
+﻿#include "pch.h"
+#include "LogArgs.h"
+#include <cstdio>
+
+namespace LogArgs {
+
+    template <typename T>
+    static bool readRaw(const char* arg, size_t argSize, T& value) {
+        if (argSize < 1 + sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, arg + 1, sizeof(T));
+        return true;
+    }
+
+    /// <summary>
+    /// 저장된 인자 하나가 차지하는 byte 수. 잘못된 데이터면 0
+    /// </summary>
+    size_t encodedSize(const char* arg, size_t argSize) {
+        if (argSize < 1) {
+            return 0;
+        }
+        size_t size = 0;
+        switch (static_cast<ELogArgType>(arg[0])) {
+        case ELogArgType::INT: size = 1 + sizeof(int64_t); break;
+        case ELogArgType::UINT: size = 1 + sizeof(uint64_t); break;
+        case ELogArgType::DOUBLE: size = 1 + sizeof(double); break;
+        case ELogArgType::CHAR: size = 1 + sizeof(char); break;
+        case ELogArgType::BOOL: size = 1 + sizeof(unsigned char); break;
+        case ELogArgType::POINTER: size = 1 + sizeof(uintptr_t); break;
+        case ELogArgType::STRING:
+        case ELogArgType::FIELD_KEY: {
+            uint32_t length;
+            if (!readRaw(arg, argSize, length)) return 0;
+            size = 1 + sizeof(length) + length;
+            break;
+        }
+        default: return 0;
+        }
+        return size <= argSize ? size : 0;
+    }
+
+    /// <summary>
+    /// 저장된 인자 하나를 문자열로 변환
+    /// </summary>
+    /// <param name="line : 출력 버퍼"></param>
+    /// <param name="arg : [타입][값] 형태의 인자 시작 위치"></param>
+    /// <param name="argSize : arg 이후 남은 byte 수"></param>
+    /// <returns>읽은 byte 수, 잘못된 데이터면 0</returns>
+    size_t renderOne(CLogLineBuffer& line, const char* arg, size_t argSize) {
+        if (argSize < 1) {
+            return 0;
+        }
+        char text[64];
+        switch (static_cast<ELogArgType>(arg[0])) {
+        case ELogArgType::INT: {
+            int64_t value;
+            if (!readRaw(arg, argSize, value)) return 0;
+            line.appendInt(value);
+            return 1 + sizeof(value);
+        }
+        case ELogArgType::UINT: {
+            uint64_t value;
+            if (!readRaw(arg, argSize, value)) return 0;
+            int size = std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+            line.append(text, static_cast<size_t>(size));
+            return 1 + sizeof(value);
+        }
+        case ELogArgType::DOUBLE: {
+            double value;
+            if (!readRaw(arg, argSize, value)) return 0;
+            int size = std::snprintf(text, sizeof(text), "%g", value);
+            line.append(text, static_cast<size_t>(size));
+            return 1 + sizeof(value);
+        }
+        case ELogArgType::CHAR: {
+            char value;
+            if (!readRaw(arg, argSize, value)) return 0;
+            line.append(value);
+            return 1 + sizeof(value);
+        }
+        case ELogArgType::BOOL: {
+            unsigned char value;
+            if (!readRaw(arg, argSize, value)) return 0;
+            line.append(value ? "true" : "false");
+            return 1 + sizeof(value);
+        }
+        case ELogArgType::POINTER: {
+            uintptr_t value;
+            if (!readRaw(arg, argSize, value)) return 0;
+            int size = std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(value));
+            line.append(text, static_cast<size_t>(size));
+            return 1 + sizeof(value);
+        }
+        case ELogArgType::STRING:
+        case ELogArgType::FIELD_KEY: {
+            uint32_t length;
+            if (!readRaw(arg, argSize, length) || argSize < 1 + sizeof(length) + length) return 0;
+            line.append(arg + 1 + sizeof(length), length);
+            return 1 + sizeof(length) + length;
+        }
+        }
+        return 0;
+    }
+
+    /// <summary>
+    /// format 의 "{}" 자리에 저장된 인자를 순서대로 채우고, 구조화 필드를 " 이름=값" 형태로 붙여서 line 에 기록
+    /// </summary>
+    /// <returns>args 에서 읽은 byte 수</returns>
+    size_t render(CLogLineBuffer& line, const char* format, const char* args, size_t argsSize, unsigned argCount) {
+        unsigned used = 0;
+        size_t offset = renderMessage(line, format, args, argsSize, argCount, used);
+        while (used + 1 < argCount && offset < argsSize) {
+            if (static_cast<ELogArgType>(args[offset]) != ELogArgType::FIELD_KEY) {
+                break;
+            }
+            line.append(' ');
+            size_t keySize = renderOne(line, args + offset, argsSize - offset);
+            if (keySize == 0) {
+                break;
+            }
+            line.append('=');
+            size_t valueSize = renderOne(line, args + offset + keySize, argsSize - offset - keySize);
+            if (valueSize == 0) {
+                line.append("{?}", 3);
+                break;
+            }
+            offset += keySize + valueSize;
+            used += 2;
+        }
+        return offset;
+    }
+
+    /// <summary>
+    /// format 의 "{}" 자리에 저장된 인자를 순서대로 채워서 line 에 기록 (구조화 필드는 채우지 않음)
+    /// </summary>
+    /// <returns>args 에서 읽은 byte 수 (첫 구조화 필드의 위치)</returns>
+    size_t renderMessage(CLogLineBuffer& line, const char* format, const char* args, size_t argsSize, unsigned argCount,
+        unsigned& usedCount) {
+        size_t offset = 0;
+        unsigned used = 0;
+        // 구조화 필드 앞의 인자만 "{}" 에 채운다.
+        bool fieldsReached = false;
+        const char* literalStart = format;
+        const char* p = format;
+        while (*p != '\0') {
+            if ((p[0] == '{' && p[1] == '{') || (p[0] == '}' && p[1] == '}')) {
+                line.append(literalStart, static_cast<size_t>(p - literalStart) + 1);
+                p += 2;
+                literalStart = p;
+                continue;
+            }
+            if (p[0] == '{' && p[1] == '}' && used < argCount && !fieldsReached) {
+                if (offset < argsSize && static_cast<ELogArgType>(args[offset]) == ELogArgType::FIELD_KEY) {
+                    fieldsReached = true;
+                    p += 2;
+                    continue;
+                }
+                line.append(literalStart, static_cast<size_t>(p - literalStart));
+                size_t consumed = renderOne(line, args + offset, argsSize - offset);
+                if (consumed == 0) {
+                    line.append("{?}", 3);
+                    used = argCount;    // 이후 인자는 신뢰할 수 없음
+                }
+                offset += consumed;
+                ++used;
+                p += 2;
+                literalStart = p;
+                continue;
+            }
+            ++p;
+        }
+        line.append(literalStart, static_cast<size_t>(p - literalStart));
+
+        // 출력하지 않은 나머지 인자는 건너뛴다.
+        while (used < argCount && offset < argsSize) {
+            if (static_cast<ELogArgType>(args[offset]) == ELogArgType::FIELD_KEY) {
+                break;
+            }
+            size_t consumed = encodedSize(args + offset, argsSize - offset);
+            if (consumed == 0) {
+                break;
+            }
+            offset += consumed;
+            ++used;
+        }
+        usedCount = used;
+        return offset;
+    }
+}
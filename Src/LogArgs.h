@@ -0,0 +1,134 @@
+﻿// LogArgs.h
+#ifndef LogArgs_H
+#define LogArgs_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "LogLineBuffer.h"
+
+// LOG_*F 지연 포맷 인자의 저장 형식
+// 호출 스레드는 인자를 [타입 1 byte][값] 형태로 복사만 하고, 문자열 변환은 writer 스레드에서 한다.
+enum class ELogArgType : unsigned char {
+    INT,        // int64
+    UINT,       // uint64
+    DOUBLE,
+    CHAR,
+    BOOL,
+    POINTER,
+    STRING,     // uint32 길이 + 문자열 내용 (호출 시점의 내용을 복사)
+    FIELD_KEY   // 구조화 필드 이름 (STRING 과 같은 형식), 바로 다음 인자가 필드 값
+};
+
+namespace LogArgs {
+
+    template <typename T>
+    inline void appendRaw(CLogLineBuffer& buffer, ELogArgType eType, const T& value) {
+        char bytes[1 + sizeof(T)];
+        bytes[0] = static_cast<char>(eType);
+        std::memcpy(bytes + 1, &value, sizeof(T));
+        buffer.append(bytes, sizeof(bytes));
+    }
+
+    inline void appendString(CLogLineBuffer& buffer, const char* text, size_t size,
+        ELogArgType eType = ELogArgType::STRING) {
+        uint32_t length = static_cast<uint32_t>(size);
+        appendRaw(buffer, eType, length);
+        buffer.append(text, length);
+    }
+
+    // 정수/열거형
+    template <typename T>
+    inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+        encode(CLogLineBuffer& buffer, T value) {
+        appendRaw(buffer, ELogArgType::INT, static_cast<int64_t>(value));
+    }
+
+    template <typename T>
+    inline typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+        encode(CLogLineBuffer& buffer, T value) {
+        appendRaw(buffer, ELogArgType::UINT, static_cast<uint64_t>(value));
+    }
+
+    template <typename T>
+    inline typename std::enable_if<std::is_enum<T>::value>::type
+        encode(CLogLineBuffer& buffer, T value) {
+        appendRaw(buffer, ELogArgType::INT, static_cast<int64_t>(value));
+    }
+
+    template <typename T>
+    inline typename std::enable_if<std::is_floating_point<T>::value>::type
+        encode(CLogLineBuffer& buffer, T value) {
+        appendRaw(buffer, ELogArgType::DOUBLE, static_cast<double>(value));
+    }
+
+    inline void encode(CLogLineBuffer& buffer, bool value) {
+        appendRaw(buffer, ELogArgType::BOOL, static_cast<unsigned char>(value ? 1 : 0));
+    }
+
+    inline void encode(CLogLineBuffer& buffer, char value) {
+        appendRaw(buffer, ELogArgType::CHAR, value);
+    }
+
+    inline void encode(CLogLineBuffer& buffer, const char* value) {
+        if (value == nullptr) {
+            value = "(null)";
+        }
+        appendString(buffer, value, std::strlen(value));
+    }
+
+    inline void encode(CLogLineBuffer& buffer, char* value) {
+        encode(buffer, static_cast<const char*>(value));
+    }
+
+    inline void encode(CLogLineBuffer& buffer, const std::string& value) {
+        appendString(buffer, value.data(), value.size());
+    }
+
+    template <typename T>
+    inline void encode(CLogLineBuffer& buffer, T* value) {
+        appendRaw(buffer, ELogArgType::POINTER, reinterpret_cast<uintptr_t>(value));
+    }
+
+    inline void encodeAll(CLogLineBuffer&) {
+    }
+
+    template <typename T, typename... Rest>
+    inline void encodeAll(CLogLineBuffer& buffer, const T& value, const Rest&... rest) {
+        encode(buffer, value);
+        encodeAll(buffer, rest...);
+    }
+
+    // 구조화 필드 : 이름, 값 순서로 저장 (LOG_*_KV)
+    inline void encodeFields(CLogLineBuffer&) {
+    }
+
+    template <typename T, typename... Rest>
+    inline void encodeFields(CLogLineBuffer& buffer, const char* key, const T& value, const Rest&... rest) {
+        appendString(buffer, key, std::strlen(key), ELogArgType::FIELD_KEY);
+        encode(buffer, value);
+        encodeFields(buffer, rest...);
+    }
+
+    // 저장된 인자를 "{}" 자리에 채워서 line 에 기록. ("{{", "}}" 는 중괄호 문자)
+    // 인자가 모자라면 "{}" 를 그대로 두고, 남는 인자는 무시한다.
+    // 구조화 필드는 메시지 뒤에 " 이름=값" 형태로 붙인다.
+    // 반환값 : args 에서 읽은 byte 수
+    size_t render(CLogLineBuffer& line, const char* format, const char* args, size_t argsSize, unsigned argCount);
+
+    // render 에서 구조화 필드를 제외한 메시지 부분만 기록
+    // usedCount : 읽은 인자 개수, 반환값 : args 에서 읽은 byte 수 (첫 구조화 필드의 위치)
+    size_t renderMessage(CLogLineBuffer& line, const char* format, const char* args, size_t argsSize, unsigned argCount,
+        unsigned& usedCount);
+
+    // 저장된 인자 하나를 문자열로 변환해 line 에 기록. 반환값 : 읽은 byte 수 (0 이면 잘못된 데이터)
+    size_t renderOne(CLogLineBuffer& line, const char* arg, size_t argSize);
+
+    // 저장된 인자 하나가 차지하는 byte 수 (0 이면 잘못된 데이터)
+    size_t encodedSize(const char* arg, size_t argSize);
+}
+
+#endif // LogArgs_H
@@ -0,0 +1,540 @@
+﻿#include "pch.h"
+#include "LogBatchedFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#if defined(LOGGER_WITH_IO_URING) && defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define LOG_BATCHED_FILE_HAS_IO_URING 1
+#endif
+
+namespace {
+    // writev 한 번에 넘길 수 있는 최대 iovec 개수
+#ifdef IOV_MAX
+    const size_t kMaxPieces = IOV_MAX;
+#else
+    const size_t kMaxPieces = 1024;
+#endif
+    // 이보다 짧은 로그는 참조 대신 복사해서 앞뒤 조각과 합친다. (iovec 개수를 줄임)
+    const size_t kMinReferencedSize = 64;
+    // io_uring 버퍼 하나의 최소 크기
+    const size_t kMinUringBufferSize = 4 * 1024;
+}
+
+#ifdef LOG_BATCHED_FILE_HAS_IO_URING
+// io_uring 링 (liburing 없이 io_uring_setup/io_uring_enter/io_uring_register 를 직접 호출)
+struct CBatchedLogFile::SUring {
+    int ringDescriptor = -1;
+    void* sqRing = nullptr;
+    size_t sqRingSize = 0;
+    void* cqRing = nullptr;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqesSize = 0;
+
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    bool fixedBuffers = false;      // 버퍼 등록에 성공하면 IORING_OP_WRITE_FIXED 사용
+
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        for (;;) {
+            long result = syscall(__NR_io_uring_enter, ringDescriptor, toSubmit, minComplete, flags, nullptr, 0);
+            if (result >= 0 || errno != EINTR) {
+                return static_cast<int>(result);
+            }
+        }
+    }
+};
+#else
+struct CBatchedLogFile::SUring {
+};
+#endif
+
+/// <summary>
+/// 묶음 기록 로그파일
+/// </summary>
+/// <param name="eWriteMode : WRITEV 또는 IO_URING"></param>
+/// <param name="queueDepth : IO_URING 의 버퍼 개수 (동시에 진행할 수 있는 기록 개수)"></param>
+/// <param name="bufferSize : 모아 둘 최대 크기 (IO_URING 은 버퍼 하나의 크기)"></param>
+CBatchedLogFile::CBatchedLogFile(EFileWriteMode eWriteMode, unsigned queueDepth, size_t bufferSize)
+    : writeMode(eWriteMode), queueDepth((std::max)(queueDepth, 1u)), bufferSize(bufferSize)
+{
+    if (eWriteMode == EFileWriteMode::IO_URING) {
+#ifndef LOG_BATCHED_FILE_HAS_IO_URING
+        throw std::runtime_error("io_uring write mode requires Linux and building with LOGGER_WITH_IO_URING.");
+#else
+        this->bufferSize = (std::max)(bufferSize, kMinUringBufferSize);
+        setupUring();
+#endif
+    }
+    else {
+        staging.reserve(bufferSize);
+        pendingPieces.reserve(kMaxPieces);
+    }
+}
+
+CBatchedLogFile::~CBatchedLogFile() {
+    close();
+    teardownUring();
+}
+
+/// <summary>
+/// 로그파일 열기
+/// </summary>
+/// <param name="filename"></param>
+/// <param name="append : true 면 기존 내용 뒤에 이어서 기록"></param>
+void CBatchedLogFile::open(const std::string& filename, bool append) {
+    close();
+    this->filename = filename;
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        append ? OPEN_ALWAYS : CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Unable to open log file: " + filename);
+    }
+    LARGE_INTEGER existingSize;
+    fileSize = GetFileSizeEx(handle, &existingSize) ? static_cast<unsigned long long>(existingSize.QuadPart) : 0;
+    LARGE_INTEGER distance;
+    distance.QuadPart = 0;
+    SetFilePointerEx(handle, distance, nullptr, FILE_END);
+    fileHandle = handle;
+#else
+    // io_uring 은 파일 위치를 직접 지정하므로 O_APPEND 를 사용하지 않는다.
+    fileDescriptor = ::open(filename.c_str(), O_WRONLY | O_CREAT | (append ? 0 : O_TRUNC), 0644);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Unable to open log file: " + filename);
+    }
+    off_t existingSize = ::lseek(fileDescriptor, 0, SEEK_END);
+    fileSize = existingSize > 0 ? static_cast<unsigned long long>(existingSize) : 0;
+#endif
+    fileOpen = true;
+    submittedOffset = fileSize;
+    pendingPieces.clear();
+    staging.clear();
+    pendingBytes = 0;
+}
+
+void CBatchedLogFile::close() {
+    if (!fileOpen) {
+        return;
+    }
+    flush();
+#ifdef _WIN32
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = nullptr;
+#else
+    ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    fileOpen = false;
+}
+
+/// <summary>
+/// 로그 하나를 모아 둔다. 모아 둔 크기나 개수가 한도를 넘으면 먼저 기록한다.
+/// </summary>
+/// <param name="data"></param>
+/// <param name="size"></param>
+/// <param name="stable : 다음 submit 까지 data 의 내용이 그대로 남아 있으면 true"></param>
+void CBatchedLogFile::append(const char* data, size_t size, bool stable) {
+    if (!fileOpen || size == 0) {
+        return;
+    }
+    ++stats.recordCount;
+    fileSize += size;
+    if (writeMode == EFileWriteMode::IO_URING) {
+        appendToUring(data, size);
+        return;
+    }
+
+#ifdef _WIN32
+    // WriteFile 은 한 버퍼만 받으므로 항상 모아서 기록
+    stable = false;
+#endif
+    if (pendingPieces.size() >= kMaxPieces || pendingBytes + size > bufferSize) {
+        submitVectored();
+    }
+    if (stable && size >= kMinReferencedSize) {
+        SPendingPiece piece = { data, 0, size };
+        pendingPieces.push_back(piece);
+    }
+    else {
+        // 바로 앞 조각도 복사한 것이면 하나로 합친다.
+        if (!pendingPieces.empty() && pendingPieces.back().data == nullptr) {
+            pendingPieces.back().size += size;
+        }
+        else {
+            SPendingPiece piece = { nullptr, staging.size(), size };
+            pendingPieces.push_back(piece);
+        }
+        staging.insert(staging.end(), data, data + size);
+    }
+    pendingBytes += size;
+}
+
+void CBatchedLogFile::submit() {
+    if (!fileOpen) {
+        return;
+    }
+    if (writeMode == EFileWriteMode::IO_URING) {
+        submitUringBuffer();
+        reapUring(false);
+        return;
+    }
+    submitVectored();
+}
+
+/// <summary>
+/// 참조만 해 둔 조각을 staging 으로 복사해서 순서대로 하나로 합친다.
+/// </summary>
+void CBatchedLogFile::retain() {
+    bool referenced = false;
+    for (const auto& piece : pendingPieces) {
+        if (piece.data != nullptr) {
+            referenced = true;
+            break;
+        }
+    }
+    if (!referenced) {
+        return;
+    }
+    thread_local std::vector<char> merged;
+    merged.clear();
+    merged.reserve((std::max)(pendingBytes, bufferSize));
+    for (const auto& piece : pendingPieces) {
+        const char* data = piece.data != nullptr ? piece.data : staging.data() + piece.offset;
+        merged.insert(merged.end(), data, data + piece.size);
+    }
+    staging.swap(merged);
+    pendingPieces.clear();
+    SPendingPiece piece = { nullptr, 0, staging.size() };
+    pendingPieces.push_back(piece);
+}
+
+void CBatchedLogFile::flush() {
+    submit();
+    if (writeMode == EFileWriteMode::IO_URING) {
+        while (inFlightCount > 0) {
+            reapUring(true);
+        }
+    }
+}
+
+/// <summary>
+/// 모아 둔 조각을 writev 한 번으로 기록 (일부만 기록되면 나머지를 이어서 기록)
+/// </summary>
+void CBatchedLogFile::submitVectored() {
+    if (pendingPieces.empty()) {
+        return;
+    }
+    ++stats.batchCount;
+#ifdef _WIN32
+    // Windows 는 모든 조각이 staging 에 연속으로 들어 있다.
+    writeAll(staging.data(), staging.size());
+#else
+    // 묶음마다 새로 할당하지 않도록 재사용
+    thread_local std::vector<iovec> vectors;
+    vectors.resize(pendingPieces.size());
+    for (size_t i = 0; i < pendingPieces.size(); ++i) {
+        const SPendingPiece& piece = pendingPieces[i];
+        vectors[i].iov_base = const_cast<char*>(piece.data != nullptr ? piece.data : staging.data() + piece.offset);
+        vectors[i].iov_len = piece.size;
+    }
+
+    iovec* next = vectors.data();
+    size_t remaining = vectors.size();
+    while (remaining > 0) {
+        ++stats.systemCallCount;
+        ssize_t written = ::writev(fileDescriptor, next, static_cast<int>(remaining));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // 디스크 가득 참 등 : 이번 묶음은 버린다. (ofstream 과 같이 로그 호출에는 알리지 않음)
+            break;
+        }
+        stats.writtenBytes += static_cast<unsigned long long>(written);
+        size_t done = static_cast<size_t>(written);
+        while (remaining > 0 && done >= next->iov_len) {
+            done -= next->iov_len;
+            ++next;
+            --remaining;
+        }
+        if (remaining > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + done;
+            next->iov_len -= done;
+        }
+    }
+#endif
+    pendingPieces.clear();
+    staging.clear();
+    pendingBytes = 0;
+}
+
+/// <summary>
+/// 현재 파일 위치에 data 를 모두 기록 (동기)
+/// </summary>
+void CBatchedLogFile::writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        ++stats.systemCallCount;
+#ifdef _WIN32
+        DWORD written = 0;
+        DWORD chunk = static_cast<DWORD>((std::min)(size, static_cast<size_t>(1u << 30)));
+        if (!WriteFile(static_cast<HANDLE>(fileHandle), data, chunk, &written, nullptr) || written == 0) {
+            return;
+        }
+#else
+        ssize_t written = ::write(fileDescriptor, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return;
+        }
+#endif
+        stats.writtenBytes += static_cast<unsigned long long>(written);
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+#ifdef LOG_BATCHED_FILE_HAS_IO_URING
+
+/// <summary>
+/// io_uring 링을 만들고 버퍼를 커널에 등록
+/// 등록에 실패하면(메모리 잠금 한도 등) 등록하지 않은 버퍼로 IORING_OP_WRITE 를 사용한다.
+/// </summary>
+void CBatchedLogFile::setupUring() {
+    uring.reset(new SUring());
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    long ringDescriptor = syscall(__NR_io_uring_setup, queueDepth, &params);
+    if (ringDescriptor < 0) {
+        uring.reset();
+        throw std::runtime_error("io_uring_setup failed: " + std::string(std::strerror(errno)));
+    }
+    SUring& ring = *uring;
+    ring.ringDescriptor = static_cast<int>(ringDescriptor);
+
+    ring.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        ring.sqRingSize = ring.cqRingSize = (std::max)(ring.sqRingSize, ring.cqRingSize);
+    }
+    void* sqRing = mmap(nullptr, ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ring.ringDescriptor, IORING_OFF_SQ_RING);
+    void* cqRing = singleMap ? sqRing : mmap(nullptr, ring.cqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring.ringDescriptor, IORING_OFF_CQ_RING);
+    ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        ring.ringDescriptor, IORING_OFF_SQES);
+    ring.sqRing = sqRing == MAP_FAILED ? nullptr : sqRing;
+    ring.cqRing = cqRing == MAP_FAILED ? nullptr : cqRing;
+    ring.sqes = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe*>(sqes);
+    if (ring.sqRing == nullptr || ring.cqRing == nullptr || ring.sqes == nullptr) {
+        teardownUring();
+        throw std::runtime_error("io_uring ring mapping failed.");
+    }
+
+    char* sqBase = static_cast<char*>(ring.sqRing);
+    char* cqBase = static_cast<char*>(ring.cqRing);
+    ring.sqTail = reinterpret_cast<unsigned*>(sqBase + params.sq_off.tail);
+    ring.sqMask = reinterpret_cast<unsigned*>(sqBase + params.sq_off.ring_mask);
+    ring.sqArray = reinterpret_cast<unsigned*>(sqBase + params.sq_off.array);
+    ring.cqHead = reinterpret_cast<unsigned*>(cqBase + params.cq_off.head);
+    ring.cqTail = reinterpret_cast<unsigned*>(cqBase + params.cq_off.tail);
+    ring.cqMask = reinterpret_cast<unsigned*>(cqBase + params.cq_off.ring_mask);
+    ring.cqes = reinterpret_cast<io_uring_cqe*>(cqBase + params.cq_off.cqes);
+
+    // 버퍼는 페이지 단위로 정렬해서 한 번에 할당
+    const size_t kPageSize = 4096;
+    bufferSize = (bufferSize + kPageSize - 1) / kPageSize * kPageSize;
+    uringMemory.reset(new char[bufferSize * queueDepth + kPageSize]);
+    char* alignedBase = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(uringMemory.get()) + kPageSize - 1) / kPageSize * kPageSize);
+    uringBuffers.assign(queueDepth, SUringBuffer());
+    std::vector<iovec> registered(queueDepth);
+    for (unsigned i = 0; i < queueDepth; ++i) {
+        uringBuffers[i].data = alignedBase + bufferSize * i;
+        registered[i].iov_base = uringBuffers[i].data;
+        registered[i].iov_len = bufferSize;
+    }
+    ring.fixedBuffers = syscall(__NR_io_uring_register, ring.ringDescriptor, IORING_REGISTER_BUFFERS,
+        registered.data(), queueDepth) == 0;
+    currentBuffer = 0;
+    inFlightCount = 0;
+}
+
+void CBatchedLogFile::teardownUring() {
+    if (!uring) {
+        return;
+    }
+    SUring& ring = *uring;
+    if (ring.sqes != nullptr) {
+        munmap(ring.sqes, ring.sqesSize);
+    }
+    if (ring.cqRing != nullptr && ring.cqRing != ring.sqRing) {
+        munmap(ring.cqRing, ring.cqRingSize);
+    }
+    if (ring.sqRing != nullptr) {
+        munmap(ring.sqRing, ring.sqRingSize);
+    }
+    if (ring.ringDescriptor >= 0) {
+        // 링을 닫으면 등록한 버퍼도 해제된다.
+        ::close(ring.ringDescriptor);
+    }
+    uring.reset();
+}
+
+/// <summary>
+/// 현재 버퍼에 복사. 가득 차면 제출하고 다음 버퍼로 넘어간다.
+/// </summary>
+void CBatchedLogFile::appendToUring(const char* data, size_t size) {
+    while (size > 0) {
+        SUringBuffer& buffer = uringBuffers[currentBuffer];
+        size_t chunk = (std::min)(size, bufferSize - buffer.size);
+        std::memcpy(buffer.data + buffer.size, data, chunk);
+        buffer.size += chunk;
+        data += chunk;
+        size -= chunk;
+        if (buffer.size == bufferSize) {
+            submitUringBuffer();
+        }
+    }
+}
+
+/// <summary>
+/// 현재 버퍼를 제출하고 다음 버퍼로 넘어간다. 다음 버퍼가 아직 기록 중이면 완료될 때까지 대기
+/// </summary>
+void CBatchedLogFile::submitUringBuffer() {
+    SUringBuffer& buffer = uringBuffers[currentBuffer];
+    if (buffer.size == 0) {
+        return;
+    }
+    SUring& ring = *uring;
+    buffer.fileOffset = submittedOffset;
+    buffer.inFlight = true;
+    submittedOffset += buffer.size;
+
+    // 제출 큐 항목은 링 크기(queueDepth 이상)보다 많이 쌓이지 않는다. (버퍼 개수 = 동시 기록 개수)
+    unsigned tail = *ring.sqTail;
+    unsigned index = tail & *ring.sqMask;
+    io_uring_sqe& sqe = ring.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = ring.fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.fd = fileDescriptor;
+    sqe.addr = reinterpret_cast<unsigned long long>(buffer.data);
+    sqe.len = static_cast<unsigned>(buffer.size);
+    sqe.off = buffer.fileOffset;
+    sqe.buf_index = static_cast<unsigned short>(currentBuffer);
+    sqe.user_data = currentBuffer;
+    ring.sqArray[index] = index;
+    __atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    ++stats.batchCount;
+    ++stats.systemCallCount;
+    ++inFlightCount;
+    if (ring.enter(1, 0, 0) < 0) {
+        // 제출하지 못하면 직접 기록
+        __atomic_store_n(ring.sqTail, tail, __ATOMIC_RELEASE);
+        --inFlightCount;
+        completeUringBuffer(buffer, 0);
+    }
+
+    currentBuffer = (currentBuffer + 1) % uringBuffers.size();
+    while (uringBuffers[currentBuffer].inFlight) {
+        reapUring(true);
+    }
+}
+
+/// <summary>
+/// 완료된 기록을 꺼내서 버퍼를 다시 사용할 수 있게 한다.
+/// </summary>
+/// <param name="wait : true 면 하나 이상 완료될 때까지 대기"></param>
+void CBatchedLogFile::reapUring(bool wait) {
+    SUring& ring = *uring;
+    if (wait && inFlightCount > 0) {
+        unsigned head = *ring.cqHead;
+        if (head == __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE)) {
+            ++stats.systemCallCount;
+            ring.enter(0, 1, IORING_ENTER_GETEVENTS);
+        }
+    }
+    unsigned head = *ring.cqHead;
+    unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+        SUringBuffer& buffer = uringBuffers[static_cast<size_t>(cqe.user_data)];
+        int result = cqe.res;
+        ++head;
+        __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+        --inFlightCount;
+        completeUringBuffer(buffer, result);
+    }
+}
+
+/// <summary>
+/// 기록이 끝난 버퍼 정리. 일부만 기록되었거나 실패하면 남은 부분을 pwrite 로 직접 기록한다.
+/// </summary>
+/// <param name="buffer"></param>
+/// <param name="result : 기록한 byte 수 또는 -errno"></param>
+void CBatchedLogFile::completeUringBuffer(SUringBuffer& buffer, int result) {
+    size_t done = result > 0 ? static_cast<size_t>(result) : 0;
+    stats.writtenBytes += done;
+    while (done < buffer.size) {
+        ++stats.systemCallCount;
+        ssize_t written = ::pwrite(fileDescriptor, buffer.data + done, buffer.size - done,
+            static_cast<off_t>(buffer.fileOffset + done));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            break;
+        }
+        stats.writtenBytes += static_cast<unsigned long long>(written);
+        done += static_cast<size_t>(written);
+    }
+    buffer.size = 0;
+    buffer.inFlight = false;
+}
+
+#else
+
+void CBatchedLogFile::setupUring() {
+}
+
+void CBatchedLogFile::teardownUring() {
+}
+
+void CBatchedLogFile::appendToUring(const char*, size_t) {
+}
+
+void CBatchedLogFile::submitUringBuffer() {
+}
+
+void CBatchedLogFile::reapUring(bool) {
+}
+
+void CBatchedLogFile::completeUringBuffer(SUringBuffer&, int) {
+}
+
+#endif
@@ -0,0 +1,112 @@
+﻿// CBatchedLogFile.h
+#ifndef CBatchedLogFile_H
+#define CBatchedLogFile_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+// CBatchedLogFile 기록 통계
+struct SBatchedWriteStats {
+    unsigned long long recordCount = 0;     // append 횟수
+    unsigned long long batchCount = 0;      // 묶어서 기록한 횟수
+    unsigned long long systemCallCount = 0; // writev / io_uring_enter / WriteFile 호출 횟수
+    unsigned long long writtenBytes = 0;
+};
+
+// 로그를 모아 두었다가 한 번의 시스템 호출로 기록하는 로그파일
+// WRITEV   : 로그마다 iovec 하나를 만들어 writev 한 번으로 기록한다.
+//            submit 까지 내용이 남아 있는 로그(sink 큐 슬롯의 텍스트)는 복사하지 않고 그 위치를 그대로 참조한다.
+//            (writev 가 없는 Windows 는 한 버퍼에 모아 WriteFile 한 번으로 기록)
+// IO_URING : 커널에 등록(register)한 queueDepth 개의 버퍼에 로그를 모으고, 가득 찬 버퍼를 io_uring 으로 제출한다.
+//            기록 완료를 기다리지 않고 다음 버퍼에 계속 모으며, 최대 queueDepth 개의 기록이 동시에 진행된다.
+//            Linux 에서 LOGGER_WITH_IO_URING 을 정의해야 사용할 수 있다. (liburing 없이 커널 헤더만 사용)
+// 한 스레드(sink 의 전용 스레드)에서만 호출한다.
+class CBatchedLogFile {
+public:
+    // bufferSize : 모아 둘 최대 크기 (IO_URING 은 버퍼 하나의 크기)
+    // eWriteMode 를 이 빌드에서 사용할 수 없으면 std::runtime_error
+    CBatchedLogFile(EFileWriteMode eWriteMode, unsigned queueDepth, size_t bufferSize = 256 * 1024);
+    ~CBatchedLogFile();
+
+    // append 가 false 면 기존 내용을 삭제하고, true 면 파일 끝에 이어서 기록. 실패하면 std::runtime_error
+    void open(const std::string& filename, bool append);
+    // 남은 로그를 기록하고 파일을 닫는다.
+    void close();
+    bool isOpen() const { return fileOpen; }
+
+    // stable : 다음 submit 까지 data 의 내용이 그대로 남아 있으면 true (WRITEV 는 복사하지 않고 참조)
+    void append(const char* data, size_t size, bool stable);
+    // 모아 둔 로그를 기록 (IO_URING 은 제출만 하고 완료를 기다리지 않음)
+    void submit();
+    // 아직 기록하지 않은 로그 중 참조만 해 둔 것을 복사 (stable 로 넘긴 data 가 곧 바뀌는 경우)
+    void retain();
+    // 모아 둔 로그를 기록하고 모든 기록이 끝날 때까지 대기
+    void flush();
+
+    EFileWriteMode getWriteMode() const { return writeMode; }
+    // 기록했거나 모아 둔 내용을 포함한 파일 크기
+    unsigned long long getFileSize() const { return fileSize; }
+    const SBatchedWriteStats& getStats() const { return stats; }
+
+private:
+    CBatchedLogFile(const CBatchedLogFile&) = delete;
+    CBatchedLogFile& operator=(const CBatchedLogFile&) = delete;
+
+    // 모아 둔 로그 조각. data 가 nullptr 이면 staging 의 offset 위치
+    struct SPendingPiece {
+        const char* data;
+        size_t offset;
+        size_t size;
+    };
+
+    // io_uring 으로 기록할 버퍼
+    struct SUringBuffer {
+        char* data = nullptr;
+        size_t size = 0;
+        unsigned long long fileOffset = 0;
+        bool inFlight = false;
+    };
+
+    struct SUring;
+
+    void submitVectored();
+    void writeAll(const char* data, size_t size);
+    void appendToUring(const char* data, size_t size);
+    void submitUringBuffer();
+    void reapUring(bool wait);
+    void completeUringBuffer(SUringBuffer& buffer, int result);
+    void setupUring();
+    void teardownUring();
+
+    EFileWriteMode writeMode;
+    unsigned queueDepth;
+    size_t bufferSize;
+    bool fileOpen = false;
+    std::string filename;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+    unsigned long long fileSize = 0;
+    SBatchedWriteStats stats;
+
+    // WRITEV
+    std::vector<SPendingPiece> pendingPieces;
+    std::vector<char> staging;
+    size_t pendingBytes = 0;
+
+    // IO_URING
+    std::unique_ptr<SUring> uring;
+    std::unique_ptr<char[]> uringMemory;
+    std::vector<SUringBuffer> uringBuffers;
+    size_t currentBuffer = 0;
+    unsigned inFlightCount = 0;
+    unsigned long long submittedOffset = 0;     // 다음에 제출할 버퍼의 파일 위치
+};
+
+#endif // CBatchedLogFile_H
@@ -0,0 +1,356 @@
+﻿#include "pch.h"
+#include "LogBinaryFormat.h"
+#include "LogSink.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    void appendVarint(CLogLineBuffer& out, unsigned long long value) {
+        char bytes[10];
+        size_t size = 0;
+        while (value >= 0x80) {
+            bytes[size++] = static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        bytes[size++] = static_cast<char>(value);
+        out.append(bytes, size);
+    }
+
+    void appendString(CLogLineBuffer& out, const char* text, size_t size) {
+        appendVarint(out, size);
+        out.append(text, size);
+    }
+
+    // 부호 있는 값을 작은 절대값일수록 짧은 varint 가 되도록 변환
+    unsigned long long zigzagEncode(long long value) {
+        return (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63);
+    }
+
+    long long zigzagDecode(unsigned long long value) {
+        return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+    }
+
+    // 비정상 종료로 잘린 파일에서 터무니없는 길이를 읽지 않도록 제한
+    const unsigned long long kMaxFieldSize = 64ULL * 1024 * 1024;
+}
+
+/// <summary>
+/// 새 파일 시작. 파일 헤더를 기록하고 호출 위치 정의를 초기화한다.
+/// </summary>
+/// <param name="out"></param>
+/// <param name="ePrecision : 디코더가 시간을 표시할 단위"></param>
+void CBinaryLogEncoder::beginFile(CLogLineBuffer& out, ETimePrecision ePrecision) {
+    callSiteIds.clear();
+    lastTime = 0;
+    out.append(BinaryLogFormat::kMagic, sizeof(BinaryLogFormat::kMagic));
+    out.append(static_cast<char>(ePrecision));
+}
+
+/// <summary>
+/// 호출 위치가 있는 로그 기록. 처음 보는 호출 위치면 정의를 먼저 기록한다.
+/// </summary>
+void CBinaryLogEncoder::encodeRecord(CLogLineBuffer& out, const SLogCallSite& callSite, const char* format,
+    long long wallNanoseconds, unsigned threadNumber, const char* args, size_t argsSize, unsigned argCount,
+    float sampleRate) {
+    auto key = std::make_pair(static_cast<const void*>(&callSite), static_cast<const void*>(format));
+    auto found = callSiteIds.find(key);
+    if (found == callSiteIds.end()) {
+        unsigned long long id = callSiteIds.size();
+        found = callSiteIds.emplace(key, id).first;
+
+        out.append(BinaryLogFormat::kCallSiteTag);
+        appendVarint(out, id);
+        out.append(static_cast<char>(callSite.eLogLevel));
+        appendVarint(out, static_cast<unsigned long long>(callSite.lineNumber));
+        appendString(out, callSite.functionName, std::strlen(callSite.functionName));
+        appendString(out, callSite.fileName, std::strlen(callSite.fileName));
+        appendString(out, format, std::strlen(format));
+    }
+
+    if (sampleRate < 1.0f) {
+        out.append(BinaryLogFormat::kSampledRecordTag);
+        out.append(reinterpret_cast<const char*>(&sampleRate), sizeof(sampleRate));
+    }
+    else {
+        out.append(BinaryLogFormat::kRecordTag);
+    }
+    appendTimeDelta(out, wallNanoseconds);
+    appendVarint(out, found->second);
+    appendVarint(out, threadNumber);
+    appendArgs(out, args, argsSize, argCount);
+}
+
+/// <summary>
+/// 호출 위치 정보 없이 이미 조립된 로그 한 줄 기록 (LOG_* 매크로를 거치지 않은 logMessage 호출)
+/// </summary>
+void CBinaryLogEncoder::encodeText(CLogLineBuffer& out, ELogLevel eLogLevel, long long wallNanoseconds,
+    unsigned threadNumber, const char* text, size_t size) {
+    out.append(BinaryLogFormat::kTextTag);
+    appendTimeDelta(out, wallNanoseconds);
+    out.append(static_cast<char>(eLogLevel));
+    appendVarint(out, threadNumber);
+    appendString(out, text, size);
+}
+
+void CBinaryLogEncoder::appendTimeDelta(CLogLineBuffer& out, long long wallNanoseconds) {
+    // 비동기 모드의 병합 순서와 시간 측정 방식에 따라 조금 앞선 시간이 올 수 있으므로 부호 있는 차이로 기록
+    appendVarint(out, zigzagEncode(wallNanoseconds - lastTime));
+    lastTime = wallNanoseconds;
+}
+
+/// <summary>
+/// LogArgs 형식의 인자를 정수/문자열 길이는 varint 로 줄여서 기록
+/// 잘못된 인자를 만나면 그 앞까지만 기록한다.
+/// </summary>
+void CBinaryLogEncoder::appendArgs(CLogLineBuffer& out, const char* args, size_t argsSize, unsigned argCount) {
+    unsigned validCount = 0;
+    size_t offset = 0;
+    while (validCount < argCount) {
+        size_t size = LogArgs::encodedSize(args + offset, argsSize - offset);
+        if (size == 0) {
+            break;
+        }
+        offset += size;
+        ++validCount;
+    }
+
+    appendVarint(out, validCount);
+    offset = 0;
+    for (unsigned i = 0; i < validCount; ++i) {
+        const char* arg = args + offset;
+        size_t size = LogArgs::encodedSize(arg, argsSize - offset);
+        offset += size;
+
+        ELogArgType eType = static_cast<ELogArgType>(arg[0]);
+        switch (eType) {
+        case ELogArgType::INT: {
+            int64_t value;
+            std::memcpy(&value, arg + 1, sizeof(value));
+            out.append(arg[0]);
+            appendVarint(out, zigzagEncode(value));
+            break;
+        }
+        case ELogArgType::UINT:
+        case ELogArgType::POINTER: {
+            uint64_t value = 0;
+            std::memcpy(&value, arg + 1, size - 1);
+            out.append(arg[0]);
+            appendVarint(out, value);
+            break;
+        }
+        case ELogArgType::STRING:
+        case ELogArgType::FIELD_KEY:
+            out.append(arg[0]);
+            appendString(out, arg + 1 + sizeof(uint32_t), size - 1 - sizeof(uint32_t));
+            break;
+        default:
+            out.append(arg, size);
+            break;
+        }
+    }
+}
+
+/// <summary>
+/// 바이너리 로그파일을 열고 헤더 확인
+/// </summary>
+/// <param name="path"></param>
+void CBinaryLogReader::open(const std::string& path) {
+    file.open(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open log file: " + path);
+    }
+    char header[BinaryLogFormat::kHeaderSize];
+    if (!file.read(header, sizeof(header))
+        || std::memcmp(header, BinaryLogFormat::kMagic, sizeof(BinaryLogFormat::kMagic)) != 0
+        || static_cast<unsigned char>(header[sizeof(BinaryLogFormat::kMagic)]) > static_cast<unsigned char>(ETimePrecision::NANOSECONDS)) {
+        throw std::runtime_error("Not a binary log file: " + path);
+    }
+    precision = static_cast<ETimePrecision>(header[sizeof(BinaryLogFormat::kMagic)]);
+    clock.configure(precision, ETimeSource::SYSTEM_CLOCK);
+    lastTime = 0;
+    callSites.clear();
+}
+
+/// <summary>
+/// 다음 로그를 읽는다. 호출 위치 정의는 내부에 보관하고 건너뛴다.
+/// </summary>
+/// <param name="entry"></param>
+/// <returns></returns>
+bool CBinaryLogReader::next(SBinaryLogEntry& entry) {
+    for (;;) {
+        int tag = file.get();
+        if (tag == std::char_traits<char>::eof()) {
+            return false;
+        }
+
+        unsigned long long value = 0;
+        if (tag == BinaryLogFormat::kCallSiteTag) {
+            SBinaryCallSite callSite;
+            unsigned long long id = 0;
+            int level = 0;
+            if (!readVarint(id) || id != callSites.size() || (level = file.get()) < 0 || level > 3 || !readVarint(value)
+                || !readString(callSite.functionName) || !readString(callSite.fileName) || !readString(callSite.format)) {
+                return false;
+            }
+            callSite.eLogLevel = static_cast<ELogLevel>(level);
+            callSite.lineNumber = static_cast<int>(value);
+            callSites.push_back(std::move(callSite));
+            continue;
+        }
+
+        if (tag == BinaryLogFormat::kRecordTag || tag == BinaryLogFormat::kSampledRecordTag) {
+            float sampleRate = 1.0f;
+            if (tag == BinaryLogFormat::kSampledRecordTag
+                && !file.read(reinterpret_cast<char*>(&sampleRate), sizeof(sampleRate))) {
+                return false;
+            }
+            unsigned long long id = 0;
+            unsigned long long argCount = 0;
+            if (!readVarint(value) || !readVarint(id) || id >= callSites.size()) {
+                return false;
+            }
+            lastTime += zigzagDecode(value);
+            if (!readVarint(value) || !readVarint(argCount) || argCount > kMaxFieldSize
+                || !readArgs(entry.data, static_cast<unsigned>(argCount))) {
+                return false;
+            }
+            entry.callSite = &callSites[static_cast<size_t>(id)];
+            entry.eLogLevel = entry.callSite->eLogLevel;
+            entry.wallNanoseconds = lastTime;
+            entry.threadNumber = static_cast<unsigned>(value);
+            entry.argCount = static_cast<unsigned>(argCount);
+            entry.sampleRate = sampleRate;
+            return true;
+        }
+
+        if (tag == BinaryLogFormat::kTextTag) {
+            int level = 0;
+            if (!readVarint(value) || (level = file.get()) < 0 || level > 3) {
+                return false;
+            }
+            lastTime += zigzagDecode(value);
+            if (!readVarint(value) || !readString(entry.data)) {
+                return false;
+            }
+            entry.callSite = nullptr;
+            entry.eLogLevel = static_cast<ELogLevel>(level);
+            entry.wallNanoseconds = lastTime;
+            entry.threadNumber = static_cast<unsigned>(value);
+            entry.argCount = 0;
+            entry.sampleRate = 1.0f;
+            return true;
+        }
+
+        // 메모리 매핑 파일이 비정상 종료되면 끝부분이 0 으로 채워져 있다.
+        return false;
+    }
+}
+
+/// <summary>
+/// [시간]\t [종류]\t표시 메시지 (Log from 함수 at 파일:줄) 형태로 변환
+/// </summary>
+void CBinaryLogReader::render(const SBinaryLogEntry& entry, CLogLineBuffer& line) const {
+    line.clear();
+    if (entry.callSite == nullptr) {
+        line.append(entry.data.data(), entry.data.size());
+        return;
+    }
+
+    char timeText[32];
+    size_t timeSize = clock.format(entry.wallNanoseconds, timeText, sizeof(timeText));
+    SLogStringView levelTag = logLevelTag(entry.eLogLevel);
+    line.append('[');
+    line.append(timeText, timeSize);
+    line.append("]\t ", 3);
+    line.append(levelTag.data, levelTag.size);
+    LogArgs::render(line, entry.callSite->format.c_str(), entry.data.data(), entry.data.size(), entry.argCount);
+    LogText::appendSampleRate(line, entry.sampleRate);
+    line.append(" (Log from ", 11);
+    line.append(entry.callSite->functionName.data(), entry.callSite->functionName.size());
+    line.append(" at ", 4);
+    line.append(entry.callSite->fileName.data(), entry.callSite->fileName.size());
+    line.append(':');
+    line.appendInt(entry.callSite->lineNumber);
+    line.append(")\n", 2);
+}
+
+bool CBinaryLogReader::readVarint(unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = file.get();
+        if (byte < 0) {
+            return false;
+        }
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// <summary>
+/// 줄여서 기록한 인자를 LogArgs 형식으로 되돌린다.
+/// </summary>
+bool CBinaryLogReader::readArgs(std::string& args, unsigned argCount) {
+    args.clear();
+    for (unsigned i = 0; i < argCount; ++i) {
+        int type = file.get();
+        if (type < 0) {
+            return false;
+        }
+        args.push_back(static_cast<char>(type));
+
+        unsigned long long value = 0;
+        switch (static_cast<ELogArgType>(type)) {
+        case ELogArgType::INT: {
+            if (!readVarint(value)) return false;
+            int64_t number = zigzagDecode(value);
+            args.append(reinterpret_cast<const char*>(&number), sizeof(number));
+            break;
+        }
+        case ELogArgType::UINT: {
+            if (!readVarint(value)) return false;
+            uint64_t number = value;
+            args.append(reinterpret_cast<const char*>(&number), sizeof(number));
+            break;
+        }
+        case ELogArgType::POINTER: {
+            if (!readVarint(value)) return false;
+            uintptr_t pointer = static_cast<uintptr_t>(value);
+            args.append(reinterpret_cast<const char*>(&pointer), sizeof(pointer));
+            break;
+        }
+        case ELogArgType::STRING:
+        case ELogArgType::FIELD_KEY: {
+            std::string text;
+            if (!readString(text)) return false;
+            uint32_t length = static_cast<uint32_t>(text.size());
+            args.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            args.append(text);
+            break;
+        }
+        case ELogArgType::DOUBLE:
+        case ELogArgType::CHAR:
+        case ELogArgType::BOOL: {
+            char raw[sizeof(double)];
+            size_t size = static_cast<ELogArgType>(type) == ELogArgType::DOUBLE ? sizeof(double) : 1;
+            if (!file.read(raw, static_cast<std::streamsize>(size))) return false;
+            args.append(raw, size);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CBinaryLogReader::readString(std::string& value) {
+    unsigned long long size = 0;
+    if (!readVarint(size) || size > kMaxFieldSize) {
+        return false;
+    }
+    value.resize(static_cast<size_t>(size));
+    return size == 0 || static_cast<bool>(file.read(&value[0], static_cast<std::streamsize>(size)));
+}
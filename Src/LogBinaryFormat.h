@@ -0,0 +1,98 @@
+﻿// LogBinaryFormat.h
+#ifndef LogBinaryFormat_H
+#define LogBinaryFormat_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "Logger.h"
+
+// 바이너리 로그파일 형식
+//   파일 헤더 : "CLOGBIN1" + 시간 표시 단위(1 byte)
+//   'S' 호출 위치 정의 : id, 레벨, 줄 번호, 함수 이름, 파일 이름, 포맷 문자열  (호출 위치마다 한 번)
+//   'R' 로그 : 시간 차이, 호출 위치 id, 스레드 번호, 인자 개수, 인자
+//            (인자는 LogArgs 형식에서 정수와 문자열 길이만 varint 로 줄인 형태)
+//   'P' 샘플링으로 기록된 로그 : 샘플링 비율(float 4 byte) + 'R' 과 같은 내용
+//   'T' 호출 위치 정보 없이 조립된 로그 : 시간 차이, 레벨, 스레드 번호, 길이, 로그 한 줄
+// 정수는 모두 varint, 시간 차이는 이전 로그와의 nanoseconds 차이(zigzag), 문자열은 varint 길이 + 내용
+namespace BinaryLogFormat {
+    const char kMagic[8] = { 'C', 'L', 'O', 'G', 'B', 'I', 'N', '1' };
+    const size_t kHeaderSize = sizeof(kMagic) + 1;
+
+    const char kCallSiteTag = 'S';
+    const char kRecordTag = 'R';
+    const char kTextTag = 'T';
+    const char kSampledRecordTag = 'P';
+}
+
+// 로그를 바이너리 형식으로 변환 (logMutex 를 잡은 상태에서 사용)
+// 처음 보는 호출 위치는 정의를 먼저 기록하고, 이후에는 id 만 기록한다.
+class CBinaryLogEncoder {
+public:
+    // 새 파일을 시작할 때 호출. 호출 위치 정의와 시간 기준을 초기화하고 파일 헤더를 기록한다.
+    void beginFile(CLogLineBuffer& out, ETimePrecision ePrecision);
+
+    void encodeRecord(CLogLineBuffer& out, const SLogCallSite& callSite, const char* format, long long wallNanoseconds,
+        unsigned threadNumber, const char* args, size_t argsSize, unsigned argCount, float sampleRate = 1.0f);
+    void encodeText(CLogLineBuffer& out, ELogLevel eLogLevel, long long wallNanoseconds, unsigned threadNumber,
+        const char* text, size_t size);
+
+private:
+    void appendTimeDelta(CLogLineBuffer& out, long long wallNanoseconds);
+    void appendArgs(CLogLineBuffer& out, const char* args, size_t argsSize, unsigned argCount);
+
+    // (호출 위치, 포맷 문자열) 주소 -> id
+    std::map<std::pair<const void*, const void*>, unsigned long long> callSiteIds;
+    long long lastTime = 0;
+};
+
+// 바이너리 로그파일의 호출 위치 정의
+struct SBinaryCallSite {
+    ELogLevel eLogLevel = ELogLevel::LOG_DEBUG;
+    int lineNumber = 0;
+    std::string functionName;
+    std::string fileName;
+    std::string format;
+};
+
+// 바이너리 로그파일에서 읽은 로그 하나
+struct SBinaryLogEntry {
+    ELogLevel eLogLevel = ELogLevel::LOG_DEBUG;
+    long long wallNanoseconds = 0;          // 1970-01-01 기준
+    unsigned threadNumber = 0;
+    const SBinaryCallSite* callSite = nullptr;  // 'T' 로그면 nullptr
+    unsigned argCount = 0;
+    float sampleRate = 1.0f;                // 'P' 로그의 샘플링 비율
+    std::string data;                       // 'R' 은 인자, 'T' 는 로그 한 줄
+};
+
+// 바이너리 로그파일 읽기 (디코더용)
+class CBinaryLogReader {
+public:
+    // 파일 헤더가 맞지 않으면 std::runtime_error
+    void open(const std::string& path);
+    ETimePrecision getPrecision() const { return precision; }
+
+    // 다음 로그를 읽는다. 파일 끝이거나 잘린/0 으로 채워진 영역(비정상 종료)이면 false
+    bool next(SBinaryLogEntry& entry);
+    // 기존 텍스트 로그와 같은 한 줄로 변환
+    void render(const SBinaryLogEntry& entry, CLogLineBuffer& line) const;
+
+private:
+    bool readVarint(unsigned long long& value);
+    bool readString(std::string& value);
+    bool readArgs(std::string& args, unsigned argCount);
+
+    std::ifstream file;
+    ETimePrecision precision = ETimePrecision::SECONDS;
+    CLogClock clock;
+    long long lastTime = 0;
+    std::deque<SBinaryCallSite> callSites;    // id 순서
+};
+
+#endif // LogBinaryFormat_H
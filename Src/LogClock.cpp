@@ -0,0 +1,180 @@
+﻿#include "pch.h"
+#include "LogClock.h"
+#include "LogPlatform.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define LOG_CLOCK_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LOG_CLOCK_HAS_TSC 1
+#endif
+
+namespace {
+    const long long kNanosecondsPerSecond = 1000000000LL;
+
+    long long systemNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    long long steadyTicks() {
+        return static_cast<long long>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    long long readTsc() {
+#ifdef LOG_CLOCK_HAS_TSC
+        return static_cast<long long>(__rdtsc());
+#else
+        return steadyTicks();
+#endif
+    }
+
+    // 초 이하 자리를 width 자리 숫자로 기록 (앞자리는 0 으로 채움)
+    void writeDigits(char* out, long long value, int width) {
+        for (int i = width - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+}
+
+CLogClock::CLogClock()
+{
+    precision.store(static_cast<int>(ETimePrecision::SECONDS));
+    source.store(static_cast<int>(ETimeSource::SYSTEM_CLOCK));
+    anchorWall.store(0);
+    anchorRaw.store(0);
+    nanosecondsPerTick.store(1.0);
+}
+
+/// <summary>
+/// 시간 표시 단위와 시간 측정 방식 설정
+/// STEADY_CLOCK, TSC 는 현재 시각과의 기준점을 잡고, TSC 는 주파수를 측정하기 위해 약 10ms 대기한다.
+/// </summary>
+/// <param name="ePrecision : 표시 단위"></param>
+/// <param name="eSource : 측정 방식"></param>
+void CLogClock::configure(ETimePrecision ePrecision, ETimeSource eSource) {
+    calibrate(eSource);
+    precision.store(static_cast<int>(ePrecision));
+    source.store(static_cast<int>(eSource));
+}
+
+ETimePrecision CLogClock::getPrecision() const {
+    return static_cast<ETimePrecision>(precision.load(std::memory_order_relaxed));
+}
+
+ETimeSource CLogClock::getSource() const {
+    return static_cast<ETimeSource>(source.load(std::memory_order_relaxed));
+}
+
+void CLogClock::calibrate(ETimeSource eSource) {
+    switch (eSource) {
+    case ETimeSource::SYSTEM_CLOCK:
+        anchorWall.store(0);
+        anchorRaw.store(0);
+        nanosecondsPerTick.store(1.0);
+        break;
+    case ETimeSource::STEADY_CLOCK:
+        anchorRaw.store(steadyTicks());
+        anchorWall.store(systemNanoseconds());
+        nanosecondsPerTick.store(1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den);
+        break;
+    case ETimeSource::TSC: {
+        long long steadyStart = steadyTicks();
+        long long tscStart = readTsc();
+        long long wallStart = systemNanoseconds();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        long long steadyEnd = steadyTicks();
+        long long tscEnd = readTsc();
+        double steadyNanoseconds = static_cast<double>(steadyEnd - steadyStart)
+            * 1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+        anchorRaw.store(tscStart);
+        anchorWall.store(wallStart);
+        nanosecondsPerTick.store(tscEnd > tscStart ? steadyNanoseconds / static_cast<double>(tscEnd - tscStart) : 1.0);
+        break;
+    }
+    }
+}
+
+/// <summary>
+/// 로그 호출 시점의 원시 시간 값. 현재 시각으로의 변환은 출력할 때 한다.
+/// </summary>
+/// <returns></returns>
+long long CLogClock::now() const {
+    switch (static_cast<ETimeSource>(source.load(std::memory_order_relaxed))) {
+    case ETimeSource::STEADY_CLOCK:
+        return steadyTicks();
+    case ETimeSource::TSC:
+        return readTsc();
+    default:
+        return systemNanoseconds();
+    }
+}
+
+long long CLogClock::toWallNanoseconds(long long rawTime) const {
+    if (static_cast<ETimeSource>(source.load(std::memory_order_relaxed)) == ETimeSource::SYSTEM_CLOCK) {
+        return rawTime;
+    }
+    double elapsed = static_cast<double>(rawTime - anchorRaw.load(std::memory_order_relaxed))
+        * nanosecondsPerTick.load(std::memory_order_relaxed);
+    return anchorWall.load(std::memory_order_relaxed) + static_cast<long long>(elapsed);
+}
+
+/// <summary>
+/// 원시 시간 값을 "yyyy-mm-dd hh:mm:ss[.초 이하]" 형태로 buffer 에 기록
+/// </summary>
+/// <param name="rawTime : now() 로 읽은 값"></param>
+/// <param name="buffer"></param>
+/// <param name="bufferSize : 30 byte 이상 권장"></param>
+/// <returns>기록한 길이 (buffer 가 작으면 0)</returns>
+size_t CLogClock::format(long long rawTime, char* buffer, size_t bufferSize) const {
+    // 스레드별로 마지막에 변환한 초의 문자열을 보관
+    struct SSecondCache {
+        long long second = LLONG_MIN;
+        char text[32];
+        size_t size = 0;
+    };
+    thread_local SSecondCache cache;
+
+    long long wallNanoseconds = toWallNanoseconds(rawTime);
+    long long second = wallNanoseconds / kNanosecondsPerSecond;
+    long long subSecond = wallNanoseconds % kNanosecondsPerSecond;
+    if (subSecond < 0) {
+        subSecond += kNanosecondsPerSecond;
+        --second;
+    }
+
+    if (cache.second != second) {
+        std::time_t secondTime = static_cast<std::time_t>(second);
+        std::tm localTime;
+        // 현재 시간 정보 구조체를 로컬에 복사
+        LogPlatform::localTime(secondTime, localTime);
+        cache.size = strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &localTime);
+        cache.second = second;
+    }
+
+    int digits = 0;
+    long long fraction = 0;
+    switch (static_cast<ETimePrecision>(precision.load(std::memory_order_relaxed))) {
+    case ETimePrecision::MILLISECONDS: digits = 3; fraction = subSecond / 1000000; break;
+    case ETimePrecision::MICROSECONDS: digits = 6; fraction = subSecond / 1000; break;
+    case ETimePrecision::NANOSECONDS: digits = 9; fraction = subSecond; break;
+    default: break;
+    }
+
+    size_t size = cache.size + (digits > 0 ? 1 + digits : 0);
+    if (size > bufferSize) {
+        return 0;
+    }
+    std::memcpy(buffer, cache.text, cache.size);
+    if (digits > 0) {
+        buffer[cache.size] = '.';
+        writeDigits(buffer + cache.size + 1, fraction, digits);
+    }
+    return size;
+}
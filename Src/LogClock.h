@@ -0,0 +1,56 @@
+﻿// CLogClock.h
+#ifndef CLogClock_H
+#define CLogClock_H
+
+#include <atomic>
+#include <cstddef>
+
+// 로그 시간 표시 단위
+enum class ETimePrecision {
+    SECONDS,        // yyyy-mm-dd hh:mm:ss
+    MILLISECONDS,   // yyyy-mm-dd hh:mm:ss.mmm
+    MICROSECONDS,   // yyyy-mm-dd hh:mm:ss.uuuuuu
+    NANOSECONDS     // yyyy-mm-dd hh:mm:ss.nnnnnnnnn
+};
+
+// 로그 호출 시점에 읽는 시간 값의 종류
+enum class ETimeSource {
+    SYSTEM_CLOCK,   // system_clock (현재 시각, nanoseconds)
+    STEADY_CLOCK,   // steady_clock 원시 값, 출력할 때 현재 시각으로 변환
+    TSC             // CPU time stamp counter 원시 값, 출력할 때 현재 시각으로 변환 (x86 이 아니면 steady_clock)
+};
+
+// 로그 시간 측정/표시
+// 같은 초 안의 로그는 스레드별로 캐시해 둔 "yyyy-mm-dd hh:mm:ss" 를 복사하고 초 이하 자리만 새로 쓴다.
+// (localtime/strftime 은 초가 바뀔 때만 호출)
+class CLogClock {
+public:
+    CLogClock();
+
+    // 로그를 남기기 전에 설정해야 한다. (이미 측정된 원시 값은 새 설정으로 변환되지 않음)
+    void configure(ETimePrecision ePrecision, ETimeSource eSource);
+    ETimePrecision getPrecision() const;
+    ETimeSource getSource() const;
+
+    // 로그 호출 시점에 읽는 원시 시간 값
+    long long now() const;
+    // 원시 시간 값을 1970-01-01 기준 nanoseconds 로 변환
+    long long toWallNanoseconds(long long rawTime) const;
+    // 원시 시간 값을 설정한 단위의 문자열로 기록하고 길이를 반환
+    size_t format(long long rawTime, char* buffer, size_t bufferSize) const;
+
+private:
+    CLogClock(const CLogClock&) = delete;
+    CLogClock& operator=(const CLogClock&) = delete;
+
+    void calibrate(ETimeSource eSource);
+
+    std::atomic<int> precision;
+    std::atomic<int> source;
+    // 원시 값 -> 현재 시각 변환 기준점 : wall = anchorWall + (raw - anchorRaw) * nanosecondsPerTick
+    std::atomic<long long> anchorWall;
+    std::atomic<long long> anchorRaw;
+    std::atomic<double> nanosecondsPerTick;
+};
+
+#endif // CLogClock_H
@@ -0,0 +1,154 @@
+﻿#include "pch.h"
+#include "LogCollector.h"
+#include "LogSharedRing.h"
+#include "LogSink.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+    // 한 번에 링에서 꺼내는 최대 개수 (정렬/기록 사이에 링이 너무 오래 차 있지 않도록)
+    const size_t kCollectBatch = 4096;
+    // 링이 비어 있을 때 다시 확인하는 간격
+    const std::chrono::milliseconds kIdleInterval(5);
+    // sink 의 주기적 작업(flush 간격, 파일 교체) 확인 간격
+    const std::chrono::milliseconds kPollInterval(100);
+
+    long long currentWallNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
+
+/// <summary>
+/// 수집 프로세스에서 공유 메모리 링을 만든다.
+/// </summary>
+/// <param name="ringName : 로그를 남기는 프로세스가 configureSharedLogging 에 지정할 이름"></param>
+/// <param name="slotCount : 링에 대기할 수 있는 로그 개수 (2의 거듭제곱으로 올림)"></param>
+/// <param name="slotSize : 한 줄의 최대 크기 (byte, 슬롯 헤더 포함)"></param>
+CLogCollector::CLogCollector(const std::string& ringName, size_t slotCount, size_t slotSize)
+    : ring(CSharedLogRing::create(ringName, slotCount, slotSize))
+{
+    stopRequested.store(false);
+    collectedCount.store(0);
+}
+
+CLogCollector::~CLogCollector() {
+    stop();
+}
+
+void CLogCollector::start(const std::vector<std::shared_ptr<CLogSink>>& newSinks) {
+    stop();
+    sinks = newSinks;
+    stopRequested.store(false);
+    collectorThread = std::thread(&CLogCollector::collectorThreadMain, this);
+}
+
+void CLogCollector::stop() {
+    if (!collectorThread.joinable()) {
+        return;
+    }
+    stopRequested.store(true);
+    collectorThread.join();
+}
+
+SLogCollectorStats CLogCollector::getStats() const {
+    SLogCollectorStats stats;
+    stats.collectedCount = collectedCount.load(std::memory_order_relaxed);
+    stats.droppedCount = ring->getDroppedCount();
+    stats.abandonedCount = ring->getAbandonedCount();
+    return stats;
+}
+
+/// <summary>
+/// 수집 스레드 : 링에서 꺼내고, reorderWindow 보다 오래된 로그를 시간순으로 기록한다.
+/// 멈출 때는 공개된 로그를 모두 꺼내서 기록하고 sink 를 flush 한다.
+/// </summary>
+void CLogCollector::collectorThreadMain() {
+    std::chrono::steady_clock::time_point lastPoll = std::chrono::steady_clock::now();
+    while (!stopRequested.load()) {
+        bool collected = collect(kCollectBatch);
+        emit(currentWallNanoseconds() - std::chrono::duration_cast<std::chrono::nanoseconds>(reorderWindow).count());
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - lastPoll >= kPollInterval) {
+            for (const auto& sink : sinks) {
+                sink->poll();
+            }
+            lastPoll = now;
+        }
+        if (!collected) {
+            std::this_thread::sleep_for(kIdleInterval);
+        }
+    }
+
+    while (collect(kCollectBatch)) {
+    }
+    emit(LLONG_MAX);
+    for (const auto& sink : sinks) {
+        sink->flush();
+    }
+}
+
+bool CLogCollector::isEarlier(const SPendingRecord& left, const SPendingRecord& right) {
+    return left.wallNanoseconds != right.wallNanoseconds ? left.wallNanoseconds < right.wallNanoseconds
+        : left.order < right.order;
+}
+
+/// <summary>
+/// 링에 공개된 로그를 최대 maxRecords 개 꺼내서 정렬 대기 목록에 추가
+/// 새로 꺼낸 로그만 정렬한 뒤 기존 목록과 병합한다. (대부분 이미 시간순)
+/// </summary>
+/// <returns>하나라도 꺼냈으면 true</returns>
+bool CLogCollector::collect(size_t maxRecords) {
+    CSharedLogRing::SRecord record;
+    size_t previousSize = pending.size();
+    size_t count = 0;
+    while (count < maxRecords && ring->read(record, abandonTimeout)) {
+        SPendingRecord entry;
+        entry.wallNanoseconds = record.wallNanoseconds;
+        entry.order = nextOrder++;
+        entry.processId = record.processId;
+        entry.threadNumber = record.threadNumber;
+        entry.eLogLevel = record.eLogLevel;
+        entry.text.assign(record.text, record.textSize);
+        pending.push_back(std::move(entry));
+        ++count;
+    }
+    if (count == 0) {
+        return false;
+    }
+    auto middle = pending.begin() + static_cast<std::ptrdiff_t>(previousSize);
+    if (!std::is_sorted(middle, pending.end(), isEarlier)) {
+        std::sort(middle, pending.end(), isEarlier);
+    }
+    if (middle != pending.begin() && isEarlier(*middle, *(middle - 1))) {
+        std::inplace_merge(pending.begin(), middle, pending.end(), isEarlier);
+    }
+    return true;
+}
+
+/// <summary>
+/// 정렬 대기 목록 앞에서부터 untilWallNanoseconds 이전의 로그를 sink 에 기록
+/// </summary>
+void CLogCollector::emit(long long untilWallNanoseconds) {
+    size_t count = 0;
+    while (count < pending.size() && pending[count].wallNanoseconds <= untilWallNanoseconds) {
+        const SPendingRecord& entry = pending[count];
+        SLogEvent event;
+        event.eLogLevel = entry.eLogLevel;
+        event.threadNumber = entry.threadNumber;
+        event.rawTime = entry.wallNanoseconds;
+        event.clock = &logClock;
+        event.text = entry.text.data();
+        event.textSize = entry.text.size();
+        event.processId = entry.processId;
+        for (const auto& sink : sinks) {
+            if (sink->accepts(event.eLogLevel)) {
+                sink->submit(event);
+            }
+        }
+        ++count;
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+    collectedCount.fetch_add(count, std::memory_order_relaxed);
+}
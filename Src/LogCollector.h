@@ -0,0 +1,83 @@
+﻿// CLogCollector.h
+#ifndef CLogCollector_H
+#define CLogCollector_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LogClock.h"
+
+enum class ELogLevel;
+class CLogSink;
+class CSharedLogRing;
+
+// 수집 통계
+struct SLogCollectorStats {
+    unsigned long long collectedCount = 0;      // 링에서 꺼내서 기록한 로그
+    unsigned long long droppedCount = 0;        // 링이 가득 차서 로그를 남기는 프로세스가 버린 로그
+    unsigned long long abandonedCount = 0;      // 예약한 프로세스가 공개하기 전에 종료되어 건너뛴 슬롯
+};
+
+// 여러 프로세스의 로그를 모아 기록하는 수집 프로세스용
+// 공유 메모리 링(CSharedLogRing)을 만들고, 전용 스레드에서 꺼낸 로그를 시간순으로 정렬해 sink(보통 교체 설정한 CFileLogSink)에 기록한다.
+// 로그를 남기는 프로세스는 CLogger::configureSharedLogging(링 이름) 으로 링에 넣기만 한다.
+// 프로세스마다 시각이 조금씩 어긋나 들어오므로 reorderWindow 만큼 모아서 정렬한 뒤 기록한다. (그보다 늦게 들어온 로그는 들어온 순서로 기록)
+class CLogCollector {
+public:
+    // 링을 만든다. (CSharedLogRing::create) 실패하면 std::runtime_error
+    // slotCount : 링에 대기할 수 있는 로그 개수, slotSize : 한 줄의 최대 크기 (byte, 슬롯 헤더 32 byte 포함)
+    explicit CLogCollector(const std::string& ringName, size_t slotCount = 16384, size_t slotSize = 512);
+    ~CLogCollector();
+
+    // 아래 설정은 start 전에 호출
+    void setReorderWindow(std::chrono::milliseconds window) { reorderWindow = window; }
+    // 예약만 하고 공개하지 않은 슬롯에서 예약한 프로세스가 살아 있는지 다시 확인하는 간격
+    // 종료됐으면 건너뛰고, 살아 있으면 공개할 때까지 기다린다. (그동안 링이 차면 새 로그는 버려진다)
+    void setAbandonTimeout(std::chrono::milliseconds timeout) { abandonTimeout = timeout; }
+
+    // 수집 스레드 시작
+    void start(const std::vector<std::shared_ptr<CLogSink>>& sinks);
+    // 링에 공개된 로그를 모두 기록하고 수집 스레드를 멈춘다. (공유 메모리 링은 남겨 둔다)
+    void stop();
+
+    SLogCollectorStats getStats() const;
+    CSharedLogRing& getRing() const { return *ring; }
+
+private:
+    CLogCollector(const CLogCollector&) = delete;
+    CLogCollector& operator=(const CLogCollector&) = delete;
+
+    // 정렬을 기다리는 로그
+    struct SPendingRecord {
+        long long wallNanoseconds;
+        unsigned long long order;       // 링에서 꺼낸 순서 (같은 시각이면 이 순서로)
+        unsigned long processId;
+        unsigned threadNumber;
+        ELogLevel eLogLevel;
+        std::string text;
+    };
+
+    void collectorThreadMain();
+    bool collect(size_t maxRecords);
+    void emit(long long untilWallNanoseconds);
+    static bool isEarlier(const SPendingRecord& left, const SPendingRecord& right);
+
+    std::unique_ptr<CSharedLogRing> ring;
+    std::vector<std::shared_ptr<CLogSink>> sinks;
+    std::deque<SPendingRecord> pending;     // 시간순으로 정렬된 상태 유지
+    unsigned long long nextOrder = 0;
+    CLogClock logClock;             // SYSTEM_CLOCK : 원시 시간 값 = 링의 nanoseconds
+    std::chrono::milliseconds reorderWindow{ 100 };
+    std::chrono::milliseconds abandonTimeout{ 5000 };
+
+    std::thread collectorThread;
+    std::atomic<bool> stopRequested;
+    std::atomic<unsigned long long> collectedCount;
+};
+
+#endif // CLogCollector_H
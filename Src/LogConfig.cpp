@@ -0,0 +1,273 @@
+﻿#include "pch.h"
+#include "LogConfig.h"
+#include <atomic>
+#include <cctype>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+const int SLogConfig::kLevelCount;
+
+namespace {
+    std::atomic<bool> reloadRequested(false);
+#ifndef _WIN32
+    struct sigaction previousHangupAction;
+    std::atomic<bool> reloadSignalInstalled(false);
+
+    // async-signal-safe : atomic<bool> 저장만 한다.
+    void hangupSignalHandler(int) {
+        reloadRequested.store(true);
+    }
+#endif
+
+    std::string trim(const std::string& text) {
+        size_t begin = 0;
+        size_t end = text.size();
+        while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+            ++begin;
+        }
+        while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+            --end;
+        }
+        return text.substr(begin, end - begin);
+    }
+
+    std::string toUpper(std::string text) {
+        for (auto& ch : text) {
+            ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+        }
+        return text;
+    }
+
+    [[noreturn]] void throwLineError(int lineNumber, const std::string& line, const char* reason) {
+        throw std::runtime_error("Invalid log config line " + std::to_string(lineNumber) + " (" + reason + "): " + line);
+    }
+
+    bool parseLevel(const std::string& text, ELogLevel& eLogLevel) {
+        static const char* const levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+        std::string name = toUpper(text);
+        for (int i = 0; i < SLogConfig::kLevelCount; ++i) {
+            if (name == levelNames[i]) {
+                eLogLevel = static_cast<ELogLevel>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parseBool(const std::string& text, bool& value) {
+        std::string name = toUpper(text);
+        if (name == "TRUE" || name == "ON" || name == "1") {
+            value = true;
+            return true;
+        }
+        if (name == "FALSE" || name == "OFF" || name == "0") {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    // "초당 개수 [burst]"
+    bool parseRateLimit(const std::string& text, double& recordsPerSecond, unsigned& burst) {
+        std::istringstream input(text);
+        burst = 0;
+        if (!(input >> recordsPerSecond)) {
+            return false;
+        }
+        if (!(input >> burst)) {
+            input.clear();
+        }
+        std::string rest;
+        return !(input >> rest);
+    }
+
+    // "probability 0.01" / "every_n 10" / "all"
+    bool parseSampleRule(const std::string& text, ESampleMode& eMode, double& value) {
+        std::istringstream input(text);
+        std::string mode;
+        input >> mode;
+        mode = toUpper(mode);
+        value = 0.0;
+        if (mode == "ALL") {
+            eMode = ESampleMode::ALL;
+        }
+        else if (mode == "PROBABILITY") {
+            eMode = ESampleMode::PROBABILITY;
+            if (!(input >> value) || value < 0.0 || value > 1.0) {
+                return false;
+            }
+        }
+        else if (mode == "EVERY_N") {
+            eMode = ESampleMode::EVERY_N;
+            if (!(input >> value) || value < 1.0) {
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+        std::string rest;
+        return !(input >> rest);
+    }
+}
+
+namespace LogConfig {
+
+    /// <summary>
+    /// 설정 파일 내용을 SLogConfig 로 변환
+    /// </summary>
+    /// <param name="text : 설정 파일 전체 내용"></param>
+    SLogConfig parse(const std::string& text) {
+        SLogConfig config;
+        std::istringstream input(text);
+        std::string rawLine;
+        int lineNumber = 0;
+        while (std::getline(input, rawLine)) {
+            ++lineNumber;
+            std::string line = trim(rawLine.substr(0, rawLine.find('#')));
+            if (line.empty()) {
+                continue;
+            }
+            size_t equal = line.find('=');
+            if (equal == std::string::npos) {
+                throwLineError(lineNumber, rawLine, "missing '='");
+            }
+            std::string key = trim(line.substr(0, equal));
+            std::string value = trim(line.substr(equal + 1));
+
+            // "이름.레벨" 형태의 항목
+            std::string option;
+            size_t dot = key.find('.');
+            if (dot != std::string::npos) {
+                option = key.substr(dot + 1);
+                key = key.substr(0, dot);
+            }
+
+            if (key == "level" && option.empty()) {
+                if (!parseLevel(value, config.minLevel)) {
+                    throwLineError(lineNumber, rawLine, "unknown level");
+                }
+            }
+            else if (key == "level") {
+                // level.file@이름, level.module@이름, level.function@이름
+                SLogLevelRule rule;
+                size_t at = option.find('@');
+                std::string target = option.substr(0, at);
+                if (at == std::string::npos || at + 1 == option.size()) {
+                    throwLineError(lineNumber, rawLine, "expected level.<module|file|function>@<pattern>");
+                }
+                if (target == "module") {
+                    rule.eTarget = ELogRuleTarget::MODULE;
+                }
+                else if (target == "file") {
+                    rule.eTarget = ELogRuleTarget::FILE;
+                }
+                else if (target == "function") {
+                    rule.eTarget = ELogRuleTarget::FUNCTION;
+                }
+                else {
+                    throwLineError(lineNumber, rawLine, "expected level.<module|file|function>@<pattern>");
+                }
+                rule.pattern = option.substr(at + 1);
+                if (!parseLevel(value, rule.eLogLevel)) {
+                    throwLineError(lineNumber, rawLine, "unknown level");
+                }
+                config.levelRules.push_back(rule);
+            }
+            else if ((key == "console_level" || key == "file_level") && option.empty()) {
+                ELogLevel eLogLevel;
+                if (!parseLevel(value, eLogLevel)) {
+                    throwLineError(lineNumber, rawLine, "unknown level");
+                }
+                (key == "console_level" ? config.consoleLevel : config.fileLevel) = static_cast<int>(eLogLevel);
+            }
+            else if (key == "rate_limit") {
+                double recordsPerSecond;
+                unsigned burst;
+                if (!parseRateLimit(value, recordsPerSecond, burst)) {
+                    throwLineError(lineNumber, rawLine, "expected 'records_per_second [burst]'");
+                }
+                ELogLevel eLogLevel = ELogLevel::LOG_DEBUG;
+                if (!option.empty() && !parseLevel(option, eLogLevel)) {
+                    throwLineError(lineNumber, rawLine, "unknown level");
+                }
+                for (int i = 0; i < SLogConfig::kLevelCount; ++i) {
+                    if (option.empty() || i == static_cast<int>(eLogLevel)) {
+                        config.rateLimit[i] = recordsPerSecond;
+                        config.rateBurst[i] = burst;
+                    }
+                }
+            }
+            else if (key == "duplicate_suppression" && option.empty()) {
+                if (!parseBool(value, config.duplicateSuppression)) {
+                    throwLineError(lineNumber, rawLine, "expected true or false");
+                }
+            }
+            else if (key == "sample" && !option.empty()) {
+                // sample.레벨 또는 sample.레벨@파일
+                SLogSampleRule rule;
+                size_t at = option.find('@');
+                if (at != std::string::npos) {
+                    rule.fileName = option.substr(at + 1);
+                    option = option.substr(0, at);
+                }
+                if (!parseLevel(option, rule.eLogLevel)) {
+                    throwLineError(lineNumber, rawLine, "unknown level");
+                }
+                if (!parseSampleRule(value, rule.eMode, rule.value)) {
+                    throwLineError(lineNumber, rawLine, "expected 'all', 'probability <0..1>' or 'every_n <N>'");
+                }
+                config.sampling.push_back(rule);
+            }
+            else if (key == "trace" && option.empty()) {
+                config.tracePath = value;
+            }
+            else {
+                throwLineError(lineNumber, rawLine, "unknown setting");
+            }
+        }
+        return config;
+    }
+
+    SLogConfig load(const std::string& path) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Unable to open log config file: " + path);
+        }
+        std::ostringstream text;
+        text << file.rdbuf();
+        return parse(text.str());
+    }
+
+    bool installReloadSignal() {
+#ifdef _WIN32
+        return false;
+#else
+        if (reloadSignalInstalled.exchange(true)) {
+            return true;
+        }
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &hangupSignalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGHUP, &action, &previousHangupAction);
+        return true;
+#endif
+    }
+
+    void uninstallReloadSignal() {
+#ifndef _WIN32
+        if (reloadSignalInstalled.exchange(false)) {
+            sigaction(SIGHUP, &previousHangupAction, nullptr);
+        }
+#endif
+    }
+
+    bool takeReloadRequest() {
+        return reloadRequested.exchange(false);
+    }
+}
@@ -0,0 +1,56 @@
+﻿// LogConfig.h
+#ifndef LogConfig_H
+#define LogConfig_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+// 실행 중에 바꿀 수 있는 로거 설정
+// CLogger 는 현재 설정을 불변 스냅샷(shared_ptr<const SLogConfig>) 하나로 보관하고, 바꿀 때는 새 스냅샷으로 한 번에 교체한다.
+// 로그 호출 경로는 레벨, 규칙, 샘플링, sink 목록을 모두 이 스냅샷에서 읽는다. (CLogger::getConfig)
+struct SLogConfig {
+    static const int kLevelCount = 4;
+
+    ELogLevel minLevel = ELogLevel::LOG_DEBUG;
+    std::vector<SLogLevelRule> levelRules;         // 모듈/파일/함수별 최소 레벨
+    int consoleLevel = -1;                          // 콘솔 sink 최소 레벨, -1 이면 바꾸지 않음
+    int fileLevel = -1;                             // 로그파일 sink 최소 레벨, -1 이면 바꾸지 않음 (비행 기록 장치 사용 중에는 무시)
+    double rateLimit[kLevelCount] = {};             // 레벨별 호출 위치당 초당 로그 개수, 0 이면 제한 없음
+    unsigned rateBurst[kLevelCount] = {};
+    bool duplicateSuppression = false;
+    std::vector<SLogSampleRule> sampling;
+    std::string tracePath;                          // 비어 있으면 trace 출력 안 함
+
+    // 출력 대상 목록 (configureLogging, addSink 등으로 바꾼다. applyConfig 는 현재 목록에 trace sink 만 더하거나 뺀다)
+    std::vector<std::shared_ptr<CLogSink>> sinks;
+};
+
+// 설정 파일 : 한 줄에 "이름 = 값", '#' 뒤는 주석
+//   level = INFO
+//   level.file@Network.cpp = DEBUG      (level.module@디렉토리, level.function@함수, '*' 사용 가능)
+//   console_level = WARNING
+//   file_level = DEBUG
+//   rate_limit = 1000 100              (모든 레벨 : 초당 개수 burst)
+//   rate_limit.DEBUG = 100
+//   duplicate_suppression = true
+//   sample.DEBUG = probability 0.01
+//   sample.DEBUG@Network.cpp = every_n 10
+//   trace = Log/trace.json
+// 없는 항목은 SLogConfig 의 기본값이다.
+namespace LogConfig {
+    // 잘못된 줄이 있으면 std::runtime_error (줄 번호 포함)
+    SLogConfig parse(const std::string& text);
+    // 파일을 읽을 수 없거나 잘못된 줄이 있으면 std::runtime_error
+    SLogConfig load(const std::string& path);
+
+    // SIGHUP 을 받으면 다시 읽기 요청을 남긴다. (Windows 에는 SIGHUP 이 없으므로 false)
+    bool installReloadSignal();
+    void uninstallReloadSignal();
+    // 다시 읽기 요청이 있었으면 true 를 돌려주고 지운다.
+    bool takeReloadRequest();
+}
+
+#endif // LogConfig_H
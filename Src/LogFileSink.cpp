@@ -0,0 +1,396 @@
+﻿#include "pch.h"
+#include "LogFileSink.h"
+#include "LogMappedFile.h"
+#include "LogBinaryFormat.h"
+#include "LogJson.h"
+#include <stdexcept>
+
+/// <summary>
+/// 로그파일을 새로 만들고 계속 열어둔다. (로그마다 open/close 하지 않음)
+/// </summary>
+/// <param name="path : 로그파일 경로"></param>
+/// <param name="writeBufferSize : 쓰기 버퍼 크기 (byte), 0 이면 표준 라이브러리 기본값"></param>
+CFileLogSink::CFileLogSink(const std::string& path, size_t writeBufferSize)
+    : path(path), logFileBufferSize(writeBufferSize)
+{
+    if (!openFile(std::ios::out | std::ios::trunc)) {
+        throw std::runtime_error("Unable to open log file: " + path);
+    }
+}
+
+CFileLogSink::~CFileLogSink() {
+    stopDedicatedThread();
+    if (mappedLogFile) {
+        mappedLogFile->close();
+    }
+    closeFile();
+}
+
+/// <summary>
+/// 로그파일 flush 시점 설정
+/// </summary>
+/// <param name="eFlushPolicy : flush 기준"></param>
+/// <param name="threshold : EVERY_N_RECORDS 는 로그 개수, EVERY_N_BYTES 는 byte 수, INTERVAL 은 milliseconds"></param>
+/// <param name="flushOnError : LOG_ERROR 는 정책과 상관없이 즉시 flush"></param>
+void CFileLogSink::setFlushPolicy(EFlushPolicy eFlushPolicy, unsigned long long threshold, bool flushOnError) {
+    std::lock_guard<std::mutex> lock(getSinkMutex());
+    flushPolicy = eFlushPolicy;
+    flushThreshold = threshold;
+    flushOnErrorLog = flushOnError;
+}
+
+/// <summary>
+/// 로그파일 교체(rotation) 설정
+/// 현재 로그파일은 "이름_yyyymmdd-hhmmss_번호.확장자" 로 이름이 바뀌고, 새 로그파일이 만들어진다.
+/// </summary>
+/// <param name="maxFileSize : 이 크기(byte) 이상이면 교체, 0 이면 사용 안 함"></param>
+/// <param name="intervalSeconds : 로그파일을 연 뒤 이 시간(초)이 지나면 교체, 0 이면 사용 안 함"></param>
+/// <param name="retentionCount : 보관할 교체 파일 개수, 0 이면 모두 보관"></param>
+/// <param name="eCompression : 교체된 파일 압축 방식 (별도의 낮은 우선순위 스레드에서 압축)"></param>
+void CFileLogSink::setRotation(unsigned long long maxFileSize, unsigned intervalSeconds, unsigned retentionCount,
+    ELogCompression eCompression) {
+    std::lock_guard<std::mutex> lock(getSinkMutex());
+    logRotator.configure(maxFileSize, std::chrono::seconds(intervalSeconds), retentionCount, eCompression);
+}
+
+SRotationStats CFileLogSink::getRotationStats() const {
+    return logRotator.getStats();
+}
+
+/// <summary>
+/// 로그파일을 메모리 매핑으로 기록
+/// 파일을 segment 단위로 미리 할당해 매핑해 두고, 매핑된 영역에 바로 복사한다.
+/// 매핑에 복사된 로그는 프로세스가 비정상 종료되어도 남으며, 종료 시 파일을 실제 길이로 자른다.
+/// flush 정책과 로그파일 교체는 적용되지 않는다.
+/// </summary>
+/// <param name="segmentSize : 한 번에 할당/매핑하는 크기 (byte)"></param>
+void CFileLogSink::enableMappedFile(size_t segmentSize) {
+    std::lock_guard<std::mutex> lock(getSinkMutex());
+    if (!fileOpen || mappedLogFile || batchedLogFile) {
+        return;
+    }
+    closeFile();
+
+    std::unique_ptr<CMappedLogFile> mappedFile(new CMappedLogFile(segmentSize));
+    try {
+        mappedFile->open(path);
+    }
+    catch (...) {
+        fileOpen = false;
+        throw;
+    }
+    mappedLogFile = std::move(mappedFile);
+    if (fileFormat == ELogFileFormat::BINARY) {
+        beginBinaryFile();
+    }
+    // 텍스트/JSON 형식은 위치만 예약하고 복사하므로 sink 의 락이 필요 없다.
+    setConcurrentWrite(fileFormat != ELogFileFormat::BINARY);
+}
+
+bool CFileLogSink::usesMappedFile() const {
+    std::lock_guard<std::mutex> lock(getSinkMutex());
+    return mappedLogFile != nullptr;
+}
+
+/// <summary>
+/// 로그파일 기록 방식 설정
+/// WRITEV, IO_URING 은 sink 전용 스레드를 시작하고, 전용 스레드가 큐에서 꺼낸 로그 묶음을 한 번에 기록한다.
+/// 묶음마다 파일에 기록하므로 flush 정책은 적용되지 않는다. (메모리 매핑을 사용 중이면 무시)
+/// </summary>
+/// <param name="eWriteMode"></param>
+/// <param name="queueDepth : IO_URING 의 동시 기록 개수"></param>
+void CFileLogSink::setWriteMode(EFileWriteMode eWriteMode, unsigned queueDepth) {
+    {
+        std::lock_guard<std::mutex> lock(getSinkMutex());
+        if (!fileOpen || mappedLogFile || batchedLogFile || eWriteMode == EFileWriteMode::STREAM) {
+            return;
+        }
+        std::unique_ptr<CBatchedLogFile> batchedFile(new CBatchedLogFile(eWriteMode, queueDepth));
+        closeFile();
+        batchedLogFile = std::move(batchedFile);
+        writeMode = eWriteMode;
+        // 이미 기록한 내용(바이너리 헤더 등) 뒤에 이어서 기록
+        if (!openFile(std::ios::out | std::ios::app)) {
+            throw std::runtime_error("Unable to open log file: " + path);
+        }
+    }
+    // 파일 교체 등으로 로그가 밀리더라도 버리지 않는다.
+    enableDedicatedThread(4096, EOverflowPolicy::BLOCK);
+}
+
+SBatchedWriteStats CFileLogSink::getWriteStats() const {
+    std::lock_guard<std::mutex> lock(getSinkMutex());
+    return batchedLogFile ? batchedLogFile->getStats() : SBatchedWriteStats();
+}
+
+/// <summary>
+/// 로그파일 저장 형식 설정
+/// BINARY 는 호출 위치(함수, 파일, 줄, 포맷 문자열)를 한 번만 기록하고, 로그마다 시간 차이/호출 위치 id/스레드 번호/인자만 기록한다.
+/// LogDecoder 로 기존 텍스트 형태로 변환할 수 있다.
+/// </summary>
+/// <param name="eFileFormat"></param>
+/// <param name="ePrecision : 디코더가 표시할 시간 단위"></param>
+void CFileLogSink::setFileFormat(ELogFileFormat eFileFormat, ETimePrecision ePrecision) {
+    std::lock_guard<std::mutex> lock(getSinkMutex());
+    binaryPrecision = ePrecision;
+    if (fileFormat == eFileFormat) {
+        return;
+    }
+    fileFormat = eFileFormat;
+    if (eFileFormat == ELogFileFormat::BINARY) {
+        binaryEncoder.reset(new CBinaryLogEncoder());
+        if (fileOpen) {
+            beginBinaryFile();
+        }
+    }
+    setConcurrentWrite(mappedLogFile && fileFormat != ELogFileFormat::BINARY);
+}
+
+bool CFileLogSink::usesDefaultText() const {
+    return fileFormat == ELogFileFormat::TEXT && CLogSink::usesDefaultText();
+}
+
+/// <summary>
+/// 로그파일에 기록하고 flush 정책/교체 조건 확인
+/// </summary>
+void CFileLogSink::write(const SLogEvent& event) {
+    if (!fileOpen) {
+        return;
+    }
+
+    const char* entry = event.text;
+    size_t entrySize = event.textSize;
+    if (fileFormat == ELogFileFormat::BINARY) {
+        binaryRecord.clear();
+        long long wallNanoseconds = event.clock->toWallNanoseconds(event.rawTime);
+        if (event.callSite != nullptr && event.format != nullptr) {
+            binaryEncoder->encodeRecord(binaryRecord, *event.callSite, event.format, wallNanoseconds,
+                event.threadNumber, event.args, event.argsSize, event.argCount, event.sampleRate);
+        }
+        else {
+            binaryEncoder->encodeText(binaryRecord, event.eLogLevel, wallNanoseconds, event.threadNumber,
+                event.text, event.textSize);
+        }
+        entry = binaryRecord.data();
+        entrySize = binaryRecord.size();
+    }
+    else if (fileFormat == ELogFileFormat::JSON_LINES) {
+        thread_local CLogLineBuffer jsonLine;
+        LogJson::render(event, jsonLine);
+        entry = jsonLine.data();
+        entrySize = jsonLine.size();
+    }
+    else if (entry == nullptr || !CLogSink::usesDefaultText()) {
+        thread_local CLogLineBuffer line;
+        formatText(event, line);
+        entry = line.data();
+        entrySize = line.size();
+    }
+
+    if (mappedLogFile) {
+        mappedLogFile->append(entry, entrySize);
+        return;
+    }
+    // 묶음 기록은 전용 스레드가 꺼낸 묶음이 끝날 때 flush 정책을 확인한다. (onBatchEnd)
+    bool batchEndFlush = batchedLogFile && hasDedicatedThread();
+    if (batchEndFlush) {
+        // 큐 슬롯의 텍스트는 묶음이 끝날 때까지 남아 있으므로 복사하지 않는다.
+        batchedLogFile->append(entry, entrySize, entry == event.text);
+        logFileSize += entrySize;
+    }
+    else {
+        writeFile(entry, entrySize);
+    }
+    ++pendingRecords;
+    pendingBytes += entrySize;
+    if (event.eLogLevel == ELogLevel::LOG_ERROR && flushOnErrorLog) {
+        if (batchEndFlush) {
+            errorPending = true;
+        }
+        else {
+            flushFile();
+        }
+    }
+    else if (!batchEndFlush) {
+        flushFileIfDue();
+    }
+    rotateFileIfDue();
+}
+
+void CFileLogSink::flushOutput() {
+    if (mappedLogFile) {
+        mappedLogFile->flush();
+    }
+    else if (fileOpen) {
+        flushFile();
+        if (batchedLogFile) {
+            // io_uring 은 제출한 기록이 끝날 때까지 대기
+            batchedLogFile->flush();
+        }
+    }
+}
+
+/// <summary>
+/// 전용 스레드가 꺼낸 묶음이 끝나면 flush 정책에 따라 한 번에 기록
+/// EVERY_RECORD 면 묶음마다 writev 한 번(io_uring 은 제출 한 번)으로 기록한다.
+/// </summary>
+void CFileLogSink::onBatchEnd() {
+    if (!batchedLogFile || !fileOpen) {
+        return;
+    }
+    if (errorPending) {
+        errorPending = false;
+        flushFile();
+    }
+    else {
+        flushFileIfDue();
+    }
+    // 기록하지 않고 남겨 둔 로그는 큐 슬롯이 재사용되기 전에 복사해 둔다.
+    batchedLogFile->retain();
+}
+
+/// <summary>
+/// 로그가 없는 동안에도 INTERVAL 정책의 flush 와 시간 기준 교체가 늦어지지 않도록 확인
+/// </summary>
+void CFileLogSink::onPoll() {
+    if (!fileOpen || mappedLogFile) {
+        return;
+    }
+    flushFileIfDue();
+    rotateFileIfDue();
+}
+
+/// <summary>
+/// path 를 지정한 쓰기 버퍼로 연다.
+/// </summary>
+/// <param name="openMode : trunc 또는 app"></param>
+/// <returns></returns>
+bool CFileLogSink::openFile(std::ios::openmode openMode) {
+    pendingRecords = 0;
+    pendingBytes = 0;
+    lastFlushTime = std::chrono::steady_clock::now();
+    logFileSize = 0;
+    if (batchedLogFile) {
+        try {
+            batchedLogFile->open(path, (openMode & std::ios::app) != 0);
+            logFileSize = batchedLogFile->getFileSize();
+        }
+        catch (const std::runtime_error&) {
+        }
+        fileOpen = batchedLogFile->isOpen();
+    }
+    else {
+        // 쓰기 버퍼는 open 전에 지정해야 적용된다.
+        logFile = std::ofstream();
+        if (logFileBufferSize > 0) {
+            logFileBuffer.reset(new char[logFileBufferSize]);
+            logFile.rdbuf()->pubsetbuf(logFileBuffer.get(), static_cast<std::streamsize>(logFileBufferSize));
+        }
+        logFile.open(path, openMode);
+        if (openMode & std::ios::app) {
+            logFile.seekp(0, std::ios::end);
+            std::streamoff existingSize = logFile.tellp();
+            logFileSize = existingSize > 0 ? static_cast<unsigned long long>(existingSize) : 0;
+        }
+        fileOpen = logFile.is_open();
+    }
+    logFileOpenedAt = std::chrono::steady_clock::now();
+    if (!fileOpen) {
+        return false;
+    }
+    if (fileFormat == ELogFileFormat::BINARY && (openMode & std::ios::trunc)) {
+        beginBinaryFile();
+    }
+    return true;
+}
+
+void CFileLogSink::closeFile() {
+    if (batchedLogFile) {
+        batchedLogFile->close();
+    }
+    else if (logFile.is_open()) {
+        logFile.flush();
+        logFile.close();
+    }
+}
+
+void CFileLogSink::writeFile(const char* data, size_t size) {
+    if (mappedLogFile) {
+        mappedLogFile->append(data, size);
+        return;
+    }
+    if (batchedLogFile) {
+        batchedLogFile->append(data, size, false);
+        logFileSize += size;
+        return;
+    }
+    logFile.write(data, static_cast<std::streamsize>(size));
+    logFileSize += size;
+}
+
+/// <summary>
+/// 바이너리 파일 헤더 기록. 새 파일을 열었을 때 호출
+/// </summary>
+void CFileLogSink::beginBinaryFile() {
+    binaryRecord.clear();
+    binaryEncoder->beginFile(binaryRecord, binaryPrecision);
+    writeFile(binaryRecord.data(), binaryRecord.size());
+}
+
+/// <summary>
+/// flush 정책에 따라 flush 할 시점이면 로그파일을 flush
+/// </summary>
+void CFileLogSink::flushFileIfDue() {
+    if (pendingRecords == 0) {
+        return;
+    }
+    bool due = false;
+    switch (flushPolicy) {
+    case EFlushPolicy::EVERY_RECORD:
+        due = true;
+        break;
+    case EFlushPolicy::EVERY_N_RECORDS:
+        due = pendingRecords >= flushThreshold;
+        break;
+    case EFlushPolicy::EVERY_N_BYTES:
+        due = pendingBytes >= flushThreshold;
+        break;
+    case EFlushPolicy::INTERVAL:
+        due = std::chrono::steady_clock::now() - lastFlushTime >= std::chrono::milliseconds(flushThreshold);
+        break;
+    }
+    if (due) {
+        flushFile();
+    }
+}
+
+void CFileLogSink::flushFile() {
+    // 묶음 기록은 커널에 넘기기만 한다. (ofstream::flush 와 같음)
+    if (batchedLogFile) {
+        batchedLogFile->submit();
+    }
+    else {
+        logFile.flush();
+    }
+    pendingRecords = 0;
+    pendingBytes = 0;
+    lastFlushTime = std::chrono::steady_clock::now();
+}
+
+/// <summary>
+/// 교체 조건을 만족하면 로그파일 교체
+/// </summary>
+void CFileLogSink::rotateFileIfDue() {
+    if (mappedLogFile || !logRotator.isEnabled() || !logRotator.shouldRotate(logFileSize, logFileOpenedAt)) {
+        return;
+    }
+    closeFile();
+    // 이름 변경에 실패하면 (다른 프로세스가 파일을 열고 있는 경우 등) 기존 파일에 이어서 기록
+    bool rotated = logRotator.rotate(path);
+    if (!openFile(rotated ? std::ios::out | std::ios::trunc : std::ios::out | std::ios::app)) {
+        return;
+    }
+    if (!rotated) {
+        logFileSize = 0;
+    }
+}
@@ -0,0 +1,90 @@
+﻿// CFileLogSink.h
+#ifndef CFileLogSink_H
+#define CFileLogSink_H
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "LogSink.h"
+#include "LogRotator.h"
+#include "LogBatchedFile.h"
+
+class CMappedLogFile;
+class CBinaryLogEncoder;
+
+// 로그파일 출력
+// 기본은 쓰기 버퍼를 사용하는 ofstream 이며, 교체(rotation), 메모리 매핑, 묶음 기록(writev/io_uring), 바이너리 형식을 선택할 수 있다.
+class CFileLogSink : public CLogSink {
+public:
+    // 파일을 새로 만든다. (기존 내용 삭제, 디렉토리는 만들지 않음) 실패하면 std::runtime_error
+    // writeBufferSize : 쓰기 버퍼 크기 (byte), 0 이면 표준 라이브러리 기본값
+    explicit CFileLogSink(const std::string& path, size_t writeBufferSize = 64 * 1024);
+    ~CFileLogSink();
+
+    const std::string& getPath() const { return path; }
+
+    void setFlushPolicy(EFlushPolicy eFlushPolicy, unsigned long long threshold = 0, bool flushOnError = true);
+    void setRotation(unsigned long long maxFileSize, unsigned intervalSeconds = 0, unsigned retentionCount = 5,
+        ELogCompression eCompression = ELogCompression::NONE);
+    SRotationStats getRotationStats() const;
+    // 아래 설정은 로그를 남기기 전에 호출
+    void enableMappedFile(size_t segmentSize = 64 * 1024 * 1024);
+    bool usesMappedFile() const;
+    // WRITEV, IO_URING 은 전용 스레드를 시작하고, 큐에서 꺼낸 로그 묶음마다 한 번에 기록한다.
+    // IO_URING 을 이 빌드에서 사용할 수 없으면 std::runtime_error
+    void setWriteMode(EFileWriteMode eWriteMode, unsigned queueDepth = 8);
+    EFileWriteMode getWriteMode() const { return writeMode; }
+    // WRITEV, IO_URING 의 기록 통계 (시스템 호출 횟수 등)
+    SBatchedWriteStats getWriteStats() const;
+    // ePrecision : 바이너리 형식을 디코더가 표시할 시간 단위
+    void setFileFormat(ELogFileFormat eFileFormat, ETimePrecision ePrecision = ETimePrecision::SECONDS);
+    ELogFileFormat getFileFormat() const { return fileFormat; }
+
+    bool usesDefaultText() const override;
+
+protected:
+    void write(const SLogEvent& event) override;
+    void flushOutput() override;
+    void onBatchEnd() override;
+    void onPoll() override;
+
+private:
+    bool openFile(std::ios::openmode openMode);
+    void closeFile();
+    void writeFile(const char* data, size_t size);
+    void beginBinaryFile();
+    void flushFileIfDue();
+    void flushFile();
+    void rotateFileIfDue();
+
+    std::string path;
+    std::ofstream logFile;
+    std::unique_ptr<char[]> logFileBuffer;
+    size_t logFileBufferSize = 0;
+    unsigned long long logFileSize = 0;
+    std::chrono::steady_clock::time_point logFileOpenedAt;
+    bool fileOpen = false;
+
+    EFlushPolicy flushPolicy = EFlushPolicy::EVERY_RECORD;
+    unsigned long long flushThreshold = 0;
+    bool flushOnErrorLog = true;
+    unsigned long long pendingRecords = 0;
+    unsigned long long pendingBytes = 0;
+    std::chrono::steady_clock::time_point lastFlushTime;
+
+    CLogRotator logRotator;
+    // enableMappedFile 로 설정하면 logFile 대신 사용 (텍스트 형식이면 로그 호출 스레드가 락 없이 바로 복사)
+    std::unique_ptr<CMappedLogFile> mappedLogFile;
+    // setWriteMode 로 WRITEV, IO_URING 을 설정하면 logFile 대신 사용
+    std::unique_ptr<CBatchedLogFile> batchedLogFile;
+    EFileWriteMode writeMode = EFileWriteMode::STREAM;
+    bool errorPending = false;      // 묶음 안에 flush 할 LOG_ERROR 가 있음
+    ELogFileFormat fileFormat = ELogFileFormat::TEXT;
+    ETimePrecision binaryPrecision = ETimePrecision::SECONDS;
+    std::unique_ptr<CBinaryLogEncoder> binaryEncoder;
+    CLogLineBuffer binaryRecord;
+};
+
+#endif // CFileLogSink_H
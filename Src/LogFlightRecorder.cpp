@@ -0,0 +1,657 @@
+﻿#include "pch.h"
+#include "LogFlightRecorder.h"
+#include "LogClock.h"
+#include "LogPlatform.h"
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const size_t CFlightRecorderSink::kSlotWords;
+const size_t CFlightRecorderSink::kHeaderWords;
+const size_t CFlightRecorderSink::kDataSize;
+std::atomic<CFlightRecorderSink*> CFlightRecorderSink::crashRecorder(nullptr);
+
+namespace {
+    const int kCrashSignals[] = {
+        SIGSEGV, SIGABRT, SIGFPE, SIGILL,
+#ifndef _WIN32
+        SIGBUS,
+#endif
+    };
+    const size_t kCrashSignalCount = sizeof(kCrashSignals) / sizeof(kCrashSignals[0]);
+
+    // 설치 전의 시그널 처리 (비정상 종료 시 되돌린 뒤 다시 발생시킨다)
+#ifdef _WIN32
+    typedef void (*SignalHandler)(int);
+    SignalHandler previousHandlers[kCrashSignalCount];
+#else
+    struct sigaction previousActions[kCrashSignalCount];
+#endif
+    std::atomic<bool> crashHandlerInstalled(false);
+
+    const uint64_t kTextFlag = 1ULL << 8;
+    const uint64_t kScopeFlag = 1ULL << 9;
+
+    // 시그널 핸들러에서 쓰는 고정 크기 출력 버퍼 (힙 할당, 락 없음)
+    struct SCrashLine {
+        char* out;
+        size_t capacity;
+        size_t size;
+
+        void append(const char* text, size_t length) {
+            length = (std::min)(length, capacity - size);
+            std::memcpy(out + size, text, length);
+            size += length;
+        }
+        void append(const char* text) {
+            append(text, std::strlen(text));
+        }
+        void append(char ch) {
+            append(&ch, 1);
+        }
+        void appendUnsigned(unsigned long long value, int width = 0) {
+            char digits[24];
+            int pos = sizeof(digits);
+            do {
+                digits[--pos] = static_cast<char>('0' + value % 10);
+                value /= 10;
+                --width;
+            } while (value != 0 || width > 0);
+            append(digits + pos, sizeof(digits) - pos);
+        }
+        void appendSigned(long long value) {
+            if (value < 0) {
+                append('-');
+                appendUnsigned(0ULL - static_cast<unsigned long long>(value));
+                return;
+            }
+            appendUnsigned(static_cast<unsigned long long>(value));
+        }
+        void appendHex(unsigned long long value) {
+            static const char kHexDigits[] = "0123456789abcdef";
+            char digits[16];
+            int pos = sizeof(digits);
+            do {
+                digits[--pos] = kHexDigits[value & 0xF];
+                value >>= 4;
+            } while (value != 0);
+            append("0x", 2);
+            append(digits + pos, sizeof(digits) - pos);
+        }
+        // snprintf 를 쓸 수 없으므로 소수점 아래 6자리까지 직접 변환 (%g 와 표기가 다를 수 있음)
+        void appendDouble(double value) {
+            if (value != value) {
+                append("nan");
+                return;
+            }
+            if (value < 0) {
+                append('-');
+                value = -value;
+            }
+            if (value >= 1e18) {
+                append("inf");
+                return;
+            }
+            unsigned long long integral = static_cast<unsigned long long>(value);
+            unsigned long long fraction = static_cast<unsigned long long>((value - integral) * 1000000.0 + 0.5);
+            if (fraction >= 1000000) {
+                ++integral;
+                fraction -= 1000000;
+            }
+            appendUnsigned(integral);
+            if (fraction == 0) {
+                return;
+            }
+            int width = 6;
+            while (fraction % 10 == 0) {
+                fraction /= 10;
+                --width;
+            }
+            append('.');
+            appendUnsigned(fraction, width);
+        }
+        // 저장된 인자 하나를 변환. 반환값 : 읽은 byte 수 (0 이면 잘못된 데이터)
+        size_t appendArg(const char* arg, size_t argSize) {
+            size_t size = LogArgs::encodedSize(arg, argSize);
+            if (size == 0) {
+                return 0;
+            }
+            switch (static_cast<ELogArgType>(arg[0])) {
+            case ELogArgType::INT: { int64_t value; std::memcpy(&value, arg + 1, sizeof(value)); appendSigned(value); break; }
+            case ELogArgType::UINT: { uint64_t value; std::memcpy(&value, arg + 1, sizeof(value)); appendUnsigned(value); break; }
+            case ELogArgType::DOUBLE: { double value; std::memcpy(&value, arg + 1, sizeof(value)); appendDouble(value); break; }
+            case ELogArgType::CHAR: append(arg[1]); break;
+            case ELogArgType::BOOL: append(arg[1] != 0 ? "true" : "false"); break;
+            case ELogArgType::POINTER: { uintptr_t value; std::memcpy(&value, arg + 1, sizeof(value)); appendHex(value); break; }
+            case ELogArgType::STRING:
+            case ELogArgType::FIELD_KEY: append(arg + 1 + sizeof(uint32_t), size - 1 - sizeof(uint32_t)); break;
+            }
+            return size;
+        }
+        // 1970-01-01 기준 초를 "yyyy-mm-dd hh:mm:ss" 로 (localtime 대신 정수 계산)
+        void appendDateTime(long long seconds) {
+            long long days = seconds / 86400;
+            long long secondOfDay = seconds % 86400;
+            if (secondOfDay < 0) {
+                secondOfDay += 86400;
+                --days;
+            }
+            long long z = days + 719468;
+            long long era = (z >= 0 ? z : z - 146096) / 146097;
+            long long dayOfEra = z - era * 146097;
+            long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+            long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+            long long monthIndex = (5 * dayOfYear + 2) / 153;
+            long long day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+            long long month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+            long long year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+            appendUnsigned(static_cast<unsigned long long>(year), 4);
+            append('-');
+            appendUnsigned(static_cast<unsigned long long>(month), 2);
+            append('-');
+            appendUnsigned(static_cast<unsigned long long>(day), 2);
+            append(' ');
+            appendUnsigned(static_cast<unsigned long long>(secondOfDay / 3600), 2);
+            append(':');
+            appendUnsigned(static_cast<unsigned long long>(secondOfDay / 60 % 60), 2);
+            append(':');
+            appendUnsigned(static_cast<unsigned long long>(secondOfDay % 60), 2);
+        }
+    };
+
+    void writeAll(int fileDescriptor, const char* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int written = _write(fileDescriptor, data, static_cast<unsigned>(size));
+#else
+            ssize_t written = ::write(fileDescriptor, data, size);
+#endif
+            if (written <= 0) {
+                return;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    // 현지 시간 - UTC (초). 시그널 핸들러에서는 localtime 을 쓸 수 없으므로 미리 계산한다.
+    long long currentUtcOffset() {
+        std::time_t now = std::time(nullptr);
+        std::tm utc;
+        LogPlatform::utcTime(now, utc);
+        utc.tm_isdst = -1;
+        return static_cast<long long>(std::difftime(now, std::mktime(&utc)));
+    }
+}
+
+/// <summary>
+/// 비행 기록 장치
+/// </summary>
+/// <param name="capacity : 보관할 로그 개수 (2의 거듭제곱으로 올림)"></param>
+/// <param name="eRecordBelow : 이 레벨 미만의 로그를 보관"></param>
+/// <param name="eDumpLevel : 이 레벨 이상의 로그가 들어오면 보관한 로그를 기록"></param>
+/// <param name="target : 보관한 로그를 기록할 sink"></param>
+CFlightRecorderSink::CFlightRecorderSink(size_t capacity, ELogLevel eRecordBelow, ELogLevel eDumpLevel,
+    std::shared_ptr<CLogSink> target)
+    : target(std::move(target))
+{
+    slotCount = 1;
+    while (slotCount < capacity) {
+        slotCount <<= 1;
+    }
+    slots.reset(new SFlightSlot[slotCount]);
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].sequence.store(0);
+        for (auto& word : slots[i].words) {
+            word.store(0);
+        }
+    }
+    nextIndex.store(0);
+    dumpedIndex.store(0);
+    skippedCount.store(0);
+    clock.store(nullptr);
+    recordBelow = static_cast<int>(eRecordBelow);
+    targetLevel.store(static_cast<int>(ELogLevel::LOG_DEBUG));
+    dumpLevel = static_cast<int>(eDumpLevel);
+    crashPath[0] = '\0';
+    // 로그 호출 스레드가 링에 바로 기록 (sink 의 락을 잡지 않음)
+    setConcurrentWrite(true);
+}
+
+CFlightRecorderSink::~CFlightRecorderSink() {
+    stopDedicatedThread();
+    if (crashRecorder.load() == this) {
+        uninstallCrashHandler();
+    }
+}
+
+/// <summary>
+/// 대상 sink 의 레벨 지정
+/// 보관 레벨 미만의 로그는 링에만 보관해야 하므로, 대상 sink 에는 지정한 레벨과 보관 레벨 중 높은 레벨을 적용한다.
+/// </summary>
+/// <param name="eLogLevel : 비행 기록 장치가 없을 때 대상 sink 가 사용할 레벨 (restoreTargetLevel 로 되돌림)"></param>
+void CFlightRecorderSink::setTargetLevel(ELogLevel eLogLevel) {
+    int level = static_cast<int>(eLogLevel);
+    targetLevel.store(level);
+    target->setMinLevel(static_cast<ELogLevel>(level > recordBelow ? level : recordBelow));
+}
+
+ELogLevel CFlightRecorderSink::getTargetLevel() const {
+    return static_cast<ELogLevel>(targetLevel.load());
+}
+
+void CFlightRecorderSink::restoreTargetLevel() {
+    target->setMinLevel(getTargetLevel());
+}
+
+void CFlightRecorderSink::write(const SLogEvent& event) {
+    int level = static_cast<int>(event.eLogLevel);
+    if (level < recordBelow) {
+        record(event);
+    }
+    if (level >= dumpLevel) {
+        dump(event.eLogLevel == ELogLevel::LOG_ERROR ? "LOG_ERROR" : "dump level");
+    }
+}
+
+/// <summary>
+/// 로그 하나를 링에 보관. 문자열로 변환하지 않고 호출 위치/포맷/인자를 그대로 복사한다.
+/// </summary>
+void CFlightRecorderSink::record(const SLogEvent& event) {
+    if (clock.load(std::memory_order_relaxed) == nullptr) {
+        clock.store(event.clock, std::memory_order_relaxed);
+    }
+
+    uint64_t words[kSlotWords];
+    char* data = reinterpret_cast<char*>(words + kHeaderWords);
+    size_t dataSize = 0;
+    unsigned argCount = 0;
+    bool isText = event.callSite == nullptr || event.format == nullptr;
+    if (isText) {
+        dataSize = (std::min)(event.textSize, kDataSize);
+        std::memcpy(data, event.text, dataSize);
+        if (dataSize < event.textSize && dataSize > 0) {
+            data[dataSize - 1] = '\n';
+        }
+    }
+    else {
+        // 슬롯에 들어가는 인자까지만 보관 (긴 문자열은 들어가는 만큼 자른다)
+        const char* args = event.args;
+        size_t offset = 0;
+        while (argCount < event.argCount && offset < event.argsSize) {
+            size_t size = LogArgs::encodedSize(args + offset, event.argsSize - offset);
+            if (size == 0) {
+                break;
+            }
+            if (dataSize + size > kDataSize) {
+                const size_t kStringHeader = 1 + sizeof(uint32_t);
+                if (static_cast<ELogArgType>(args[offset]) == ELogArgType::STRING && dataSize + kStringHeader < kDataSize) {
+                    uint32_t length = static_cast<uint32_t>(kDataSize - dataSize - kStringHeader);
+                    data[dataSize] = args[offset];
+                    std::memcpy(data + dataSize + 1, &length, sizeof(length));
+                    std::memcpy(data + dataSize + kStringHeader, args + offset + kStringHeader, length);
+                    dataSize = kDataSize;
+                    ++argCount;
+                }
+                break;
+            }
+            std::memcpy(data + dataSize, args + offset, size);
+            dataSize += size;
+            offset += size;
+            ++argCount;
+        }
+    }
+    words[0] = reinterpret_cast<uintptr_t>(event.callSite);
+    words[1] = reinterpret_cast<uintptr_t>(event.format);
+    words[2] = static_cast<uint64_t>(event.rawTime);
+    words[3] = static_cast<uint64_t>(static_cast<unsigned char>(event.eLogLevel)) | (isText ? kTextFlag : 0)
+        | (event.scope ? kScopeFlag : 0)
+        | (static_cast<uint64_t>(argCount) << 16) | (static_cast<uint64_t>(dataSize) << 32);
+    uint32_t sampleRateBits;
+    std::memcpy(&sampleRateBits, &event.sampleRate, sizeof(sampleRateBits));
+    words[4] = event.threadNumber | (static_cast<uint64_t>(sampleRateBits) << 32);
+
+    unsigned long long index = nextIndex.fetch_add(1, std::memory_order_relaxed);
+    SFlightSlot& slot = slots[index & (slotCount - 1)];
+    unsigned long long writing = 2 * index + 1;
+    unsigned long long current = slot.sequence.load(std::memory_order_relaxed);
+    // 링을 한 바퀴 돌 동안 끝나지 않은 쓰기(또는 더 새로운 로그)가 있으면 이 로그는 보관하지 않는다.
+    if ((current & 1) != 0 || current > writing
+        || !slot.sequence.compare_exchange_strong(current, writing, std::memory_order_relaxed)) {
+        skippedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    size_t wordCount = kHeaderWords + (dataSize + 7) / 8;
+    for (size_t i = 0; i < wordCount; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(writing + 1, std::memory_order_release);
+}
+
+/// <summary>
+/// index 번째 로그를 슬롯에서 꺼낸다. 이미 덮어썼거나 쓰는 중이면 false
+/// </summary>
+bool CFlightRecorderSink::readSlot(unsigned long long index, SFlightRecord& record) const {
+    const SFlightSlot& slot = slots[index & (slotCount - 1)];
+    unsigned long long expected = 2 * index + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+    uint64_t words[kSlotWords];
+    for (size_t i = 0; i < kHeaderWords; ++i) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    size_t dataSize = (std::min)(static_cast<size_t>((words[3] >> 32) & 0xFFFF), kDataSize);
+    size_t wordCount = kHeaderWords + (dataSize + 7) / 8;
+    for (size_t i = kHeaderWords; i < wordCount; ++i) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        return false;
+    }
+
+    record.callSite = reinterpret_cast<const SLogCallSite*>(static_cast<uintptr_t>(words[0]));
+    record.format = reinterpret_cast<const char*>(static_cast<uintptr_t>(words[1]));
+    record.rawTime = static_cast<long long>(words[2]);
+    record.eLogLevel = static_cast<ELogLevel>(words[3] & 0xFF);
+    record.isText = (words[3] & kTextFlag) != 0;
+    record.scope = (words[3] & kScopeFlag) != 0;
+    record.argCount = static_cast<unsigned>((words[3] >> 16) & 0xFFFF);
+    record.dataSize = dataSize;
+    record.threadNumber = static_cast<unsigned>(words[4] & 0xFFFFFFFF);
+    uint32_t sampleRateBits = static_cast<uint32_t>(words[4] >> 32);
+    std::memcpy(&record.sampleRate, &sampleRateBits, sizeof(record.sampleRate));
+    std::memcpy(record.data, words + kHeaderWords, dataSize);
+    return true;
+}
+
+/// <summary>
+/// 지난 dump 이후 보관한 로그를 오래된 순서로 대상 sink 에 기록하고 flush
+/// </summary>
+/// <param name="reason : 기록 앞뒤에 남길 구분 문구"></param>
+void CFlightRecorderSink::dump(const char* reason) {
+    if (!target) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(dumpMutex);
+    unsigned long long end = nextIndex.load(std::memory_order_acquire);
+    unsigned long long begin = dumpedIndex.load(std::memory_order_relaxed);
+    if (end > slotCount) {
+        begin = (std::max)(begin, static_cast<unsigned long long>(end - slotCount));
+    }
+    if (begin >= end || clock.load() == nullptr) {
+        return;
+    }
+    dumpedIndex.store(end, std::memory_order_relaxed);
+
+    CLogLineBuffer marker;
+    marker.append("----- flight recorder : ");
+    marker.appendInt(static_cast<long long>(end - begin));
+    marker.append(" records before ");
+    marker.append(reason);
+    marker.append(" -----\n");
+    submitMarker(marker.data(), marker.size());
+
+    SFlightRecord record;
+    for (unsigned long long index = begin; index < end; ++index) {
+        if (readSlot(index, record)) {
+            submitRecord(record);
+        }
+    }
+    submitMarker("----- end of flight recorder -----\n", 35);
+    target->flush();
+}
+
+void CFlightRecorderSink::submitRecord(const SFlightRecord& record) {
+    SLogEvent event;
+    event.eLogLevel = record.eLogLevel;
+    event.threadNumber = record.threadNumber;
+    event.rawTime = record.rawTime;
+    event.clock = clock.load(std::memory_order_relaxed);
+    if (record.isText) {
+        event.text = record.data;
+        event.textSize = record.dataSize;
+    }
+    else {
+        event.callSite = record.callSite;
+        event.format = record.format;
+        event.args = record.data;
+        event.argsSize = record.dataSize;
+        event.argCount = record.argCount;
+        event.sampleRate = record.sampleRate;
+        event.scope = record.scope;
+    }
+    thread_local CLogLineBuffer line;
+    if (event.text == nullptr && target->usesDefaultText()) {
+        LogText::render(line, event);
+        event.text = line.data();
+        event.textSize = line.size();
+    }
+    target->submit(event);
+}
+
+void CFlightRecorderSink::submitMarker(const char* text, size_t size) {
+    SLogEvent event;
+    event.eLogLevel = ELogLevel::LOG_INFO;
+    event.clock = clock.load(std::memory_order_relaxed);
+    event.rawTime = event.clock->now();
+    event.text = text;
+    event.textSize = size;
+    target->submit(event);
+}
+
+/// <summary>
+/// 비정상 종료 시그널(SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS)에서 링을 path 에 이어서 기록하도록 설치
+/// 기록한 뒤에는 이전 시그널 처리로 되돌리고 시그널을 다시 발생시킨다.
+/// </summary>
+/// <param name="path : 기록할 파일 (비어 있으면 표준 에러)"></param>
+void CFlightRecorderSink::installCrashHandler(const std::string& path) {
+    size_t size = (std::min)(path.size(), sizeof(crashPath) - 1);
+    std::memcpy(crashPath, path.data(), size);
+    crashPath[size] = '\0';
+    utcOffsetSeconds = currentUtcOffset();
+    crashRecorder.store(this);
+
+    if (crashHandlerInstalled.exchange(true)) {
+        return;
+    }
+    for (size_t i = 0; i < kCrashSignalCount; ++i) {
+#ifdef _WIN32
+        previousHandlers[i] = std::signal(kCrashSignals[i], &CFlightRecorderSink::crashSignalHandler);
+#else
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &CFlightRecorderSink::crashSignalHandler;
+        sigemptyset(&action.sa_mask);
+        sigaction(kCrashSignals[i], &action, &previousActions[i]);
+#endif
+    }
+}
+
+/// <summary>
+/// 설치 전의 시그널 처리로 되돌린다. (async-signal-safe)
+/// </summary>
+void CFlightRecorderSink::uninstallCrashHandler() {
+    crashRecorder.store(nullptr);
+    if (!crashHandlerInstalled.exchange(false)) {
+        return;
+    }
+    for (size_t i = 0; i < kCrashSignalCount; ++i) {
+#ifdef _WIN32
+        std::signal(kCrashSignals[i], previousHandlers[i] == SIG_ERR ? SIG_DFL : previousHandlers[i]);
+#else
+        sigaction(kCrashSignals[i], &previousActions[i], nullptr);
+#endif
+    }
+}
+
+void CFlightRecorderSink::crashSignalHandler(int signalNumber) {
+    CFlightRecorderSink* recorder = crashRecorder.exchange(nullptr);
+    if (recorder != nullptr) {
+        recorder->dumpForCrash(signalNumber);
+    }
+    uninstallCrashHandler();
+    std::raise(signalNumber);
+}
+
+/// <summary>
+/// 시그널 핸들러에서 링을 기록. open/write/close 와 atomic 읽기만 사용한다.
+/// </summary>
+void CFlightRecorderSink::dumpForCrash(int signalNumber) {
+    int fileDescriptor = 2;
+    if (crashPath[0] != '\0') {
+#ifdef _WIN32
+        int opened = _open(crashPath, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        int opened = ::open(crashPath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+        if (opened >= 0) {
+            fileDescriptor = opened;
+        }
+    }
+
+    char text[1024];
+    SCrashLine line = { text, sizeof(text), 0 };
+    line.append("----- flight recorder : signal ");
+    line.appendUnsigned(static_cast<unsigned long long>(signalNumber));
+    line.append(" -----\n");
+    writeAll(fileDescriptor, text, line.size);
+
+    unsigned long long end = nextIndex.load();
+    unsigned long long begin = dumpedIndex.load();
+    if (end > slotCount && begin < end - slotCount) {
+        begin = end - slotCount;
+    }
+    SFlightRecord record;
+    for (unsigned long long index = begin; index < end; ++index) {
+        if (readSlot(index, record)) {
+            size_t size = renderForCrash(record, text, sizeof(text));
+            writeAll(fileDescriptor, text, size);
+        }
+    }
+    const char footer[] = "----- end of flight recorder -----\n";
+    writeAll(fileDescriptor, footer, sizeof(footer) - 1);
+
+    if (fileDescriptor != 2) {
+#ifdef _WIN32
+        _close(fileDescriptor);
+#else
+        ::close(fileDescriptor);
+#endif
+    }
+}
+
+/// <summary>
+/// 기본 텍스트 형식으로 변환 (async-signal-safe, 실수는 소수점 아래 6자리까지)
+/// </summary>
+size_t CFlightRecorderSink::renderForCrash(const SFlightRecord& record, char* out, size_t capacity) const {
+    SCrashLine line = { out, capacity, 0 };
+    if (record.isText) {
+        line.append(record.data, record.dataSize);
+        return line.size;
+    }
+
+    const CLogClock* logClock = clock.load(std::memory_order_relaxed);
+    long long wallNanoseconds = logClock->toWallNanoseconds(record.rawTime) + utcOffsetSeconds * 1000000000LL;
+    long long seconds = wallNanoseconds / 1000000000LL;
+    long long subSecond = wallNanoseconds % 1000000000LL;
+    if (subSecond < 0) {
+        subSecond += 1000000000LL;
+        --seconds;
+    }
+    line.append('[');
+    line.appendDateTime(seconds);
+    switch (logClock->getPrecision()) {
+    case ETimePrecision::MILLISECONDS: line.append('.'); line.appendUnsigned(subSecond / 1000000, 3); break;
+    case ETimePrecision::MICROSECONDS: line.append('.'); line.appendUnsigned(subSecond / 1000, 6); break;
+    case ETimePrecision::NANOSECONDS: line.append('.'); line.appendUnsigned(subSecond, 9); break;
+    default: break;
+    }
+    line.append("]\t ", 3);
+    line.append(record.callSite->levelTag.data, record.callSite->levelTag.size);
+
+    // LogArgs::render 와 같은 규칙으로 "{}" 자리에 인자를 채우고 구조화 필드를 붙인다.
+    const char* args = record.data;
+    size_t offset = 0;
+    unsigned used = 0;
+    for (const char* p = record.format; *p != '\0'; ++p) {
+        if ((p[0] == '{' && p[1] == '{') || (p[0] == '}' && p[1] == '}')) {
+            line.append(*p);
+            ++p;
+            continue;
+        }
+        if (p[0] != '{' || p[1] != '}' || used >= record.argCount || offset >= record.dataSize
+            || static_cast<ELogArgType>(args[offset]) == ELogArgType::FIELD_KEY) {
+            line.append(*p);
+            continue;
+        }
+        ++p;
+        ++used;
+        size_t size = line.appendArg(args + offset, record.dataSize - offset);
+        if (size == 0) {
+            line.append("{?}", 3);
+            used = record.argCount;
+            continue;
+        }
+        offset += size;
+    }
+    while (used < record.argCount && offset < record.dataSize
+        && static_cast<ELogArgType>(args[offset]) != ELogArgType::FIELD_KEY) {
+        size_t size = LogArgs::encodedSize(args + offset, record.dataSize - offset);
+        if (size == 0) {
+            break;
+        }
+        offset += size;
+        ++used;
+    }
+    while (used + 1 < record.argCount && offset < record.dataSize
+        && static_cast<ELogArgType>(args[offset]) == ELogArgType::FIELD_KEY) {
+        line.append(' ');
+        size_t keySize = line.appendArg(args + offset, record.dataSize - offset);
+        line.append('=');
+        size_t valueSize = keySize == 0 ? 0 : line.appendArg(args + offset + keySize, record.dataSize - offset - keySize);
+        if (valueSize == 0) {
+            break;
+        }
+        offset += keySize + valueSize;
+        used += 2;
+    }
+    if (record.sampleRate > 0.0f && record.sampleRate < 1.0f) {
+        // 소수점 아래 6 자리까지 (snprintf 를 쓰지 않음)
+        unsigned long long millionths = static_cast<unsigned long long>(record.sampleRate * 1000000.0f + 0.5f);
+        if (millionths > 999999) {
+            millionths = 999999;
+        }
+        int width = 6;
+        while (width > 1 && millionths % 10 == 0) {
+            millionths /= 10;
+            --width;
+        }
+        line.append(" sample_rate=0.", 15);
+        line.appendUnsigned(millionths, width);
+    }
+
+    line.append(" (Log from ", 11);
+    line.append(record.callSite->functionName);
+    line.append(" at ", 4);
+    line.append(record.callSite->fileName);
+    line.append(':');
+    line.appendUnsigned(static_cast<unsigned long long>(record.callSite->lineNumber));
+    line.append(")\n", 2);
+    if (line.size == capacity) {
+        out[capacity - 1] = '\n';
+    }
+    return line.size;
+}
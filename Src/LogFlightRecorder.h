@@ -0,0 +1,105 @@
+﻿// CFlightRecorderSink.h
+#ifndef CFlightRecorderSink_H
+#define CFlightRecorderSink_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "LogArgs.h"
+#include "LogSink.h"
+
+// 비행 기록 장치(flight recorder)
+// recordBelow 미만 레벨(기본 DEBUG/INFO)의 로그를 고정 크기 링에 덮어쓰며 보관하고(락 없음, 문자열 변환 없음),
+// LOG_ERROR 가 들어오거나 dump() 를 호출하면 보관 중인 로그를 대상 sink(로그파일)에 기록한다.
+// installCrashHandler 를 호출하면 SIGSEGV/SIGABRT 등에서 async-signal-safe 함수(open/write)만으로 링을 기록한다.
+// 링의 슬롯 하나에 로그 하나를 보관하며, 슬롯보다 큰 인자/텍스트는 들어가는 만큼만 보관한다.
+class CFlightRecorderSink : public CLogSink {
+public:
+    // capacity : 보관할 로그 개수 (2의 거듭제곱으로 올림)
+    // eRecordBelow : 이 레벨 미만의 로그를 보관, eDumpLevel 이상의 로그가 들어오면 dump
+    // target : dump 한 로그를 기록할 sink (최소 레벨과 상관없이 기록)
+    CFlightRecorderSink(size_t capacity, ELogLevel eRecordBelow, ELogLevel eDumpLevel, std::shared_ptr<CLogSink> target);
+    ~CFlightRecorderSink();
+
+    bool usesDefaultText() const override { return false; }
+
+    // 지난 dump 이후 보관한 로그를 오래된 순서로 대상 sink 에 기록
+    // reason : 기록 앞뒤에 남길 구분 문구
+    void dump(const char* reason = "explicit dump");
+
+    // 비정상 종료 시그널에서 링을 path 에 이어서 기록 (프로세스에 하나만 설치, 마지막 설치가 유효)
+    void installCrashHandler(const std::string& path);
+    static void uninstallCrashHandler();
+
+    size_t getCapacity() const { return slotCount; }
+    unsigned long long getRecordedCount() const { return nextIndex.load(std::memory_order_relaxed); }
+    std::shared_ptr<CLogSink> getTarget() const { return target; }
+    // 대상 sink 의 레벨 지정 : 값을 보관하고, 대상 sink 에는 보관 레벨(eRecordBelow)과 둘 중 높은 레벨을 적용한다.
+    void setTargetLevel(ELogLevel eLogLevel);
+    ELogLevel getTargetLevel() const;
+    // 대상 sink 를 setTargetLevel 로 보관한 레벨로 되돌린다. (비행 기록 장치를 끌 때)
+    void restoreTargetLevel();
+
+protected:
+    void write(const SLogEvent& event) override;
+
+private:
+    // 슬롯 하나의 크기 (8 byte 단위, sequence 제외)
+    static const size_t kSlotWords = 32;
+    static const size_t kHeaderWords = 5;
+    static const size_t kDataSize = (kSlotWords - kHeaderWords) * 8;
+
+    // 링의 슬롯. 내용은 sequence 로 보호되는 atomic word 로 기록/읽기 한다. (seqlock)
+    // sequence : 2 * index + 1 이면 기록 중, 2 * index + 2 면 index 번째 로그 기록 완료
+    struct SFlightSlot {
+        std::atomic<unsigned long long> sequence;
+        std::atomic<uint64_t> words[kSlotWords];
+    };
+
+    // 슬롯에서 꺼낸 로그
+    struct SFlightRecord {
+        const SLogCallSite* callSite;
+        const char* format;
+        long long rawTime;
+        ELogLevel eLogLevel;
+        bool isText;
+        unsigned argCount;
+        size_t dataSize;
+        unsigned threadNumber;
+        float sampleRate;
+        bool scope;
+        char data[kDataSize];
+    };
+
+    void record(const SLogEvent& event);
+    bool readSlot(unsigned long long index, SFlightRecord& record) const;
+    void submitRecord(const SFlightRecord& record);
+    void submitMarker(const char* text, size_t size);
+    // 시그널 핸들러에서 호출 (async-signal-safe)
+    void dumpForCrash(int signalNumber);
+    size_t renderForCrash(const SFlightRecord& record, char* out, size_t capacity) const;
+    static void crashSignalHandler(int signalNumber);
+
+    size_t slotCount;
+    std::unique_ptr<SFlightSlot[]> slots;
+    std::atomic<unsigned long long> nextIndex;
+    std::atomic<unsigned long long> dumpedIndex;    // 이 번호 이전의 로그는 이미 dump 됨
+    std::atomic<unsigned long long> skippedCount;   // 다른 스레드가 같은 슬롯을 쓰는 중이라 보관하지 못한 로그
+    int recordBelow;
+    std::atomic<int> targetLevel;                   // 비행 기록 장치가 없을 때의 대상 sink 레벨
+    int dumpLevel;
+    std::shared_ptr<CLogSink> target;
+    std::atomic<const CLogClock*> clock;           // 첫 로그의 시간 기준 (시간 변환에 사용)
+    std::mutex dumpMutex;
+
+    // 시그널 핸들러용 (로그파일 경로, 현지 시간 오프셋은 설치할 때 미리 계산)
+    char crashPath[512];
+    long long utcOffsetSeconds = 0;
+    static std::atomic<CFlightRecorderSink*> crashRecorder;
+};
+
+#endif // CFlightRecorderSink_H
@@ -0,0 +1,193 @@
+﻿#include "pch.h"
+#include "LogJson.h"
+#include "LogArgs.h"
+#include "LogClock.h"
+#include "LogSink.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    SLogStringView levelName(ELogLevel eLogLevel) {
+        static const SLogStringView levelNames[] = {
+            { "DEBUG", 5 }, { "INFO", 4 }, { "WARNING", 7 }, { "ERROR", 5 }
+        };
+        static const SLogStringView unknown = { "UNKNOWN", 7 };
+        int index = static_cast<int>(eLogLevel);
+        return index >= 0 && index < 4 ? levelNames[index] : unknown;
+    }
+
+    void appendString(CLogLineBuffer& line, const char* text, size_t size) {
+        line.append('"');
+        LogJson::appendEscaped(line, text, size);
+        line.append('"');
+    }
+
+    void appendHeader(CLogLineBuffer& line, SLogStringView time, ELogLevel eLogLevel, unsigned threadNumber) {
+        SLogStringView level = levelName(eLogLevel);
+        line.append("{\"time\":\"", 9);
+        line.append(time.data, time.size);
+        line.append("\",\"level\":\"", 11);
+        line.append(level.data, level.size);
+        line.append("\",\"thread\":", 11);
+        line.appendInt(threadNumber);
+    }
+}
+
+namespace LogJson {
+
+    void appendEscaped(CLogLineBuffer& line, const char* text, size_t size) {
+        static const char kHexDigits[] = "0123456789abcdef";
+        const char* literalStart = text;
+        const char* end = text + size;
+        for (const char* p = text; p < end; ++p) {
+            unsigned char ch = static_cast<unsigned char>(*p);
+            if (ch >= 0x20 && ch != '"' && ch != '\\') {
+                continue;
+            }
+            line.append(literalStart, static_cast<size_t>(p - literalStart));
+            literalStart = p + 1;
+            switch (ch) {
+            case '"': line.append("\\\"", 2); break;
+            case '\\': line.append("\\\\", 2); break;
+            case '\n': line.append("\\n", 2); break;
+            case '\r': line.append("\\r", 2); break;
+            case '\t': line.append("\\t", 2); break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', kHexDigits[ch >> 4], kHexDigits[ch & 0xF] };
+                line.append(escaped, sizeof(escaped));
+                break;
+            }
+            }
+        }
+        line.append(literalStart, static_cast<size_t>(end - literalStart));
+    }
+
+    size_t appendValue(CLogLineBuffer& line, const char* arg, size_t argSize) {
+        size_t size = LogArgs::encodedSize(arg, argSize);
+        if (size == 0) {
+            return 0;
+        }
+        char text[64];
+        switch (static_cast<ELogArgType>(arg[0])) {
+        case ELogArgType::INT:
+        case ELogArgType::UINT:
+        case ELogArgType::BOOL:
+            LogArgs::renderOne(line, arg, argSize);
+            break;
+        case ELogArgType::DOUBLE: {
+            double value;
+            std::memcpy(&value, arg + 1, sizeof(value));
+            // JSON 에는 NaN/Infinity 가 없으므로 null
+            if (std::isfinite(value)) {
+                int length = std::snprintf(text, sizeof(text), "%.17g", value);
+                line.append(text, static_cast<size_t>(length));
+            }
+            else {
+                line.append("null", 4);
+            }
+            break;
+        }
+        case ELogArgType::CHAR:
+            appendString(line, arg + 1, 1);
+            break;
+        case ELogArgType::POINTER:
+            line.append('"');
+            LogArgs::renderOne(line, arg, argSize);
+            line.append('"');
+            break;
+        case ELogArgType::STRING:
+        case ELogArgType::FIELD_KEY:
+            appendString(line, arg + 1 + sizeof(uint32_t), size - 1 - sizeof(uint32_t));
+            break;
+        }
+        return size;
+    }
+
+    /// <summary>
+    /// 호출 위치가 있는 로그를 JSON 한 줄로 기록
+    /// 메시지는 "{}" 자리에 인자를 채운 문자열, 구조화 필드는 "fields" 객체로 기록한다.
+    /// </summary>
+    void appendRecord(CLogLineBuffer& line, SLogStringView time, ELogLevel eLogLevel, unsigned threadNumber,
+        const char* functionName, const char* fileName, int lineNumber,
+        const char* format, const char* args, size_t argsSize, unsigned argCount, float sampleRate,
+        const char* loggerName, unsigned long processId) {
+        appendHeader(line, time, eLogLevel, threadNumber);
+        if (processId != 0) {
+            line.append(",\"pid\":", 7);
+            line.appendInt(static_cast<long long>(processId));
+        }
+        if (loggerName != nullptr && loggerName[0] != '\0') {
+            line.append(",\"logger\":", 10);
+            appendString(line, loggerName, std::strlen(loggerName));
+        }
+        line.append(",\"function\":", 12);
+        appendString(line, functionName, std::strlen(functionName));
+        line.append(",\"file\":", 8);
+        appendString(line, fileName, std::strlen(fileName));
+        line.append(",\"line\":", 8);
+        line.appendInt(lineNumber);
+
+        // 메시지는 thread_local 버퍼에 채운 뒤 escape
+        thread_local CLogLineBuffer message;
+        message.clear();
+        unsigned used = 0;
+        size_t offset = LogArgs::renderMessage(message, format, args, argsSize, argCount, used);
+        line.append(",\"message\":", 11);
+        appendString(line, message.data(), message.size());
+
+        bool firstField = true;
+        while (used + 1 < argCount && offset < argsSize
+            && static_cast<ELogArgType>(args[offset]) == ELogArgType::FIELD_KEY) {
+            size_t keySize = LogArgs::encodedSize(args + offset, argsSize - offset);
+            size_t valueSize = keySize == 0 ? 0 : LogArgs::encodedSize(args + offset + keySize, argsSize - offset - keySize);
+            if (valueSize == 0) {
+                break;
+            }
+            line.append(firstField ? ",\"fields\":{" : ",", firstField ? 11 : 1);
+            appendValue(line, args + offset, keySize);
+            line.append(':');
+            appendValue(line, args + offset + keySize, valueSize);
+            offset += keySize + valueSize;
+            used += 2;
+            firstField = false;
+        }
+        if (!firstField) {
+            line.append('}');
+        }
+        if (sampleRate < 1.0f) {
+            char text[32];
+            int size = std::snprintf(text, sizeof(text), ",\"sample_rate\":%g", static_cast<double>(sampleRate));
+            line.append(text, static_cast<size_t>(size));
+        }
+        line.append("}\n", 2);
+    }
+
+    void appendText(CLogLineBuffer& line, SLogStringView time, ELogLevel eLogLevel, unsigned threadNumber,
+        const char* text, size_t size) {
+        while (size > 0 && (text[size - 1] == '\n' || text[size - 1] == '\r')) {
+            --size;
+        }
+        appendHeader(line, time, eLogLevel, threadNumber);
+        line.append(",\"message\":", 11);
+        appendString(line, text, size);
+        line.append("}\n", 2);
+    }
+
+    /// <summary>
+    /// sink 로 전달된 로그를 JSON 한 줄로 조립
+    /// </summary>
+    void render(const SLogEvent& event, CLogLineBuffer& line) {
+        line.clear();
+        char timeText[32];
+        size_t timeSize = event.clock->format(event.rawTime, timeText, sizeof(timeText));
+        SLogStringView time = { timeText, timeSize };
+        if (event.callSite != nullptr && event.format != nullptr) {
+            appendRecord(line, time, event.eLogLevel, event.threadNumber, event.callSite->functionName,
+                event.callSite->fileName, event.callSite->lineNumber, event.format, event.args, event.argsSize,
+                event.argCount, event.sampleRate, event.loggerName, event.processId);
+            return;
+        }
+        appendText(line, time, event.eLogLevel, event.threadNumber, event.text, event.textSize);
+    }
+}
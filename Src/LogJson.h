@@ -0,0 +1,39 @@
+﻿// LogJson.h
+#ifndef LogJson_H
+#define LogJson_H
+
+#include <cstddef>
+
+#include "LogLineBuffer.h"
+#include "Logger.h"
+
+struct SLogEvent;
+
+// JSON Lines 형식 : 로그 한 줄에 JSON 객체 하나
+// {"time":"2024-01-01 09:00:00.123","level":"INFO","thread":3,"function":"main","file":"Main.cpp","line":42,
+//  "message":"order filled","fields":{"id":1,"qty":3},"sample_rate":0.01}
+// 중간 문자열(std::string)을 만들지 않고 출력 버퍼에 바로 escape 해서 기록한다.
+// 문자열은 그대로 복사하므로 UTF-8 이 아닌 바이트(CP949 등)는 JSON 파서가 거부할 수 있다.
+namespace LogJson {
+    // JSON 문자열 안에 들어갈 수 있도록 escape 해서 기록 (따옴표 제외)
+    void appendEscaped(CLogLineBuffer& line, const char* text, size_t size);
+    // 인코딩된 인자(LogArgs) 하나를 JSON 값으로 기록 (정수/실수/bool 은 숫자/true/false, 나머지는 문자열)
+    // 읽은 byte 수를 돌려주고, 잘못된 데이터면 0
+    size_t appendValue(CLogLineBuffer& line, const char* arg, size_t argSize);
+
+    // 호출 위치가 있는 로그 (LOG_* / LOG_*F / LOG_*_KV)
+    // sampleRate 가 1 보다 작으면(샘플링으로 기록된 로그) "sample_rate", loggerName 이 있으면 "logger",
+    // processId 가 0 이 아니면 "pid" 를 붙인다.
+    void appendRecord(CLogLineBuffer& line, SLogStringView time, ELogLevel eLogLevel, unsigned threadNumber,
+        const char* functionName, const char* fileName, int lineNumber,
+        const char* format, const char* args, size_t argsSize, unsigned argCount, float sampleRate = 1.0f,
+        const char* loggerName = nullptr, unsigned long processId = 0);
+    // 이미 조립된 텍스트 로그 (끝의 줄바꿈은 제외하고 message 로 기록)
+    void appendText(CLogLineBuffer& line, SLogStringView time, ELogLevel eLogLevel, unsigned threadNumber,
+        const char* text, size_t size);
+
+    // CLogSink::LogFormatter 로 사용 : sink->setFormatter(&LogJson::render)
+    void render(const SLogEvent& event, CLogLineBuffer& line);
+}
+
+#endif // LogJson_H
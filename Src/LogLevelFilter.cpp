@@ -0,0 +1,129 @@
+﻿#include "pch.h"
+#include "LogLevelFilter.h"
+#include "Logger.h"
+#include "LogConfig.h"
+#include <cstring>
+
+CLogLevelFilter::CLogLevelFilter()
+{
+}
+
+/// <summary>
+/// 설정 스냅샷 교체. 기본 레벨과 규칙을 같은 스냅샷에서 읽으므로 둘 중 하나만 바뀐 결과는 저장되지 않는다.
+/// </summary>
+/// <param name="newConfig : 적용할 스냅샷 (minLevel, levelRules 사용)"></param>
+void CLogLevelFilter::apply(const std::shared_ptr<const SLogConfig>& newConfig) {
+    std::lock_guard<std::mutex> lock(rulesMutex);
+    config = newConfig;
+    refreshLocked();
+}
+
+/// <summary>
+/// 처음 실행된 호출 위치의 기록 여부를 저장하고 목록에 등록
+/// 다른 스레드가 먼저 등록했으면 저장된 결과를 그대로 사용한다.
+/// </summary>
+bool CLogLevelFilter::resolve(const SLogCallSite& callSite) {
+    std::lock_guard<std::mutex> lock(rulesMutex);
+    unsigned char state = callSite.siteState->levelState.load(std::memory_order_relaxed);
+    if (state == SLogSiteState::kLevelUnknown) {
+        state = isEnabledLocked(callSite) ? SLogSiteState::kLevelEnabled : SLogSiteState::kLevelDisabled;
+        callSite.siteState->levelState.store(state, std::memory_order_relaxed);
+        resolvedSites.push_back(&callSite);
+    }
+    return state == SLogSiteState::kLevelEnabled;
+}
+
+/// <summary>
+/// 호출 위치에 맞는 규칙의 레벨(없으면 기본 레벨)과 비교
+/// </summary>
+bool CLogLevelFilter::isEnabledLocked(const SLogCallSite& callSite) const {
+    if (!config) {
+        return true;
+    }
+    int minLevel = static_cast<int>(config->minLevel);
+    int matchedTarget = -1;
+    for (const auto& rule : config->levelRules) {
+        int target = static_cast<int>(rule.eTarget);
+        if (target < matchedTarget) {
+            continue;
+        }
+        bool matched = false;
+        switch (rule.eTarget) {
+        case ELogRuleTarget::MODULE:
+            matched = matchModule(rule.pattern, callSite.filePath);
+            break;
+        case ELogRuleTarget::FILE:
+            matched = matchPattern(rule.pattern.c_str(), callSite.fileName, callSite.fileName + std::strlen(callSite.fileName));
+            break;
+        case ELogRuleTarget::FUNCTION:
+            matched = matchPattern(rule.pattern.c_str(), callSite.functionName,
+                callSite.functionName + std::strlen(callSite.functionName));
+            break;
+        }
+        if (matched) {
+            minLevel = static_cast<int>(rule.eLogLevel);
+            matchedTarget = target;
+        }
+    }
+    return static_cast<int>(callSite.eLogLevel) >= minLevel;
+}
+
+/// <summary>
+/// 등록된 모든 호출 위치의 기록 여부를 다시 계산 (설정을 바꿀 때만, 호출 위치 수 x 규칙 수)
+/// </summary>
+void CLogLevelFilter::refreshLocked() {
+    for (const SLogCallSite* callSite : resolvedSites) {
+        callSite->siteState->levelState.store(
+            isEnabledLocked(*callSite) ? SLogSiteState::kLevelEnabled : SLogSiteState::kLevelDisabled,
+            std::memory_order_relaxed);
+    }
+}
+
+/// <summary>
+/// '*' 만 지원하는 wildcard 비교 (마지막 '*' 위치로 되돌아가며 비교)
+/// </summary>
+bool CLogLevelFilter::matchPattern(const char* pattern, const char* text, const char* textEnd) {
+    const char* starPattern = nullptr;
+    const char* starText = nullptr;
+    while (text < textEnd) {
+        if (*pattern == '*') {
+            starPattern = ++pattern;
+            starText = text;
+        }
+        else if (*pattern != '\0' && *pattern == *text) {
+            ++pattern;
+            ++text;
+        }
+        else if (starPattern != nullptr) {
+            pattern = starPattern;
+            text = ++starText;
+        }
+        else {
+            return false;
+        }
+    }
+    while (*pattern == '*') {
+        ++pattern;
+    }
+    return *pattern == '\0';
+}
+
+/// <summary>
+/// 소스 파일 경로의 디렉토리 이름 중 하나라도 pattern 과 같으면 true (파일 이름은 제외)
+/// </summary>
+bool CLogLevelFilter::matchModule(const std::string& pattern, const char* filePath) {
+    if (filePath == nullptr) {
+        return false;
+    }
+    const char* begin = filePath;
+    for (const char* p = filePath; *p != '\0'; ++p) {
+        if (*p != '/' && *p != '\\') {
+            continue;
+        }
+        if (p > begin && matchPattern(pattern.c_str(), begin, p)) {
+            return true;
+        }
+        begin = p + 1;
+    }
+    return false;
+}
@@ -0,0 +1,64 @@
+﻿// CLogLevelFilter.h
+#ifndef CLogLevelFilter_H
+#define CLogLevelFilter_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class ELogLevel;
+struct SLogCallSite;
+struct SLogConfig;
+
+// 레벨 규칙을 적용할 대상
+enum class ELogRuleTarget {
+    MODULE,         // 소스 파일 경로의 디렉토리 이름 (예: "Network" 는 .../Network/Socket.cpp 에 적용)
+    FILE,           // 소스 파일 이름 (디렉토리 제외)
+    FUNCTION        // 함수 이름 (__FUNCTION__)
+};
+
+// 호출 위치별 최소 레벨 규칙 하나. pattern 의 '*' 는 임의의 문자열과 일치한다.
+struct SLogLevelRule {
+    ELogRuleTarget eTarget;
+    std::string pattern;
+    ELogLevel eLogLevel;
+
+    bool operator==(const SLogLevelRule& other) const {
+        return eTarget == other.eTarget && pattern == other.pattern && eLogLevel == other.eLogLevel;
+    }
+    bool operator!=(const SLogLevelRule& other) const {
+        return !(*this == other);
+    }
+};
+
+// 모듈/파일/함수별 최소 레벨
+// 설정 스냅샷(SLogConfig::minLevel, levelRules)을 보관하고, 호출 위치마다 처음 한 번 규칙을 찾아서 결과(기록 여부)를
+// SLogSiteState::levelState 에 저장하고, 그 호출 위치를 목록에 등록한다.
+// 스냅샷이 바뀌면 등록된 호출 위치의 결과를 새 스냅샷 하나로 모두 다시 계산하므로, 로그 호출 경로는 규칙 개수와 상관없이 load 한 번이다.
+// 여러 규칙이 맞으면 FUNCTION > FILE > MODULE 순으로 우선하고, 같은 대상끼리는 나중 규칙이 우선한다.
+class CLogLevelFilter {
+public:
+    CLogLevelFilter();
+
+    // 새 설정 스냅샷으로 교체하고 등록된 호출 위치의 결과를 다시 계산
+    void apply(const std::shared_ptr<const SLogConfig>& config);
+
+    // 호출 위치의 기록 여부를 찾아서 저장하고 등록 (호출 위치마다 처음 한 번)
+    bool resolve(const SLogCallSite& callSite);
+
+private:
+    CLogLevelFilter(const CLogLevelFilter&) = delete;
+    CLogLevelFilter& operator=(const CLogLevelFilter&) = delete;
+
+    bool isEnabledLocked(const SLogCallSite& callSite) const;
+    void refreshLocked();
+    static bool matchPattern(const char* pattern, const char* text, const char* textEnd);
+    static bool matchModule(const std::string& pattern, const char* filePath);
+
+    mutable std::mutex rulesMutex;
+    std::shared_ptr<const SLogConfig> config;           // 결과를 계산한 설정 스냅샷 (nullptr 이면 모두 기록)
+    std::vector<const SLogCallSite*> resolvedSites;     // levelState 를 저장한 호출 위치 (제거하지 않음)
+};
+
+#endif // CLogLevelFilter_H
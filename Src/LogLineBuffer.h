@@ -0,0 +1,69 @@
+﻿// CLogLineBuffer.h
+#ifndef CLogLineBuffer_H
+#define CLogLineBuffer_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// 로그 한 줄을 조립하는 버퍼
+// 스레드마다 하나씩 재사용하며, 고정 크기 배열을 넘는 긴 로그만 힙(overflowText)을 사용한다.
+// overflowText 는 한 번 늘어난 용량을 유지하므로 같은 길이의 로그가 반복되면 다시 할당하지 않는다.
+class CLogLineBuffer {
+public:
+    static const size_t kInlineCapacity = 1024;
+
+    void clear() {
+        length = 0;
+        useOverflow = false;
+        overflowText.clear();
+    }
+
+    void append(const char* text, size_t size) {
+        if (!useOverflow && length + size <= kInlineCapacity) {
+            std::memcpy(inlineText + length, text, size);
+            length += size;
+            return;
+        }
+        if (!useOverflow) {
+            overflowText.assign(inlineText, length);
+            useOverflow = true;
+        }
+        overflowText.append(text, size);
+        length += size;
+    }
+
+    void append(const char* text) {
+        append(text, std::strlen(text));
+    }
+
+    void append(char ch) {
+        append(&ch, 1);
+    }
+
+    void appendInt(long long value) {
+        char digits[24];
+        size_t pos = sizeof(digits);
+        unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                                 : static_cast<unsigned long long>(value);
+        do {
+            digits[--pos] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) {
+            digits[--pos] = '-';
+        }
+        append(digits + pos, sizeof(digits) - pos);
+    }
+
+    const char* data() const { return useOverflow ? overflowText.data() : inlineText; }
+    size_t size() const { return length; }
+
+private:
+    char inlineText[kInlineCapacity];
+    size_t length = 0;
+    bool useOverflow = false;
+    std::string overflowText;
+};
+
+#endif // CLogLineBuffer_H
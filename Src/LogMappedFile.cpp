@@ -0,0 +1,314 @@
+﻿#include "pch.h"
+#include "LogMappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Windows 의 매핑 시작 위치 단위(allocation granularity)에 맞춘다.
+    const size_t kSegmentAlignment = 64 * 1024;
+}
+
+CMappedLogFile::CMappedLogFile(size_t segmentSize)
+{
+    size_t alignedSize = (std::max)(segmentSize, kSegmentAlignment);
+    this->segmentSize = (alignedSize + kSegmentAlignment - 1) / kSegmentAlignment * kSegmentAlignment;
+    writeOffset.store(0);
+    for (auto& slot : slots) {
+        slot.segmentIndex.store(-1);
+        slot.committed.store(0);
+    }
+}
+
+CMappedLogFile::~CMappedLogFile() {
+    close();
+}
+
+/// <summary>
+/// 로그파일을 새로 만들고 첫 segment 를 매핑한 뒤 다음 segment 를 미리 매핑하는 스레드를 시작
+/// </summary>
+/// <param name="filename"></param>
+void CMappedLogFile::open(const std::string& filename) {
+    close();
+    this->filename = filename;
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Unable to open log file: " + filename);
+    }
+    fileHandle = handle;
+#else
+    fileDescriptor = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("Unable to open log file: " + filename);
+    }
+#endif
+    fileOpen = true;
+    writeOffset.store(0);
+    requestedSegment = 0;
+    lastMappedSegment = 0;
+    finishedPending = false;
+    stopMapper = false;
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        if (!mapSegmentLocked(0)) {
+            close();
+            throw std::runtime_error("Unable to map log file: " + filename);
+        }
+    }
+    mapperThread = std::thread(&CMappedLogFile::mapperThreadMain, this);
+}
+
+/// <summary>
+/// 매핑을 모두 해제하고 파일을 실제 기록한 길이로 자른 뒤 닫는다.
+/// </summary>
+void CMappedLogFile::close() {
+    if (mapperThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(segmentMutex);
+            stopMapper = true;
+        }
+        mapperWakeup.notify_one();
+        mapperThread.join();
+    }
+    if (!fileOpen) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        for (auto& slot : slots) {
+            unmapSlotLocked(slot);
+        }
+    }
+
+    unsigned long long length = writeOffset.load();
+#ifdef _WIN32
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(length);
+    SetFilePointerEx(fileHandle, position, nullptr, FILE_BEGIN);
+    SetEndOfFile(fileHandle);
+    CloseHandle(fileHandle);
+    fileHandle = nullptr;
+#else
+    if (ftruncate(fileDescriptor, static_cast<off_t>(length)) != 0) {
+        // 자르지 못하면 파일 끝에 0 이 채워진 영역이 남는다.
+    }
+    ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    fileOpen = false;
+}
+
+/// <summary>
+/// 기록할 위치를 원자적으로 예약하고 매핑된 영역에 바로 복사
+/// segment 경계에 걸친 로그는 나누어 복사한다.
+/// </summary>
+/// <param name="data"></param>
+/// <param name="size"></param>
+/// <returns></returns>
+bool CMappedLogFile::append(const char* data, size_t size) {
+    unsigned long long offset = writeOffset.fetch_add(size, std::memory_order_relaxed);
+    bool written = true;
+    while (size > 0) {
+        unsigned long long segmentIndex = offset / segmentSize;
+        size_t segmentOffset = static_cast<size_t>(offset % segmentSize);
+        size_t piece = (std::min)(size, segmentSize - segmentOffset);
+
+        SSegmentSlot& slot = slots[segmentIndex % kSlotCount];
+        char* base = acquireSegment(segmentIndex);
+        if (base != nullptr) {
+            std::memcpy(base + segmentOffset, data, piece);
+            // 절반을 넘기는 로그가 다음 segment 매핑을 요청
+            size_t half = segmentSize / 2;
+            if (segmentOffset < half && segmentOffset + piece >= half) {
+                requestSegment(segmentIndex + 1);
+            }
+            commit(slot, piece);
+        }
+        else {
+            written = false;
+        }
+
+        data += piece;
+        offset += piece;
+        size -= piece;
+    }
+    return written;
+}
+
+/// <summary>
+/// 매핑된 내용을 디스크에 기록하도록 요청
+/// </summary>
+void CMappedLogFile::flush() {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    for (auto& slot : slots) {
+        if (slot.segmentIndex.load() < 0) {
+            continue;
+        }
+#ifdef _WIN32
+        FlushViewOfFile(slot.base, 0);
+#else
+        msync(slot.base, segmentSize, MS_ASYNC);
+#endif
+    }
+}
+
+/// <summary>
+/// segment 의 매핑 주소. 아직 매핑되지 않았으면 직접 매핑한다. (미리 매핑이 늦은 경우)
+/// </summary>
+/// <param name="segmentIndex"></param>
+/// <returns>매핑에 실패하면 nullptr</returns>
+char* CMappedLogFile::acquireSegment(unsigned long long segmentIndex) {
+    SSegmentSlot& slot = slots[segmentIndex % kSlotCount];
+    if (slot.segmentIndex.load(std::memory_order_acquire) == static_cast<long long>(segmentIndex)) {
+        return slot.base;
+    }
+
+    std::unique_lock<std::mutex> lock(segmentMutex);
+    while (true) {
+        if (slot.segmentIndex.load() == static_cast<long long>(segmentIndex)) {
+            return slot.base;
+        }
+        releaseFinishedSlotsLocked();
+        if (slot.segmentIndex.load() < 0) {
+            return mapSegmentLocked(segmentIndex) ? slot.base : nullptr;
+        }
+        // 같은 슬롯을 쓰는 이전 segment 에 아직 복사 중인 로그가 있음
+        segmentReady.wait(lock);
+    }
+}
+
+/// <summary>
+/// segment 영역을 미리 할당하고 매핑. segmentMutex 를 잡은 상태에서 호출
+/// </summary>
+/// <param name="segmentIndex"></param>
+/// <returns></returns>
+bool CMappedLogFile::mapSegmentLocked(unsigned long long segmentIndex) {
+    SSegmentSlot& slot = slots[segmentIndex % kSlotCount];
+    if (slot.segmentIndex.load() == static_cast<long long>(segmentIndex)) {
+        return true;
+    }
+    if (slot.segmentIndex.load() >= 0) {
+        return false;
+    }
+
+    unsigned long long offset = segmentIndex * segmentSize;
+    unsigned long long end = offset + segmentSize;
+#ifdef _WIN32
+    // 파일보다 큰 매핑 객체를 만들면 파일이 그 크기로 늘어난다.
+    HANDLE mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(end >> 32), static_cast<DWORD>(end & 0xFFFFFFFFULL), nullptr);
+    if (mapping == nullptr) {
+        return false;
+    }
+    void* base = MapViewOfFile(mapping, FILE_MAP_WRITE,
+        static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset & 0xFFFFFFFFULL), segmentSize);
+    if (base == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    slot.mappingHandle = mapping;
+#else
+    bool allocated = false;
+#ifdef __linux__
+    allocated = fallocate(fileDescriptor, 0, static_cast<off_t>(offset), static_cast<off_t>(segmentSize)) == 0;
+#endif
+    // fallocate 를 지원하지 않는 파일 시스템은 파일 크기만 늘린다.
+    if (!allocated && ftruncate(fileDescriptor, static_cast<off_t>(end)) != 0) {
+        return false;
+    }
+    void* base = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor,
+        static_cast<off_t>(offset));
+    if (base == MAP_FAILED) {
+        return false;
+    }
+#endif
+    slot.base = static_cast<char*>(base);
+    slot.committed.store(0);
+    slot.segmentIndex.store(static_cast<long long>(segmentIndex), std::memory_order_release);
+    lastMappedSegment = (std::max)(lastMappedSegment, segmentIndex);
+    segmentReady.notify_all();
+    return true;
+}
+
+void CMappedLogFile::unmapSlotLocked(SSegmentSlot& slot) {
+    if (slot.segmentIndex.load() < 0) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(slot.base);
+    CloseHandle(slot.mappingHandle);
+    slot.mappingHandle = nullptr;
+#else
+    munmap(slot.base, segmentSize);
+#endif
+    slot.base = nullptr;
+    slot.segmentIndex.store(-1, std::memory_order_release);
+}
+
+/// <summary>
+/// 끝까지 복사가 끝난 segment 의 매핑을 해제. segmentMutex 를 잡은 상태에서 호출
+/// </summary>
+void CMappedLogFile::releaseFinishedSlotsLocked() {
+    for (auto& slot : slots) {
+        if (slot.segmentIndex.load() >= 0 && slot.committed.load(std::memory_order_acquire) == segmentSize) {
+            unmapSlotLocked(slot);
+            segmentReady.notify_all();
+        }
+    }
+    finishedPending = false;
+}
+
+/// <summary>
+/// 복사한 byte 수를 반영. segment 를 다 채운 스레드가 매핑 해제를 요청한다.
+/// </summary>
+/// <param name="slot"></param>
+/// <param name="size"></param>
+void CMappedLogFile::commit(SSegmentSlot& slot, size_t size) {
+    if (slot.committed.fetch_add(size, std::memory_order_acq_rel) + size == segmentSize) {
+        {
+            std::lock_guard<std::mutex> lock(segmentMutex);
+            finishedPending = true;
+        }
+        mapperWakeup.notify_one();
+    }
+}
+
+void CMappedLogFile::requestSegment(unsigned long long segmentIndex) {
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        if (segmentIndex <= requestedSegment) {
+            return;
+        }
+        requestedSegment = segmentIndex;
+    }
+    mapperWakeup.notify_one();
+}
+
+/// <summary>
+/// 다음 segment 미리 매핑, 다 쓴 segment 해제
+/// </summary>
+void CMappedLogFile::mapperThreadMain() {
+    std::unique_lock<std::mutex> lock(segmentMutex);
+    while (!stopMapper) {
+        if (finishedPending) {
+            releaseFinishedSlotsLocked();
+        }
+        // 이미 다 쓰고 해제한 segment 를 다시 매핑하지 않도록 한 번도 매핑하지 않은 segment 만 처리
+        unsigned long long target = requestedSegment;
+        if (target > lastMappedSegment) {
+            mapSegmentLocked(target);
+        }
+        mapperWakeup.wait(lock, [&] {
+            return stopMapper || finishedPending || requestedSegment != target;
+        });
+    }
+}
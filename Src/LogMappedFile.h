@@ -0,0 +1,82 @@
+﻿// CMappedLogFile.h
+#ifndef CMappedLogFile_H
+#define CMappedLogFile_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 메모리 매핑 로그파일
+// 파일을 고정 크기 segment 단위로 미리 할당(preallocate)하고 매핑해 두면, 로그 호출 스레드는
+// 원자적으로 예약한 위치에 로그를 바로 복사한다. (write 시스템 호출, 커널로의 복사 없음)
+// 매핑에 복사된 로그는 프로세스가 비정상 종료되어도 파일에 남는다.
+// 현재 segment 를 절반 이상 쓰면 다음 segment 를 별도 스레드에서 미리 매핑하고, 다 쓴 segment 는 해제한다.
+// close() 하면 파일을 실제 기록한 길이로 자른다. (비정상 종료 시에는 파일 끝에 0 이 채워진 영역이 남음)
+class CMappedLogFile {
+public:
+    // segmentSize 는 64KB 단위로 올림
+    explicit CMappedLogFile(size_t segmentSize);
+    ~CMappedLogFile();
+
+    // 파일을 새로 만들고(기존 내용 삭제) 첫 segment 를 매핑. 실패하면 std::runtime_error
+    void open(const std::string& filename);
+    // 남은 segment 를 해제하고 파일을 기록한 길이로 자른다. 이후 append 를 호출하면 안 된다.
+    void close();
+    bool isOpen() const { return fileOpen; }
+
+    // 여러 스레드에서 동시에 호출 가능. 매핑에 실패한 부분은 기록되지 않고 false 를 반환
+    bool append(const char* data, size_t size);
+    // 매핑된 내용을 디스크에 기록하도록 요청 (완료를 기다리지 않음)
+    void flush();
+
+    size_t getSegmentSize() const { return segmentSize; }
+    unsigned long long getWrittenSize() const { return writeOffset.load(std::memory_order_relaxed); }
+
+private:
+    CMappedLogFile(const CMappedLogFile&) = delete;
+    CMappedLogFile& operator=(const CMappedLogFile&) = delete;
+
+    static const size_t kSlotCount = 4;
+
+    // 매핑된 segment 하나. segment 번호 % kSlotCount 위치의 슬롯을 사용한다.
+    struct SSegmentSlot {
+        std::atomic<long long> segmentIndex;    // 매핑된 segment 번호, 비어 있으면 -1
+        std::atomic<size_t> committed;          // 복사가 끝난 byte 수, segmentSize 가 되면 해제 가능
+        char* base = nullptr;
+        void* mappingHandle = nullptr;          // Windows 파일 매핑 핸들
+    };
+
+    char* acquireSegment(unsigned long long segmentIndex);
+    bool mapSegmentLocked(unsigned long long segmentIndex);
+    void unmapSlotLocked(SSegmentSlot& slot);
+    void releaseFinishedSlotsLocked();
+    void commit(SSegmentSlot& slot, size_t size);
+    void requestSegment(unsigned long long segmentIndex);
+    void mapperThreadMain();
+
+    size_t segmentSize;
+    bool fileOpen = false;
+    std::string filename;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+    std::atomic<unsigned long long> writeOffset;    // 다음 로그를 기록할 파일 위치 (예약)
+    SSegmentSlot slots[kSlotCount];
+
+    std::mutex segmentMutex;
+    std::condition_variable mapperWakeup;
+    std::condition_variable segmentReady;
+    unsigned long long requestedSegment = 0;        // 미리 매핑할 segment 번호
+    unsigned long long lastMappedSegment = 0;       // 지금까지 매핑한 가장 큰 segment 번호
+    bool finishedPending = false;                   // 다 쓴 segment 가 있음
+    bool stopMapper = false;
+    std::thread mapperThread;
+};
+
+#endif // CMappedLogFile_H
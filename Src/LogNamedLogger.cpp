@@ -0,0 +1,217 @@
+﻿#include "pch.h"
+#include "LogNamedLogger.h"
+#include "LogSink.h"
+#include "LogFileSink.h"
+#include "LogPlatform.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace {
+    // LOG_* 메시지를 인자 하나짜리 레코드로 기록할 때의 포맷 (CLogger 와 같음)
+    const char kMessageFormat[] = "{}";
+
+    // 이름 -> 로거. 로거는 제거하지 않는다. (설정 변경과 생성만 직렬화, 로그 호출 경로에서는 사용하지 않음)
+    std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::map<std::string, std::unique_ptr<CNamedLogger>>& registry() {
+        static std::map<std::string, std::unique_ptr<CNamedLogger>> loggers;
+        return loggers;
+    }
+}
+
+CNamedLogger::CNamedLogger(const std::string& name, CNamedLogger* parent)
+    : name(name), parent(parent)
+{
+    effectiveLevel.store(-1);
+    if (parent != nullptr) {
+        effectiveSinks.exchange(parent->effectiveSinks.share());
+        effectiveLevel.store(parent->effectiveLevel.load());
+    }
+}
+
+/// <summary>
+/// 이름으로 로거를 찾는다. 없으면 상위 로거("a.b.c" -> "a.b" -> "a" -> "")부터 만들어서 설정을 물려받는다.
+/// </summary>
+/// <param name="name : '.' 으로 구분한 이름, "" 는 최상위 로거"></param>
+CNamedLogger& CNamedLogger::get(const std::string& name) {
+    // 기본 로거를 먼저 만들어서 로거 목록보다 나중에 해제되도록 한다. (sink 큐의 로그가 기본 로거의 시계를 참조)
+    CLogger::getInstance();
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto& loggers = registry();
+    auto found = loggers.find(name);
+    if (found != loggers.end()) {
+        return *found->second;
+    }
+
+    // 아직 없는 상위 로거의 이름을 모아서 위에서부터 만든다.
+    std::vector<std::string> missing{ name };
+    CNamedLogger* parent = nullptr;
+    std::string current = name;
+    while (!current.empty()) {
+        size_t dot = current.find_last_of('.');
+        current = dot == std::string::npos ? std::string() : current.substr(0, dot);
+        found = loggers.find(current);
+        if (found != loggers.end()) {
+            parent = found->second.get();
+            break;
+        }
+        missing.push_back(current);
+    }
+    for (auto it = missing.rbegin(); it != missing.rend(); ++it) {
+        std::unique_ptr<CNamedLogger> logger(new CNamedLogger(*it, parent));
+        CNamedLogger* created = logger.get();
+        if (parent != nullptr) {
+            parent->children.push_back(created);
+        }
+        loggers.emplace(*it, std::move(logger));
+        parent = created;
+    }
+    return *parent;
+}
+
+/// <summary>
+/// "Log" 디렉토리에 이 로거 전용 로그파일을 만든다.
+/// 로그파일 sink 는 전용 출력 스레드를 사용하므로, 로그 호출 스레드는 이 로거의 큐에 복사만 한다.
+/// </summary>
+/// <param name="filename : 생성할 로그파일 이름"></param>
+/// <param name="queueCapacity : 전용 출력 스레드 큐에 대기할 수 있는 로그 개수"></param>
+void CNamedLogger::configureLogging(const char* filename, size_t queueCapacity) {
+    std::string logDir = LogPlatform::currentDirectory() + "/Log";
+    LogPlatform::createDirectory(logDir);
+    auto fileSink = std::make_shared<CFileLogSink>(logDir + "/" + filename);
+    fileSink->enableDedicatedThread(queueCapacity);
+    setSinks(LogSinkList{ fileSink });
+}
+
+void CNamedLogger::setSinks(const LogSinkList& sinks) {
+    std::shared_ptr<const LogSinkList> previous;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        previous = ownSinks;
+        ownSinks = sinks.empty() ? nullptr : std::make_shared<const LogSinkList>(sinks);
+        updateEffectiveLocked();
+    }
+    // 빠진 sink 는 남은 로그를 기록 (로그 호출 스레드가 참조를 놓으면 해제된다)
+    if (previous) {
+        for (const auto& sink : *previous) {
+            if (std::find(sinks.begin(), sinks.end(), sink) == sinks.end()) {
+                sink->flush();
+            }
+        }
+    }
+}
+
+void CNamedLogger::addSink(const std::shared_ptr<CLogSink>& sink) {
+    LogSinkList sinks;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        if (ownSinks) {
+            sinks = *ownSinks;
+        }
+    }
+    sinks.push_back(sink);
+    setSinks(sinks);
+}
+
+void CNamedLogger::clearSinks() {
+    setSinks(LogSinkList());
+}
+
+void CNamedLogger::setLevel(ELogLevel eLogLevel) {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    ownLevel = static_cast<int>(eLogLevel);
+    updateEffectiveLocked();
+}
+
+void CNamedLogger::clearLevel() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    ownLevel = -1;
+    updateEffectiveLocked();
+}
+
+void CNamedLogger::flush() {
+    std::shared_ptr<const LogSinkList> sinks = effectiveSinks.share();
+    if (!sinks) {
+        CLogger::getInstance().flush();
+        return;
+    }
+    for (const auto& sink : *sinks) {
+        sink->flush();
+    }
+}
+
+void CNamedLogger::logMessage(const SLogCallSite* callSite, const std::string& message) {
+    logFormat(callSite, kMessageFormat, message);
+}
+
+void CNamedLogger::logMessage(const SLogCallSite* callSite, const char* message) {
+    logFormat(callSite, kMessageFormat, message);
+}
+
+/// <summary>
+/// 인자를 인코딩할 스레드별 버퍼 (CLogger 의 레코드 버퍼와 별도)
+/// </summary>
+CLogLineBuffer& CNamedLogger::beginRecord() {
+    thread_local CLogLineBuffer record;
+    record.clear();
+    return record;
+}
+
+/// <summary>
+/// 인코딩된 로그를 이 로거의 sink 로 전달
+/// 전용 출력 스레드를 사용하는 sink 는 큐에 복사만 하고, 기본 텍스트 형식은 필요한 sink 가 있을 때 한 번만 조립한다.
+/// </summary>
+void CNamedLogger::writeRecord(const LogSinkList& sinks, const SLogCallSite* callSite, const char* format,
+    const CLogLineBuffer& args, unsigned argCount) {
+    SLogEvent event;
+    event.eLogLevel = callSite->eLogLevel;
+    event.threadNumber = CLogger::getThreadNumber();
+    const CLogClock& logClock = CLogger::getInstance().getLogClock();
+    event.rawTime = logClock.now();
+    event.clock = &logClock;
+    event.callSite = callSite;
+    event.format = format;
+    event.args = args.data();
+    event.argsSize = args.size();
+    event.argCount = argCount;
+    event.loggerName = name.c_str();
+
+    thread_local CLogLineBuffer line;
+    for (const auto& sink : sinks) {
+        if (!sink->accepts(event.eLogLevel)) {
+            continue;
+        }
+        if (event.text == nullptr && sink->usesDefaultText()) {
+            LogText::render(line, event);
+            event.text = line.data();
+            event.textSize = line.size();
+        }
+        sink->submit(event);
+    }
+}
+
+/// <summary>
+/// 이 로거와 하위 로거의 실제 sink/레벨 갱신 (registryMutex 를 잡은 상태에서 호출)
+/// 직접 설정한 값이 없으면 상위 로거의 값을 사용한다.
+/// </summary>
+void CNamedLogger::updateEffectiveLocked() {
+    std::shared_ptr<const LogSinkList> sinks = ownSinks;
+    if (!sinks && parent != nullptr) {
+        sinks = parent->effectiveSinks.share();
+    }
+    if (effectiveSinks.share() != sinks) {
+        effectiveSinks.exchange(sinks);
+    }
+    int level = ownLevel;
+    if (level < 0 && parent != nullptr) {
+        level = parent->effectiveLevel.load(std::memory_order_relaxed);
+    }
+    effectiveLevel.store(level, std::memory_order_relaxed);
+    for (CNamedLogger* child : children) {
+        child->updateEffectiveLocked();
+    }
+}
@@ -0,0 +1,150 @@
+﻿// CNamedLogger.h
+#ifndef CNamedLogger_H
+#define CNamedLogger_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LogSnapshot.h"
+#include "Logger.h"
+
+// 이름 있는 로거 ("net", "net.http" ...)
+// 하위 시스템마다 자신의 sink(로그파일, 전용 출력 스레드/큐)와 최소 레벨을 두어, 기본 로거(CLogger)와 서로의 출력을 기다리지 않는다.
+// 설정하지 않은 항목은 이름의 상위 로거("net.http" -> "net" -> "")에서 물려받고, 끝까지 없으면 기본 로거를 사용한다.
+// 로거는 한 번 만들면 프로세스가 끝날 때까지 유지되므로 get 으로 얻은 참조를 보관해서 사용한다.
+class CNamedLogger {
+public:
+    typedef std::vector<std::shared_ptr<CLogSink>> LogSinkList;
+
+    // 이름으로 찾고, 없으면 상위 로거까지 만든다. ("" 는 최상위)
+    static CNamedLogger& get(const std::string& name);
+
+    const std::string& getName() const { return name; }
+    CNamedLogger* getParent() const { return parent; }
+
+    // "Log" 디렉토리에 이 로거 전용 로그파일을 만들고, 전용 출력 스레드(queueCapacity 개 큐)에서 기록한다.
+    void configureLogging(const char* filename, size_t queueCapacity = 4096);
+    // 이 로거의 sink 지정 (하위 로거도 물려받음). 빈 목록이면 상위 로거의 sink 를 다시 사용
+    void setSinks(const LogSinkList& sinks);
+    void addSink(const std::shared_ptr<CLogSink>& sink);
+    void clearSinks();
+    // 이 로거의 최소 레벨 (하위 로거도 물려받음)
+    void setLevel(ELogLevel eLogLevel);
+    // 상위 로거의 레벨을 다시 사용 (끝까지 없으면 기본 로거의 레벨/규칙/샘플링)
+    void clearLevel();
+    // 이 로거가 사용하는 sink 의 남은 로그를 기록
+    void flush();
+
+    // LOGGER_* 매크로용
+    bool isEnabled(const SLogCallSite& callSite) const {
+        int level = effectiveLevel.load(std::memory_order_relaxed);
+        if (level < 0) {
+            return CLogger::isEnabled(callSite) && CLogger::isSampled(callSite);
+        }
+        return static_cast<int>(callSite.eLogLevel) >= level;
+    }
+
+    template <typename... Args>
+    void logFormat(const SLogCallSite* callSite, const char* format, const Args&... args) {
+        CLogReadSection section;
+        const LogSinkList* sinks = effectiveSinks.get();
+        if (sinks == nullptr) {
+            CLogger::getInstance().logFormat(callSite, format, args...);
+            return;
+        }
+        CLogLineBuffer& record = beginRecord();
+        LogArgs::encodeAll(record, args...);
+        writeRecord(*sinks, callSite, format, record, static_cast<unsigned>(sizeof...(Args)));
+    }
+
+    template <typename... Fields>
+    void logFields(const SLogCallSite* callSite, const char* message, const Fields&... fields) {
+        static_assert(sizeof...(Fields) % 2 == 0, "LOGGER_*_KV needs name, value pairs");
+        CLogReadSection section;
+        const LogSinkList* sinks = effectiveSinks.get();
+        if (sinks == nullptr) {
+            CLogger::getInstance().logFields(callSite, message, fields...);
+            return;
+        }
+        CLogLineBuffer& record = beginRecord();
+        LogArgs::encodeFields(record, fields...);
+        writeRecord(*sinks, callSite, message, record, static_cast<unsigned>(sizeof...(Fields)));
+    }
+
+    void logMessage(const SLogCallSite* callSite, const std::string& message);
+    void logMessage(const SLogCallSite* callSite, const char* message);
+
+private:
+    CNamedLogger(const std::string& name, CNamedLogger* parent);
+    CNamedLogger(const CNamedLogger&) = delete;
+    CNamedLogger& operator=(const CNamedLogger&) = delete;
+
+    static CLogLineBuffer& beginRecord();
+    void writeRecord(const LogSinkList& sinks, const SLogCallSite* callSite, const char* format,
+        const CLogLineBuffer& args, unsigned argCount);
+    void updateEffectiveLocked();
+
+    std::string name;
+    CNamedLogger* parent;
+    std::vector<CNamedLogger*> children;
+
+    // 직접 설정한 값 (registryMutex 로 보호)
+    std::shared_ptr<const LogSinkList> ownSinks;
+    int ownLevel = -1;
+
+    // 상위 로거까지 반영한 값. 로그 호출 시 락 없이 읽는다. (sink 가 nullptr / 레벨이 -1 이면 기본 로거 사용)
+    // sink 목록은 CLogReadSection 안에서 포인터만 읽고, 바뀐 목록은 읽던 스레드가 모두 끝난 뒤에 놓는다.
+    CLogSnapshot<LogSinkList> effectiveSinks;
+    std::atomic<int> effectiveLevel;
+};
+
+// 이름 있는 로거 매크로 : LOGGER_INFOF(netLog, "connected {}", address)
+// 호출 위치 정보와 레벨 확인은 LOG_* 매크로와 같고, 기록만 logger 의 sink 로 보낸다.
+#define LOGGER_AT_CALL_SITE(logger, eLevel, method, ...) \
+    do { \
+        static SLogSiteState logSiteState; \
+        static constexpr SLogCallSite logCallSite = { eLevel, logLevelTag(eLevel), __FUNCTION__, logBaseName(__FILE__), __LINE__, \
+            &logSiteState, __FILE__ }; \
+        CNamedLogger& namedLogger = (logger); \
+        if (namedLogger.isEnabled(logCallSite)) { \
+            namedLogger.method(&logCallSite, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if LOG_COMPILE_MIN_LEVEL <= 0
+#define LOGGER_DEBUG(logger, message) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_DEBUG, logMessage, message)
+#define LOGGER_DEBUGF(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_DEBUG, logFormat, __VA_ARGS__)
+#define LOGGER_DEBUG_KV(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_DEBUG, logFields, __VA_ARGS__)
+#else
+#define LOGGER_DEBUG(logger, message) LOG_DISABLED_AT_COMPILE_TIME(logger, message)
+#define LOGGER_DEBUGF(logger, ...) LOG_DISABLED_AT_COMPILE_TIME(logger, __VA_ARGS__)
+#define LOGGER_DEBUG_KV(logger, ...) LOG_DISABLED_AT_COMPILE_TIME(logger, __VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 1
+#define LOGGER_INFO(logger, message) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_INFO, logMessage, message)
+#define LOGGER_INFOF(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_INFO, logFormat, __VA_ARGS__)
+#define LOGGER_INFO_KV(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_INFO, logFields, __VA_ARGS__)
+#else
+#define LOGGER_INFO(logger, message) LOG_DISABLED_AT_COMPILE_TIME(logger, message)
+#define LOGGER_INFOF(logger, ...) LOG_DISABLED_AT_COMPILE_TIME(logger, __VA_ARGS__)
+#define LOGGER_INFO_KV(logger, ...) LOG_DISABLED_AT_COMPILE_TIME(logger, __VA_ARGS__)
+#endif
+
+#if LOG_COMPILE_MIN_LEVEL <= 2
+#define LOGGER_WARNING(logger, message) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_WARNING, logMessage, message)
+#define LOGGER_WARNINGF(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_WARNING, logFormat, __VA_ARGS__)
+#define LOGGER_WARNING_KV(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_WARNING, logFields, __VA_ARGS__)
+#else
+#define LOGGER_WARNING(logger, message) LOG_DISABLED_AT_COMPILE_TIME(logger, message)
+#define LOGGER_WARNINGF(logger, ...) LOG_DISABLED_AT_COMPILE_TIME(logger, __VA_ARGS__)
+#define LOGGER_WARNING_KV(logger, ...) LOG_DISABLED_AT_COMPILE_TIME(logger, __VA_ARGS__)
+#endif
+
+#define LOGGER_ERROR(logger, message) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_ERROR, logMessage, message)
+#define LOGGER_ERRORF(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_ERROR, logFormat, __VA_ARGS__)
+#define LOGGER_ERROR_KV(logger, ...) LOGGER_AT_CALL_SITE(logger, ELogLevel::LOG_ERROR, logFields, __VA_ARGS__)
+
+#endif // CNamedLogger_H
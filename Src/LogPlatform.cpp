@@ -0,0 +1,114 @@
+﻿#include "pch.h"
+#include "LogPlatform.h"
+#include <cerrno>
+#include <cstdio>
+#include <locale>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace LogPlatform {
+
+    bool localTime(std::time_t time, std::tm& result) {
+#ifdef _WIN32
+        return localtime_s(&result, &time) == 0;
+#else
+        return localtime_r(&time, &result) != nullptr;
+#endif
+    }
+
+    bool utcTime(std::time_t time, std::tm& result) {
+#ifdef _WIN32
+        return gmtime_s(&result, &time) == 0;
+#else
+        return gmtime_r(&time, &result) != nullptr;
+#endif
+    }
+
+    std::string currentDirectory() {
+        char currentDir[FILENAME_MAX];
+#ifdef _WIN32
+        char* result = _getcwd(currentDir, sizeof(currentDir));
+#else
+        char* result = getcwd(currentDir, sizeof(currentDir));
+#endif
+        if (result == nullptr) {
+            throw std::runtime_error("Failed to get current working directory.");
+        }
+        return currentDir;
+    }
+
+    void createDirectory(const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR)) { // 디렉토리 존재 여부 확인
+            return;
+        }
+#ifdef _WIN32
+        int result = _mkdir(path.c_str());
+#else
+        int result = mkdir(path.c_str(), 0755);
+#endif
+        // 다른 스레드/프로세스가 먼저 만든 경우는 성공으로 처리
+        if (result != 0 && errno != EEXIST) {
+            throw std::runtime_error("Unable to create directory: " + path);
+        }
+    }
+
+    bool fileStamp(const std::string& path, long long& modifiedTime, unsigned long long& size) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            return false;
+        }
+        modifiedTime = static_cast<long long>(info.st_mtime);
+        size = static_cast<unsigned long long>(info.st_size);
+        return true;
+    }
+
+    unsigned long processId() {
+#ifdef _WIN32
+        return static_cast<unsigned long>(_getpid());
+#else
+        return static_cast<unsigned long>(getpid());
+#endif
+    }
+
+    /// <summary>
+    /// 프로세스가 실행 중인지 확인 (권한이 없어 확인할 수 없는 프로세스는 실행 중으로 본다)
+    /// </summary>
+    bool isProcessAlive(unsigned long processId) {
+#ifdef _WIN32
+        HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(processId));
+        if (process == nullptr) {
+            return GetLastError() == ERROR_ACCESS_DENIED;
+        }
+        DWORD exitCode = 0;
+        bool alive = GetExitCodeProcess(process, &exitCode) != 0 && exitCode == STILL_ACTIVE;
+        CloseHandle(process);
+        return alive;
+#else
+        return kill(static_cast<pid_t>(processId), 0) == 0 || errno == EPERM;
+#endif
+    }
+
+    /// <summary>
+    /// 프로세스 로케일 설정
+    /// 설치되지 않은 로케일이면 std::runtime_error 가 발생하므로, 이때는 기존 로케일을 그대로 사용한다.
+    /// </summary>
+    void installGlobalLocale() {
+#ifdef _WIN32
+        try {
+            std::locale::global(std::locale("Korean"));
+        }
+        catch (const std::runtime_error&) {
+        }
+#endif
+    }
+}
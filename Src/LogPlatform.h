@@ -0,0 +1,32 @@
+﻿// LogPlatform.h
+#ifndef LogPlatform_H
+#define LogPlatform_H
+
+#include <ctime>
+#include <string>
+
+// 운영체제마다 다른 함수(localtime_s/localtime_r, _getcwd/getcwd, _mkdir/mkdir, 로케일 이름)를 감싼 함수들
+namespace LogPlatform {
+    // time 을 현지 시간/UTC 로 변환. 실패하면 false
+    bool localTime(std::time_t time, std::tm& result);
+    bool utcTime(std::time_t time, std::tm& result);
+
+    // 현재 작업 디렉토리. 실패하면 std::runtime_error
+    std::string currentDirectory();
+    // 디렉토리가 없으면 생성 (상위 디렉토리는 만들지 않음). 실패하면 std::runtime_error
+    void createDirectory(const std::string& path);
+
+    // 파일의 마지막 수정 시각(초)과 크기. 파일이 없으면 false
+    bool fileStamp(const std::string& path, long long& modifiedTime, unsigned long long& size);
+
+    // 현재 프로세스 id
+    unsigned long processId();
+    // 프로세스가 실행 중인지 (종료되어 없는 프로세스면 false)
+    bool isProcessAlive(unsigned long processId);
+
+    // ofstream 을 만들기 전에 프로세스 로케일 설정
+    // Windows 는 한국어 로케일(코드 페이지 949), 그 외는 바이트를 그대로 기록하므로 변경하지 않는다.
+    void installGlobalLocale();
+}
+
+#endif // LogPlatform_H
@@ -0,0 +1,214 @@
+﻿#include "pch.h"
+#include "LogRateLimiter.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace {
+    long long steadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+const unsigned char SLogSiteState::kLevelUnknown;
+const unsigned char SLogSiteState::kLevelDisabled;
+const unsigned char SLogSiteState::kLevelEnabled;
+const int CLogRateLimiter::kLevelCount;
+
+CLogRateLimiter::CLogRateLimiter() {
+    active.store(false);
+    suppressDuplicates.store(false);
+    for (int i = 0; i < kLevelCount; ++i) {
+        intervalNanos[i].store(0);
+        burstNanos[i].store(0);
+    }
+    pendingSites.store(nullptr);
+    totalSuppressed.store(0);
+    totalRepeated.store(0);
+}
+
+/// <summary>
+/// 레벨별 호출 위치당 속도 제한 설정
+/// </summary>
+/// <param name="recordsPerSecond : 호출 위치 하나가 1초에 남길 수 있는 로그 개수, 0 이하면 제한 없음"></param>
+/// <param name="burst : 한꺼번에 남길 수 있는 최대 개수, 0 이면 recordsPerSecond (최소 1)"></param>
+void CLogRateLimiter::setRateLimit(ELogLevel eLogLevel, double recordsPerSecond, unsigned burst) {
+    int level = static_cast<int>(eLogLevel);
+    if (level < 0 || level >= kLevelCount) {
+        return;
+    }
+    long long interval = 0;
+    long long burstWindow = 0;
+    if (recordsPerSecond > 0.0) {
+        interval = static_cast<long long>(1e9 / recordsPerSecond);
+        if (interval < 1) {
+            interval = 1;
+        }
+        if (burst == 0) {
+            burst = recordsPerSecond < 1.0 ? 1u : static_cast<unsigned>(recordsPerSecond);
+        }
+        burstWindow = interval * static_cast<long long>(burst);
+    }
+    burstNanos[level].store(burstWindow, std::memory_order_relaxed);
+    intervalNanos[level].store(interval, std::memory_order_relaxed);
+    updateActive();
+}
+
+void CLogRateLimiter::setDuplicateSuppression(bool enable) {
+    suppressDuplicates.store(enable, std::memory_order_relaxed);
+    updateActive();
+}
+
+void CLogRateLimiter::updateActive() {
+    bool anyLimit = suppressDuplicates.load(std::memory_order_relaxed);
+    for (int i = 0; i < kLevelCount; ++i) {
+        anyLimit = anyLimit || intervalNanos[i].load(std::memory_order_relaxed) != 0;
+    }
+    active.store(anyLimit, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// 로그를 남길지 판단
+/// 직전 메시지와 같으면 반복 개수만 세고, 아니면 token bucket(GCRA) 으로 속도를 확인한다.
+/// 허용 시각 하나만 compare_exchange 로 갱신하므로 여러 스레드가 같은 위치에서 로그를 남겨도 락이 없다.
+/// </summary>
+/// <returns>남겨야 하면 true</returns>
+bool CLogRateLimiter::admit(SLogSiteState& state, const SLogCallSite* callSite, const char* format, const char* args,
+    size_t argsSize, SLogSiteSummary& summary) {
+    bool duplicates = suppressDuplicates.load(std::memory_order_relaxed);
+    if (duplicates) {
+        if (isRepeatedMessage(state, format, args, argsSize)) {
+            state.repeatedCount.fetch_add(1, std::memory_order_relaxed);
+            totalRepeated.fetch_add(1, std::memory_order_relaxed);
+            addPendingSite(state, callSite);
+            return false;
+        }
+    }
+
+    int level = static_cast<int>(callSite->eLogLevel);
+    long long interval = intervalNanos[level].load(std::memory_order_relaxed);
+    if (interval != 0) {
+        long long burstWindow = burstNanos[level].load(std::memory_order_relaxed);
+        long long now = steadyNanos();
+        long long allowedAt = state.nextAllowedTime.load(std::memory_order_relaxed);
+        for (;;) {
+            long long next = (allowedAt > now ? allowedAt : now) + interval;
+            if (next - now > burstWindow) {
+                state.suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                totalSuppressed.fetch_add(1, std::memory_order_relaxed);
+                if (duplicates) {
+                    // 남기지 않은 메시지가 다음 로그의 "반복" 기준이 되지 않도록 한다.
+                    forgetLastMessage(state);
+                }
+                addPendingSite(state, callSite);
+                return false;
+            }
+            if (state.nextAllowedTime.compare_exchange_weak(allowedAt, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+
+    summary.callSite = callSite;
+    summary.suppressedCount = 0;
+    summary.repeatedCount = 0;
+    if (state.suppressedCount.load(std::memory_order_relaxed) != 0) {
+        summary.suppressedCount = state.suppressedCount.exchange(0, std::memory_order_relaxed);
+    }
+    if (state.repeatedCount.load(std::memory_order_relaxed) != 0) {
+        summary.repeatedCount = state.repeatedCount.exchange(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+/// <summary>
+/// 메시지 내용 hash (FNV-1a). 포맷 문자열은 상수이므로 주소만 섞는다.
+/// </summary>
+unsigned long long CLogRateLimiter::hashMessage(const char* format, const char* args, size_t argsSize) {
+    unsigned long long hash = 14695981039346656037ULL;
+    uintptr_t formatAddress = reinterpret_cast<uintptr_t>(format);
+    for (size_t i = 0; i < sizeof(formatAddress); ++i) {
+        hash = (hash ^ ((formatAddress >> (i * 8)) & 0xff)) * 1099511628211ULL;
+    }
+    for (size_t i = 0; i < argsSize; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(args[i])) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// <summary>
+/// 직전에 통과한 메시지와 같은지 확인하고, 다르면 이 메시지를 새 기준으로 복사한다.
+/// hash 가 같아도 포맷 문자열 주소와 인자 byte 가 모두 같아야 반복으로 본다.
+/// </summary>
+bool CLogRateLimiter::isRepeatedMessage(SLogSiteState& state, const char* format, const char* args, size_t argsSize) {
+    unsigned long long hash = hashMessage(format, args, argsSize);
+    while (state.lastMessageLock.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    bool repeated = state.lastMessageValid && state.lastMessageHash == hash && state.lastFormat == format
+        && state.lastArgsSize == argsSize && (argsSize == 0 || std::memcmp(state.lastArgs, args, argsSize) == 0);
+    if (!repeated) {
+        if (argsSize > state.lastArgsCapacity) {
+            delete[] state.lastArgs;
+            state.lastArgs = new char[argsSize];
+            state.lastArgsCapacity = argsSize;
+        }
+        if (argsSize != 0) {
+            std::memcpy(state.lastArgs, args, argsSize);
+        }
+        state.lastArgsSize = argsSize;
+        state.lastFormat = format;
+        state.lastMessageHash = hash;
+        state.lastMessageValid = true;
+    }
+    state.lastMessageLock.store(false, std::memory_order_release);
+    return repeated;
+}
+
+/// <summary>
+/// 남기지 않은 메시지가 다음 로그의 "반복" 기준이 되지 않도록 기준을 지운다.
+/// </summary>
+void CLogRateLimiter::forgetLastMessage(SLogSiteState& state) {
+    while (state.lastMessageLock.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    state.lastMessageValid = false;
+    state.lastMessageLock.store(false, std::memory_order_release);
+}
+
+/// <summary>
+/// 처음 로그를 생략한 호출 위치를 요약 대기 목록에 추가 (호출 위치는 static 이므로 제거하지 않는다)
+/// </summary>
+void CLogRateLimiter::addPendingSite(SLogSiteState& state, const SLogCallSite* callSite) {
+    if (state.listed.load(std::memory_order_relaxed) || state.listed.exchange(true, std::memory_order_relaxed)) {
+        return;
+    }
+    state.callSite = callSite;
+    SLogSiteState* head = pendingSites.load(std::memory_order_relaxed);
+    do {
+        state.nextListed = head;
+    } while (!pendingSites.compare_exchange_weak(head, &state, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void CLogRateLimiter::takePendingSummaries(std::vector<SLogSiteSummary>& summaries) {
+    for (SLogSiteState* state = pendingSites.load(std::memory_order_acquire); state != nullptr; state = state->nextListed) {
+        SLogSiteSummary summary;
+        summary.callSite = state->callSite;
+        summary.suppressedCount = state->suppressedCount.exchange(0, std::memory_order_relaxed);
+        summary.repeatedCount = state->repeatedCount.exchange(0, std::memory_order_relaxed);
+        if (summary.suppressedCount != 0 || summary.repeatedCount != 0) {
+            summaries.push_back(summary);
+        }
+    }
+}
+
+unsigned long long CLogRateLimiter::getSuppressedCount() const {
+    return totalSuppressed.load(std::memory_order_relaxed);
+}
+
+unsigned long long CLogRateLimiter::getRepeatedCount() const {
+    return totalRepeated.load(std::memory_order_relaxed);
+}
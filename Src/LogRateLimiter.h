@@ -0,0 +1,101 @@
+﻿// CLogRateLimiter.h
+#ifndef CLogRateLimiter_H
+#define CLogRateLimiter_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+enum class ELogLevel;
+struct SLogCallSite;
+
+// LOG_* 매크로 호출 위치마다 하나씩 있는 레벨/속도 제한/중복 생략/샘플링/스코프 집계 상태
+// 매크로 안의 static 변수로 만들어지므로 0 으로 초기화되고, 동적 초기화(guard)가 없다.
+struct SLogSiteState {
+    std::atomic<long long> nextAllowedTime;             // 다음 로그가 허용되는 시각 (steady_clock, ns)
+    // 마지막으로 통과한 메시지 (중복 생략을 켰을 때만 사용, lastMessageLock 으로 보호)
+    // hash 가 같으면 포맷 문자열 주소와 인자 byte 를 비교하므로 hash 충돌로 다른 메시지를 버리지 않는다.
+    // 인자 복사본(lastArgs)은 호출 위치와 함께 프로세스가 끝날 때까지 유지하고, 더 큰 메시지가 오면 늘린다.
+    std::atomic<bool> lastMessageLock;
+    bool lastMessageValid;
+    unsigned long long lastMessageHash;
+    const char* lastFormat;
+    char* lastArgs;
+    size_t lastArgsSize;
+    size_t lastArgsCapacity;
+    std::atomic<unsigned long long> suppressedCount;    // 속도 제한으로 생략한 개수 (아직 요약을 남기지 않은 것)
+    std::atomic<unsigned long long> repeatedCount;      // 직전 메시지와 같아서 생략한 개수
+    std::atomic<bool> listed;                           // 요약 대기 목록에 등록됨
+    const SLogCallSite* callSite;                       // 등록할 때 기록 (요약 로그의 호출 위치)
+    SLogSiteState* nextListed;
+
+    std::atomic<unsigned long long> samplingRule;       // 이 위치에 적용할 샘플링 규칙 (CLogSampler 가 세대 번호와 함께 캐시)
+    std::atomic<unsigned long long> sampleCounter;      // 1/N 샘플링 호출 횟수
+
+    std::atomic<unsigned> scopeIndex;                   // LOG_SCOPE_STATS 집계 번호 (1 부터, 0 이면 아직 없음)
+
+    // 레벨 확인 결과 (CLogger::isEnabled). 처음 한 번 규칙에서 찾고, 레벨 설정이 바뀌면 CLogLevelFilter 가 다시 계산해서 덮어쓴다.
+    static const unsigned char kLevelUnknown = 0;
+    static const unsigned char kLevelDisabled = 1;
+    static const unsigned char kLevelEnabled = 2;
+    std::atomic<unsigned char> levelState;
+};
+
+// 통과한 로그 앞에, 또는 flush 시에 남길 생략 요약
+struct SLogSiteSummary {
+    const SLogCallSite* callSite;
+    unsigned long long suppressedCount;
+    unsigned long long repeatedCount;
+};
+
+// 호출 위치별 속도 제한(token bucket)과 연속 중복 메시지 생략
+// 속도 제한 상태는 호출 위치의 SLogSiteState 에 atomic 으로 두므로 로그 호출 경로에서 락을 잡지 않는다.
+// 중복 생략은 마지막 메시지 복사본을 호출 위치별 spin lock 으로 보호한다. (같은 호출 위치끼리만 경합)
+// 아무 설정도 하지 않으면 isActive() 가 false 이고, 로그마다 atomic load 한 번의 비용만 든다.
+class CLogRateLimiter {
+public:
+    CLogRateLimiter();
+
+    // 호출 위치마다 초당 recordsPerSecond 개, 한 번에 최대 burst 개까지 허용 (recordsPerSecond <= 0 이면 제한 없음)
+    void setRateLimit(ELogLevel eLogLevel, double recordsPerSecond, unsigned burst);
+    void setDuplicateSuppression(bool enable);
+
+    bool isActive() const {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    // 로그를 남길지 판단. 남길 때는 그동안 생략한 개수를 summary 에 돌려준다.
+    // format, args : 중복 판단에 쓰는 메시지 내용 (포맷 문자열 주소 + 인코딩된 인자)
+    bool admit(SLogSiteState& state, const SLogCallSite* callSite, const char* format, const char* args, size_t argsSize,
+        SLogSiteSummary& summary);
+
+    // 메시지 내용 hash (FNV-1a). 포맷 문자열은 상수이므로 주소만 섞는다.
+    static unsigned long long hashMessage(const char* format, const char* args, size_t argsSize);
+
+    // 요약을 남기지 않은 생략 개수를 모두 꺼낸다. (flush, 종료 시)
+    void takePendingSummaries(std::vector<SLogSiteSummary>& summaries);
+
+    unsigned long long getSuppressedCount() const;
+    unsigned long long getRepeatedCount() const;
+
+private:
+    CLogRateLimiter(const CLogRateLimiter&) = delete;
+    CLogRateLimiter& operator=(const CLogRateLimiter&) = delete;
+
+    void updateActive();
+    static bool isRepeatedMessage(SLogSiteState& state, const char* format, const char* args, size_t argsSize);
+    static void forgetLastMessage(SLogSiteState& state);
+    void addPendingSite(SLogSiteState& state, const SLogCallSite* callSite);
+
+    static const int kLevelCount = 4;
+
+    std::atomic<bool> active;
+    std::atomic<bool> suppressDuplicates;
+    std::atomic<long long> intervalNanos[kLevelCount];     // 로그 한 개당 간격, 0 이면 제한 없음
+    std::atomic<long long> burstNanos[kLevelCount];        // burst * intervalNanos
+    std::atomic<SLogSiteState*> pendingSites;               // 한 번이라도 로그를 생략한 호출 위치 (제거하지 않음)
+    std::atomic<unsigned long long> totalSuppressed;
+    std::atomic<unsigned long long> totalRepeated;
+};
+
+#endif // CLogRateLimiter_H
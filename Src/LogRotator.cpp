@@ -0,0 +1,335 @@
+﻿#include "pch.h"
+#include "LogRotator.h"
+#include "LogPlatform.h"
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifdef LOGGER_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef LOGGER_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+    const size_t kCompressChunkSize = 64 * 1024;
+
+    /// <summary>
+    /// 파일 이름 변경. 대상 파일이 있으면 덮어쓴다. (같은 디렉토리 안에서는 원자적으로 처리됨)
+    /// </summary>
+    bool renameLogFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    // 압축 스레드는 로그 호출 스레드보다 낮은 우선순위로 실행
+    void lowerCurrentThreadPriority() {
+#ifdef _WIN32
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+    }
+
+#ifdef LOGGER_WITH_ZLIB
+    bool gzipFile(const std::string& sourcePath, const std::string& targetPath) {
+        std::ifstream source(sourcePath, std::ios::binary);
+        if (!source.is_open()) {
+            return false;
+        }
+        gzFile target = gzopen(targetPath.c_str(), "wb6");
+        if (target == nullptr) {
+            return false;
+        }
+        std::vector<char> chunk(kCompressChunkSize);
+        bool ok = true;
+        while (ok && source) {
+            source.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            std::streamsize readSize = source.gcount();
+            if (readSize > 0 && gzwrite(target, chunk.data(), static_cast<unsigned>(readSize)) != readSize) {
+                ok = false;
+            }
+        }
+        if (gzclose(target) != Z_OK) {
+            ok = false;
+        }
+        return ok;
+    }
+#endif
+
+#ifdef LOGGER_WITH_ZSTD
+    bool zstdFile(const std::string& sourcePath, const std::string& targetPath) {
+        std::ifstream source(sourcePath, std::ios::binary);
+        std::ofstream target(targetPath, std::ios::binary | std::ios::trunc);
+        if (!source.is_open() || !target.is_open()) {
+            return false;
+        }
+        ZSTD_CCtx* context = ZSTD_createCCtx();
+        if (context == nullptr) {
+            return false;
+        }
+        std::vector<char> input(kCompressChunkSize);
+        std::vector<char> output(ZSTD_CStreamOutSize());
+        bool ok = true;
+        bool lastChunk = false;
+        while (ok && !lastChunk) {
+            source.read(input.data(), static_cast<std::streamsize>(input.size()));
+            size_t readSize = static_cast<size_t>(source.gcount());
+            lastChunk = !source;
+            ZSTD_EndDirective mode = lastChunk ? ZSTD_e_end : ZSTD_e_continue;
+            ZSTD_inBuffer in = { input.data(), readSize, 0 };
+            bool finished = false;
+            while (!finished) {
+                ZSTD_outBuffer out = { output.data(), output.size(), 0 };
+                size_t remaining = ZSTD_compressStream2(context, &out, &in, mode);
+                if (ZSTD_isError(remaining)) {
+                    ok = false;
+                    break;
+                }
+                target.write(output.data(), static_cast<std::streamsize>(out.pos));
+                finished = lastChunk ? (remaining == 0) : (in.pos == in.size);
+            }
+        }
+        ZSTD_freeCCtx(context);
+        target.close();
+        return ok && !target.fail();
+    }
+#endif
+
+    unsigned long long fileSizeOf(const std::string& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        return file.is_open() ? static_cast<unsigned long long>(file.tellg()) : 0;
+    }
+}
+
+CLogRotator::CLogRotator()
+    : interval(0)
+{
+    rotationCount.store(0);
+    compressedCount.store(0);
+    compressFailedCount.store(0);
+    deletedCount.store(0);
+    bytesBeforeCompression.store(0);
+    bytesAfterCompression.store(0);
+}
+
+CLogRotator::~CLogRotator() {
+    // 압축 대기 중인 파일을 모두 처리한 후 종료
+    {
+        std::lock_guard<std::mutex> lock(rotatorMutex);
+        stopCompressor = true;
+    }
+    compressorWakeup.notify_one();
+    if (compressorThread.joinable()) {
+        compressorThread.join();
+    }
+}
+
+/// <summary>
+/// 로그파일 교체 조건 설정
+/// </summary>
+/// <param name="maxFileSize : 이 크기(byte) 이상이면 교체, 0 이면 사용 안 함"></param>
+/// <param name="interval : 로그파일을 연 뒤 이 시간이 지나면 교체, 0 이면 사용 안 함"></param>
+/// <param name="retentionCount : 보관할 교체 파일 개수, 0 이면 모두 보관"></param>
+/// <param name="eCompression : 교체된 파일 압축 방식"></param>
+void CLogRotator::configure(unsigned long long maxFileSize, std::chrono::seconds interval, unsigned retentionCount,
+    ELogCompression eCompression) {
+#ifndef LOGGER_WITH_ZLIB
+    if (eCompression == ELogCompression::GZIP) {
+        throw std::runtime_error("gzip compression requires building with LOGGER_WITH_ZLIB.");
+    }
+#endif
+#ifndef LOGGER_WITH_ZSTD
+    if (eCompression == ELogCompression::ZSTD) {
+        throw std::runtime_error("zstd compression requires building with LOGGER_WITH_ZSTD.");
+    }
+#endif
+    std::lock_guard<std::mutex> lock(rotatorMutex);
+    this->maxFileSize = maxFileSize;
+    this->interval = interval;
+    this->retentionCount = retentionCount;
+    compression = eCompression;
+    if (compression != ELogCompression::NONE && !compressorThread.joinable()) {
+        compressorThread = std::thread(&CLogRotator::compressorThreadMain, this);
+    }
+    enforceRetentionLocked();
+}
+
+bool CLogRotator::isEnabled() const {
+    return maxFileSize > 0 || interval.count() > 0;
+}
+
+bool CLogRotator::shouldRotate(unsigned long long fileSize, std::chrono::steady_clock::time_point openedAt) const {
+    if (maxFileSize > 0 && fileSize >= maxFileSize) {
+        return true;
+    }
+    return interval.count() > 0 && std::chrono::steady_clock::now() - openedAt >= interval;
+}
+
+/// <summary>
+/// 현재 로그파일을 보관 이름으로 바꾼다. 압축을 사용하면 압축 스레드로 넘긴다.
+/// </summary>
+/// <param name="logFilename : 닫힌 상태의 현재 로그파일"></param>
+/// <returns>이름 변경 성공 여부</returns>
+bool CLogRotator::rotate(const std::string& logFilename) {
+    std::lock_guard<std::mutex> lock(rotatorMutex);
+    std::string rotatedName = makeRotatedName(logFilename);
+    if (!renameLogFile(logFilename, rotatedName)) {
+        return false;
+    }
+    rotationCount.fetch_add(1);
+    rotatedFiles.push_back(rotatedName);
+    if (compression != ELogCompression::NONE) {
+        pendingFiles.push_back(rotatedName);
+        compressorWakeup.notify_one();
+    }
+    enforceRetentionLocked();
+    return true;
+}
+
+SRotationStats CLogRotator::getStats() const {
+    SRotationStats stats;
+    stats.rotationCount = rotationCount.load();
+    stats.compressedCount = compressedCount.load();
+    stats.compressFailedCount = compressFailedCount.load();
+    stats.deletedCount = deletedCount.load();
+    stats.bytesBeforeCompression = bytesBeforeCompression.load();
+    stats.bytesAfterCompression = bytesAfterCompression.load();
+    std::lock_guard<std::mutex> lock(rotatorMutex);
+    stats.pendingCompressions = static_cast<unsigned>(pendingFiles.size() + (compressing ? 1 : 0));
+    return stats;
+}
+
+void CLogRotator::waitForCompression() {
+    std::unique_lock<std::mutex> lock(rotatorMutex);
+    compressionDone.wait(lock, [this] { return pendingFiles.empty() && !compressing; });
+}
+
+/// <summary>
+/// "이름_yyyymmdd-hhmmss_번호.확장자" 형태의 보관 파일 이름 생성
+/// </summary>
+std::string CLogRotator::makeRotatedName(const std::string& logFilename) {
+    size_t slashPos = logFilename.find_last_of("/\\");
+    size_t dotPos = logFilename.find_last_of('.');
+    if (dotPos == std::string::npos || (slashPos != std::string::npos && dotPos < slashPos)) {
+        dotPos = logFilename.size();
+    }
+
+    std::time_t nowTime = std::time(nullptr);
+    std::tm localTime;
+    LogPlatform::localTime(nowTime, localTime);
+    char timeText[32];
+    strftime(timeText, sizeof(timeText), "%Y%m%d-%H%M%S", &localTime);
+
+    return logFilename.substr(0, dotPos) + "_" + timeText + "_" + std::to_string(++sequence)
+        + logFilename.substr(dotPos);
+}
+
+/// <summary>
+/// 보관 개수를 넘는 오래된 교체 파일 삭제. rotatorMutex 를 잡은 상태에서 호출
+/// </summary>
+void CLogRotator::enforceRetentionLocked() {
+    while (retentionCount > 0 && rotatedFiles.size() > retentionCount) {
+        std::string oldest = rotatedFiles.front();
+        rotatedFiles.pop_front();
+        for (auto it = pendingFiles.begin(); it != pendingFiles.end(); ++it) {
+            if (*it == oldest) {
+                pendingFiles.erase(it);
+                break;
+            }
+        }
+        if (std::remove(oldest.c_str()) == 0) {
+            deletedCount.fetch_add(1);
+        }
+    }
+}
+
+/// <summary>
+/// 압축 스레드 본체. 교체된 파일을 하나씩 압축하고 원본은 삭제한다.
+/// </summary>
+void CLogRotator::compressorThreadMain() {
+    lowerCurrentThreadPriority();
+    std::unique_lock<std::mutex> lock(rotatorMutex);
+    for (;;) {
+        compressorWakeup.wait(lock, [this] { return stopCompressor || !pendingFiles.empty(); });
+        if (pendingFiles.empty()) {
+            break;      // stopCompressor
+        }
+        std::string sourcePath = pendingFiles.front();
+        pendingFiles.pop_front();
+        ELogCompression method = compression;
+        compressing = true;
+        lock.unlock();
+
+        std::string compressedPath;
+        unsigned long long sourceSize = 0;
+        unsigned long long compressedSize = 0;
+        bool ok = compressFile(method, sourcePath, compressedPath, sourceSize, compressedSize);
+
+        lock.lock();
+        compressing = false;
+        if (ok) {
+            compressedCount.fetch_add(1);
+            bytesBeforeCompression.fetch_add(sourceSize);
+            bytesAfterCompression.fetch_add(compressedSize);
+            bool retained = false;
+            for (auto& rotated : rotatedFiles) {
+                if (rotated == sourcePath) {
+                    rotated = compressedPath;
+                    retained = true;
+                    break;
+                }
+            }
+            // 압축하는 동안 보관 개수를 넘어 목록에서 빠졌으면 압축 파일도 삭제
+            if (!retained && std::remove(compressedPath.c_str()) == 0) {
+                deletedCount.fetch_add(1);
+            }
+        }
+        else {
+            compressFailedCount.fetch_add(1);
+        }
+        compressionDone.notify_all();
+    }
+    compressionDone.notify_all();
+}
+
+bool CLogRotator::compressFile(ELogCompression eMethod, const std::string& sourcePath, std::string& compressedPath,
+    unsigned long long& sourceSize, unsigned long long& compressedSize) {
+    bool ok = false;
+    switch (eMethod) {
+#ifdef LOGGER_WITH_ZLIB
+    case ELogCompression::GZIP:
+        compressedPath = sourcePath + ".gz";
+        ok = gzipFile(sourcePath, compressedPath);
+        break;
+#endif
+#ifdef LOGGER_WITH_ZSTD
+    case ELogCompression::ZSTD:
+        compressedPath = sourcePath + ".zst";
+        ok = zstdFile(sourcePath, compressedPath);
+        break;
+#endif
+    default:
+        return false;
+    }
+    if (!ok) {
+        std::remove(compressedPath.c_str());
+        return false;
+    }
+    sourceSize = fileSizeOf(sourcePath);
+    compressedSize = fileSizeOf(compressedPath);
+    std::remove(sourcePath.c_str());
+    return true;
+}
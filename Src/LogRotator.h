@@ -0,0 +1,88 @@
+﻿// CLogRotator.h
+#ifndef CLogRotator_H
+#define CLogRotator_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 교체된 로그파일 압축 방식
+// GZIP 은 LOGGER_WITH_ZLIB, ZSTD 는 LOGGER_WITH_ZSTD 를 정의하고 해당 라이브러리를 링크해야 사용할 수 있다.
+enum class ELogCompression {
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+// 로그파일 교체 통계
+struct SRotationStats {
+    unsigned long long rotationCount;           // 교체 횟수
+    unsigned long long compressedCount;         // 압축 완료한 파일 개수
+    unsigned long long compressFailedCount;     // 압축 실패한 파일 개수 (원본 유지)
+    unsigned long long deletedCount;            // 보관 개수를 넘어 삭제한 파일 개수
+    unsigned long long bytesBeforeCompression;
+    unsigned long long bytesAfterCompression;
+    unsigned pendingCompressions;               // 압축 대기 중인 파일 개수
+};
+
+// 로그파일 크기/시간 기준 교체
+// 현재 로그파일을 "이름_yyyymmdd-hhmmss_번호.확장자" 로 바꾸고(rename), 압축은 우선순위가 낮은 별도 스레드에서 처리한다.
+// 보관 개수는 이 프로세스에서 교체한 파일 기준이다.
+class CLogRotator {
+public:
+    CLogRotator();
+    ~CLogRotator();
+
+    // maxFileSize : 이 크기(byte) 이상이면 교체, 0 이면 사용 안 함
+    // interval : 로그파일을 연 뒤 이 시간이 지나면 교체, 0 이면 사용 안 함
+    // retentionCount : 보관할 교체 파일 개수, 0 이면 모두 보관
+    void configure(unsigned long long maxFileSize, std::chrono::seconds interval, unsigned retentionCount,
+        ELogCompression eCompression);
+    bool isEnabled() const;
+    bool shouldRotate(unsigned long long fileSize, std::chrono::steady_clock::time_point openedAt) const;
+
+    // logFilename 을 보관 이름으로 바꾼다. 로그파일이 닫힌 상태에서 호출해야 한다.
+    bool rotate(const std::string& logFilename);
+    SRotationStats getStats() const;
+
+    // 압축 대기 중인 파일을 모두 처리할 때까지 대기
+    void waitForCompression();
+
+private:
+    CLogRotator(const CLogRotator&) = delete;
+    CLogRotator& operator=(const CLogRotator&) = delete;
+
+    std::string makeRotatedName(const std::string& logFilename);
+    void enforceRetentionLocked();
+    void compressorThreadMain();
+    bool compressFile(ELogCompression eMethod, const std::string& sourcePath, std::string& compressedPath,
+        unsigned long long& sourceSize, unsigned long long& compressedSize);
+
+    unsigned long long maxFileSize = 0;
+    std::chrono::seconds interval;
+    unsigned retentionCount = 0;
+    ELogCompression compression = ELogCompression::NONE;
+    unsigned long long sequence = 0;
+
+    mutable std::mutex rotatorMutex;
+    std::condition_variable compressorWakeup;
+    std::condition_variable compressionDone;
+    std::deque<std::string> rotatedFiles;       // 오래된 순서
+    std::deque<std::string> pendingFiles;       // 압축 대기
+    bool compressing = false;
+    bool stopCompressor = false;
+    std::thread compressorThread;
+
+    std::atomic<unsigned long long> rotationCount;
+    std::atomic<unsigned long long> compressedCount;
+    std::atomic<unsigned long long> compressFailedCount;
+    std::atomic<unsigned long long> deletedCount;
+    std::atomic<unsigned long long> bytesBeforeCompression;
+    std::atomic<unsigned long long> bytesAfterCompression;
+};
+
+#endif // CLogRotator_H
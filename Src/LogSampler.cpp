@@ -0,0 +1,155 @@
+﻿#include "pch.h"
+#include "LogSampler.h"
+#include "Logger.h"
+#include <chrono>
+#include <cstdint>
+
+namespace {
+    // 캐시된 규칙 : [세대 번호 30 bit][방식 2 bit][값 32 bit]
+    const unsigned kGenerationMask = 0x3FFFFFFF;
+    const int kGenerationShift = 34;
+    const int kModeShift = 32;
+
+    unsigned long long packRule(unsigned generation, ESampleMode eMode, unsigned value) {
+        return (static_cast<unsigned long long>(generation & kGenerationMask) << kGenerationShift)
+            | (static_cast<unsigned long long>(eMode) << kModeShift) | value;
+    }
+
+    /// <summary>
+    /// 스레드별 난수 (xorshift64*). 처음 호출할 때 스레드마다 다른 값으로 시작한다.
+    /// </summary>
+    uint32_t nextRandom() {
+        thread_local uint64_t state = 0;
+        if (state == 0) {
+            state = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&state))
+                ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            state |= 1;
+        }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<uint32_t>((state * 2685821657736338717ULL) >> 32);
+    }
+}
+
+const int CLogSampler::kLevelCount;
+
+CLogSampler::CLogSampler() {
+    active.store(false);
+    generation.store(1);
+    for (auto& rule : levelRules) {
+        rule = SSampleRule{ ESampleMode::ALL, 0 };
+    }
+}
+
+void CLogSampler::setFileRuleLocked(const std::string& name, int level, SSampleRule rule) {
+    for (auto& fileRule : fileRules) {
+        if (fileRule.fileName == name && fileRule.level == level) {
+            fileRule.rule = rule;
+            return;
+        }
+    }
+    fileRules.push_back(SFileRule{ name, level, rule });
+}
+
+/// <summary>
+/// 모든 규칙 교체. 같은 잠금 안에서 바꾸므로 중간 상태가 보이지 않고, 호출 위치의 캐시도 한 번만 무효화된다.
+/// 같은 파일/레벨의 규칙이 여러 개면 앞의 것을 뒤의 것으로 바꾼다.
+/// </summary>
+void CLogSampler::setRules(const std::vector<SLogSampleRule>& rules) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    for (auto& rule : levelRules) {
+        rule = SSampleRule{ ESampleMode::ALL, 0 };
+    }
+    fileRules.clear();
+    for (const auto& rule : rules) {
+        int level = static_cast<int>(rule.eLogLevel);
+        if (level < 0 || level >= kLevelCount) {
+            continue;
+        }
+        if (rule.fileName.empty()) {
+            levelRules[level] = makeRule(rule.eMode, rule.value);
+        }
+        else {
+            setFileRuleLocked(logBaseName(rule.fileName.c_str()), level, makeRule(rule.eMode, rule.value));
+        }
+    }
+    updateLocked();
+}
+
+CLogSampler::SSampleRule CLogSampler::makeRule(ESampleMode eMode, double value) {
+    if (eMode == ESampleMode::PROBABILITY) {
+        if (value >= 1.0) {
+            return SSampleRule{ ESampleMode::ALL, 0 };
+        }
+        return SSampleRule{ eMode, value <= 0.0 ? 0u : static_cast<unsigned>(value * 4294967296.0) };
+    }
+    if (eMode == ESampleMode::EVERY_N && value > 1.0) {
+        return SSampleRule{ eMode, value >= 4294967295.0 ? 0xFFFFFFFFu : static_cast<unsigned>(value) };
+    }
+    return SSampleRule{ ESampleMode::ALL, 0 };
+}
+
+/// <summary>
+/// 세대 번호를 올려서 호출 위치에 캐시된 규칙을 무효화한다. (세대 번호 0 은 "캐시 없음" 이므로 건너뜀)
+/// </summary>
+void CLogSampler::updateLocked() {
+    bool anyRule = !fileRules.empty();
+    for (const auto& rule : levelRules) {
+        anyRule = anyRule || rule.eMode != ESampleMode::ALL;
+    }
+    unsigned next = (generation.load(std::memory_order_relaxed) + 1) & kGenerationMask;
+    generation.store(next == 0 ? 1 : next, std::memory_order_relaxed);
+    active.store(anyRule, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// 호출 위치에 적용할 규칙을 찾아서 캐시 (설정을 바꾼 뒤 처음 한 번)
+/// </summary>
+unsigned long long CLogSampler::resolveRule(const SLogCallSite& callSite) {
+    std::lock_guard<std::mutex> lock(configMutex);
+    int level = static_cast<int>(callSite.eLogLevel);
+    SSampleRule rule = levelRules[level];
+    for (const auto& fileRule : fileRules) {
+        if (fileRule.level == level && fileRule.fileName == callSite.fileName) {
+            rule = fileRule.rule;
+            break;
+        }
+    }
+    unsigned long long packed = packRule(generation.load(std::memory_order_relaxed), rule.eMode, rule.value);
+    callSite.siteState->samplingRule.store(packed, std::memory_order_relaxed);
+    return packed;
+}
+
+/// <summary>
+/// 이번 로그를 기록할지 결정 (LOG_* 매크로에서 메시지를 만들기 전에 호출)
+/// </summary>
+bool CLogSampler::sample(const SLogCallSite& callSite) {
+    SLogSiteState& state = *callSite.siteState;
+    unsigned long long rule = state.samplingRule.load(std::memory_order_relaxed);
+    if ((rule >> kGenerationShift) != generation.load(std::memory_order_relaxed)) {
+        rule = resolveRule(callSite);
+    }
+    unsigned value = static_cast<unsigned>(rule);
+    switch (static_cast<ESampleMode>((rule >> kModeShift) & 3)) {
+    case ESampleMode::PROBABILITY:
+        return nextRandom() < value;
+    case ESampleMode::EVERY_N:
+        return state.sampleCounter.fetch_add(1, std::memory_order_relaxed) % value == 0;
+    default:
+        return true;
+    }
+}
+
+float CLogSampler::sampleRate(const SLogCallSite& callSite) const {
+    unsigned long long rule = callSite.siteState->samplingRule.load(std::memory_order_relaxed);
+    unsigned value = static_cast<unsigned>(rule);
+    switch (static_cast<ESampleMode>((rule >> kModeShift) & 3)) {
+    case ESampleMode::PROBABILITY:
+        return static_cast<float>(value / 4294967296.0);
+    case ESampleMode::EVERY_N:
+        return 1.0f / static_cast<float>(value);
+    default:
+        return 1.0f;
+    }
+}
@@ -0,0 +1,83 @@
+﻿// CLogSampler.h
+#ifndef CLogSampler_H
+#define CLogSampler_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "LogRateLimiter.h"
+
+// 샘플링 방식
+enum class ESampleMode {
+    ALL,            // 모두 기록 (샘플링 안 함)
+    PROBABILITY,    // value 확률(0 ~ 1)로 기록
+    EVERY_N         // 호출 위치마다 value 번에 한 번 기록
+};
+
+// 샘플링 규칙 하나 (설정 파일 / SLogConfig 용)
+struct SLogSampleRule {
+    std::string fileName;       // 비어 있으면 레벨 전체 규칙
+    ELogLevel eLogLevel;
+    ESampleMode eMode;
+    double value;
+
+    bool operator==(const SLogSampleRule& other) const {
+        return fileName == other.fileName && eLogLevel == other.eLogLevel && eMode == other.eMode && value == other.value;
+    }
+    bool operator!=(const SLogSampleRule& other) const {
+        return !(*this == other);
+    }
+};
+
+// 레벨별/소스 파일별 샘플링
+// 규칙은 호출 위치의 SLogSiteState 에 세대 번호와 함께 캐시하므로, 설정을 바꾼 뒤 처음 한 번만 규칙을 찾는다.
+// 확률 샘플링은 스레드별 난수 생성기를 사용하고 공유 상태를 건드리지 않는다.
+class CLogSampler {
+public:
+    CLogSampler();
+
+    // 모든 규칙을 설정 스냅샷의 rules(SLogConfig::sampling)로 한 번에 교체 (캐시 무효화도 한 번)
+    // 파일 규칙(파일 이름만 비교)은 같은 레벨의 레벨 전체 규칙보다 우선한다.
+    void setRules(const std::vector<SLogSampleRule>& rules);
+
+    bool isActive() const {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    // 이번 로그를 기록할지 결정
+    bool sample(const SLogCallSite& callSite);
+    // 기록한 로그에 붙일 샘플링 비율 (1 이면 샘플링 안 함). sample 이후에 호출
+    float sampleRate(const SLogCallSite& callSite) const;
+
+private:
+    CLogSampler(const CLogSampler&) = delete;
+    CLogSampler& operator=(const CLogSampler&) = delete;
+
+    struct SSampleRule {
+        ESampleMode eMode;
+        unsigned value;     // PROBABILITY : 2^32 기준 기록 확률, EVERY_N : N
+    };
+
+    struct SFileRule {
+        std::string fileName;
+        int level;
+        SSampleRule rule;
+    };
+
+    static SSampleRule makeRule(ESampleMode eMode, double value);
+    void setFileRuleLocked(const std::string& name, int level, SSampleRule rule);
+    unsigned long long resolveRule(const SLogCallSite& callSite);
+    void updateLocked();
+
+    static const int kLevelCount = 4;
+
+    std::atomic<bool> active;
+    std::atomic<unsigned> generation;       // 설정을 바꿀 때마다 증가 (캐시된 규칙 무효화)
+    std::mutex configMutex;
+    SSampleRule levelRules[kLevelCount];
+    std::vector<SFileRule> fileRules;
+};
+
+#endif // CLogSampler_H
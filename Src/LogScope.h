@@ -0,0 +1,69 @@
+﻿// CLogScope.h
+#ifndef CLogScope_H
+#define CLogScope_H
+
+#include "Logger.h"
+
+// LOG_SCOPE / LOG_SCOPE_STATS 가 만드는 스코프 시간 측정 객체
+// 생성할 때 시작 시간을 읽고, 소멸할 때 CLogger 에 실행 시간을 넘긴다.
+// DEBUG 레벨이 꺼져 있거나 샘플링에서 빠지면 시간을 읽지 않는다.
+class CLogScope {
+public:
+    CLogScope(const SLogCallSite* callSite, const char* name, bool aggregate)
+        : callSite(callSite), name(name), startTime(0), depth(0), aggregate(aggregate), active(false) {
+        if (CLogger::isEnabled(*callSite) && (aggregate || CLogger::isSampled(*callSite))) {
+            active = true;
+            depth = ++currentDepth();
+            startTime = CLogger::getInstance().beginScope();
+        }
+    }
+
+    ~CLogScope() {
+        if (active) {
+            CLogger::getInstance().endScope(*callSite, name, startTime, depth, aggregate);
+            --currentDepth();
+        }
+    }
+
+    // 현재 스레드에서 실행 중인 LOG_SCOPE 중첩 깊이
+    static unsigned& currentDepth() {
+        thread_local unsigned depth = 0;
+        return depth;
+    }
+
+private:
+    CLogScope(const CLogScope&) = delete;
+    CLogScope& operator=(const CLogScope&) = delete;
+
+    const SLogCallSite* callSite;
+    const char* name;
+    long long startTime;
+    unsigned depth;
+    bool aggregate;
+    bool active;
+};
+
+#define LOG_SCOPE_CONCAT_INNER(a, b) a##b
+#define LOG_SCOPE_CONCAT(a, b) LOG_SCOPE_CONCAT_INNER(a, b)
+
+// 스코프 매크로 : 선언한 줄부터 블록이 끝날 때까지의 실행 시간을 측정 (한 줄에 하나만 사용)
+// name 은 문자열 상수여야 한다. (주소만 저장됨)
+#define LOG_SCOPE_AT_CALL_SITE(name, aggregate) \
+    static SLogSiteState LOG_SCOPE_CONCAT(logScopeState, __LINE__); \
+    static constexpr SLogCallSite LOG_SCOPE_CONCAT(logScopeSite, __LINE__) = { ELogLevel::LOG_DEBUG, \
+        logLevelTag(ELogLevel::LOG_DEBUG), __FUNCTION__, logBaseName(__FILE__), __LINE__, \
+        &LOG_SCOPE_CONCAT(logScopeState, __LINE__), __FILE__ }; \
+    CLogScope LOG_SCOPE_CONCAT(logScope, __LINE__)(&LOG_SCOPE_CONCAT(logScopeSite, __LINE__), name, aggregate)
+
+// LOG_SCOPE("parse")       : 스코프가 끝날 때 실행 시간과 중첩 깊이를 DEBUG 로그 하나로 기록
+// LOG_SCOPE_STATS("parse") : 호출마다 기록하지 않고 스레드별로 횟수/최소/최대/평균/히스토그램을 모아서
+//                            setScopeStatsInterval 주기(또는 flush) 마다 로그 하나로 기록
+#if LOG_COMPILE_MIN_LEVEL <= 0
+#define LOG_SCOPE(name) LOG_SCOPE_AT_CALL_SITE(name, false)
+#define LOG_SCOPE_STATS(name) LOG_SCOPE_AT_CALL_SITE(name, true)
+#else
+#define LOG_SCOPE(name) LOG_DISABLED_AT_COMPILE_TIME(name)
+#define LOG_SCOPE_STATS(name) LOG_DISABLED_AT_COMPILE_TIME(name)
+#endif
+
+#endif // CLogScope_H
@@ -0,0 +1,209 @@
+﻿#include "pch.h"
+#include "LogScopeStats.h"
+#include "Logger.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    const unsigned long long kNoMinimum = (std::numeric_limits<unsigned long long>::max)();
+
+    // floor(log2(nanoseconds)) 를 히스토그램 칸 번호로 사용
+    int bucketIndex(unsigned long long nanos) {
+        int index = 0;
+        while (nanos > 1 && index < SLogScopeSummary::kBucketCount - 1) {
+            nanos >>= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    // 소유 스레드만 쓰는 값 : 원자적 증가 대신 load + store
+    void addOwned(std::atomic<unsigned long long>& value, unsigned long long amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+}
+
+const int SLogScopeSummary::kBucketCount;
+const unsigned CLogScopeStats::kMaxScopes;
+const unsigned CLogScopeStats::kChunkSize;
+
+CLogScopeStats::SThreadScopeStats::SThreadScopeStats() {
+    for (auto& chunk : chunks) {
+        chunk.store(nullptr);
+    }
+    released.store(false);
+}
+
+CLogScopeStats::SThreadScopeStats::~SThreadScopeStats() {
+    for (auto& chunk : chunks) {
+        delete chunk.load();
+    }
+}
+
+CLogScopeStats::CLogScopeStats() {
+    scopeCount.store(0);
+    for (unsigned i = 0; i < kMaxScopes; ++i) {
+        scopeSites[i].store(nullptr);
+        scopeNames[i].store(nullptr);
+    }
+}
+
+CLogScopeStats::~CLogScopeStats() {
+}
+
+/// <summary>
+/// 처음 실행된 스코프에 번호를 붙인다. 번호를 다 쓰면 0 (집계하지 않음)
+/// </summary>
+unsigned CLogScopeStats::registerScope(const SLogCallSite& callSite, const char* name) {
+    std::lock_guard<std::mutex> lock(scopeRegistryMutex);
+    unsigned index = callSite.siteState->scopeIndex.load(std::memory_order_relaxed);
+    if (index != 0) {
+        return index;
+    }
+    unsigned count = scopeCount.load(std::memory_order_relaxed);
+    if (count >= kMaxScopes) {
+        return 0;
+    }
+    scopeSites[count].store(&callSite, std::memory_order_relaxed);
+    scopeNames[count].store(name, std::memory_order_relaxed);
+    scopeCount.store(count + 1, std::memory_order_release);
+    callSite.siteState->scopeIndex.store(count + 1, std::memory_order_relaxed);
+    return count + 1;
+}
+
+/// <summary>
+/// 현재 스레드의 누적값. 처음 호출할 때 목록에 등록하고, 스레드가 끝나면 released 로 표시한다.
+/// </summary>
+CLogScopeStats::SThreadScopeStats& CLogScopeStats::getThreadStats() {
+    struct SThreadHolder {
+        std::shared_ptr<SThreadScopeStats> stats;
+        ~SThreadHolder() {
+            if (stats) {
+                stats->released.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local SThreadHolder holder;
+    if (!holder.stats) {
+        holder.stats = std::make_shared<SThreadScopeStats>();
+        std::lock_guard<std::mutex> lock(threadRegistryMutex);
+        threadStats.push_back(holder.stats);
+    }
+    return *holder.stats;
+}
+
+/// <summary>
+/// 실행 시간 하나를 현재 스레드의 누적값에 더한다.
+/// </summary>
+void CLogScopeStats::record(const SLogCallSite& callSite, const char* name, unsigned long long elapsedNanos) {
+    unsigned index = callSite.siteState->scopeIndex.load(std::memory_order_relaxed);
+    if (index == 0 && (index = registerScope(callSite, name)) == 0) {
+        return;
+    }
+    --index;
+
+    SThreadScopeStats& stats = getThreadStats();
+    std::atomic<SScopeChunk*>& chunkSlot = stats.chunks[index / kChunkSize];
+    SScopeChunk* chunk = chunkSlot.load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        chunk = new SScopeChunk();
+        for (auto& accumulator : chunk->accumulators) {
+            accumulator.count.store(0, std::memory_order_relaxed);
+            accumulator.totalNanos.store(0, std::memory_order_relaxed);
+            accumulator.minNanos.store(kNoMinimum, std::memory_order_relaxed);
+            accumulator.maxNanos.store(0, std::memory_order_relaxed);
+            for (auto& bucket : accumulator.buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            accumulator.reportedCount = 0;
+            accumulator.reportedTotal = 0;
+            std::fill(accumulator.reportedBuckets, accumulator.reportedBuckets + SLogScopeSummary::kBucketCount, 0ULL);
+        }
+        chunkSlot.store(chunk, std::memory_order_release);
+    }
+
+    SScopeAccumulator& accumulator = chunk->accumulators[index % kChunkSize];
+    addOwned(accumulator.totalNanos, elapsedNanos);
+    addOwned(accumulator.buckets[bucketIndex(elapsedNanos)], 1);
+    unsigned long long minNanos = accumulator.minNanos.load(std::memory_order_relaxed);
+    while (elapsedNanos < minNanos
+        && !accumulator.minNanos.compare_exchange_weak(minNanos, elapsedNanos, std::memory_order_relaxed)) {
+    }
+    unsigned long long maxNanos = accumulator.maxNanos.load(std::memory_order_relaxed);
+    while (elapsedNanos > maxNanos
+        && !accumulator.maxNanos.compare_exchange_weak(maxNanos, elapsedNanos, std::memory_order_relaxed)) {
+    }
+    // count 를 마지막에 올려서, collect 가 count 를 읽은 뒤에는 합계와 히스토그램도 반영되어 있도록 한다.
+    accumulator.count.store(accumulator.count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/// <summary>
+/// 모든 스레드의 누적값에서 지난 collect 이후 늘어난 만큼을 스코프별로 합친다.
+/// collect 는 한 번에 한 스레드만 호출해야 한다. (보고 스레드 또는 flush, CLogger 가 직렬화)
+/// </summary>
+void CLogScopeStats::collect(std::vector<SLogScopeSummary>& summaries) {
+    unsigned count = scopeCount.load(std::memory_order_acquire);
+    if (count == 0) {
+        return;
+    }
+    std::vector<SLogScopeSummary> totals(count);
+    for (unsigned i = 0; i < count; ++i) {
+        SLogScopeSummary& total = totals[i];
+        total.callSite = scopeSites[i].load(std::memory_order_relaxed);
+        total.name = scopeNames[i].load(std::memory_order_relaxed);
+        total.count = 0;
+        total.totalNanos = 0;
+        total.minNanos = kNoMinimum;
+        total.maxNanos = 0;
+        std::fill(total.buckets, total.buckets + SLogScopeSummary::kBucketCount, 0ULL);
+    }
+
+    std::vector<std::shared_ptr<SThreadScopeStats>> threads;
+    {
+        std::lock_guard<std::mutex> lock(threadRegistryMutex);
+        threads = threadStats;
+    }
+    for (const auto& stats : threads) {
+        // released 를 먼저 읽어야, 종료 직전에 기록한 값까지 합친 뒤 목록에서 제거할 수 있다.
+        bool released = stats->released.load(std::memory_order_acquire);
+        for (unsigned i = 0; i < count; ++i) {
+            SScopeChunk* chunk = stats->chunks[i / kChunkSize].load(std::memory_order_acquire);
+            if (chunk == nullptr) {
+                i += kChunkSize - 1 - i % kChunkSize;
+                continue;
+            }
+            SScopeAccumulator& accumulator = chunk->accumulators[i % kChunkSize];
+            unsigned long long recorded = accumulator.count.load(std::memory_order_acquire);
+            if (recorded == accumulator.reportedCount) {
+                continue;
+            }
+            SLogScopeSummary& total = totals[i];
+            total.count += recorded - accumulator.reportedCount;
+            accumulator.reportedCount = recorded;
+            unsigned long long totalNanos = accumulator.totalNanos.load(std::memory_order_relaxed);
+            total.totalNanos += totalNanos - accumulator.reportedTotal;
+            accumulator.reportedTotal = totalNanos;
+            for (int b = 0; b < SLogScopeSummary::kBucketCount; ++b) {
+                unsigned long long bucket = accumulator.buckets[b].load(std::memory_order_relaxed);
+                total.buckets[b] += bucket - accumulator.reportedBuckets[b];
+                accumulator.reportedBuckets[b] = bucket;
+            }
+            total.minNanos = (std::min)(total.minNanos, accumulator.minNanos.exchange(kNoMinimum, std::memory_order_relaxed));
+            total.maxNanos = (std::max)(total.maxNanos, accumulator.maxNanos.exchange(0, std::memory_order_relaxed));
+        }
+        if (released) {
+            std::lock_guard<std::mutex> lock(threadRegistryMutex);
+            threadStats.erase(std::remove(threadStats.begin(), threadStats.end(), stats), threadStats.end());
+        }
+    }
+
+    for (auto& total : totals) {
+        if (total.count == 0) {
+            continue;
+        }
+        if (total.minNanos > total.maxNanos) {
+            total.minNanos = total.maxNanos;
+        }
+        summaries.push_back(total);
+    }
+}
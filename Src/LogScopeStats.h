@@ -0,0 +1,86 @@
+﻿// CLogScopeStats.h
+#ifndef CLogScopeStats_H
+#define CLogScopeStats_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "LogRateLimiter.h"
+
+// LOG_SCOPE_STATS 집계 결과 (한 보고 주기 동안 모든 스레드의 합)
+struct SLogScopeSummary {
+    static const int kBucketCount = 40;     // i 번째 : [2^i, 2^(i+1)) nanoseconds, 마지막은 그 이상 전부
+
+    const SLogCallSite* callSite;
+    const char* name;
+    unsigned long long count;
+    unsigned long long totalNanos;
+    unsigned long long minNanos;
+    unsigned long long maxNanos;
+    unsigned long long buckets[kBucketCount];
+};
+
+// LOG_SCOPE_STATS 의 스코프별 실행 시간 집계
+// 스레드마다 자신의 누적값만 갱신하고(락, 공유 쓰기 없음), 보고할 때 collect 가 모든 스레드의 값을 합친다.
+class CLogScopeStats {
+public:
+    static const unsigned kMaxScopes = 1024;
+
+    CLogScopeStats();
+    ~CLogScopeStats();
+
+    // 실행 시간 하나 기록 (스코프를 빠져나가는 스레드에서 호출)
+    void record(const SLogCallSite& callSite, const char* name, unsigned long long elapsedNanos);
+    // 지난 collect 이후 기록된 값을 스코프별로 합쳐서 꺼낸다. (보고 스레드 / flush)
+    void collect(std::vector<SLogScopeSummary>& summaries);
+
+private:
+    CLogScopeStats(const CLogScopeStats&) = delete;
+    CLogScopeStats& operator=(const CLogScopeStats&) = delete;
+
+    static const unsigned kChunkSize = 32;
+
+    // 스레드 하나의 스코프 하나 누적값
+    // count/total/buckets 는 소유 스레드만 쓰고(load + store), collect 는 지난번에 읽은 값과의 차이만 가져간다.
+    // min/max 는 collect 가 주기마다 초기화하므로 compare_exchange 로 갱신한다.
+    struct SScopeAccumulator {
+        std::atomic<unsigned long long> count;
+        std::atomic<unsigned long long> totalNanos;
+        std::atomic<unsigned long long> minNanos;
+        std::atomic<unsigned long long> maxNanos;
+        std::atomic<unsigned long long> buckets[SLogScopeSummary::kBucketCount];
+        // collect 전용
+        unsigned long long reportedCount;
+        unsigned long long reportedTotal;
+        unsigned long long reportedBuckets[SLogScopeSummary::kBucketCount];
+    };
+
+    struct SScopeChunk {
+        SScopeAccumulator accumulators[kChunkSize];
+    };
+
+    // 스레드별 누적값. 스코프 번호 / kChunkSize 번째 묶음을 처음 쓸 때 할당한다.
+    struct SThreadScopeStats {
+        std::atomic<SScopeChunk*> chunks[kMaxScopes / kChunkSize];
+        std::atomic<bool> released;     // 스레드 종료. 다음 collect 후 목록에서 제거
+        SThreadScopeStats();
+        ~SThreadScopeStats();
+    };
+
+    unsigned registerScope(const SLogCallSite& callSite, const char* name);
+    SThreadScopeStats& getThreadStats();
+
+    // 스코프 번호 -> 호출 위치/이름 (번호는 1 부터, SLogSiteState::scopeIndex 에 캐시)
+    std::atomic<unsigned> scopeCount;
+    std::atomic<const SLogCallSite*> scopeSites[kMaxScopes];
+    std::atomic<const char*> scopeNames[kMaxScopes];
+    std::mutex scopeRegistryMutex;
+
+    // 스레드가 처음 LOG_SCOPE_STATS 를 지날 때 등록
+    std::mutex threadRegistryMutex;
+    std::vector<std::shared_ptr<SThreadScopeStats>> threadStats;
+};
+
+#endif // CLogScopeStats_H
@@ -0,0 +1,391 @@
+﻿#include "pch.h"
+#include "LogSharedRing.h"
+#include "Logger.h"
+#include "LogPlatform.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const uint32_t kRingMagic = 0x4C475348;     // "HSGL"
+    const uint32_t kRingVersion = 2;
+    const size_t kCacheLineSize = 64;
+    const size_t kMinSlotSize = 128;
+
+    size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    size_t roundUp(size_t value, size_t unit) {
+        return (value + unit - 1) / unit * unit;
+    }
+
+    // shm_open 이름은 '/' 로 시작해야 한다.
+    std::string sharedMemoryName(const std::string& name) {
+        return !name.empty() && name[0] == '/' ? name : "/" + name;
+    }
+
+    // 슬롯 상태 : (바퀴 번호 << 32) | 소유
+    // 소유는 비어 있음(kSlotFree), 공개됨(kSlotPublished), 그 밖에는 예약해서 쓰는 중인 프로세스 id
+    const uint32_t kSlotFree = 0;
+    const uint32_t kSlotPublished = 0xFFFFFFFF;
+
+    uint64_t slotState(uint32_t lap, uint32_t owner) {
+        return (static_cast<uint64_t>(lap) << 32) | owner;
+    }
+
+    uint32_t stateLap(uint64_t state) {
+        return static_cast<uint32_t>(state >> 32);
+    }
+
+    uint32_t stateOwner(uint64_t state) {
+        return static_cast<uint32_t>(state);
+    }
+
+    // 슬롯 상태의 바퀴 번호가 index 의 바퀴보다 앞서면 양수, 뒤처지면 음수 (32 bit 로 돌아가도 비교 가능)
+    int32_t lapDistance(uint64_t state, uint32_t lap) {
+        return static_cast<int32_t>(stateLap(state) - lap);
+    }
+
+#ifndef _WIN32
+    std::string systemError(const std::string& message, const std::string& name) {
+        return message + ": " + name + " (" + std::strerror(errno) + ")";
+    }
+#endif
+}
+
+// 공유 메모리 맨 앞의 링 정보. magic 은 초기화를 마친 뒤 마지막에 기록한다.
+struct CSharedLogRing::SRingHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t slotCount;
+    uint64_t slotSize;
+    std::atomic<uint32_t> collectorProcessId;       // 링을 만든(꺼내는) 프로세스, 없으면 0
+    alignas(64) std::atomic<uint64_t> writeIndex;   // 다음에 예약할 슬롯 번호 (누적)
+    alignas(64) std::atomic<uint64_t> readIndex;    // 다음에 꺼낼 슬롯 번호 (누적, 수집 프로세스를 다시 시작하면 이어서 사용)
+    std::atomic<uint64_t> droppedCount;
+    std::atomic<uint64_t> abandonedCount;
+};
+
+// 슬롯 헤더. 뒤에 텍스트가 이어진다.
+// state : index / slotCount 번째 바퀴에서 비어 있음 -> 예약(프로세스 id) -> 공개됨 -> 꺼낸 뒤 다음 바퀴의 비어 있음
+// 예약한 프로세스 id 가 예약과 같은 CAS 로 기록되므로, 꺼내는 쪽은 쓰는 중인 슬롯의 주인을 항상 알 수 있다.
+struct CSharedLogRing::SRingSlot {
+    std::atomic<uint64_t> state;
+    uint32_t textSize;
+    uint32_t processId;
+    int64_t wallNanoseconds;
+    uint32_t threadNumber;
+    int32_t level;
+};
+
+// 여러 프로세스가 같은 메모리의 atomic 을 사용하므로 락 없는 구현이어야 한다.
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared log ring needs lock-free atomics");
+
+/// <summary>
+/// 수집 프로세스에서 링 생성
+/// 같은 크기의 링이 이미 있으면 그대로 열어서 남은 로그부터 꺼내고, 다른 수집 프로세스가 사용 중이거나 크기가 다르면 std::runtime_error
+/// </summary>
+/// <param name="name : 공유 메모리 이름 (예: "my_service_log")"></param>
+/// <param name="slotCount : 슬롯 개수 (2의 거듭제곱으로 올림)"></param>
+/// <param name="slotSize : 슬롯 하나의 크기 (byte, 헤더 포함, 64 byte 단위로 올림)"></param>
+std::unique_ptr<CSharedLogRing> CSharedLogRing::create(const std::string& name, size_t slotCount, size_t slotSize) {
+#ifdef _WIN32
+    (void)slotCount;
+    (void)slotSize;
+    throw std::runtime_error("Shared memory log ring is not supported on this platform: " + name);
+#else
+    slotCount = roundUpPowerOfTwo(slotCount < 2 ? 2 : slotCount);
+    slotSize = roundUp(slotSize < kMinSlotSize ? kMinSlotSize : slotSize, kCacheLineSize);
+    size_t mappedSize = slotsOffset() + slotCount * slotSize;
+
+    std::string sharedName = sharedMemoryName(name);
+    int fileDescriptor = shm_open(sharedName.c_str(), O_RDWR | O_CREAT, 0660);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error(systemError("Unable to create shared log ring", sharedName));
+    }
+    struct stat status;
+    if (fstat(fileDescriptor, &status) != 0) {
+        ::close(fileDescriptor);
+        throw std::runtime_error(systemError("Unable to create shared log ring", sharedName));
+    }
+    // 로그를 남기는 프로세스가 매핑한 채로 크기를 줄이면 SIGBUS 가 발생하므로, 크기가 다른 기존 링은 사용하지 않는다.
+    bool existing = status.st_size != 0;
+    if (existing && static_cast<size_t>(status.st_size) != mappedSize) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Shared log ring already exists with a different size: " + sharedName);
+    }
+    if (!existing && ftruncate(fileDescriptor, static_cast<off_t>(mappedSize)) != 0) {
+        ::close(fileDescriptor);
+        throw std::runtime_error(systemError("Unable to resize shared log ring", sharedName));
+    }
+    void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    ::close(fileDescriptor);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error(systemError("Unable to map shared log ring", sharedName));
+    }
+    std::unique_ptr<CSharedLogRing> ring(new CSharedLogRing(name, memory, mappedSize));
+
+    SRingHeader* header = ring->header;
+    bool valid = existing && header->magic.load(std::memory_order_acquire) == kRingMagic
+        && header->version == kRingVersion && header->slotCount == slotCount && header->slotSize == slotSize;
+    if (!valid) {
+        // 새 링 (또는 초기화 도중 종료된 링) : 모든 슬롯이 0 번째 바퀴의 비어 있음
+        new (header) SRingHeader();
+        header->version = kRingVersion;
+        header->slotCount = slotCount;
+        header->slotSize = slotSize;
+        header->collectorProcessId.store(0);
+        header->writeIndex.store(0);
+        header->readIndex.store(0);
+        header->droppedCount.store(0);
+        header->abandonedCount.store(0);
+        char* slots = static_cast<char*>(memory) + slotsOffset();
+        for (size_t i = 0; i < slotCount; ++i) {
+            SRingSlot* slot = new (slots + i * slotSize) SRingSlot();
+            slot->state.store(slotState(0, kSlotFree), std::memory_order_relaxed);
+        }
+        header->magic.store(kRingMagic, std::memory_order_release);
+    }
+    ring->slotCount = slotCount;
+    ring->slotSize = slotSize;
+
+    // 수집 프로세스는 하나만 (이전 수집 프로세스가 종료됐으면 이어받는다)
+    uint32_t collector = header->collectorProcessId.load();
+    while (collector == 0 || !LogPlatform::isProcessAlive(collector)) {
+        if (header->collectorProcessId.compare_exchange_weak(collector, static_cast<uint32_t>(ring->processId))) {
+            ring->collector = true;
+            return ring;
+        }
+    }
+    if (collector == ring->processId) {
+        ring->collector = true;
+        return ring;
+    }
+    throw std::runtime_error("Shared log ring is already collected by process " + std::to_string(collector) + ": " + sharedName);
+#endif
+}
+
+/// <summary>
+/// 로그를 남기는 프로세스에서 수집 프로세스가 만든 링을 연다.
+/// </summary>
+/// <param name="name : CSharedLogRing::create 에 지정한 이름"></param>
+std::unique_ptr<CSharedLogRing> CSharedLogRing::open(const std::string& name) {
+#ifdef _WIN32
+    throw std::runtime_error("Shared memory log ring is not supported on this platform: " + name);
+#else
+    std::string sharedName = sharedMemoryName(name);
+    int fileDescriptor = shm_open(sharedName.c_str(), O_RDWR, 0);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error(systemError("Unable to open shared log ring (is the collector running?)", sharedName));
+    }
+    struct stat status;
+    if (fstat(fileDescriptor, &status) != 0 || static_cast<size_t>(status.st_size) < slotsOffset()) {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Shared log ring is not initialized: " + sharedName);
+    }
+    size_t mappedSize = static_cast<size_t>(status.st_size);
+    void* memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+    ::close(fileDescriptor);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error(systemError("Unable to map shared log ring", sharedName));
+    }
+    std::unique_ptr<CSharedLogRing> ring(new CSharedLogRing(name, memory, mappedSize));
+
+    SRingHeader* header = ring->header;
+    uint32_t magic = header->magic.load(std::memory_order_acquire);
+    if (magic == 0) {
+        throw std::runtime_error("Shared log ring is not initialized yet: " + sharedName);
+    }
+    if (magic != kRingMagic || header->version != kRingVersion
+        || header->slotCount == 0 || (header->slotCount & (header->slotCount - 1)) != 0
+        || header->slotSize < kMinSlotSize || slotsOffset() + header->slotCount * header->slotSize != mappedSize) {
+        throw std::runtime_error("Shared log ring has an unknown format: " + sharedName);
+    }
+    ring->slotCount = static_cast<size_t>(header->slotCount);
+    ring->slotSize = static_cast<size_t>(header->slotSize);
+    return ring;
+#endif
+}
+
+void CSharedLogRing::remove(const std::string& name) {
+#ifndef _WIN32
+    shm_unlink(sharedMemoryName(name).c_str());
+#else
+    (void)name;
+#endif
+}
+
+CSharedLogRing::CSharedLogRing(const std::string& name, void* memory, size_t mappedSize)
+    : name(name), memory(memory), mappedSize(mappedSize), header(static_cast<SRingHeader*>(memory)),
+    slotCount(0), slotSize(0), processId(LogPlatform::processId())
+{
+}
+
+/// <summary>
+/// 매핑 해제. 수집 프로세스면 다음 수집 프로세스가 이어받을 수 있도록 표시를 지운다. (공유 메모리 이름은 남겨 둔다)
+/// </summary>
+CSharedLogRing::~CSharedLogRing() {
+#ifndef _WIN32
+    if (collector) {
+        uint32_t expected = static_cast<uint32_t>(processId);
+        header->collectorProcessId.compare_exchange_strong(expected, 0);
+    }
+    munmap(memory, mappedSize);
+#endif
+}
+
+size_t CSharedLogRing::getTextCapacity() const {
+    return slotSize - sizeof(SRingSlot);
+}
+
+size_t CSharedLogRing::slotsOffset() {
+    return roundUp(sizeof(SRingHeader), kCacheLineSize);
+}
+
+CSharedLogRing::SRingSlot* CSharedLogRing::slotAt(unsigned long long index) const {
+    char* slots = static_cast<char*>(memory) + slotsOffset();
+    return reinterpret_cast<SRingSlot*>(slots + (index & (slotCount - 1)) * slotSize);
+}
+
+uint32_t CSharedLogRing::lapOf(unsigned long long index) const {
+    return static_cast<uint32_t>(index / slotCount);
+}
+
+/// <summary>
+/// 슬롯을 예약해서 로그 한 줄을 넣는다. (락 없음, 파일 입출력 없음)
+/// 슬롯 상태를 비어 있음에서 자신의 프로세스 id 로 바꾼 쪽이 슬롯을 갖고, 그 뒤 writeIndex 를 넘긴다.
+/// writeIndex 를 넘기기 전에 멈춘 프로세스가 있으면 다른 프로세스가 대신 넘긴다.
+/// 슬롯보다 긴 줄은 잘라서 보관하고 마지막을 줄바꿈으로 바꾼다.
+/// </summary>
+/// <returns>링이 가득 찼으면 false</returns>
+bool CSharedLogRing::write(ELogLevel eLogLevel, long long wallNanoseconds, unsigned threadNumber, const char* text, size_t size) {
+    uint32_t owner = static_cast<uint32_t>(processId);
+    uint64_t index = header->writeIndex.load(std::memory_order_relaxed);
+    SRingSlot* slot;
+    uint32_t lap;
+    for (;;) {
+        slot = slotAt(index);
+        lap = lapOf(index);
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        int32_t distance = lapDistance(state, lap);
+        if (distance == 0 && stateOwner(state) == kSlotFree) {
+            if (slot->state.compare_exchange_weak(state, slotState(lap, owner), std::memory_order_acquire,
+                std::memory_order_relaxed)) {
+                uint64_t expected = index;
+                header->writeIndex.compare_exchange_strong(expected, index + 1, std::memory_order_relaxed);
+                break;
+            }
+        }
+        else if (distance == 0) {
+            // 다른 프로세스가 예약했지만 아직 writeIndex 를 넘기지 않음
+            uint64_t expected = index;
+            header->writeIndex.compare_exchange_strong(expected, index + 1, std::memory_order_relaxed);
+            index = header->writeIndex.load(std::memory_order_relaxed);
+        }
+        else if (distance < 0) {
+            // 수집 프로세스가 아직 꺼내지 않은 이전 바퀴의 슬롯 (가득 참)
+            header->droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else {
+            index = header->writeIndex.load(std::memory_order_relaxed);
+        }
+    }
+
+    size_t capacity = getTextCapacity();
+    size_t copySize = size < capacity ? size : capacity;
+    char* slotText = reinterpret_cast<char*>(slot + 1);
+    std::memcpy(slotText, text, copySize);
+    if (copySize < size && copySize > 0) {
+        slotText[copySize - 1] = '\n';
+    }
+    slot->textSize = static_cast<uint32_t>(copySize);
+    slot->wallNanoseconds = wallNanoseconds;
+    slot->processId = owner;
+    slot->threadNumber = threadNumber;
+    slot->level = static_cast<int32_t>(eLogLevel);
+
+    // 예약한 프로세스가 살아 있는 동안에는 아무도 이 슬롯의 상태를 바꾸지 않는다.
+    slot->state.store(slotState(lap, kSlotPublished), std::memory_order_release);
+    return true;
+}
+
+/// <summary>
+/// 공개된 다음 로그를 꺼낸다. (수집 프로세스 전용)
+/// 예약만 되고 공개되지 않은 슬롯은, 예약한 프로세스가 종료된 것을 확인했을 때만 건너뛴다.
+/// 살아 있는 프로세스의 슬롯을 건너뛰면 다음 바퀴에서 그 슬롯을 예약한 프로세스의 로그를 늦게 끝난 쓰기가 덮어쓰므로 기다린다.
+/// </summary>
+/// <param name="ownerCheckInterval : 멈춘 슬롯에서 예약한 프로세스를 다시 확인하는 간격"></param>
+bool CSharedLogRing::read(SRecord& record, std::chrono::milliseconds ownerCheckInterval) {
+    for (;;) {
+        uint64_t index = header->readIndex.load(std::memory_order_relaxed);
+        SRingSlot* slot = slotAt(index);
+        uint32_t lap = lapOf(index);
+        uint64_t state = slot->state.load(std::memory_order_acquire);
+        if (lapDistance(state, lap) > 0) {
+            // 이전 수집 프로세스가 꺼낸 뒤 readIndex 를 갱신하지 못하고 종료됨
+            header->readIndex.store(index + 1, std::memory_order_release);
+            continue;
+        }
+        uint32_t owner = stateOwner(state);
+        if (lapDistance(state, lap) < 0 || owner == kSlotFree) {
+            return false;
+        }
+        if (owner == kSlotPublished) {
+            size_t capacity = getTextCapacity();
+            size_t textSize = slot->textSize < capacity ? slot->textSize : capacity;
+            readText.assign(reinterpret_cast<const char*>(slot + 1), textSize);
+            record.wallNanoseconds = slot->wallNanoseconds;
+            record.processId = slot->processId;
+            record.threadNumber = slot->threadNumber;
+            record.eLogLevel = static_cast<ELogLevel>(slot->level < 0 || slot->level > 3 ? 0 : slot->level);
+            record.text = readText.data();
+            record.textSize = readText.size();
+
+            slot->state.store(slotState(lap + 1, kSlotFree), std::memory_order_release);
+            header->readIndex.store(index + 1, std::memory_order_release);
+            stalledIndex = ~0ULL;
+            return true;
+        }
+
+        // 예약됐지만 아직 공개되지 않은 슬롯 : 처음 만났을 때와 ownerCheckInterval 마다 주인을 확인
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (stalledIndex != index) {
+            stalledIndex = index;
+            nextOwnerCheck = now;
+        }
+        if (now < nextOwnerCheck) {
+            return false;
+        }
+        nextOwnerCheck = now + ownerCheckInterval;
+        if (LogPlatform::isProcessAlive(owner)) {
+            return false;
+        }
+        // 주인이 종료됐으므로 이 슬롯에 더 쓰는 쪽이 없다.
+        if (slot->state.compare_exchange_strong(state, slotState(lap + 1, kSlotFree), std::memory_order_acq_rel)) {
+            header->abandonedCount.fetch_add(1, std::memory_order_relaxed);
+            header->readIndex.store(index + 1, std::memory_order_release);
+            stalledIndex = ~0ULL;
+        }
+    }
+}
+
+unsigned long long CSharedLogRing::getDroppedCount() const {
+    return header->droppedCount.load(std::memory_order_relaxed);
+}
+
+unsigned long long CSharedLogRing::getAbandonedCount() const {
+    return header->abandonedCount.load(std::memory_order_relaxed);
+}
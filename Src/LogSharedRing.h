@@ -0,0 +1,84 @@
+﻿// CSharedLogRing.h
+#ifndef CSharedLogRing_H
+#define CSharedLogRing_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class ELogLevel;
+
+// 여러 프로세스가 로그를 넣고 수집 프로세스(CLogCollector) 하나가 꺼내는 POSIX 공유 메모리 링 (shm_open + mmap)
+// 슬롯 하나에 조립된 로그 한 줄을 보관한다. 슬롯보다 긴 줄은 들어가는 만큼만 보관한다.
+// 넣는 쪽은 락 없이 슬롯 상태를 자신의 프로세스 id 로 바꿔 예약(CAS)하고 내용을 채운 뒤 공개하며, 링이 가득 차면 기다리지 않고 버린다.
+// 예약한 뒤 공개하지 못하고 종료된 프로세스의 슬롯은 꺼내는 쪽이 건너뛴다.
+// 예약한 프로세스가 살아 있으면 아무리 늦어도 건너뛰지 않는다. (건너뛴 슬롯을 다음 바퀴에서 다른 프로세스가 쓰는 동안 덮어쓰지 않도록)
+// Windows 에서는 지원하지 않는다. (생성/열기 시 std::runtime_error)
+class CSharedLogRing {
+public:
+    // 꺼낸 로그 하나 (text 는 다음 read 전까지 유효)
+    struct SRecord {
+        long long wallNanoseconds;      // 1970-01-01 기준 nanoseconds
+        unsigned long processId;
+        unsigned threadNumber;
+        ELogLevel eLogLevel;
+        const char* text;
+        size_t textSize;
+    };
+
+    // 수집 프로세스 : 링을 만든다. 같은 이름/크기의 링이 이미 있으면 남은 로그를 이어서 꺼낸다.
+    // slotCount : 슬롯 개수 (2의 거듭제곱으로 올림), slotSize : 슬롯 하나의 크기 (byte, 헤더 포함)
+    static std::unique_ptr<CSharedLogRing> create(const std::string& name, size_t slotCount, size_t slotSize);
+    // 로그를 남기는 프로세스 : 수집 프로세스가 만든 링을 연다. 없거나 형식이 다르면 std::runtime_error
+    static std::unique_ptr<CSharedLogRing> open(const std::string& name);
+    // 공유 메모리 이름 삭제 (이미 연 프로세스의 매핑은 유지된다)
+    static void remove(const std::string& name);
+
+    ~CSharedLogRing();
+
+    const std::string& getName() const { return name; }
+    size_t getSlotCount() const { return slotCount; }
+    size_t getTextCapacity() const;
+
+    // 로그 한 줄을 넣는다. 링이 가득 찼으면 버리고 false (기다리지 않음)
+    bool write(ELogLevel eLogLevel, long long wallNanoseconds, unsigned threadNumber, const char* text, size_t size);
+
+    // 수집 프로세스 전용 : 다음 로그를 꺼낸다. 없거나 아직 공개되지 않았으면 false
+    // 공개되지 않은 슬롯은 처음 만났을 때와 그 뒤 ownerCheckInterval 마다 예약한 프로세스를 확인하고, 종료됐으면 건너뛴다.
+    bool read(SRecord& record, std::chrono::milliseconds ownerCheckInterval);
+
+    // 링이 가득 차서 버린 로그 / 예약한 프로세스가 공개하기 전에 종료되어 건너뛴 슬롯 (모든 프로세스 합계)
+    unsigned long long getDroppedCount() const;
+    unsigned long long getAbandonedCount() const;
+
+private:
+    struct SRingHeader;
+    struct SRingSlot;
+
+    CSharedLogRing(const std::string& name, void* memory, size_t mappedSize);
+    CSharedLogRing(const CSharedLogRing&) = delete;
+    CSharedLogRing& operator=(const CSharedLogRing&) = delete;
+
+    static size_t slotsOffset();
+    SRingSlot* slotAt(unsigned long long index) const;
+    uint32_t lapOf(unsigned long long index) const;
+
+    std::string name;
+    void* memory;
+    size_t mappedSize;
+    SRingHeader* header;
+    size_t slotCount;
+    size_t slotSize;
+    unsigned long processId;
+    bool collector = false;         // create 로 연 수집 프로세스
+
+    // 꺼내는 쪽의 상태 (수집 프로세스만 사용)
+    unsigned long long stalledIndex = ~0ULL;                    // 예약만 되고 공개되지 않은 슬롯 번호
+    std::chrono::steady_clock::time_point nextOwnerCheck;       // 예약한 프로세스가 살아 있는지 다음에 확인할 시각
+    std::string readText;
+};
+
+#endif // CSharedLogRing_H
@@ -0,0 +1,51 @@
+﻿#include "pch.h"
+#include "LogSharedSink.h"
+#include "LogClock.h"
+#include "LogPlatform.h"
+#include "LogSharedRing.h"
+#include <chrono>
+
+CSharedLogSink::CSharedLogSink(const std::string& ringName)
+    : ring(CSharedLogRing::open(ringName)), processId(LogPlatform::processId())
+{
+    setConcurrentWrite(true);
+}
+
+CSharedLogSink::~CSharedLogSink() {
+    stopDedicatedThread();
+}
+
+const std::string& CSharedLogSink::getRingName() const {
+    return ring->getName();
+}
+
+/// <summary>
+/// 프로세스 id 를 넣어서 직접 조립하므로 CLogger 가 조립한 한 줄은 사용하지 않는다.
+/// </summary>
+bool CSharedLogSink::usesDefaultText() const {
+    return false;
+}
+
+unsigned long long CSharedLogSink::getRingDroppedCount() const {
+    return ring->getDroppedCount();
+}
+
+/// <summary>
+/// 프로세스 id 를 붙여 한 줄로 조립하고 링에 넣는다. (여러 스레드가 동시에 호출)
+/// 수집 프로세스가 시간순으로 정렬할 수 있도록 현재 시각(nanoseconds)을 함께 넣는다.
+/// </summary>
+void CSharedLogSink::write(const SLogEvent& event) {
+    thread_local CLogLineBuffer line;
+    SLogEvent sharedEvent = event;
+    sharedEvent.processId = processId;
+    if (sharedEvent.callSite != nullptr && sharedEvent.format != nullptr) {
+        // 다른 sink 를 위해 조립된 한 줄에는 프로세스 id 가 없다.
+        sharedEvent.text = nullptr;
+        sharedEvent.textSize = 0;
+    }
+    formatText(sharedEvent, line);
+
+    long long wallNanoseconds = event.clock != nullptr ? event.clock->toWallNanoseconds(event.rawTime)
+        : std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    ring->write(event.eLogLevel, wallNanoseconds, event.threadNumber, line.data(), line.size());
+}
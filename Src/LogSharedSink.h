@@ -0,0 +1,35 @@
+﻿// CSharedLogSink.h
+#ifndef CSharedLogSink_H
+#define CSharedLogSink_H
+
+#include <memory>
+#include <string>
+
+#include "LogSink.h"
+
+class CSharedLogRing;
+
+// 여러 프로세스가 같은 로그파일에 기록할 때 사용하는 출력 대상
+// 조립한 한 줄(앞에 "[pid N] ")을 수집 프로세스(CLogCollector)가 만든 공유 메모리 링에 넣기만 하고, 파일 입출력은 하지 않는다.
+// 링이 가득 차면 기다리지 않고 버린다. (getRingDroppedCount)
+// 로그 호출 스레드에서 락 없이 바로 넣으므로 전용 출력 스레드가 필요 없다.
+class CSharedLogSink : public CLogSink {
+public:
+    // 링을 연다. 수집 프로세스가 링을 만들기 전이면 std::runtime_error
+    explicit CSharedLogSink(const std::string& ringName);
+    ~CSharedLogSink();
+
+    const std::string& getRingName() const;
+    bool usesDefaultText() const override;
+    // 링이 가득 차서 버린 로그 (모든 프로세스 합계)
+    unsigned long long getRingDroppedCount() const;
+
+protected:
+    void write(const SLogEvent& event) override;
+
+private:
+    std::unique_ptr<CSharedLogRing> ring;
+    unsigned long processId;
+};
+
+#endif // CSharedLogSink_H
@@ -0,0 +1,329 @@
+﻿#include "pch.h"
+#include "LogSink.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    // 큐 슬롯마다 미리 확보하는 문자열 용량 (이보다 긴 로그만 힙을 새로 사용)
+    const size_t kQueuedTextReserve = 256;
+}
+
+namespace LogText {
+
+    void appendPrefix(CLogLineBuffer& line, const CLogClock& clock, long long rawTime, SLogStringView levelTag) {
+        char timeText[32];
+        size_t timeSize = clock.format(rawTime, timeText, sizeof(timeText));
+
+        line.append('[');
+        line.append(timeText, timeSize);
+        line.append("]\t ", 3);
+        line.append(levelTag.data, levelTag.size);
+    }
+
+    void appendSuffix(CLogLineBuffer& line, const SLogCallSite& callSite) {
+        line.append(" (Log from ", 11);
+        line.append(callSite.functionName);
+        line.append(" at ", 4);
+        line.append(callSite.fileName);
+        line.append(':');
+        line.appendInt(callSite.lineNumber);
+        line.append(")\n", 2);
+    }
+
+    void appendSampleRate(CLogLineBuffer& line, float sampleRate) {
+        if (sampleRate >= 1.0f) {
+            return;
+        }
+        char text[32];
+        int size = std::snprintf(text, sizeof(text), " sample_rate=%g", static_cast<double>(sampleRate));
+        line.append(text, static_cast<size_t>(size));
+    }
+
+    /// <summary>
+    /// event 를 기본 형식의 한 줄로 조립
+    /// </summary>
+    void render(CLogLineBuffer& line, const SLogEvent& event) {
+        line.clear();
+        if (event.text != nullptr || event.callSite == nullptr) {
+            line.append(event.text, event.textSize);
+            return;
+        }
+        appendPrefix(line, *event.clock, event.rawTime, event.callSite->levelTag);
+        if (event.processId != 0) {
+            line.append("[pid ", 5);
+            line.appendInt(static_cast<long long>(event.processId));
+            line.append("] ", 2);
+        }
+        if (event.loggerName != nullptr && event.loggerName[0] != '\0') {
+            line.append('[');
+            line.append(event.loggerName);
+            line.append("] ", 2);
+        }
+        LogArgs::render(line, event.format, event.args, event.argsSize, event.argCount);
+        appendSampleRate(line, event.sampleRate);
+        appendSuffix(line, *event.callSite);
+    }
+}
+
+CLogSink::CLogSink()
+{
+    minLevel.store(static_cast<int>(ELogLevel::LOG_DEBUG));
+    droppedCount.store(0);
+}
+
+CLogSink::~CLogSink() {
+    stopDedicatedThread();
+}
+
+void CLogSink::setMinLevel(ELogLevel eLogLevel) {
+    minLevel.store(static_cast<int>(eLogLevel), std::memory_order_relaxed);
+}
+
+ELogLevel CLogSink::getMinLevel() const {
+    return static_cast<ELogLevel>(minLevel.load(std::memory_order_relaxed));
+}
+
+void CLogSink::setFormatter(LogFormatter formatter) {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    this->formatter = std::move(formatter);
+}
+
+bool CLogSink::usesDefaultText() const {
+    return !formatter;
+}
+
+/// <summary>
+/// 전용 출력 스레드 시작
+/// 로그 호출 스레드(비동기 모드면 writer 스레드)는 큐에 복사만 하고, 출력은 전용 스레드가 모아서 처리한다.
+/// </summary>
+/// <param name="queueCapacity : 대기할 수 있는 로그 개수"></param>
+/// <param name="eOverflowPolicy : 큐가 가득 찼을 때의 처리 방식"></param>
+void CLogSink::enableDedicatedThread(size_t queueCapacity, EOverflowPolicy eOverflowPolicy) {
+    if (deliveryThread.joinable()) {
+        return;
+    }
+    queue.resize(queueCapacity < 2 ? 2 : queueCapacity);
+    for (auto& slot : queue) {
+        slot.text.reserve(kQueuedTextReserve);
+        slot.args.reserve(kQueuedTextReserve);
+    }
+    queueHead = 0;
+    queueTail = 0;
+    overflowPolicy = eOverflowPolicy;
+    stopDelivery = false;
+    deliveryThread = std::thread(&CLogSink::deliveryThreadMain, this);
+}
+
+void CLogSink::stopDedicatedThread() {
+    if (!deliveryThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopDelivery = true;
+    }
+    queueNotEmpty.notify_one();
+    deliveryThread.join();
+}
+
+/// <summary>
+/// 로그 전달. 전용 스레드를 사용하면 큐에 복사하고, 아니면 바로 출력한다.
+/// </summary>
+/// <param name="event"></param>
+void CLogSink::submit(const SLogEvent& event) {
+    if (!deliveryThread.joinable()) {
+        if (concurrentWrite) {
+            write(event);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        write(event);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    size_t capacity = queue.size();
+    bool lowLevel = event.eLogLevel == ELogLevel::LOG_DEBUG || event.eLogLevel == ELogLevel::LOG_INFO;
+    if (overflowPolicy == EOverflowPolicy::DROP_DEBUG_INFO_FIRST && lowLevel
+        && queueHead - queueTail >= capacity / 4 * 3) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    while (queueHead - queueTail >= capacity) {
+        if (overflowPolicy == EOverflowPolicy::DROP_NEWEST
+            || (overflowPolicy == EOverflowPolicy::DROP_DEBUG_INFO_FIRST && lowLevel)) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        queueNotFull.wait(lock);
+    }
+
+    // 전용 스레드는 queueTail 이후 슬롯만 읽으므로, queueHead 위치의 슬롯은 락 안에서 바로 채워도 된다.
+    SQueuedEvent& slot = queue[queueHead % capacity];
+    slot.event = event;
+    if (event.text != nullptr) {
+        slot.text.assign(event.text, event.textSize);
+        slot.event.text = slot.text.data();
+    }
+    if (event.args != nullptr) {
+        slot.args.assign(event.args, event.argsSize);
+        slot.event.args = slot.args.data();
+    }
+    bool wasEmpty = queueHead == queueTail;
+    ++queueHead;
+    lock.unlock();
+    if (wasEmpty) {
+        queueNotEmpty.notify_one();
+    }
+}
+
+/// <summary>
+/// 지금까지 전달된 로그를 모두 출력하고 출력 대상을 flush
+/// </summary>
+void CLogSink::flush() {
+    if (deliveryThread.joinable()) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        size_t target = queueHead;
+        queueNotEmpty.notify_one();
+        queueDrained.wait(lock, [&] { return queueTail >= target; });
+    }
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    flushOutput();
+}
+
+void CLogSink::poll() {
+    // 전용 스레드는 스스로 확인한다.
+    if (deliveryThread.joinable()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    onPoll();
+}
+
+/// <summary>
+/// setFormatter 로 지정한 형식, 없으면 기본 형식으로 조립
+/// </summary>
+void CLogSink::formatText(const SLogEvent& event, CLogLineBuffer& line) const {
+    if (formatter) {
+        line.clear();
+        formatter(event, line);
+        return;
+    }
+    LogText::render(line, event);
+}
+
+/// <summary>
+/// 전용 스레드 본체. 큐에 쌓인 로그를 한 번에 꺼내서 출력한다.
+/// </summary>
+void CLogSink::deliveryThreadMain() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    for (;;) {
+        queueNotEmpty.wait_for(lock, std::chrono::milliseconds(50), [&] {
+            return stopDelivery || queueHead != queueTail;
+        });
+        size_t head = queueHead;
+        size_t tail = queueTail;
+        bool stopping = stopDelivery;
+        lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> sinkLock(sinkMutex);
+            for (size_t position = tail; position != head; ++position) {
+                write(queue[position % queue.size()].event);
+            }
+            if (head != tail) {
+                onBatchEnd();
+            }
+            onPoll();
+        }
+
+        lock.lock();
+        queueTail = head;
+        queueNotFull.notify_all();
+        queueDrained.notify_all();
+        if (stopping && queueHead == queueTail) {
+            return;
+        }
+    }
+}
+
+CConsoleLogSink::CConsoleLogSink()
+{
+}
+
+CConsoleLogSink::~CConsoleLogSink() {
+    stopDedicatedThread();
+    std::cout.flush();
+}
+
+void CConsoleLogSink::write(const SLogEvent& event) {
+    if (event.text != nullptr && usesDefaultText()) {
+        std::cout.write(event.text, static_cast<std::streamsize>(event.textSize));
+        return;
+    }
+    thread_local CLogLineBuffer line;
+    formatText(event, line);
+    std::cout.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+void CConsoleLogSink::flushOutput() {
+    std::cout.flush();
+}
+
+/// <summary>
+/// 최근 로그를 보관하는 메모리 sink
+/// </summary>
+/// <param name="capacity : 보관할 로그 개수"></param>
+CMemoryLogSink::CMemoryLogSink(size_t capacity)
+    : lines(capacity < 1 ? 1 : capacity)
+{
+}
+
+CMemoryLogSink::~CMemoryLogSink() {
+    stopDedicatedThread();
+}
+
+std::vector<std::string> CMemoryLogSink::getLines() const {
+    std::lock_guard<std::mutex> lock(linesMutex);
+    std::vector<std::string> result;
+    result.reserve(lineCount);
+    size_t first = (nextLine + lines.size() - lineCount) % lines.size();
+    for (size_t i = 0; i < lineCount; ++i) {
+        result.push_back(lines[(first + i) % lines.size()]);
+    }
+    return result;
+}
+
+void CMemoryLogSink::clear() {
+    std::lock_guard<std::mutex> lock(linesMutex);
+    nextLine = 0;
+    lineCount = 0;
+}
+
+void CMemoryLogSink::write(const SLogEvent& event) {
+    thread_local CLogLineBuffer line;
+    formatText(event, line);
+    std::lock_guard<std::mutex> lock(linesMutex);
+    // 이전 문자열의 용량을 재사용
+    lines[nextLine].assign(line.data(), line.size());
+    nextLine = (nextLine + 1) % lines.size();
+    if (lineCount < lines.size()) {
+        ++lineCount;
+    }
+}
+
+CCallbackLogSink::CCallbackLogSink(LogCallback callback)
+    : callback(std::move(callback))
+{
+}
+
+CCallbackLogSink::~CCallbackLogSink() {
+    stopDedicatedThread();
+}
+
+void CCallbackLogSink::write(const SLogEvent& event) {
+    thread_local CLogLineBuffer line;
+    formatText(event, line);
+    callback(event, line.data(), line.size());
+}
@@ -0,0 +1,182 @@
+﻿// CLogSink.h
+#ifndef CLogSink_H
+#define CLogSink_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logger.h"
+
+// 출력 대상(sink)으로 전달되는 로그 하나
+// LOG_* 매크로로 남긴 로그는 호출 위치/포맷/인자를 그대로 가지고 있고,
+// 호출 위치 없이 조립된 로그(logMessage 직접 호출)는 text 만 가지고 있다.
+struct SLogEvent {
+    ELogLevel eLogLevel = ELogLevel::LOG_DEBUG;
+    unsigned threadNumber = 0;
+    long long rawTime = 0;                      // clock 의 원시 시간 값
+    const CLogClock* clock = nullptr;
+
+    const char* text = nullptr;                 // 기본 형식으로 조립된 한 줄 (없으면 nullptr)
+    size_t textSize = 0;
+
+    const SLogCallSite* callSite = nullptr;     // 호출 위치 (없으면 nullptr)
+    const char* format = nullptr;
+    const char* args = nullptr;                 // LogArgs 형식의 인자
+    size_t argsSize = 0;
+    unsigned argCount = 0;
+    float sampleRate = 1.0f;                    // 샘플링으로 기록된 로그면 기록 비율 (개수를 1 / sampleRate 배로 환산)
+    const char* loggerName = nullptr;           // 이름 있는 로거(CNamedLogger)로 남긴 로그면 로거 이름
+    unsigned long processId = 0;                // 공유 메모리 링(CSharedLogSink)으로 보내는 로그면 프로세스 id
+    bool scope = false;                         // LOG_SCOPE 구간 기록 (CLogger::endScope, 인자는 elapsed_us, depth 필드)
+};
+
+// 기본 텍스트 형식 : [시간]\t [종류]\t표시 메시지 (Log from 함수 at 파일:줄)
+namespace LogText {
+    void appendPrefix(CLogLineBuffer& line, const CLogClock& clock, long long rawTime, SLogStringView levelTag);
+    void appendSuffix(CLogLineBuffer& line, const SLogCallSite& callSite);
+    // 샘플링으로 기록된 로그면 메시지 뒤에 " sample_rate=비율" 을 붙인다.
+    void appendSampleRate(CLogLineBuffer& line, float sampleRate);
+    // event 를 기본 형식의 한 줄로 조립 (이미 조립된 text 가 있으면 그대로 복사)
+    void render(CLogLineBuffer& line, const SLogEvent& event);
+}
+
+// 로그 출력 대상 (파일, 콘솔, 메모리, 사용자 함수 ...)
+// sink 마다 최소 레벨과 형식을 따로 가지며, write 는 sink 별 mutex 로 직렬화된다.
+// enableDedicatedThread 를 호출하면 로그를 큐에 넣고 sink 전용 스레드에서 출력하므로,
+// 느린 sink(콘솔 등) 때문에 다른 sink 나 로그 호출 스레드가 기다리지 않는다.
+class CLogSink {
+public:
+    // 사용자 형식 : event 를 line 에 조립
+    typedef std::function<void(const SLogEvent& event, CLogLineBuffer& line)> LogFormatter;
+
+    CLogSink();
+    virtual ~CLogSink();
+
+    void setMinLevel(ELogLevel eLogLevel);
+    ELogLevel getMinLevel() const;
+    bool accepts(ELogLevel eLogLevel) const {
+        return static_cast<int>(eLogLevel) >= minLevel.load(std::memory_order_relaxed);
+    }
+    // 로그를 남기기 전에 설정. nullptr 이면 기본 형식
+    void setFormatter(LogFormatter formatter);
+    // 기본 형식의 한 줄을 사용하는 sink 인지 (CLogger 가 한 번만 조립해서 넘겨준다)
+    virtual bool usesDefaultText() const;
+
+    // 전용 출력 스레드 사용 (로그를 남기기 전에 호출)
+    // queueCapacity : 대기할 수 있는 로그 개수, eOverflowPolicy : 큐가 가득 찼을 때의 처리 방식
+    void enableDedicatedThread(size_t queueCapacity = 4096,
+        EOverflowPolicy eOverflowPolicy = EOverflowPolicy::DROP_DEBUG_INFO_FIRST);
+    bool hasDedicatedThread() const { return deliveryThread.joinable(); }
+
+    // CLogger 가 호출. 전용 스레드를 사용하면 큐에 복사하고, 아니면 바로 write
+    void submit(const SLogEvent& event);
+    // 큐에 남은 로그를 모두 출력하고 출력 대상을 flush
+    void flush();
+    // 주기적으로 확인할 작업 (flush 간격, 파일 교체 등)
+    void poll();
+    unsigned long long getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+
+protected:
+    // sink 별 mutex 를 잡은 상태(또는 전용 스레드)에서 호출된다.
+    virtual void write(const SLogEvent& event) = 0;
+    virtual void flushOutput() {}
+    // 전용 스레드가 큐에서 꺼낸 로그 묶음을 모두 write 한 뒤 호출 (묶음의 텍스트는 이 호출까지 유지된다)
+    virtual void onBatchEnd() {}
+    virtual void onPoll() {}
+
+    // setFormatter 로 지정한 형식, 없으면 기본 형식으로 조립
+    void formatText(const SLogEvent& event, CLogLineBuffer& line) const;
+    // true 면 직접 출력할 때 mutex 없이 write 를 호출한다. (write 가 스스로 동시 호출을 처리하는 경우)
+    void setConcurrentWrite(bool enable) { concurrentWrite = enable; }
+    // 파생 클래스의 소멸자에서 호출 (전용 스레드가 파생 클래스의 write 를 호출하지 않도록)
+    void stopDedicatedThread();
+    // 설정 변경을 write 와 직렬화할 때 사용
+    std::mutex& getSinkMutex() const { return sinkMutex; }
+
+private:
+    CLogSink(const CLogSink&) = delete;
+    CLogSink& operator=(const CLogSink&) = delete;
+
+    // 전용 스레드 큐의 슬롯. 문자열은 미리 확보한 용량을 재사용한다.
+    struct SQueuedEvent {
+        SLogEvent event;
+        std::string text;
+        std::string args;
+    };
+
+    void deliveryThreadMain();
+
+    std::atomic<int> minLevel;
+    LogFormatter formatter;
+    bool concurrentWrite = false;
+    mutable std::mutex sinkMutex;
+
+    // 전용 스레드 큐 (여러 스레드가 넣고 전용 스레드만 꺼낸다)
+    std::vector<SQueuedEvent> queue;
+    size_t queueHead = 0;           // 다음에 넣을 위치 (누적)
+    size_t queueTail = 0;           // 다음에 꺼낼 위치 (누적)
+    EOverflowPolicy overflowPolicy = EOverflowPolicy::DROP_DEBUG_INFO_FIRST;
+    bool stopDelivery = false;
+    std::mutex queueMutex;
+    std::condition_variable queueNotEmpty;
+    std::condition_variable queueNotFull;
+    std::condition_variable queueDrained;
+    std::thread deliveryThread;
+    std::atomic<unsigned long long> droppedCount;
+};
+
+// 콘솔(std::cout) 출력
+class CConsoleLogSink : public CLogSink {
+public:
+    CConsoleLogSink();
+    ~CConsoleLogSink();
+
+protected:
+    void write(const SLogEvent& event) override;
+    void flushOutput() override;
+};
+
+// 최근 로그 N 개를 메모리에 보관 (링 버퍼)
+class CMemoryLogSink : public CLogSink {
+public:
+    explicit CMemoryLogSink(size_t capacity);
+    ~CMemoryLogSink();
+
+    // 오래된 순서로 복사해서 반환
+    std::vector<std::string> getLines() const;
+    void clear();
+
+protected:
+    void write(const SLogEvent& event) override;
+
+private:
+    mutable std::mutex linesMutex;
+    std::vector<std::string> lines;
+    size_t nextLine = 0;
+    size_t lineCount = 0;
+};
+
+// 사용자 함수로 전달
+class CCallbackLogSink : public CLogSink {
+public:
+    // text : 형식에 맞춰 조립된 한 줄
+    typedef std::function<void(const SLogEvent& event, const char* text, size_t size)> LogCallback;
+
+    explicit CCallbackLogSink(LogCallback callback);
+    ~CCallbackLogSink();
+
+protected:
+    void write(const SLogEvent& event) override;
+
+private:
+    LogCallback callback;
+};
+
+#endif // CLogSink_H
@@ -0,0 +1,111 @@
+﻿#include "pch.h"
+#include "LogSnapshot.h"
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    // 스레드 하나의 읽기 구간 번호. 홀수면 구간 안이고, 소유 스레드만 바꾼다.
+    // 스레드가 끝나면 released 로 표시하고 다음에 시작한 스레드가 재사용한다. (해제하지 않음)
+    struct SReaderSlot {
+        std::atomic<unsigned long long> sequence;
+        std::atomic<bool> released;
+    };
+
+    struct SReaderRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<SReaderSlot>> slots;
+        std::vector<std::shared_ptr<const void>> retired;   // 구간 안에서 교체해서 아직 놓지 못한 스냅샷
+    };
+
+    // 정적 객체 소멸 중(CLogger 소멸자)에도 사용하므로 해제하지 않는다.
+    SReaderRegistry& getRegistry() {
+        static SReaderRegistry* registry = new SReaderRegistry();
+        return *registry;
+    }
+
+    struct SReaderHolder {
+        SReaderSlot* slot = nullptr;
+        unsigned depth = 0;             // 중첩된 구간 수 (sink 가 로그를 남기는 경우)
+        ~SReaderHolder() {
+            if (slot != nullptr) {
+                slot->released.store(true, std::memory_order_release);
+                slot = nullptr;
+            }
+        }
+    };
+
+    SReaderHolder& getHolder() {
+        thread_local SReaderHolder holder;
+        return holder;
+    }
+
+    SReaderSlot* acquireSlot() {
+        SReaderRegistry& registry = getRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto& slot : registry.slots) {
+            if (slot->released.load(std::memory_order_acquire)) {
+                slot->released.store(false, std::memory_order_relaxed);
+                return slot.get();
+            }
+        }
+        std::unique_ptr<SReaderSlot> slot(new SReaderSlot());
+        slot->sequence.store(0, std::memory_order_relaxed);
+        slot->released.store(false, std::memory_order_relaxed);
+        registry.slots.push_back(std::move(slot));
+        return registry.slots.back().get();
+    }
+}
+
+/// <summary>
+/// 읽기 구간 시작. 가장 바깥 구간만 슬롯 번호를 홀수로 바꾼다.
+/// 번호를 바꾼 뒤에 스냅샷 포인터를 읽으므로, 교체하는 쪽은 이 구간을 보거나 이 구간이 새 스냅샷을 본다.
+/// </summary>
+CLogReadSection::CLogReadSection() {
+    SReaderHolder& holder = getHolder();
+    if (holder.depth++ != 0) {
+        return;
+    }
+    if (holder.slot == nullptr) {
+        holder.slot = acquireSlot();
+    }
+    holder.slot->sequence.store(holder.slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+}
+
+CLogReadSection::~CLogReadSection() {
+    SReaderHolder& holder = getHolder();
+    if (--holder.depth != 0) {
+        return;
+    }
+    holder.slot->sequence.store(holder.slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/// <summary>
+/// 교체된 스냅샷을 놓는다. 지금 구간 안에 있는 스레드(홀수 번호)마다 번호가 바뀔 때까지 기다린다.
+/// 기다리는 동안 락을 잡지 않으므로 새로 로그를 남기기 시작하는 스레드는 막지 않는다.
+/// </summary>
+/// <param name="snapshot : 이미 새 스냅샷으로 교체한 이전 스냅샷"></param>
+void CLogReadSection::retire(std::shared_ptr<const void> snapshot) {
+    SReaderRegistry& registry = getRegistry();
+    std::vector<std::shared_ptr<const void>> releasing;
+    std::vector<std::pair<const SReaderSlot*, unsigned long long>> readers;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired.push_back(std::move(snapshot));
+        if (getHolder().depth != 0) {
+            return;
+        }
+        releasing.swap(registry.retired);
+        for (const auto& slot : registry.slots) {
+            unsigned long long sequence = slot->sequence.load(std::memory_order_seq_cst);
+            if ((sequence & 1) != 0) {
+                readers.emplace_back(slot.get(), sequence);
+            }
+        }
+    }
+    for (const auto& reader : readers) {
+        while (reader.first->sequence.load(std::memory_order_acquire) == reader.second) {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,73 @@
+﻿// CLogSnapshot.h
+#ifndef CLogSnapshot_H
+#define CLogSnapshot_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// 로그 호출 경로가 불변 스냅샷(설정, sink 목록)을 읽는 구간
+// 스레드마다 자기 슬롯의 번호만 바꾸므로 락도, 공유 참조 카운트 변경도 없다. (중첩 가능)
+// 스냅샷을 교체한 쪽은 교체 시점에 구간 안에 있던 스레드가 모두 빠져나온 뒤에 이전 스냅샷을 놓는다.
+class CLogReadSection {
+public:
+    CLogReadSection();
+    ~CLogReadSection();
+
+    // 교체된 스냅샷을 넘긴다. 읽고 있던 스레드가 모두 구간을 벗어날 때까지 기다린 뒤 놓는다.
+    // 호출한 스레드가 구간 안에 있으면 기다리지 않고 보관했다가 다음 retire 때 놓는다.
+    static void retire(std::shared_ptr<const void> snapshot);
+
+private:
+    CLogReadSection(const CLogReadSection&) = delete;
+    CLogReadSection& operator=(const CLogReadSection&) = delete;
+};
+
+// 로그 호출 경로에서 읽고 설정을 바꿀 때만 교체하는 불변 스냅샷
+// 읽기는 CLogReadSection 안에서 raw 포인터 load 한 번이고, 소유권(shared_ptr)은 교체하는 쪽만 다룬다.
+// 멤버 형식은 C++ 표준 버전과 관계없이 같다.
+template <typename T>
+class CLogSnapshot {
+public:
+    CLogSnapshot()
+        : current(nullptr)
+    {
+    }
+
+    // CLogReadSection 안에서만 사용. 반환한 포인터는 구간이 끝날 때까지 유효하다. (없으면 nullptr)
+    const T* get() const {
+        return current.load(std::memory_order_seq_cst);
+    }
+
+    // 현재 스냅샷의 소유권 (설정 함수용, 락을 잡는다)
+    std::shared_ptr<const T> share() const {
+        std::lock_guard<std::mutex> lock(ownerMutex);
+        return owner;
+    }
+
+    // 교체하고 이전 스냅샷을 반환. 이전 스냅샷을 읽던 스레드가 모두 구간을 벗어난 뒤에 반환한다.
+    std::shared_ptr<const T> exchange(std::shared_ptr<const T> next) {
+        std::shared_ptr<const T> previous;
+        {
+            std::lock_guard<std::mutex> lock(ownerMutex);
+            previous = std::move(owner);
+            owner = std::move(next);
+            current.store(owner.get(), std::memory_order_seq_cst);
+        }
+        if (previous) {
+            CLogReadSection::retire(previous);
+        }
+        return previous;
+    }
+
+private:
+    CLogSnapshot(const CLogSnapshot&) = delete;
+    CLogSnapshot& operator=(const CLogSnapshot&) = delete;
+
+    std::atomic<const T*> current;
+    mutable std::mutex ownerMutex;
+    std::shared_ptr<const T> owner;
+};
+
+#endif // CLogSnapshot_H
@@ -0,0 +1,103 @@
+﻿#include "pch.h"
+#include "LogThreadBuffer.h"
+#include <cstring>
+
+/// <summary>
+/// 요청한 크기 이상의 2의 거듭제곱 크기로 링 버퍼를 생성
+/// 생성한 스레드를 소유 스레드로 기록한다.
+/// </summary>
+/// <param name="requestedCapacity : 최소 슬롯 개수"></param>
+/// <param name="threadNumber : 로그에 기록하는 스레드 번호"></param>
+CThreadLogBuffer::CThreadLogBuffer(size_t requestedCapacity, unsigned threadNumber)
+{
+    size_t slotCount = 2;
+    while (slotCount < requestedCapacity) {
+        slotCount <<= 1;
+    }
+    slots.reset(new SLogRecord[slotCount]);
+    mask = slotCount - 1;
+    threadId = std::this_thread::get_id();
+    this->threadNumber = threadNumber;
+
+    producing.store(false);
+    released.store(false);
+    head.store(0);
+    tail.store(0);
+    recordCount.store(0);
+    byteCount.store(0);
+    droppedCount.store(0);
+    poppedCount.store(0);
+}
+
+CThreadLogBuffer::~CThreadLogBuffer() {
+}
+
+/// <summary>
+/// 로그를 슬롯에 복사해 넣는다. 버퍼가 가득 찼으면 false 를 반환한다.
+/// 소유 스레드에서만 호출해야 한다.
+/// </summary>
+/// <param name="eRecordKind"></param>
+/// <param name="eLogLevel"></param>
+/// <param name="timestamp"></param>
+/// <param name="text"></param>
+/// <param name="size"></param>
+/// <returns></returns>
+bool CThreadLogBuffer::tryPush(ELogRecordKind eRecordKind, ELogLevel eLogLevel, long long timestamp,
+    const char* text, size_t size) {
+    size_t pos = head.load(std::memory_order_relaxed);
+    if (pos - cachedTail > mask) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (pos - cachedTail > mask) {
+            return false;   // 가득 참
+        }
+    }
+
+    SLogRecord& target = slots[pos & mask];
+    target.eRecordKind = eRecordKind;
+    target.eLogLevel = eLogLevel;
+    target.timestamp = timestamp;
+    target.length = size;
+    if (size <= SLogRecord::kInlineCapacity) {
+        std::memcpy(target.inlineText, text, size);
+    }
+    else {
+        target.overflowText.assign(text, size);
+    }
+    head.store(pos + 1, std::memory_order_release);
+
+    // 소유 스레드만 쓰는 값이므로 fetch_add 대신 load/store 로 충분하다.
+    byteCount.store(byteCount.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    recordCount.store(recordCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return true;
+}
+
+/// <summary>
+/// 가장 오래된 레코드를 반환. 비어 있으면 nullptr
+/// writer 스레드에서만 호출해야 한다.
+/// </summary>
+/// <returns></returns>
+SLogRecord* CThreadLogBuffer::front() {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    if (pos == cachedHead) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (pos == cachedHead) {
+            return nullptr;
+        }
+    }
+    return &slots[pos & mask];
+}
+
+/// <summary>
+/// front() 로 읽은 레코드를 버퍼에서 제거
+/// </summary>
+void CThreadLogBuffer::pop() {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    tail.store(pos + 1, std::memory_order_release);
+    poppedCount.store(poppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+size_t CThreadLogBuffer::sizeApprox() const {
+    size_t consumed = tail.load(std::memory_order_relaxed);
+    size_t produced = head.load(std::memory_order_relaxed);
+    return produced > consumed ? produced - consumed : 0;
+}
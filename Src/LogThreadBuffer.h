@@ -0,0 +1,85 @@
+﻿// CThreadLogBuffer.h
+#ifndef CThreadLogBuffer_H
+#define CThreadLogBuffer_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "Logger.h"
+
+// 비동기 모드에서 writer 스레드로 넘기는 로그 레코드
+// 대부분의 로그는 슬롯 안의 고정 배열에 복사되고, kInlineCapacity 를 넘는 로그만 힙을 사용한다.
+struct SLogRecord {
+    static const size_t kInlineCapacity = 256;
+
+    ELogRecordKind eRecordKind = ELogRecordKind::TEXT;
+    ELogLevel eLogLevel = ELogLevel::LOG_DEBUG;
+    long long timestamp = 0;    // steady_clock 기준, 스레드 간 병합 순서에 사용
+    size_t length = 0;
+    char inlineText[kInlineCapacity];
+    std::string overflowText;
+
+    const char* data() const { return length <= kInlineCapacity ? inlineText : overflowText.data(); }
+    size_t size() const { return length; }
+};
+
+// 스레드 하나가 사용하는 단일 생산자/단일 소비자(SPSC) 링 버퍼
+// 로그 호출 스레드만 넣고 writer 스레드만 꺼내므로 락과 CAS 없이 동작한다.
+// 스레드별 통계(기록 개수, byte 수, 버린 개수)도 함께 가지고 있다.
+class CThreadLogBuffer {
+public:
+    CThreadLogBuffer(size_t requestedCapacity, unsigned threadNumber);
+    ~CThreadLogBuffer();
+
+    // 생산자(로그 호출 스레드) 전용
+    bool tryPush(ELogRecordKind eRecordKind, ELogLevel eLogLevel, long long timestamp, const char* text, size_t size);
+    void countDropped() { droppedCount.store(droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    // 소비자(writer 스레드) 전용
+    SLogRecord* front();
+    void pop();
+
+    size_t capacity() const { return mask + 1; }
+    size_t sizeApprox() const;
+
+    std::thread::id getThreadId() const { return threadId; }
+    unsigned getThreadNumber() const { return threadNumber; }
+    unsigned long long getRecordCount() const { return recordCount.load(std::memory_order_acquire); }
+    unsigned long long getByteCount() const { return byteCount.load(std::memory_order_relaxed); }
+    unsigned long long getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+    unsigned long long getPoppedCount() const { return poppedCount.load(std::memory_order_acquire); }
+
+    // 로그를 넣는 중인지 표시 (shutdown 과의 경합 확인용)
+    std::atomic<bool> producing;
+    // 스레드가 종료되어 더 이상 로그가 들어오지 않음. 비워지면 writer 스레드가 목록에서 제거
+    std::atomic<bool> released;
+
+private:
+    CThreadLogBuffer(const CThreadLogBuffer&) = delete;
+    CThreadLogBuffer& operator=(const CThreadLogBuffer&) = delete;
+
+    std::unique_ptr<SLogRecord[]> slots;
+    size_t mask = 0;
+    std::thread::id threadId;
+    unsigned threadNumber = 0;
+
+    // 생산자 쪽 상태와 소비자 쪽 상태가 같은 캐시 라인을 공유하지 않도록 분리
+    // (C++14 의 new 는 alignas(64) 를 보장하지 않으므로 padding 으로 띄운다)
+    char padding0[64];
+    std::atomic<size_t> head;                       // 생산자가 다음에 쓸 위치
+    size_t cachedTail = 0;                          // 생산자가 마지막으로 확인한 tail
+    std::atomic<unsigned long long> recordCount;
+    std::atomic<unsigned long long> byteCount;
+    std::atomic<unsigned long long> droppedCount;
+    char padding1[64];
+    std::atomic<size_t> tail;                       // 소비자가 다음에 읽을 위치
+    size_t cachedHead = 0;                          // 소비자가 마지막으로 확인한 head
+    std::atomic<unsigned long long> poppedCount;
+    char padding2[64];
+};
+
+#endif // CThreadLogBuffer_H
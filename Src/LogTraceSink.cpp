@@ -0,0 +1,220 @@
+﻿#include "pch.h"
+#include "LogTraceSink.h"
+#include "LogArgs.h"
+#include "LogClock.h"
+#include "LogJson.h"
+#include "LogPlatform.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    const char* levelName(ELogLevel eLogLevel) {
+        static const char* const levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+        int index = static_cast<int>(eLogLevel);
+        return index >= 0 && index < 4 ? levelNames[index] : "UNKNOWN";
+    }
+
+    void appendString(CLogLineBuffer& line, const char* text, size_t size) {
+        line.append('"');
+        LogJson::appendEscaped(line, text, size);
+        line.append('"');
+    }
+}
+
+/// <summary>
+/// trace 파일을 새로 만들고 JSON 배열을 시작한다.
+/// </summary>
+/// <param name="path : trace 파일 경로"></param>
+CTraceLogSink::CTraceLogSink(const std::string& path)
+    : path(path), processId(LogPlatform::processId())
+{
+    traceFile.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!traceFile.is_open()) {
+        throw std::runtime_error("Unable to open trace file: " + path);
+    }
+    traceFile << "[\n";
+}
+
+/// <summary>
+/// 프로세스 이름 메타데이터를 마지막 원소로 기록하고 배열을 닫는다. (앞 원소의 ',' 가 남지 않도록)
+/// </summary>
+CTraceLogSink::~CTraceLogSink() {
+    stopDedicatedThread();
+    line.clear();
+    line.append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":", 38);
+    line.appendInt(static_cast<long long>(processId));
+    line.append(",\"tid\":0,\"args\":{\"name\":\"Logger\"}}\n]\n");
+    traceFile.write(line.data(), static_cast<std::streamsize>(line.size()));
+    traceFile.close();
+}
+
+bool CTraceLogSink::usesDefaultText() const {
+    return false;
+}
+
+/// <summary>
+/// 로그 하나를 trace 이벤트 한 줄로 변환해서 기록
+/// 처음 보는 스레드 번호면 트랙 이름(thread_name) 메타데이터를 먼저 기록한다.
+/// </summary>
+void CTraceLogSink::write(const SLogEvent& event) {
+    line.clear();
+    if (event.threadNumber >= namedThreads.size() || !namedThreads[event.threadNumber]) {
+        appendThreadName(line, event.threadNumber);
+    }
+    long long wallNanoseconds = event.clock->toWallNanoseconds(event.rawTime);
+    if (!appendScope(line, event, wallNanoseconds)) {
+        appendInstant(line, event, wallNanoseconds);
+    }
+    traceFile.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+void CTraceLogSink::flushOutput() {
+    traceFile.flush();
+}
+
+void CTraceLogSink::appendThreadName(CLogLineBuffer& line, unsigned threadNumber) {
+    if (threadNumber >= namedThreads.size()) {
+        namedThreads.resize(threadNumber + 1, false);
+    }
+    namedThreads[threadNumber] = true;
+    line.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":", 37);
+    line.appendInt(static_cast<long long>(processId));
+    line.append(",\"tid\":", 7);
+    line.appendInt(threadNumber);
+    line.append(",\"args\":{\"name\":\"thread ", 24);
+    line.appendInt(threadNumber);
+    line.append("\"}},\n", 5);
+}
+
+/// <summary>
+/// trace 시간 단위(microseconds)로 기록. 소수점 아래 3자리까지 nanoseconds 를 유지한다.
+/// </summary>
+void CTraceLogSink::appendTimestamp(CLogLineBuffer& line, long long wallNanoseconds) {
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%lld.%03lld", wallNanoseconds / 1000, wallNanoseconds % 1000);
+    line.append(text, static_cast<size_t>(length));
+}
+
+void CTraceLogSink::appendCallSiteArgs(CLogLineBuffer& line, const SLogCallSite& callSite) {
+    line.append("\"function\":", 11);
+    appendString(line, callSite.functionName, std::strlen(callSite.functionName));
+    line.append(",\"file\":", 8);
+    appendString(line, callSite.fileName, std::strlen(callSite.fileName));
+    line.append(",\"line\":", 8);
+    line.appendInt(callSite.lineNumber);
+}
+
+/// <summary>
+/// LOG_SCOPE 기록(SLogEvent::scope)이면 끝난 시각에서 실행 시간(첫 필드 elapsed_us)을 빼서 구간 이벤트로 기록
+/// 같은 이름의 필드를 붙인 일반 로그는 scope 가 false 이므로 시점 이벤트로 남는다.
+/// </summary>
+/// <returns>LOG_SCOPE 기록이 아니면 false (아무것도 기록하지 않음)</returns>
+bool CTraceLogSink::appendScope(CLogLineBuffer& line, const SLogEvent& event, long long wallNanoseconds) {
+    if (!event.scope || event.callSite == nullptr || event.format == nullptr || event.argCount < 2) {
+        return false;
+    }
+    size_t keySize = LogArgs::encodedSize(event.args, event.argsSize);
+    const char* value = event.args + keySize;
+    if (LogArgs::encodedSize(value, event.argsSize - keySize) == 0
+        || static_cast<ELogArgType>(value[0]) != ELogArgType::DOUBLE) {
+        return false;
+    }
+    double elapsedMicroseconds;
+    std::memcpy(&elapsedMicroseconds, value + 1, sizeof(elapsedMicroseconds));
+    long long elapsedNanoseconds = static_cast<long long>(elapsedMicroseconds * 1000.0);
+
+    line.append("{\"name\":", 8);
+    appendString(line, event.format, std::strlen(event.format));
+    line.append(",\"cat\":\"scope\",\"ph\":\"X\",\"ts\":", 29);
+    appendTimestamp(line, wallNanoseconds - elapsedNanoseconds);
+    line.append(",\"dur\":", 7);
+    appendTimestamp(line, elapsedNanoseconds);
+    line.append(",\"pid\":", 7);
+    line.appendInt(static_cast<long long>(processId));
+    line.append(",\"tid\":", 7);
+    line.appendInt(event.threadNumber);
+    line.append(",\"args\":{", 9);
+    appendCallSiteArgs(line, *event.callSite);
+
+    // elapsed_us 는 dur 로 옮겼으므로 나머지 필드(depth)만 args 에 넣는다.
+    size_t offset = keySize + LogArgs::encodedSize(value, event.argsSize - keySize);
+    for (unsigned used = 2; used + 1 < event.argCount && offset < event.argsSize; used += 2) {
+        size_t fieldKeySize = LogArgs::encodedSize(event.args + offset, event.argsSize - offset);
+        size_t fieldValueSize = fieldKeySize == 0 ? 0
+            : LogArgs::encodedSize(event.args + offset + fieldKeySize, event.argsSize - offset - fieldKeySize);
+        if (fieldValueSize == 0) {
+            break;
+        }
+        line.append(',');
+        LogJson::appendValue(line, event.args + offset, fieldKeySize);
+        line.append(':');
+        LogJson::appendValue(line, event.args + offset + fieldKeySize, fieldValueSize);
+        offset += fieldKeySize + fieldValueSize;
+    }
+    line.append("}},\n", 4);
+    return true;
+}
+
+/// <summary>
+/// 일반 로그는 스레드 트랙 위의 시점 이벤트로 기록
+/// 이름은 인자를 채운 메시지, args 에는 레벨/호출 위치/구조화 필드를 넣는다.
+/// </summary>
+void CTraceLogSink::appendInstant(CLogLineBuffer& line, const SLogEvent& event, long long wallNanoseconds) {
+    const char* level = levelName(event.eLogLevel);
+    line.append("{\"name\":", 8);
+    unsigned used = 0;
+    size_t offset = 0;
+    if (event.callSite != nullptr && event.format != nullptr) {
+        message.clear();
+        offset = LogArgs::renderMessage(message, event.format, event.args, event.argsSize, event.argCount, used);
+        appendString(line, message.data(), message.size());
+    }
+    else {
+        // 조립된 텍스트 로그 : 끝의 줄바꿈만 제외
+        size_t size = event.textSize;
+        while (size > 0 && (event.text[size - 1] == '\n' || event.text[size - 1] == '\r')) {
+            --size;
+        }
+        appendString(line, event.text, size);
+    }
+    line.append(",\"cat\":\"", 8);
+    line.append(level);
+    line.append("\",\"ph\":\"i\",\"s\":\"t\",\"ts\":", 24);
+    appendTimestamp(line, wallNanoseconds);
+    line.append(",\"pid\":", 7);
+    line.appendInt(static_cast<long long>(processId));
+    line.append(",\"tid\":", 7);
+    line.appendInt(event.threadNumber);
+    line.append(",\"args\":{\"level\":\"", 18);
+    line.append(level);
+    line.append('"');
+    if (event.callSite != nullptr) {
+        line.append(',');
+        appendCallSiteArgs(line, *event.callSite);
+    }
+    if (event.format != nullptr) {
+        // LOG_*_KV 필드 : {} 에 쓰이고 남은 FIELD_KEY, 값 쌍
+        while (used + 1 < event.argCount && offset < event.argsSize
+            && static_cast<ELogArgType>(event.args[offset]) == ELogArgType::FIELD_KEY) {
+            size_t keySize = LogArgs::encodedSize(event.args + offset, event.argsSize - offset);
+            size_t valueSize = keySize == 0 ? 0
+                : LogArgs::encodedSize(event.args + offset + keySize, event.argsSize - offset - keySize);
+            if (valueSize == 0) {
+                break;
+            }
+            line.append(',');
+            LogJson::appendValue(line, event.args + offset, keySize);
+            line.append(':');
+            LogJson::appendValue(line, event.args + offset + keySize, valueSize);
+            offset += keySize + valueSize;
+            used += 2;
+        }
+    }
+    if (event.sampleRate < 1.0f) {
+        char text[32];
+        int length = std::snprintf(text, sizeof(text), ",\"sample_rate\":%g", static_cast<double>(event.sampleRate));
+        line.append(text, static_cast<size_t>(length));
+    }
+    line.append("}},\n", 4);
+}
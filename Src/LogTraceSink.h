@@ -0,0 +1,44 @@
+﻿// CTraceLogSink.h
+#ifndef CTraceLogSink_H
+#define CTraceLogSink_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "LogSink.h"
+
+// Chrome Trace Event 형식(JSON 배열) 출력 : chrome://tracing, https://ui.perfetto.dev 에서 열 수 있다.
+// LOG_SCOPE 기록은 실행 구간("ph":"X"), 나머지 로그는 시점 표시("ph":"i")로 변환하고,
+// 로그를 남긴 스레드 번호마다 트랙(tid) 하나를 만든다.
+// 변환은 write 에서 하므로 enableDedicatedThread 와 함께 쓰면 로그 호출 스레드에서는 이벤트를 복사만 한다.
+// 소멸할 때 배열을 닫는다. (비정상 종료로 닫히지 않은 파일도 두 뷰어 모두 읽을 수 있음)
+class CTraceLogSink : public CLogSink {
+public:
+    // 파일을 새로 만든다. 실패하면 std::runtime_error
+    explicit CTraceLogSink(const std::string& path);
+    ~CTraceLogSink();
+
+    const std::string& getPath() const { return path; }
+    bool usesDefaultText() const override;
+
+protected:
+    void write(const SLogEvent& event) override;
+    void flushOutput() override;
+
+private:
+    void appendThreadName(CLogLineBuffer& line, unsigned threadNumber);
+    void appendTimestamp(CLogLineBuffer& line, long long wallNanoseconds);
+    void appendCallSiteArgs(CLogLineBuffer& line, const SLogCallSite& callSite);
+    bool appendScope(CLogLineBuffer& line, const SLogEvent& event, long long wallNanoseconds);
+    void appendInstant(CLogLineBuffer& line, const SLogEvent& event, long long wallNanoseconds);
+
+    std::string path;
+    std::ofstream traceFile;
+    unsigned long processId;
+    std::vector<bool> namedThreads;     // 스레드 번호별 thread_name 메타데이터 기록 여부
+    CLogLineBuffer line;
+    CLogLineBuffer message;
+};
+
+#endif // CTraceLogSink_H
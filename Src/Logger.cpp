@@ -1,18 +1,58 @@
 ﻿#include "pch.h"
 #include "Logger.h"
+#include "LogThreadBuffer.h"
+#include "LogLineBuffer.h"
+#include "LogSink.h"
+#include "LogFileSink.h"
+#include "LogFlightRecorder.h"
+#include "LogTraceSink.h"
+#include "LogSharedSink.h"
+#include "LogConfig.h"
+#include "LogPlatform.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
 #include <iostream>
-#include <locale>
-#if __cplusplus >= 201703L  // C++20 이상
-#include <filesystem>
-namespace fs = std::filesystem;
-#else
-#include <direct.h>
-#include <io.h>
-#include <codecvt>
-#endif
+#include <stdexcept>
 
 
+std::atomic<int> CLogger::minLogLevel(static_cast<int>(ELogLevel::LOG_DEBUG));
+std::atomic<bool> CLogger::samplingActive(false);
+
+namespace {
+    std::atomic<unsigned> nextThreadNumber(0);
+
+    // 로그를 남긴 스레드를 구분하는 작은 번호 (처음 로그를 남길 때 부여)
+    unsigned currentThreadNumber() {
+        thread_local unsigned threadNumber = nextThreadNumber.fetch_add(1, std::memory_order_relaxed);
+        return threadNumber;
+    }
+
+    // LOG_* 메시지를 인자 하나짜리 지연 포맷 레코드로 기록할 때의 포맷
+    const char kMessageFormat[] = "{}";
+
+    // 속도 제한/중복 생략 요약 로그의 포맷 (생략된 로그의 호출 위치로 기록)
+    const char kSuppressedFormat[] = "{} messages suppressed by rate limit";
+    const char kRepeatedFormat[] = "last message repeated {} times";
+
+    // LOG_SCOPE_STATS 히스토그램 칸 경계 표시 (2^i nanoseconds)
+    void appendDurationLabel(std::string& text, unsigned long long nanos) {
+        const char* units[] = { "ns", "us", "ms", "s" };
+        double value = static_cast<double>(nanos);
+        int unit = 0;
+        while (unit < 3 && value >= 1000.0) {
+            value /= 1000.0;
+            ++unit;
+        }
+        char label[32];
+        std::snprintf(label, sizeof(label), "%.3g%s", value, units[unit]);
+        text += label;
+    }
+
+    typedef std::vector<std::shared_ptr<CLogSink>> LogSinkList;
+}
+
 // Singleton 인스턴스 반환
 CLogger& CLogger::getInstance() {
     static CLogger instance;
@@ -21,68 +61,424 @@ CLogger& CLogger::getInstance() {
 
 CLogger::CLogger()
 {
-    // UTF-8 인코딩 설정
+    // 인코딩 설정
     // ofstream 인스턴스가 생성되기 전에 인코딩을 설정해야 한다. 
-    std::locale::global(std::locale("Korean"));
-    saveToFile = false;
+    LogPlatform::installGlobalLocale();
+
+    scopeClock.configure(ETimePrecision::NANOSECONDS, ETimeSource::STEADY_CLOCK);
+    asyncEnabled.store(false);
+    stopWriter.store(false);
+    writerSleeping.store(false);
+    registryGeneration.store(0);
+    for (auto& dropped : droppedCount) {
+        dropped.store(0);
+    }
+
+    // configureLogging 전에는 콘솔에만 출력
+    // 콘솔은 전용 스레드에서 모아서 출력하므로, 터미널이 느려도 큐가 가득 차기 전까지는 파일 출력이 기다리지 않는다.
+    consoleSink = std::make_shared<CConsoleLogSink>();
+    consoleSink->enableDedicatedThread(4096, EOverflowPolicy::BLOCK);
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    installSinksLocked(LogSinkList{ consoleSink });
 }
 CLogger::~CLogger() {
+    // 프로세스 종료 시 버퍼에 남은 로그를 모두 기록한 후 writer 스레드 종료
+    stopWatchingConfig();
+    stopScopeStatsThread();
+    flushScopeStats();
+    shutdown();
+    for (const auto& sink : getConfig()->sinks) {
+        sink->flush();
+    }
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    installSinksLocked(LogSinkList());
 }
 
 /// <summary>
 /// 디버그 로그 텍스트 파일 생성 함수
+/// 콘솔 sink 와 "Log" 디렉토리의 로그파일 sink 로 구성한다.
 /// </summary>
 /// <param name="filename : 생성할 로그파일 이름"></param>
 /// <param name="enableFileLogging: 로그를 파일에 저장 유무 선택"></param>
-void CLogger::configureLogging(const char* filename, bool enableFileLogging) {
-    std::lock_guard<std::mutex> lock(logMutex);
+/// <param name="writeBufferSize: 로그파일 쓰기 버퍼 크기 (byte), 0 이면 표준 라이브러리 기본값"></param>
+void CLogger::configureLogging(const char* filename, bool enableFileLogging, size_t writeBufferSize) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    if (!consoleSink) {
+        consoleSink = std::make_shared<CConsoleLogSink>();
+        consoleSink->enableDedicatedThread(4096, EOverflowPolicy::BLOCK);
+    }
 
-    std::string logDir;
+    // 이전 로그파일은 남은 내용을 기록하고 닫은 뒤 새 파일을 연다.
+    if (fileSink) {
+        installSinksLocked(LogSinkList{ consoleSink });
+    }
+    // 파일 저장을 사용하지 않으면 디렉토리/파일을 전혀 건드리지 않는다.
+    if (!enableFileLogging) {
+        return;
+    }
+
+    // 현재 작업 디렉토리의 "Log" 디렉토리 생성 (없으면 생성)
+    std::string logDir = LogPlatform::currentDirectory() + "/Log";
+    LogPlatform::createDirectory(logDir);
 
-#if __cplusplus >= 201703L              // C++17 이상일 때    
-    logDir = "Log";
-    if (!fs::exists(logDir)) {
-        fs::create_directory(logDir);
+    std::shared_ptr<CFileLogSink> newFileSink = std::make_shared<CFileLogSink>(logDir + "/" + filename, writeBufferSize);
+    newFileSink->setFlushPolicy(flushPolicy, flushThreshold, flushOnErrorLog);
+    newFileSink->setFileFormat(fileFormat, logClock.getPrecision());
+    newFileSink->setWriteMode(fileWriteMode, fileWriteQueueDepth);
+    if (rotationConfigured) {
+        newFileSink->setRotation(rotationMaxFileSize, rotationIntervalSeconds, rotationRetentionCount, rotationCompression);
     }
+    installSinksLocked(LogSinkList{ consoleSink, newFileSink });
+}
 
+/// <summary>
+/// 여러 프로세스가 하나의 로그파일에 기록하는 구성
+/// 로그파일 대신 수집 프로세스의 공유 메모리 링에 넣으므로, 로그 호출 스레드는 파일 입출력을 기다리지 않는다.
+/// </summary>
+/// <param name="ringName : 수집 프로세스(CLogCollector)가 만든 링 이름"></param>
+void CLogger::configureSharedLogging(const std::string& ringName) {
+    std::shared_ptr<CSharedLogSink> sharedSink = std::make_shared<CSharedLogSink>(ringName);
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    if (!consoleSink) {
+        consoleSink = std::make_shared<CConsoleLogSink>();
+        consoleSink->enableDedicatedThread(4096, EOverflowPolicy::BLOCK);
+    }
+    installSinksLocked(LogSinkList{ consoleSink, sharedSink });
+}
 
-#else                                   // C++14 일 때
-    // 현재 작업 디렉토리 가져오기
-    char currentDir[FILENAME_MAX];
-    if (_getcwd(currentDir, sizeof(currentDir)) == nullptr) {
-        throw std::runtime_error("Failed to get current working directory.");
+/// <summary>
+/// 지정한 sink 들로 출력 대상을 구성
+/// sink 마다 최소 레벨, 형식, 전용 출력 스레드를 따로 설정할 수 있다.
+/// </summary>
+/// <param name="sinks"></param>
+void CLogger::configureLogging(const std::vector<std::shared_ptr<CLogSink>>& sinks) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    installSinksLocked(sinks);
+}
+
+void CLogger::addSink(const std::shared_ptr<CLogSink>& sink) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    LogSinkList sinks = getConfig()->sinks;
+    sinks.push_back(sink);
+    installSinksLocked(sinks);
+}
+
+void CLogger::removeSink(const std::shared_ptr<CLogSink>& sink) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    LogSinkList sinks = getConfig()->sinks;
+    sinks.erase(std::remove(sinks.begin(), sinks.end(), sink), sinks.end());
+    installSinksLocked(sinks);
+    sink->flush();
+}
+
+/// <summary>
+/// 현재 설정 스냅샷의 복사본 (sinkConfigMutex 를 잡은 상태에서 고친 뒤 publishConfigLocked 로 교체)
+/// </summary>
+std::shared_ptr<SLogConfig> CLogger::copyConfigLocked() const {
+    std::shared_ptr<const SLogConfig> current = activeConfig.share();
+    return current ? std::make_shared<SLogConfig>(*current) : std::make_shared<SLogConfig>();
+}
+
+/// <summary>
+/// 설정 스냅샷 교체. sinkConfigMutex 를 잡은 상태에서 호출
+/// 스냅샷은 한 번에 바뀌고, 호출 위치별 캐시와 찾아 둔 sink 는 이전 스냅샷과 달라진 항목만 새 스냅샷에서 다시 계산한다.
+/// 교체는 이전 스냅샷을 읽던 로그 호출 스레드가 모두 끝난 뒤에 돌아오고, 빠진 sink 는 남은 로그를 출력한 뒤 해제된다.
+/// </summary>
+/// <param name="next : 새 스냅샷 (교체 후에는 고치지 않음)"></param>
+void CLogger::publishConfigLocked(const std::shared_ptr<SLogConfig>& next) {
+    std::shared_ptr<const SLogConfig> previous = activeConfig.exchange(next);
+
+    minLogLevel.store(static_cast<int>(next->minLevel), std::memory_order_relaxed);
+    levelFilter.apply(next);
+    for (int i = 0; i < SLogConfig::kLevelCount; ++i) {
+        if (!previous || previous->rateLimit[i] != next->rateLimit[i] || previous->rateBurst[i] != next->rateBurst[i]) {
+            rateLimiter.setRateLimit(static_cast<ELogLevel>(i), next->rateLimit[i], next->rateBurst[i]);
+        }
+    }
+    if (!previous || previous->duplicateSuppression != next->duplicateSuppression) {
+        rateLimiter.setDuplicateSuppression(next->duplicateSuppression);
+    }
+    if (!previous || previous->sampling != next->sampling) {
+        sampler.setRules(next->sampling);
+        samplingActive.store(sampler.isActive(), std::memory_order_relaxed);
     }
 
-    // "Log" 디렉토리 경로 설정
-    logDir = std::string(currentDir) + "/Log";
-    struct stat info;
-    if (stat(logDir.c_str(), &info) != 0 || !(info.st_mode & S_IFDIR)) { // 디렉토리 존재 여부 확인
-        if (_mkdir(logDir.c_str()) != 0) { // 디렉토리 생성
-            throw std::runtime_error("Unable to create directory: " + logDir);
+    if (previous && previous->sinks == next->sinks) {
+        return;
+    }
+    fileSink.reset();
+    consoleSink.reset();
+    flightRecorder.reset();
+    traceSink.reset();
+    for (const auto& sink : next->sinks) {
+        if (!flightRecorder) {
+            flightRecorder = std::dynamic_pointer_cast<CFlightRecorderSink>(sink);
+        }
+        if (!traceSink) {
+            traceSink = std::dynamic_pointer_cast<CTraceLogSink>(sink);
+        }
+        if (!fileSink) {
+            fileSink = std::dynamic_pointer_cast<CFileLogSink>(sink);
+        }
+        if (!consoleSink) {
+            consoleSink = std::dynamic_pointer_cast<CConsoleLogSink>(sink);
         }
     }
 
+    if (previous) {
+        for (const auto& sink : previous->sinks) {
+            if (std::find(next->sinks.begin(), next->sinks.end(), sink) == next->sinks.end()) {
+                sink->flush();
+            }
+        }
+    }
+}
 
-#endif
-    // "Log" 디렉토리 생성 (없으면 생성)
-    logFilename = logDir + "/" + filename;
-    saveToFile = enableFileLogging;
+/// <summary>
+/// 출력 대상 목록 교체. sinkConfigMutex 를 잡은 상태에서 호출
+/// </summary>
+/// <param name="sinks"></param>
+void CLogger::installSinksLocked(const std::vector<std::shared_ptr<CLogSink>>& sinks) {
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    next->sinks = sinks;
+    publishConfigLocked(next);
+}
 
+std::shared_ptr<CFileLogSink> CLogger::getFileSink() const {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    return fileSink;
+}
 
-    if (saveToFile)
-    {
-        std::ofstream logFile;
-        logFile.open(logFilename, std::ios::trunc);
-        if (!logFile.is_open()) {
-            throw std::runtime_error("Unable to open log file: " + logFilename);
+std::shared_ptr<CConsoleLogSink> CLogger::getConsoleSink() const {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    return consoleSink;
+}
+
+/// <summary>
+/// 로그파일을 메모리 매핑으로 기록 (CFileLogSink::enableMappedFile)
+/// </summary>
+/// <param name="segmentSize : 한 번에 할당/매핑하는 크기 (byte)"></param>
+void CLogger::enableMappedFile(size_t segmentSize) {
+    std::shared_ptr<CFileLogSink> sink = getFileSink();
+    if (sink) {
+        sink->enableMappedFile(segmentSize);
+    }
+}
+
+/// <summary>
+/// 로그파일 저장 형식 설정 (CFileLogSink::setFileFormat)
+/// 콘솔 출력은 그대로 텍스트이며, 바이너리 파일은 LogDecoder 로 기존 텍스트 형태로 변환할 수 있다.
+/// </summary>
+/// <param name="eFileFormat"></param>
+void CLogger::setFileFormat(ELogFileFormat eFileFormat) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    fileFormat = eFileFormat;
+    if (fileSink) {
+        fileSink->setFileFormat(eFileFormat, logClock.getPrecision());
+    }
+}
+
+/// <summary>
+/// 로그파일 기록 방식 설정 (CFileLogSink::setWriteMode)
+/// </summary>
+/// <param name="eWriteMode"></param>
+/// <param name="queueDepth : IO_URING 의 동시 기록 개수"></param>
+void CLogger::setFileWriteMode(EFileWriteMode eWriteMode, unsigned queueDepth) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    fileWriteMode = eWriteMode;
+    fileWriteQueueDepth = queueDepth;
+    if (fileSink) {
+        fileSink->setWriteMode(eWriteMode, queueDepth);
+    }
+}
+
+/// <summary>
+/// 로그파일 교체(rotation) 설정 (CFileLogSink::setRotation)
+/// </summary>
+/// <param name="maxFileSize : 이 크기(byte) 이상이면 교체, 0 이면 사용 안 함"></param>
+/// <param name="intervalSeconds : 로그파일을 연 뒤 이 시간(초)이 지나면 교체, 0 이면 사용 안 함"></param>
+/// <param name="retentionCount : 보관할 교체 파일 개수, 0 이면 모두 보관"></param>
+/// <param name="eCompression : 교체된 파일 압축 방식 (별도의 낮은 우선순위 스레드에서 압축)"></param>
+void CLogger::setRotation(unsigned long long maxFileSize, unsigned intervalSeconds, unsigned retentionCount,
+    ELogCompression eCompression) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    rotationConfigured = true;
+    rotationMaxFileSize = maxFileSize;
+    rotationIntervalSeconds = intervalSeconds;
+    rotationRetentionCount = retentionCount;
+    rotationCompression = eCompression;
+    if (fileSink) {
+        fileSink->setRotation(maxFileSize, intervalSeconds, retentionCount, eCompression);
+    }
+}
+
+SRotationStats CLogger::getRotationStats() const {
+    std::shared_ptr<CFileLogSink> sink = getFileSink();
+    return sink ? sink->getRotationStats() : SRotationStats();
+}
+
+/// <summary>
+/// 비행 기록 장치(flight recorder) 사용
+/// eRecordBelow 미만 레벨의 로그는 로그파일(없으면 콘솔)에 바로 기록하지 않고 메모리의 링에 덮어쓰며 보관한다.
+/// LOG_ERROR 가 들어오면 그 로그보다 먼저 보관한 로그를 기록하고, CExcep 생성이나 dumpFlightRecorder 호출 때도 기록한다.
+/// 비동기 모드에서는 writer 스레드가 링에 보관한다.
+/// </summary>
+/// <param name="capacity : 보관할 로그 개수"></param>
+/// <param name="eRecordBelow : 이 레벨 미만의 로그를 보관"></param>
+/// <param name="installCrashHandler : SIGSEGV, SIGABRT 등에서 보관한 로그를 로그파일에 기록"></param>
+void CLogger::enableFlightRecorder(size_t capacity, ELogLevel eRecordBelow, bool installCrashHandler) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<CLogSink> target = fileSink;
+    if (!target) {
+        target = consoleSink;
+    }
+    if (!target) {
+        throw std::runtime_error("No log sink for the flight recorder");
+    }
+
+    // 다시 설정하면 이전 비행 기록 장치가 바꾼 레벨을 먼저 되돌린다.
+    if (flightRecorder) {
+        flightRecorder->restoreTargetLevel();
+    }
+    auto recorder = std::make_shared<CFlightRecorderSink>(capacity, eRecordBelow, ELogLevel::LOG_ERROR, target);
+    LogSinkList sinks{ recorder };
+    for (const auto& sink : getConfig()->sinks) {
+        if (sink != flightRecorder) {
+            sinks.push_back(sink);
         }
-        logFile.close();
     }
+    recorder->setTargetLevel(target->getMinLevel());
 
+    if (installCrashHandler) {
+        // 텍스트 로그파일에는 이어서 기록하고, 바이너리/메모리 매핑 파일은 옆에 별도의 텍스트 파일로 기록
+        std::string crashPath;
+        if (fileSink) {
+            crashPath = fileSink->getPath();
+            if (fileSink->getFileFormat() != ELogFileFormat::TEXT || fileSink->usesMappedFile()) {
+                crashPath += ".flight.log";
+            }
+        }
+        recorder->installCrashHandler(crashPath);
+    }
+    // 맨 앞에 두어 LOG_ERROR 보다 보관한 로그가 먼저 기록되도록 한다.
+    installSinksLocked(sinks);
+}
+
+void CLogger::disableFlightRecorder() {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    if (!flightRecorder) {
+        return;
+    }
+    std::shared_ptr<CFlightRecorderSink> recorder = flightRecorder;
+    LogSinkList sinks;
+    for (const auto& sink : getConfig()->sinks) {
+        if (sink != flightRecorder) {
+            sinks.push_back(sink);
+        }
+    }
+    installSinksLocked(sinks);
+    CFlightRecorderSink::uninstallCrashHandler();
+    // 비행 기록 장치를 켜기 전(또는 그 뒤에 설정 파일로 지정한) 레벨로 되돌린다.
+    recorder->restoreTargetLevel();
+}
+
+/// <summary>
+/// 비행 기록 장치에 보관한 로그를 기록
+/// 비동기 모드면 스레드 버퍼에 남아 있는 로그까지 링에 넣은 뒤 기록한다. (writer 스레드에서 호출하면 제외)
+/// </summary>
+/// <param name="reason : 기록 앞뒤에 남길 구분 문구"></param>
+void CLogger::dumpFlightRecorder(const char* reason) {
+    std::shared_ptr<CFlightRecorderSink> recorder = getFlightRecorder();
+    if (!recorder) {
+        return;
+    }
+    if (asyncEnabled.load(std::memory_order_acquire) && std::this_thread::get_id() != writerThread.get_id()) {
+        flush();
+    }
+    recorder->dump(reason);
+}
+
+std::shared_ptr<CFlightRecorderSink> CLogger::getFlightRecorder() const {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    return flightRecorder;
+}
+
+/// <summary>
+/// trace 파일 sink 추가 (이미 있으면 교체)
+/// 로그 호출 스레드(비동기 모드면 writer 스레드)는 이벤트를 sink 큐에 복사만 하고, JSON 변환과 기록은 sink 전용 스레드가 한다.
+/// </summary>
+/// <param name="path : trace 파일 경로"></param>
+/// <param name="queueCapacity : sink 큐에 대기할 수 있는 로그 개수"></param>
+void CLogger::enableTrace(const std::string& path, size_t queueCapacity) {
+    auto trace = std::make_shared<CTraceLogSink>(path);
+    trace->enableDedicatedThread(queueCapacity, EOverflowPolicy::BLOCK);
+
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    replaceTraceSinkLocked(*next, trace);
+    next->tracePath = path;
+    publishConfigLocked(next);
+}
+
+/// <summary>
+/// trace sink 제거. 비동기 모드면 스레드 버퍼에 남은 로그까지 기록한 뒤 제거한다. (writer 스레드에서 호출하면 제외)
+/// </summary>
+void CLogger::disableTrace() {
+    if (asyncEnabled.load(std::memory_order_acquire) && std::this_thread::get_id() != writerThread.get_id()) {
+        flush();
+    }
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    if (!traceSink) {
+        return;
+    }
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    replaceTraceSinkLocked(*next, nullptr);
+    next->tracePath.clear();
+    publishConfigLocked(next);
+}
+
+/// <summary>
+/// config 의 sink 목록에서 현재 trace sink 를 빼고 trace 를 맨 뒤에 넣는다. (nullptr 이면 빼기만 함)
+/// </summary>
+void CLogger::replaceTraceSinkLocked(SLogConfig& config, const std::shared_ptr<CTraceLogSink>& trace) {
+    if (traceSink) {
+        config.sinks.erase(std::remove(config.sinks.begin(), config.sinks.end(), traceSink), config.sinks.end());
+    }
+    if (trace) {
+        config.sinks.push_back(trace);
+    }
+}
+
+/// <summary>
+/// 로그파일 flush 시점 설정 (CFileLogSink::setFlushPolicy)
+/// </summary>
+/// <param name="eFlushPolicy : flush 기준"></param>
+/// <param name="threshold : EVERY_N_RECORDS 는 로그 개수, EVERY_N_BYTES 는 byte 수, INTERVAL 은 milliseconds"></param>
+/// <param name="flushOnError : LOG_ERROR 는 정책과 상관없이 즉시 flush"></param>
+void CLogger::setFlushPolicy(EFlushPolicy eFlushPolicy, unsigned long long threshold, bool flushOnError) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    flushPolicy = eFlushPolicy;
+    flushThreshold = threshold;
+    flushOnErrorLog = flushOnError;
+    if (fileSink) {
+        fileSink->setFlushPolicy(eFlushPolicy, threshold, flushOnError);
+    }
+}
+
+/// <summary>
+/// 로그 시간 표시 단위와 측정 방식 설정
+/// 기본값은 초 단위(yyyy-mm-dd hh:mm:ss), system_clock
+/// STEADY_CLOCK, TSC 는 로그 호출 시 원시 값만 읽고 출력할 때 현재 시각으로 변환한다.
+/// </summary>
+/// <param name="ePrecision : 초/밀리초/마이크로초/나노초"></param>
+/// <param name="eSource : 시간 측정 방식"></param>
+void CLogger::setTimestampFormat(ETimePrecision ePrecision, ETimeSource eSource) {
+    logClock.configure(ePrecision, eSource);
 }
 
 /// <summary>
 /// 로그 메시지 표출 함수
+/// LOG_* 매크로를 거치지 않고 직접 호출하는 경우에 사용하며, 파일 이름은 호출 시마다 잘라낸다.
 /// </summary>
 /// <param name="eLoglevl"></param>
 /// <param name="message"></param>
@@ -91,97 +487,938 @@ void CLogger::configureLogging(const char* filename, bool enableFileLogging) {
 /// <param name="lineNumber"></param>
 void CLogger::logMessage(ELogLevel eLoglevel, const std::string& message, const char* functionName,
     const char* fileName, int lineNumber) {
-    std::ostringstream logStream;
+    SLogCallSite callSite = { eLoglevel, logLevelTag(eLoglevel), functionName, extractFileName(fileName), lineNumber, nullptr, fileName };
+    // 스레드마다 재사용하는 버퍼에 조립하므로 평상시에는 힙 할당이 없다.
+    thread_local CLogLineBuffer line;
+    formatLog(line, callSite, message.data(), message.size());
+    dispatchLog(eLoglevel, line.data(), line.size());
+}
+
+void CLogger::logMessage(ELogLevel eLoglevel, const char* message, const char* functionName,
+    const char* fileName, int lineNumber) {
+    SLogCallSite callSite = { eLoglevel, logLevelTag(eLoglevel), functionName, extractFileName(fileName), lineNumber, nullptr, fileName };
+    thread_local CLogLineBuffer line;
+    formatLog(line, callSite, message, std::strlen(message));
+    dispatchLog(eLoglevel, line.data(), line.size());
+}
+
+/// <summary>
+/// 로그 메시지 표출 함수 (LOG_* 매크로용)
+/// 메시지를 인자 하나짜리 지연 포맷 레코드로 기록하므로, 출력 형식은 sink 마다 정해진다.
+/// </summary>
+/// <param name="callSite : 매크로가 만든 호출 위치 정보"></param>
+/// <param name="message"></param>
+void CLogger::logMessage(const SLogCallSite* callSite, const std::string& message) {
+    logFormat(callSite, kMessageFormat, message);
+}
+
+/// <summary>
+/// 로그 메시지 표출 함수 (LOG_* 매크로용, 문자열 상수는 std::string 임시 객체를 만들지 않음)
+/// </summary>
+void CLogger::logMessage(const SLogCallSite* callSite, const char* message) {
+    logFormat(callSite, kMessageFormat, message);
+}
+
+unsigned CLogger::getThreadNumber() {
+    return currentThreadNumber();
+}
+
+/// <summary>
+/// 실행 중 최소 로그 레벨 설정. 이보다 낮은 레벨의 LOG_* 호출은 무시된다.
+/// </summary>
+/// <param name="eLogLevel"></param>
+void CLogger::setMinLogLevel(ELogLevel eLogLevel) {
+    CLogger& logger = getInstance();
+    std::lock_guard<std::mutex> lock(logger.sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = logger.copyConfigLocked();
+    next->minLevel = eLogLevel;
+    logger.publishConfigLocked(next);
+}
+
+ELogLevel CLogger::getMinLogLevel() {
+    return getInstance().getConfig()->minLevel;
+}
+
+/// <summary>
+/// 모듈/파일/함수별 최소 레벨 설정
+/// </summary>
+/// <param name="eTarget : MODULE 은 소스 파일 경로의 디렉토리 이름, FILE 은 파일 이름, FUNCTION 은 함수 이름"></param>
+/// <param name="pattern : 비교할 이름 ('*' 사용 가능)"></param>
+/// <param name="eLogLevel : 맞는 호출 위치의 최소 레벨"></param>
+void CLogger::setLogLevel(ELogRuleTarget eTarget, const std::string& pattern, ELogLevel eLogLevel) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    bool replaced = false;
+    for (auto& rule : next->levelRules) {
+        if (rule.eTarget == eTarget && rule.pattern == pattern) {
+            rule.eLogLevel = eLogLevel;
+            replaced = true;
+            break;
+        }
+    }
+    if (!replaced) {
+        next->levelRules.push_back(SLogLevelRule{ eTarget, pattern, eLogLevel });
+    }
+    publishConfigLocked(next);
+}
+
+void CLogger::setLogLevels(const std::vector<SLogLevelRule>& rules) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    next->levelRules = rules;
+    publishConfigLocked(next);
+}
+
+void CLogger::clearLogLevels() {
+    setLogLevels(std::vector<SLogLevelRule>());
+}
+
+namespace {
+    // 지연 포맷 레코드의 앞부분. 뒤에 인자가 LogArgs 형식으로 이어진다.
+    struct SDeferredLogHeader {
+        const SLogCallSite* callSite;
+        const char* format;
+        long long rawTime;
+        unsigned argCount;
+        float sampleRate;       // 샘플링으로 기록된 로그면 기록 비율, 아니면 1
+        bool scope;             // LOG_SCOPE 구간 기록
+    };
+}
+
+/// <summary>
+/// 지연 포맷 레코드 작성 시작. 스레드별 버퍼에 헤더를 기록하고 반환한다.
+/// </summary>
+/// <param name="callSite"></param>
+/// <param name="format : 문자열 상수"></param>
+/// <param name="argCount"></param>
+/// <param name="scope : LOG_SCOPE 구간 기록이면 true"></param>
+/// <returns></returns>
+CLogLineBuffer& CLogger::beginDeferredLog(const SLogCallSite* callSite, const char* format, unsigned argCount, bool scope) {
+    thread_local CLogLineBuffer record;
+    SDeferredLogHeader header;
+    header.callSite = callSite;
+    header.format = format;
+    header.rawTime = logClock.now();
+    header.argCount = argCount;
+    header.sampleRate = callSite->siteState != nullptr && samplingActive.load(std::memory_order_relaxed)
+        ? sampler.sampleRate(*callSite) : 1.0f;
+    header.scope = scope;
+
+    record.clear();
+    record.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    return record;
+}
+
+/// <summary>
+/// 지연 포맷 레코드 작성 완료. 속도 제한/중복 생략을 확인한 후 sink 쪽으로 넘긴다.
+/// </summary>
+void CLogger::commitDeferredLog(const SLogCallSite* callSite, CLogLineBuffer& record) {
+    if (callSite->siteState != nullptr && rateLimiter.isActive() && !admitDeferredLog(*callSite, record)) {
+        return;
+    }
+    submitDeferredLog(callSite->eLogLevel, record);
+}
+
+/// <summary>
+/// 호출 위치의 속도 제한/중복 여부 확인. 통과하면 그동안 생략한 로그의 요약을 먼저 남긴다.
+/// </summary>
+/// <returns>record 를 남겨야 하면 true</returns>
+bool CLogger::admitDeferredLog(const SLogCallSite& callSite, const CLogLineBuffer& record) {
+    SDeferredLogHeader header;
+    std::memcpy(&header, record.data(), sizeof(header));
+    SLogSiteSummary summary;
+    if (!rateLimiter.admit(*callSite.siteState, &callSite, header.format, record.data() + sizeof(header),
+        record.size() - sizeof(header), summary)) {
+        return false;
+    }
+    writeSiteSummary(summary);
+    return true;
+}
+
+/// <summary>
+/// 지연 포맷 레코드를 비동기 모드면 그대로 스레드 버퍼에 넣고, 아니면 바로 sink 로 전달한다.
+/// </summary>
+void CLogger::submitDeferredLog(ELogLevel eLogLevel, const CLogLineBuffer& record) {
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        enqueueLog(ELogRecordKind::DEFERRED, eLogLevel, record.data(), record.size());
+        return;
+    }
+    writeDeferredLog(eLogLevel, record.data(), record.size(), currentThreadNumber());
+}
 
-    logStream << "[" << getCurrentTime() << "]\t ";
-    logStream << "[" << logLevelToString(eLoglevel) << "]\t";
-    switch (eLoglevel)
+/// <summary>
+/// 생략한 로그 개수를 해당 호출 위치의 로그로 남긴다.
+/// 작성 중인 레코드(beginDeferredLog 의 버퍼)를 덮어쓰지 않도록 별도 버퍼를 사용한다.
+/// </summary>
+void CLogger::writeSiteSummary(const SLogSiteSummary& summary) {
+    thread_local CLogLineBuffer record;
+    const char* formats[2] = { kSuppressedFormat, kRepeatedFormat };
+    unsigned long long counts[2] = { summary.suppressedCount, summary.repeatedCount };
+    for (int i = 0; i < 2; ++i) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        SDeferredLogHeader header;
+        header.callSite = summary.callSite;
+        header.format = formats[i];
+        header.rawTime = logClock.now();
+        header.argCount = 1;
+        header.sampleRate = 1.0f;
+        header.scope = false;
+
+        record.clear();
+        record.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        LogArgs::encode(record, counts[i]);
+        submitDeferredLog(summary.callSite->eLogLevel, record);
+    }
+}
+
+/// <summary>
+/// 아직 요약을 남기지 않은 생략 로그를 모두 요약으로 기록 (flush, 종료 시)
+/// </summary>
+void CLogger::writePendingSiteSummaries() {
+    std::vector<SLogSiteSummary> summaries;
+    rateLimiter.takePendingSummaries(summaries);
+    for (const auto& summary : summaries) {
+        writeSiteSummary(summary);
+    }
+}
+
+/// <summary>
+/// 모든 레벨에 같은 호출 위치별 속도 제한 설정
+/// </summary>
+/// <param name="recordsPerSecond : 호출 위치 하나가 1초에 남길 수 있는 로그 개수, 0 이하면 제한 없음"></param>
+/// <param name="burst : 한꺼번에 남길 수 있는 최대 개수, 0 이면 recordsPerSecond"></param>
+void CLogger::setRateLimit(double recordsPerSecond, unsigned burst) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    for (int i = 0; i < SLogConfig::kLevelCount; ++i) {
+        next->rateLimit[i] = recordsPerSecond;
+        next->rateBurst[i] = burst;
+    }
+    publishConfigLocked(next);
+}
+
+void CLogger::setRateLimit(ELogLevel eLogLevel, double recordsPerSecond, unsigned burst) {
+    int level = static_cast<int>(eLogLevel);
+    if (level < 0 || level >= SLogConfig::kLevelCount) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    next->rateLimit[level] = recordsPerSecond;
+    next->rateBurst[level] = burst;
+    publishConfigLocked(next);
+}
+
+void CLogger::setDuplicateSuppression(bool enable) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    next->duplicateSuppression = enable;
+    publishConfigLocked(next);
+}
+
+unsigned long long CLogger::getRateLimitedCount() const {
+    return rateLimiter.getSuppressedCount();
+}
+
+unsigned long long CLogger::getRepeatedCount() const {
+    return rateLimiter.getRepeatedCount();
+}
+
+/// <summary>
+/// 레벨 전체 샘플링 설정
+/// </summary>
+/// <param name="eMode : PROBABILITY / EVERY_N, ALL 이면 해제"></param>
+/// <param name="value : PROBABILITY 는 기록 확률(0 ~ 1), EVERY_N 은 N"></param>
+void CLogger::setSampling(ELogLevel eLogLevel, ESampleMode eMode, double value) {
+    setSamplingRule(SLogSampleRule{ std::string(), eLogLevel, eMode, value });
+}
+
+/// <summary>
+/// 소스 파일별 샘플링 설정 (레벨 전체 설정보다 우선)
+/// </summary>
+/// <param name="fileName : 소스 파일 이름 (예: "Network.cpp")"></param>
+void CLogger::setSampling(const char* fileName, ELogLevel eLogLevel, ESampleMode eMode, double value) {
+    setSamplingRule(SLogSampleRule{ logBaseName(fileName), eLogLevel, eMode, value });
+}
+
+void CLogger::clearSampling() {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    next->sampling.clear();
+    publishConfigLocked(next);
+}
+
+/// <summary>
+/// 샘플링 규칙 하나 추가. 같은 파일/레벨의 규칙이 있으면 바꾼다.
+/// </summary>
+void CLogger::setSamplingRule(const SLogSampleRule& rule) {
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = copyConfigLocked();
+    bool replaced = false;
+    for (auto& sampleRule : next->sampling) {
+        if (sampleRule.fileName == rule.fileName && sampleRule.eLogLevel == rule.eLogLevel) {
+            sampleRule = rule;
+            replaced = true;
+            break;
+        }
+    }
+    if (!replaced) {
+        next->sampling.push_back(rule);
+    }
+    publishConfigLocked(next);
+}
+
+/// <summary>
+/// 설정 스냅샷 적용
+/// 레벨, 규칙, 속도 제한, 샘플링, sink 목록을 담은 새 스냅샷으로 한 번에 교체하므로, 로그 호출 스레드는 락을 잡지 않고
+/// 이전 스냅샷 전체 또는 새 스냅샷 전체를 본다. 호출 위치별 캐시는 교체 직후 새 스냅샷에서 다시 계산한다.
+/// 이전 스냅샷과 같은 항목의 캐시는 그대로 둔다. (샘플링 규칙을 다시 적용하면 호출 위치마다 규칙을 다시 찾는다)
+/// </summary>
+/// <param name="config : 적용할 설정 (복사해서 보관, sinks 는 사용하지 않음)"></param>
+void CLogger::applyConfig(const SLogConfig& config) {
+    std::lock_guard<std::mutex> applyLock(configApplyMutex);
+
+    // trace 파일은 열지 못하면 예외이므로 먼저 연다. (실패하면 아무것도 바꾸지 않음)
+    std::shared_ptr<CTraceLogSink> trace;
+    bool traceChanged = getConfig()->tracePath != config.tracePath;
+    if (traceChanged && !config.tracePath.empty()) {
+        trace = std::make_shared<CTraceLogSink>(config.tracePath);
+        trace->enableDedicatedThread(65536, EOverflowPolicy::BLOCK);
+    }
+    else if (traceChanged && asyncEnabled.load(std::memory_order_acquire) && std::this_thread::get_id() != writerThread.get_id()) {
+        // trace 를 끄기 전에 스레드 버퍼에 남은 로그를 trace 파일까지 기록
+        flush();
+    }
+
+    std::lock_guard<std::mutex> lock(sinkConfigMutex);
+    std::shared_ptr<SLogConfig> next = std::make_shared<SLogConfig>(config);
+    next->sinks = getConfig()->sinks;
+    if (traceChanged) {
+        replaceTraceSinkLocked(*next, trace);
+    }
+    publishConfigLocked(next);
+
+    // sink 의 최소 레벨은 sink 가 가지고 있다. 비행 기록 장치의 대상 sink 는 비행 기록 장치를 통해 지정한다. (끌 때 이 레벨로 되돌림)
+    auto applySinkLevel = [this](const std::shared_ptr<CLogSink>& sink, int level) {
+        if (!sink || level < 0) {
+            return;
+        }
+        if (flightRecorder && flightRecorder->getTarget() == sink) {
+            flightRecorder->setTargetLevel(static_cast<ELogLevel>(level));
+        }
+        else {
+            sink->setMinLevel(static_cast<ELogLevel>(level));
+        }
+    };
+    applySinkLevel(consoleSink, config.consoleLevel);
+    applySinkLevel(fileSink, config.fileLevel);
+}
+
+std::shared_ptr<const SLogConfig> CLogger::getConfig() const {
+    return activeConfig.share();
+}
+
+void CLogger::loadConfig(const std::string& path) {
+    applyConfig(LogConfig::load(path));
+}
+
+/// <summary>
+/// 설정 파일 감시 시작
+/// 처음 적용은 호출한 스레드에서 하므로 잘못된 파일이면 std::runtime_error 이고 감시를 시작하지 않는다.
+/// 이후 다시 읽다가 실패하면 WARNING 로그를 남기고 기존 설정을 유지한다.
+/// </summary>
+/// <param name="path : 설정 파일 경로"></param>
+/// <param name="pollMilliseconds : 파일 수정 시각/크기를 확인하는 주기"></param>
+void CLogger::watchConfig(const std::string& path, unsigned pollMilliseconds) {
+    stopWatchingConfig();
+    // 읽기 전에 확인해 두어야 읽은 뒤 감시 스레드가 시작되기 전에 바뀐 내용도 다시 읽는다.
+    long long modifiedTime = 0;
+    unsigned long long size = 0;
+    LogPlatform::fileStamp(path, modifiedTime, size);
+    loadConfig(path);
+    std::lock_guard<std::mutex> lock(configWatchMutex);
+    stopConfigWatch = false;
+    LogConfig::installReloadSignal();
+    configWatchThread = std::thread(&CLogger::configWatchThreadMain, this, path, pollMilliseconds < 1 ? 1 : pollMilliseconds,
+        modifiedTime, size);
+}
+
+void CLogger::stopWatchingConfig() {
+    {
+        std::lock_guard<std::mutex> lock(configWatchMutex);
+        stopConfigWatch = true;
+        configWatchWakeup.notify_one();
+    }
+    if (configWatchThread.joinable()) {
+        configWatchThread.join();
+        LogConfig::uninstallReloadSignal();
+    }
+}
+
+void CLogger::reloadConfig(const std::string& path) {
+    try {
+        loadConfig(path);
+        logMessage(ELogLevel::LOG_INFO, "Log config reloaded: " + path, __FUNCTION__, extractFileName(__FILE__), __LINE__);
+    }
+    catch (const std::exception& e) {
+        logMessage(ELogLevel::LOG_WARNING, std::string("Log config reload failed: ") + e.what(),
+            __FUNCTION__, extractFileName(__FILE__), __LINE__);
+    }
+}
+
+/// <summary>
+/// 설정 파일 감시 스레드
+/// SIGHUP 핸들러는 요청 표시만 남기므로, 짧은 간격으로 깨어나서 요청을 확인하고 pollMilliseconds 마다 파일을 확인한다.
+/// </summary>
+void CLogger::configWatchThreadMain(std::string path, unsigned pollMilliseconds, long long modifiedTime,
+    unsigned long long size) {
+    const std::chrono::milliseconds kSignalCheckInterval(100);
+    std::chrono::steady_clock::time_point nextPoll = std::chrono::steady_clock::now() + std::chrono::milliseconds(pollMilliseconds);
+
+    std::unique_lock<std::mutex> lock(configWatchMutex);
+    for (;;) {
+        configWatchWakeup.wait_for(lock, (std::min)(kSignalCheckInterval, std::chrono::milliseconds(pollMilliseconds)),
+            [this] { return stopConfigWatch; });
+        if (stopConfigWatch) {
+            return;
+        }
+        bool reload = LogConfig::takeReloadRequest();
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (reload || now >= nextPoll) {
+            nextPoll = now + std::chrono::milliseconds(pollMilliseconds);
+            long long currentModifiedTime = 0;
+            unsigned long long currentSize = 0;
+            if (LogPlatform::fileStamp(path, currentModifiedTime, currentSize)
+                && (currentModifiedTime != modifiedTime || currentSize != size)) {
+                modifiedTime = currentModifiedTime;
+                size = currentSize;
+                reload = true;
+            }
+        }
+        if (reload) {
+            lock.unlock();
+            reloadConfig(path);
+            lock.lock();
+        }
+    }
+}
+
+/// <summary>
+/// LOG_SCOPE 시간 측정 방식 설정 (SYSTEM_CLOCK 은 STEADY_CLOCK 으로 처리)
+/// </summary>
+void CLogger::setScopeTimeSource(ETimeSource eSource) {
+    scopeClock.configure(ETimePrecision::NANOSECONDS,
+        eSource == ETimeSource::SYSTEM_CLOCK ? ETimeSource::STEADY_CLOCK : eSource);
+}
+
+/// <summary>
+/// 스코프가 끝날 때 호출. LOG_SCOPE 는 로그 하나로 기록하고, LOG_SCOPE_STATS 는 현재 스레드의 집계에 더한다.
+/// 기록 형식 : "이름 elapsed_us=실행 시간 depth=중첩 깊이"
+/// 속도 제한/중복 생략은 적용하지 않는다. (LOG_SCOPE_STATS 집계도 같음)
+/// </summary>
+void CLogger::endScope(const SLogCallSite& callSite, const char* name, long long startTime, unsigned depth,
+    bool aggregate) {
+    long long elapsedNanos = scopeClock.toWallNanoseconds(scopeClock.now()) - scopeClock.toWallNanoseconds(startTime);
+    if (elapsedNanos < 0) {
+        elapsedNanos = 0;
+    }
+    if (aggregate) {
+        scopeStats.record(callSite, name, static_cast<unsigned long long>(elapsedNanos));
+        return;
+    }
+    logScopeFields(&callSite, true, name, "elapsed_us", elapsedNanos / 1000.0, "depth", depth);
+}
+
+/// <summary>
+/// LOG_SCOPE_STATS 보고 주기 설정. 주기가 바뀌면 보고 스레드를 다시 시작한다.
+/// </summary>
+/// <param name="milliseconds : 0 이면 보고 스레드를 멈추고 flush 때만 기록"></param>
+void CLogger::setScopeStatsInterval(unsigned milliseconds) {
+    stopScopeStatsThread();
+    if (milliseconds == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(scopeStatsMutex);
+    scopeStatsInterval = milliseconds;
+    stopScopeStats = false;
+    scopeStatsThread = std::thread(&CLogger::scopeStatsThreadMain, this);
+}
+
+void CLogger::stopScopeStatsThread() {
     {
-    case ELogLevel::LOG_DEBUG:
-        logStream << "==> " << message;
-        break;
-    case ELogLevel::LOG_INFO:
-        logStream << "\t--> " << message;
-        break;
-    case ELogLevel::LOG_WARNING:
-        logStream << "** " << message;
-        break;
-    case ELogLevel::LOG_ERROR:
-        logStream << "!! " << message;
-        break;
+        std::lock_guard<std::mutex> lock(scopeStatsMutex);
+        stopScopeStats = true;
+        scopeStatsWakeup.notify_one();
+    }
+    if (scopeStatsThread.joinable()) {
+        scopeStatsThread.join();
+    }
+}
+
+void CLogger::scopeStatsThreadMain() {
+    std::unique_lock<std::mutex> lock(scopeStatsMutex);
+    for (;;) {
+        scopeStatsWakeup.wait_for(lock, std::chrono::milliseconds(scopeStatsInterval), [this] { return stopScopeStats; });
+        if (stopScopeStats) {
+            return;
+        }
+        lock.unlock();
+        flushScopeStats();
+        lock.lock();
+    }
+}
+
+/// <summary>
+/// 모든 스레드의 LOG_SCOPE_STATS 집계를 합쳐서 스코프마다 로그 하나로 기록
+/// </summary>
+void CLogger::flushScopeStats() {
+    std::vector<SLogScopeSummary> summaries;
+    {
+        std::lock_guard<std::mutex> lock(scopeCollectMutex);
+        scopeStats.collect(summaries);
+    }
+    for (const auto& summary : summaries) {
+        writeScopeSummary(summary);
     }
+}
+
+/// <summary>
+/// 스코프 집계 하나를 기록
+/// "이름 count=횟수 min_us= mean_us= max_us= p50_us= p99_us= histogram=칸 상한:횟수,..."
+/// 백분위 값은 히스토그램 칸의 상한(2 배 간격)이므로 근사값이다.
+/// </summary>
+void CLogger::writeScopeSummary(const SLogScopeSummary& summary) {
+    double percentileNanos[2] = { 0.0, 0.0 };
+    const double percentiles[2] = { 0.50, 0.99 };
+    std::string histogram;
+    unsigned long long cumulative = 0;
+    int found = 0;
+    for (int b = 0; b < SLogScopeSummary::kBucketCount; ++b) {
+        if (summary.buckets[b] == 0) {
+            continue;
+        }
+        cumulative += summary.buckets[b];
+        double upperNanos = b + 1 < 64 ? static_cast<double>(1ULL << (b + 1)) : 0.0;
+        while (found < 2 && cumulative >= percentiles[found] * summary.count) {
+            percentileNanos[found++] = (std::min)(upperNanos, static_cast<double>(summary.maxNanos));
+        }
+        if (!histogram.empty()) {
+            histogram += ',';
+        }
+        appendDurationLabel(histogram, 1ULL << (b + 1));
+        histogram += ':';
+        histogram += std::to_string(summary.buckets[b]);
+    }
+    logScopeFields(summary.callSite, false, summary.name, "count", summary.count,
+        "min_us", summary.minNanos / 1000.0, "mean_us", static_cast<double>(summary.totalNanos) / summary.count / 1000.0,
+        "max_us", summary.maxNanos / 1000.0, "p50_us", percentileNanos[0] / 1000.0, "p99_us", percentileNanos[1] / 1000.0,
+        "histogram", histogram);
+}
+
+/// <summary>
+/// 지연 포맷 레코드를 sink 로 전달. 문자열 변환은 텍스트가 필요한 sink 가 있을 때만 한다.
+/// </summary>
+void CLogger::writeDeferredLog(ELogLevel eLogLevel, const char* record, size_t size, unsigned threadNumber) {
+    SDeferredLogHeader header;
+    std::memcpy(&header, record, sizeof(header));
 
-    logStream << " (Log from " << functionName
-        << " at " << extractFileName(fileName) << ":" << lineNumber << ")\n";
-    writeLog(logStream.str());
+    SLogEvent event;
+    event.eLogLevel = eLogLevel;
+    event.threadNumber = threadNumber;
+    event.rawTime = header.rawTime;
+    event.clock = &logClock;
+    event.callSite = header.callSite;
+    event.format = header.format;
+    event.args = record + sizeof(header);
+    event.argsSize = size - sizeof(header);
+    event.argCount = header.argCount;
+    event.sampleRate = header.sampleRate;
+    event.scope = header.scope;
+    deliverLog(event);
+}
+
+/// <summary>
+/// 로그 한 줄을 line 버퍼에 조립
+/// [시간]\t [종류]\t표시 메시지 (Log from 함수 at 파일:줄)
+/// </summary>
+void CLogger::formatLog(CLogLineBuffer& line, const SLogCallSite& callSite, const char* message, size_t messageSize) const {
+    line.clear();
+    LogText::appendPrefix(line, logClock, logClock.now(), callSite.levelTag);
+    line.append(message, messageSize);
+    LogText::appendSuffix(line, callSite);
+}
+
+/// <summary>
+/// 조립된 로그를 비동기 모드면 스레드 버퍼로, 아니면 바로 출력
+/// </summary>
+void CLogger::dispatchLog(ELogLevel eLogLevel, const char* logEntry, size_t size) {
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        enqueueLog(ELogRecordKind::TEXT, eLogLevel, logEntry, size);
+        return;
+    }
+    writeLog(eLogLevel, logEntry, size, currentThreadNumber());
 }
 
 /// <summary>
 /// 전체 파일 디렉토리 중에 마지막 파일 이름만 잘라서 반환
+/// 새 문자열을 만들지 않고 filePath 내부의 위치를 반환한다.
 /// </summary>
 /// <param name="filePath"></param>
 /// <returns></returns>
-std::string CLogger::extractFileName(const std::string& filePath) const {
-#if __cplusplus >= 201703L
-    return std::filesystem::path(filePath).filename().string();
-#else
-    size_t lastSlashPos = filePath.find_last_of("/\\");
-    if (lastSlashPos == std::string::npos) {
-        return filePath;
+const char* CLogger::extractFileName(const char* filePath) const {
+    return logBaseName(filePath);
+}
+
+/// <summary>
+/// 텍스트로 조립된 로그를 sink 로 전달
+/// </summary>
+/// <param name="eLogLevel"></param>
+/// <param name="logEntry : 텍스트로 조립된 로그"></param>
+/// <param name="size"></param>
+/// <param name="threadNumber : 로그를 남긴 스레드 번호"></param>
+void CLogger::writeLog(ELogLevel eLogLevel, const char* logEntry, size_t size, unsigned threadNumber) {
+    SLogEvent event;
+    event.eLogLevel = eLogLevel;
+    event.threadNumber = threadNumber;
+    event.rawTime = logClock.now();
+    event.clock = &logClock;
+    event.text = logEntry;
+    event.textSize = size;
+    deliverLog(event);
+}
+
+/// <summary>
+/// 로그를 받을 sink 마다 전달
+/// 기본 텍스트 형식을 쓰는 sink 가 있으면 한 번만 조립해서 함께 넘긴다.
+/// 설정 스냅샷은 읽기 구간 안에서 포인터로만 읽는다. (락, 참조 카운트 변경 없음)
+/// </summary>
+/// <param name="event"></param>
+void CLogger::deliverLog(SLogEvent& event) {
+    CLogReadSection section;
+    const SLogConfig* config = activeConfig.get();
+    thread_local CLogLineBuffer line;
+    for (const auto& sink : config->sinks) {
+        if (!sink->accepts(event.eLogLevel)) {
+            continue;
+        }
+        if (event.text == nullptr && sink->usesDefaultText()) {
+            LogText::render(line, event);
+            event.text = line.data();
+            event.textSize = line.size();
+        }
+        sink->submit(event);
     }
-    return filePath.substr(lastSlashPos + 1);
-#endif
 }
 
 /// <summary>
-/// 로그 내용을 로그파일, 실행창에 전시
+/// 비동기 로그 모드 시작
+/// 이후 로그 호출 스레드는 자신의 버퍼에 로그를 넣기만 하고, 출력은 writer 스레드가 처리한다.
 /// </summary>
-/// <param name="logEntry"></param>
-void CLogger::writeLog(const std::string& logEntry) {
-    // 멀티스레드 환경에서 여러 스레드가 동시에 공유 자원에 접근하는 것을 막기 위해 사용함 
-    std::lock_guard<std::mutex> lock(logMutex);
-    std::ofstream logFile;
-    logFile.open(logFilename, std::ios::app);
-    if (saveToFile && logFile.is_open()) {
-        logFile.write(logEntry.c_str(), logEntry.size());
-        logFile.close();
+/// <param name="threadBufferCapacity : 스레드별 버퍼 슬롯 개수 (2의 거듭제곱으로 올림)"></param>
+/// <param name="eOverflowPolicy : 버퍼가 가득 찼을 때의 처리 방식"></param>
+void CLogger::enableAsyncLogging(size_t threadBufferCapacity, EOverflowPolicy eOverflowPolicy) {
+    std::lock_guard<std::mutex> control(asyncControlMutex);
+    if (asyncEnabled.load()) {
+        return;
+    }
+
+    this->threadBufferCapacity = threadBufferCapacity;
+    overflowPolicy = eOverflowPolicy;
+    stopWriter.store(false);
+    writerThread = std::thread(&CLogger::writerThreadMain, this);
+    asyncEnabled.store(true, std::memory_order_release);
+}
+
+/// <summary>
+/// 현재까지 버퍼에 들어간 로그가 모두 출력될 때까지 대기
+/// </summary>
+void CLogger::flush() {
+    flushScopeStats();
+    writePendingSiteSummaries();
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        std::vector<std::pair<std::shared_ptr<CThreadLogBuffer>, unsigned long long>> targets;
+        {
+            std::lock_guard<std::mutex> registryLock(registryMutex);
+            for (const auto& buffer : threadBuffers) {
+                targets.emplace_back(buffer, buffer->getRecordCount());
+            }
+        }
+        std::unique_lock<std::mutex> lock(writerMutex);
+        writerWakeup.notify_one();
+        flushDone.wait(lock, [&] {
+            if (!asyncEnabled.load()) {
+                return true;
+            }
+            for (const auto& target : targets) {
+                if (target.first->getPoppedCount() < target.second) {
+                    return false;
+                }
+            }
+            return true;
+        });
     }
-    std::cout << logEntry;
+    for (const auto& sink : getConfig()->sinks) {
+        sink->flush();
+    }
+}
 
-    // mutex 잠금 해제됨 
+/// <summary>
+/// 비동기 모드 종료. 버퍼에 남은 로그를 모두 출력한 뒤 writer 스레드를 종료하고 동기 모드로 돌아간다.
+/// </summary>
+void CLogger::shutdown() {
+    writePendingSiteSummaries();
+    std::lock_guard<std::mutex> control(asyncControlMutex);
+    if (!asyncEnabled.load()) {
+        return;
+    }
+
+    asyncEnabled.store(false);
+    // 이미 버퍼에 넣는 중인 스레드가 끝날 때까지 대기
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        for (const auto& buffer : threadBuffers) {
+            while (buffer->producing.load()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stopWriter.store(true);
+        writerWakeup.notify_one();
+    }
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+    flushDone.notify_all();
+}
+
+unsigned long long CLogger::getDroppedCount() const {
+    unsigned long long total = 0;
+    for (const auto& dropped : droppedCount) {
+        total += dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+unsigned long long CLogger::getDroppedCount(ELogLevel eLogLevel) const {
+    return droppedCount[static_cast<int>(eLogLevel)].load(std::memory_order_relaxed);
 }
 
 /// <summary>
-/// 현재 시간 정보 반환
-/// 추 후, milliseconds 단위로 측정되도록 개선 예정
+/// 비동기 모드에서 로그를 남긴 스레드별 통계
 /// </summary>
 /// <returns></returns>
-std::string CLogger::getCurrentTime() const {
-    auto now = std::chrono::system_clock::now();
-    auto nowTime = std::chrono::system_clock::to_time_t(now);
-    std::tm localTime;
-    // 현재 시간 정보 구조체를 로컬에 복사
-    localtime_s(&localTime, &nowTime);
+std::vector<SThreadLogStats> CLogger::getThreadStats() const {
+    std::vector<SThreadLogStats> stats;
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    stats.reserve(threadBuffers.size());
+    for (const auto& buffer : threadBuffers) {
+        SThreadLogStats threadStats;
+        threadStats.threadId = buffer->getThreadId();
+        threadStats.recordCount = buffer->getRecordCount();
+        threadStats.byteCount = buffer->getByteCount();
+        threadStats.droppedCount = buffer->getDroppedCount();
+        threadStats.threadExited = buffer->released.load();
+        stats.push_back(threadStats);
+    }
+    return stats;
+}
 
-    char buffer[20];
-    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &localTime);
-    return std::string(buffer);
+namespace {
+    // 스레드 종료 시 버퍼를 released 로 표시. 남은 로그는 writer 스레드가 출력한 뒤 버퍼를 제거한다.
+    struct SThreadBufferHandle {
+        std::shared_ptr<CThreadLogBuffer> buffer;
+        ~SThreadBufferHandle() {
+            if (buffer) {
+                buffer->released.store(true);
+            }
+        }
+    };
 }
 
-std::string CLogger::logLevelToString(ELogLevel eLogLevel)
-{
-    switch (eLogLevel) {
-    case ELogLevel::LOG_DEBUG: return "DEBUG";
-    case ELogLevel::LOG_INFO: return "INFO";
-    case ELogLevel::LOG_WARNING: return "WARNING";
-    case ELogLevel::LOG_ERROR: return "ERROR";
-    default: return "UNKNOWN";
+/// <summary>
+/// 현재 스레드의 버퍼를 반환. 처음 호출한 스레드는 버퍼를 만들어 목록에 등록한다.
+/// </summary>
+/// <returns></returns>
+CThreadLogBuffer& CLogger::getThreadBuffer() {
+    thread_local SThreadBufferHandle handle;
+    if (!handle.buffer) {
+        handle.buffer = std::make_shared<CThreadLogBuffer>(threadBufferCapacity, currentThreadNumber());
+        std::lock_guard<std::mutex> registryLock(registryMutex);
+        threadBuffers.push_back(handle.buffer);
+        registryGeneration.fetch_add(1);
+    }
+    return *handle.buffer;
+}
+
+/// <summary>
+/// 로그를 현재 스레드의 버퍼에 넣는다. 버퍼가 가득 찬 경우 overflowPolicy 에 따라 대기하거나 버린다.
+/// </summary>
+/// <param name="eRecordKind"></param>
+/// <param name="eLogLevel"></param>
+/// <param name="logEntry"></param>
+/// <param name="size"></param>
+void CLogger::enqueueLog(ELogRecordKind eRecordKind, ELogLevel eLogLevel, const char* logEntry, size_t size) {
+    CThreadLogBuffer& buffer = getThreadBuffer();
+    buffer.producing.store(true);
+    // shutdown 과 경합한 경우 동기 방식으로 출력
+    if (!asyncEnabled.load()) {
+        buffer.producing.store(false);
+        if (eRecordKind == ELogRecordKind::DEFERRED) {
+            writeDeferredLog(eLogLevel, logEntry, size, buffer.getThreadNumber());
+        }
+        else {
+            writeLog(eLogLevel, logEntry, size, buffer.getThreadNumber());
+        }
+        return;
+    }
+
+    bool lowLevel = eLogLevel == ELogLevel::LOG_DEBUG || eLogLevel == ELogLevel::LOG_INFO;
+    if (overflowPolicy == EOverflowPolicy::DROP_DEBUG_INFO_FIRST && lowLevel
+        && buffer.sizeApprox() >= buffer.capacity() / 4 * 3) {
+        buffer.countDropped();
+        droppedCount[static_cast<int>(eLogLevel)].fetch_add(1, std::memory_order_relaxed);
+        buffer.producing.store(false, std::memory_order_release);
+        return;
+    }
+
+    long long timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    while (!buffer.tryPush(eRecordKind, eLogLevel, timestamp, logEntry, size)) {
+        if (overflowPolicy == EOverflowPolicy::DROP_NEWEST
+            || (overflowPolicy == EOverflowPolicy::DROP_DEBUG_INFO_FIRST && lowLevel)) {
+            buffer.countDropped();
+            droppedCount[static_cast<int>(eLogLevel)].fetch_add(1, std::memory_order_relaxed);
+            buffer.producing.store(false, std::memory_order_release);
+            return;
+        }
+        wakeWriter();
+        std::this_thread::yield();
+    }
+    buffer.producing.store(false, std::memory_order_release);
+
+    if (writerSleeping.load(std::memory_order_relaxed)) {
+        wakeWriter();
+    }
+}
+
+void CLogger::wakeWriter() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writerWakeup.notify_one();
+}
+
+void CLogger::writeRecordFromWriter(const SLogRecord& record, unsigned threadNumber) {
+    if (record.eRecordKind == ELogRecordKind::DEFERRED) {
+        writeDeferredLog(record.eLogLevel, record.data(), record.size(), threadNumber);
+    }
+    else {
+        writeLog(record.eLogLevel, record.data(), record.size(), threadNumber);
+    }
+}
+
+/// <summary>
+/// 모든 스레드 버퍼의 로그를 시간 순서로 병합하여 출력
+/// 각 버퍼의 맨 앞 레코드 중 timestamp 가 가장 작은 것부터 꺼낸다.
+/// </summary>
+/// <returns>출력한 로그 개수</returns>
+size_t CLogger::drainThreadBuffers(std::vector<std::shared_ptr<CThreadLogBuffer>>& buffers) {
+    size_t written = 0;
+    for (;;) {
+        CThreadLogBuffer* oldestBuffer = nullptr;
+        SLogRecord* oldest = nullptr;
+        for (const auto& buffer : buffers) {
+            SLogRecord* record = buffer->front();
+            if (record != nullptr && (oldest == nullptr || record->timestamp < oldest->timestamp)) {
+                oldest = record;
+                oldestBuffer = buffer.get();
+            }
+        }
+        if (oldest == nullptr) {
+            return written;
+        }
+        writeRecordFromWriter(*oldest, oldestBuffer->getThreadNumber());
+        oldestBuffer->pop();
+        ++written;
     }
 }
 
+/// <summary>
+/// writer 스레드 본체. 스레드별 버퍼를 비우면서 writeLog 로 출력하고, 모두 비면 잠시 대기한다.
+/// </summary>
+void CLogger::writerThreadMain() {
+    std::vector<std::shared_ptr<CThreadLogBuffer>> buffers;
+    unsigned knownGeneration = registryGeneration.load() - 1;
+    for (;;) {
+        // 종료 요청은 버퍼 목록을 갱신하기 전에 확인해야, 요청 전에 등록된 버퍼를 놓치지 않는다.
+        bool stopping = stopWriter.load();
+
+        // 버퍼 목록이 바뀌었을 때만 복사본을 갱신
+        unsigned generation = registryGeneration.load();
+        if (generation != knownGeneration) {
+            std::lock_guard<std::mutex> registryLock(registryMutex);
+            buffers = threadBuffers;
+            knownGeneration = registryGeneration.load();
+        }
+
+        size_t written = drainThreadBuffers(buffers);
+
+        // 종료된 스레드의 버퍼는 비워졌으면 목록에서 제거
+        bool hasReleased = false;
+        for (const auto& buffer : buffers) {
+            if (buffer->released.load() && buffer->sizeApprox() == 0) {
+                hasReleased = true;
+                break;
+            }
+        }
+        if (hasReleased) {
+            std::lock_guard<std::mutex> registryLock(registryMutex);
+            threadBuffers.erase(std::remove_if(threadBuffers.begin(), threadBuffers.end(),
+                [](const std::shared_ptr<CThreadLogBuffer>& buffer) {
+                    return buffer->released.load() && buffer->sizeApprox() == 0;
+                }), threadBuffers.end());
+            registryGeneration.fetch_add(1);
+        }
+
+        std::unique_lock<std::mutex> lock(writerMutex);
+        if (written > 0) {
+            flushDone.notify_all();
+        }
+        if (written == 0 && stopping) {
+            break;
+        }
+        if (written == 0) {
+            writerSleeping.store(true);
+            writerWakeup.wait_for(lock, std::chrono::milliseconds(10));
+            writerSleeping.store(false);
+        }
+        lock.unlock();
+
+        // 로그가 없는 동안에도 INTERVAL 정책의 flush, 파일 교체가 늦어지지 않도록 확인
+        std::shared_ptr<const SLogConfig> config = getConfig();
+        for (const auto& sink : config->sinks) {
+            sink->poll();
+        }
+    }
+}
+
+SLogStringView CLogger::logLevelToString(ELogLevel eLogLevel)
+{
+    static const SLogStringView levelNames[] = {
+        { "DEBUG", 5 }, { "INFO", 4 }, { "WARNING", 7 }, { "ERROR", 5 }
+    };
+    static const SLogStringView unknown = { "UNKNOWN", 7 };
+    int index = static_cast<int>(eLogLevel);
+    return index >= 0 && index < 4 ? levelNames[index] : unknown;
+}
+
 CExcep::CExcep(const std::string& msg)
 {
     message = msg;
+    // 예외 직전의 상황을 남기기 위해 비행 기록 장치에 보관한 로그를 기록
+    CLogger::getInstance().dumpFlightRecorder("CExcep");
 }
 
 const std::string& CExcep::what() const
@@ -191,6 +1428,7 @@ const std::string& CExcep::what() const
 
 CExcep::CExcep()
 {
+    CLogger::getInstance().dumpFlightRecorder("CExcep");
 }
 
 CExcep::~CExcep()
@@ -198,6 +1436,7 @@ CExcep::~CExcep()
 }
 
 CExcep::CExcep(const CExcep& other)
+    : message(other.message)
 {
-    // 복사 생성자, 명시적으로 정의
+    // 복사 생성자, 명시적으로 정의 (복사할 때는 비행 기록 장치를 다시 기록하지 않음)
 }
@@ -1,4 +1,4 @@
-// CLogger.h
+﻿// CLogger.h
 #ifndef CLogger_H
 #define CLogger_H
 
@@ -8,40 +8,391 @@
 #include <exception>
 #include <chrono>
 #include <sstream>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <vector>
 
+#include "LogArgs.h"
+#include "LogSnapshot.h"
+#include "LogClock.h"
+#include "LogLevelFilter.h"
+#include "LogRateLimiter.h"
+#include "LogRotator.h"
+#include "LogSampler.h"
+#include "LogScopeStats.h"
 
-// α   
+
+// 로그 종류 열거자 
 enum class ELogLevel {
     LOG_DEBUG,
     LOG_INFO,
     LOG_WARNING,
     LOG_ERROR
 };
+
+// 비동기 모드에서 스레드 버퍼가 가득 찼을 때의 처리 방식
+enum class EOverflowPolicy {
+    BLOCK,                  // 빈 슬롯이 생길 때까지 로그 호출 스레드가 대기
+    DROP_NEWEST,            // 새로 들어온 로그를 버림
+    DROP_DEBUG_INFO_FIRST   // 버퍼가 3/4 이상 차면 DEBUG/INFO 를 버리고, WARNING/ERROR 는 대기
+};
+
+// 로그파일 flush 시점
+enum class EFlushPolicy {
+    EVERY_RECORD,           // 로그마다 flush
+    EVERY_N_RECORDS,        // N 개의 로그마다 flush
+    EVERY_N_BYTES,          // N byte 이상 쌓이면 flush
+    INTERVAL                // 마지막 flush 후 T milliseconds 가 지나면 flush
+};
+
+// 로그파일 저장 형식
+enum class ELogFileFormat {
+    TEXT,       // 콘솔과 같은 텍스트
+    BINARY,     // 호출 위치 정의 + 로그별 시간 차이/호출 위치 id/인자 (LogDecoder 로 텍스트 변환)
+    JSON_LINES  // 로그 한 줄에 JSON 객체 하나 (시간, 레벨, 스레드, 호출 위치, 메시지, 구조화 필드)
+};
+
+// 로그파일 기록 방식
+enum class EFileWriteMode {
+    STREAM,     // 쓰기 버퍼를 사용하는 ofstream
+    WRITEV,     // sink 전용 스레드가 꺼낸 로그 묶음을 writev 한 번으로 기록
+    IO_URING    // 등록된 버퍼에 모아 io_uring 으로 비동기 기록 (Linux, LOGGER_WITH_IO_URING)
+};
+
+// 비동기 버퍼에 들어가는 레코드 종류
+enum class ELogRecordKind : unsigned char {
+    TEXT,       // 이미 포맷된 로그 한 줄
+    DEFERRED    // LOG_*F 지연 포맷 레코드 (호출 위치, 포맷 문자열, 시간, 인자)
+};
+
+// 정적 문자열 참조 (C++14 에서도 사용할 수 있도록 std::string_view 대신 사용)
+struct SLogStringView {
+    const char* data;
+    size_t size;
+};
+
+template <size_t N>
+constexpr SLogStringView makeLogStringView(const char (&text)[N]) {
+    return SLogStringView{ text, N - 1 };
+}
+
+// 로그 종류 표시 : "[종류]\t" + 메시지 앞 표시
+constexpr SLogStringView logLevelTag(ELogLevel eLogLevel) {
+    return eLogLevel == ELogLevel::LOG_DEBUG ? makeLogStringView("[DEBUG]\t==> ")
+        : eLogLevel == ELogLevel::LOG_INFO ? makeLogStringView("[INFO]\t\t--> ")
+        : eLogLevel == ELogLevel::LOG_WARNING ? makeLogStringView("[WARNING]\t** ")
+        : eLogLevel == ELogLevel::LOG_ERROR ? makeLogStringView("[ERROR]\t!! ")
+        : makeLogStringView("[UNKNOWN]\t");
+}
+
+// 전체 경로에서 마지막 파일 이름 위치를 반환 (컴파일 시간에 계산 가능)
+constexpr const char* logBaseName(const char* filePath) {
+    const char* fileName = filePath;
+    for (const char* p = filePath; *p != '\0'; ++p) {
+        if (*p == '/' || *p == '\\') {
+            fileName = p + 1;
+        }
+    }
+    return fileName;
+}
+
+// LOG_* 매크로 호출 위치 정보
+// 매크로를 사용한 곳마다 static constexpr 로 하나씩 만들어지므로 로그 호출 시에는 포인터만 전달한다.
+struct SLogCallSite {
+    ELogLevel eLogLevel;
+    SLogStringView levelTag;
+    const char* functionName;
+    const char* fileName;       // 디렉토리를 제외한 파일 이름
+    int lineNumber;
+    SLogSiteState* siteState;   // 속도 제한/중복 생략 상태 (매크로를 거치지 않은 로그는 nullptr)
+    const char* filePath;       // __FILE__ 전체 (모듈 레벨 규칙에 사용, 매크로를 거치지 않은 로그는 nullptr)
+};
+
+// 스레드별 비동기 로그 통계
+struct SThreadLogStats {
+    std::thread::id threadId;
+    unsigned long long recordCount;     // 버퍼에 넣은 로그 개수
+    unsigned long long byteCount;       // 버퍼에 넣은 byte 수
+    unsigned long long droppedCount;    // overflowPolicy 로 버린 로그 개수
+    bool threadExited;                  // 스레드가 종료되어 남은 로그만 출력 대기 중
+};
+
+class CThreadLogBuffer;
+struct SLogRecord;
+struct SLogEvent;
+class CLogSink;
+class CFileLogSink;
+class CConsoleLogSink;
+class CFlightRecorderSink;
+class CTraceLogSink;
+struct SLogConfig;
+
 class  CLogger {
 public:
     static CLogger& getInstance();
 
-    void configureLogging(const char* filename, bool enableFileLogging = true);
+    // 콘솔 + "Log" 디렉토리의 로그파일 sink 구성
+    void configureLogging(const char* filename, bool enableFileLogging = true, size_t writeBufferSize = 64 * 1024);
+    // 지정한 sink 들로 구성 (콘솔 출력도 포함하려면 CConsoleLogSink 를 넣어야 함)
+    void configureLogging(const std::vector<std::shared_ptr<CLogSink>>& sinks);
+    // 콘솔 + 공유 메모리 링 sink 구성 (여러 프로세스가 같은 로그파일을 쓸 때, 파일은 수집 프로세스(CLogCollector)가 기록)
+    // 수집 프로세스가 링을 만들기 전이면 std::runtime_error
+    void configureSharedLogging(const std::string& ringName);
+    void addSink(const std::shared_ptr<CLogSink>& sink);
+    void removeSink(const std::shared_ptr<CLogSink>& sink);
+    // 현재 구성의 로그파일/콘솔 sink (없으면 nullptr)
+    std::shared_ptr<CFileLogSink> getFileSink() const;
+    std::shared_ptr<CConsoleLogSink> getConsoleSink() const;
+
+    // 아래 로그파일 설정은 getFileSink() 에 적용된다.
+    void setFlushPolicy(EFlushPolicy eFlushPolicy, unsigned long long threshold = 0, bool flushOnError = true);
+    // 로그파일을 메모리 매핑으로 기록 (configureLogging 이후, 로그를 남기기 전에 호출)
+    void enableMappedFile(size_t segmentSize = 64 * 1024 * 1024);
+    // 로그파일 저장 형식 (configureLogging 이후, 로그를 남기기 전에 호출)
+    void setFileFormat(ELogFileFormat eFileFormat);
+    // 로그파일 기록 방식 (configureLogging 이후, 로그를 남기기 전에 호출)
+    // queueDepth : IO_URING 의 동시 기록 개수
+    void setFileWriteMode(EFileWriteMode eWriteMode, unsigned queueDepth = 8);
+    // 로그파일 크기/시간 기준 교체 설정
+    void setRotation(unsigned long long maxFileSize, unsigned intervalSeconds = 0, unsigned retentionCount = 5,
+        ELogCompression eCompression = ELogCompression::NONE);
+    SRotationStats getRotationStats() const;
+    // 비행 기록 장치(flight recorder) 사용 (configureLogging 이후에 호출)
+    // eRecordBelow 미만 레벨의 로그는 로그파일에 기록하지 않고 메모리의 링(capacity 개)에만 보관하다가,
+    // LOG_ERROR, CExcep 생성, dumpFlightRecorder 호출, 비정상 종료 시그널(installCrashHandler) 때 로그파일에 기록한다.
+    void enableFlightRecorder(size_t capacity = 8192, ELogLevel eRecordBelow = ELogLevel::LOG_WARNING,
+        bool installCrashHandler = true);
+    void disableFlightRecorder();
+    // 보관 중인 로그를 지금 기록 (비행 기록 장치를 사용하지 않으면 아무것도 하지 않음)
+    void dumpFlightRecorder(const char* reason = "explicit dump");
+    std::shared_ptr<CFlightRecorderSink> getFlightRecorder() const;
+    // Chrome Trace Event 형식(chrome://tracing, Perfetto UI)으로 로그와 LOG_SCOPE 구간을 path 에 추가로 기록 (configureLogging 이후에 호출)
+    // 이벤트 변환은 trace sink 전용 스레드에서 하며, 큐(queueCapacity 개)가 가득 차면 기다린다.
+    // 다시 호출하면 이전 trace 파일을 닫고 새 파일로 바꾼다. 실패하면 std::runtime_error
+    void enableTrace(const std::string& path, size_t queueCapacity = 65536);
+    // trace 파일을 닫는다. (JSON 배열 완성)
+    void disableTrace();
+    // 로그 시간 표시 단위/측정 방식 설정 (로그를 남기기 전에 호출)
+    void setTimestampFormat(ETimePrecision ePrecision, ETimeSource eSource = ETimeSource::SYSTEM_CLOCK);
+    const CLogClock& getLogClock() const { return logClock; }
+    // 현재 스레드의 로그 스레드 번호 (처음 호출할 때 부여)
+    static unsigned getThreadNumber();
     void logMessage(ELogLevel eLoglevel, const std::string& message, const char* functionName, const char* fileName, int lineNumber);
+    void logMessage(ELogLevel eLoglevel, const char* message, const char* functionName, const char* fileName, int lineNumber);
+    void logMessage(const SLogCallSite* callSite, const std::string& message);
+    void logMessage(const SLogCallSite* callSite, const char* message);
+
+    // 지연 포맷 로그 (LOG_*F 매크로용)
+    // 호출 스레드는 포맷 문자열 주소와 인자 값만 복사하고, 문자열 변환은 writer 스레드에서 처리한다.
+    // format 은 문자열 상수여야 한다. (레코드에는 주소만 저장됨)
+    template <typename... Args>
+    void logFormat(const SLogCallSite* callSite, const char* format, const Args&... args) {
+        CLogLineBuffer& record = beginDeferredLog(callSite, format, static_cast<unsigned>(sizeof...(Args)));
+        LogArgs::encodeAll(record, args...);
+        commitDeferredLog(callSite, record);
+    }
+
+    // 구조화 로그 (LOG_*_KV 매크로용) : message 뒤에 이름, 값 쌍을 붙인다.
+    // message 와 이름은 문자열 상수여야 한다. (message 는 주소만 저장됨)
+    template <typename... Fields>
+    void logFields(const SLogCallSite* callSite, const char* message, const Fields&... fields) {
+        static_assert(sizeof...(Fields) % 2 == 0, "LOG_*_KV needs name, value pairs");
+        CLogLineBuffer& record = beginDeferredLog(callSite, message, static_cast<unsigned>(sizeof...(Fields)));
+        LogArgs::encodeFields(record, fields...);
+        commitDeferredLog(callSite, record);
+    }
+
+    // 실행 중 최소 로그 레벨 : 이보다 낮은 레벨의 LOG_* 는 메시지를 만들기 전에 건너뛴다.
+    static void setMinLogLevel(ELogLevel eLogLevel);
+    static ELogLevel getMinLogLevel();
+    static bool isLevelEnabled(ELogLevel eLogLevel) {
+        return static_cast<int>(eLogLevel) >= minLogLevel.load(std::memory_order_relaxed);
+    }
+    // 모듈(디렉토리)/파일/함수별 최소 레벨 : 규칙에 맞는 호출 위치는 setMinLogLevel 대신 이 레벨을 사용한다.
+    // 예) setLogLevel(ELogRuleTarget::FILE, "Network.cpp", ELogLevel::LOG_DEBUG) 후 setMinLogLevel(ELogLevel::LOG_WARNING)
+    void setLogLevel(ELogRuleTarget eTarget, const std::string& pattern, ELogLevel eLogLevel);
+    void setLogLevels(const std::vector<SLogLevelRule>& rules);
+    void clearLogLevels();
+    // LOG_* 매크로용 : 호출 위치에 캐시된 결과를 읽기만 한다. 처음 호출할 때만 규칙을 찾는다.
+    static bool isEnabled(const SLogCallSite& callSite) {
+        unsigned char state = callSite.siteState->levelState.load(std::memory_order_relaxed);
+        if (state != SLogSiteState::kLevelUnknown) {
+            return state == SLogSiteState::kLevelEnabled;
+        }
+        return getInstance().levelFilter.resolve(callSite);
+    }
+
+    // 호출 위치별 속도 제한 : LOG_* 매크로 한 곳이 1초에 recordsPerSecond 개, 한꺼번에 burst 개(0 이면 recordsPerSecond)까지 기록
+    // 넘친 로그는 버리고, 다음에 통과하는 로그 앞(또는 flush 시)에 "N messages suppressed" 요약을 남긴다.
+    // recordsPerSecond 가 0 이하면 제한하지 않는다. (기본값)
+    // LOG_SCOPE / LOG_SCOPE_STATS 기록은 속도 제한과 중복 생략을 적용하지 않는다.
+    void setRateLimit(double recordsPerSecond, unsigned burst = 0);
+    void setRateLimit(ELogLevel eLogLevel, double recordsPerSecond, unsigned burst = 0);
+    // 같은 호출 위치에서 직전과 같은 메시지가 이어지면 버리고 "last message repeated N times" 요약으로 남긴다.
+    void setDuplicateSuppression(bool enable);
+    unsigned long long getRateLimitedCount() const;
+    unsigned long long getRepeatedCount() const;
+
+    // 샘플링 : LOG_* 매크로가 메시지를 만들기 전에 기록 여부를 정한다.
+    // PROBABILITY 는 value 확률(0 ~ 1), EVERY_N 은 호출 위치마다 value 번에 한 번 기록하고, ALL 이면 해제한다.
+    // 파일 규칙(파일 이름만 비교)이 레벨 규칙보다 우선하며, 기록된 로그에는 sample_rate 가 붙는다.
+    void setSampling(ELogLevel eLogLevel, ESampleMode eMode, double value);
+    void setSampling(const char* fileName, ELogLevel eLogLevel, ESampleMode eMode, double value);
+    void clearSampling();
+    static bool isSampled(const SLogCallSite& callSite) {
+        return !samplingActive.load(std::memory_order_relaxed) || getInstance().sampler.sample(callSite);
+    }
+
+    // 스코프 시간 측정 (LOG_SCOPE / LOG_SCOPE_STATS, LogScope.h)
+    // 시간은 steady_clock(기본) 또는 TSC 로 측정한다. (로그를 남기기 전에 설정)
+    void setScopeTimeSource(ETimeSource eSource);
+    // LOG_SCOPE_STATS 집계를 milliseconds 주기로 기록하는 보고 스레드 시작 (0 이면 중지, flush 때만 기록)
+    void setScopeStatsInterval(unsigned milliseconds);
+    // 지금까지 모은 LOG_SCOPE_STATS 집계를 기록
+    void flushScopeStats();
+    // CLogScope 용 : 시작 시간 측정 / 실행 시간 기록
+    long long beginScope() const {
+        return scopeClock.now();
+    }
+    void endScope(const SLogCallSite& callSite, const char* name, long long startTime, unsigned depth, bool aggregate);
+
+    // 실행 중 설정 변경 : 레벨(모듈/파일/함수별 규칙 포함), sink 레벨, 속도 제한, 중복 생략, 샘플링, trace 파일을 한 번에 적용
+    // 새 설정 스냅샷으로 한 번에 교체하므로 로그 호출 스레드는 이전 설정 전체 또는 새 설정 전체를 본다.
+    // config.sinks 는 사용하지 않고 현재 sink 목록을 이어받는다. 이전 스냅샷과 같은 항목의 캐시는 유지한다. (샘플링 캐시 등)
+    void applyConfig(const SLogConfig& config);
+    // 현재 설정 스냅샷 (레벨, 규칙, 속도 제한, 샘플링, sink 목록). 돌려받은 스냅샷은 바뀌지 않는다.
+    std::shared_ptr<const SLogConfig> getConfig() const;
+    // 설정 파일을 읽어서 적용. 잘못된 파일이면 std::runtime_error 이고 기존 설정을 유지한다.
+    void loadConfig(const std::string& path);
+    // 설정 파일을 적용하고, 파일이 바뀌거나(pollMilliseconds 주기로 확인) SIGHUP 을 받으면 다시 적용하는 감시 스레드 시작
+    void watchConfig(const std::string& path, unsigned pollMilliseconds = 1000);
+    void stopWatchingConfig();
+
+    // 비동기 모드 : 로그 호출 스레드는 자신의 버퍼에 넣기만 하고, 파일/콘솔 출력은 writer 스레드가 담당
+    // 스레드마다 별도의 버퍼를 사용하므로 로그 호출 경로에서는 락을 잡지 않는다.
+    void enableAsyncLogging(size_t threadBufferCapacity = 1024, EOverflowPolicy eOverflowPolicy = EOverflowPolicy::BLOCK);
+    void flush();
+    void shutdown();
+    unsigned long long getDroppedCount() const;
+    unsigned long long getDroppedCount(ELogLevel eLogLevel) const;
+    std::vector<SThreadLogStats> getThreadStats() const;
 
 private:
     CLogger();
     ~CLogger();
-    // ش Ŭ ̱ ̹Ƿ   
+    // 해당 클래스는 싱글톤 패턴이므로 복사와 대입을 차단
     CLogger(const CLogger&) = delete;
     CLogger& operator=(const CLogger&) = delete;
 
-    std::string extractFileName(const std::string& filePath) const;
-    void writeLog(const std::string& logEntry);
-    std::string getCurrentTime() const;
-    std::string logLevelToString(ELogLevel eLogLevel);
+    CLogLineBuffer& beginDeferredLog(const SLogCallSite* callSite, const char* format, unsigned argCount, bool scope = false);
+    void commitDeferredLog(const SLogCallSite* callSite, CLogLineBuffer& record);
+    bool admitDeferredLog(const SLogCallSite& callSite, const CLogLineBuffer& record);
+    void submitDeferredLog(ELogLevel eLogLevel, const CLogLineBuffer& record);
+    // LOG_SCOPE / LOG_SCOPE_STATS 기록 : 측정 결과이므로 속도 제한/중복 생략을 거치지 않고 바로 넘긴다.
+    // scope : LOG_SCOPE 구간 기록이면 true (SLogEvent::scope 로 전달, LOG_SCOPE_STATS 집계는 false)
+    template <typename... Fields>
+    void logScopeFields(const SLogCallSite* callSite, bool scope, const char* name, const Fields&... fields) {
+        CLogLineBuffer& record = beginDeferredLog(callSite, name, static_cast<unsigned>(sizeof...(Fields)), scope);
+        LogArgs::encodeFields(record, fields...);
+        submitDeferredLog(callSite->eLogLevel, record);
+    }
+    void writeSiteSummary(const SLogSiteSummary& summary);
+    void writePendingSiteSummaries();
+    void writeScopeSummary(const SLogScopeSummary& summary);
+    void stopScopeStatsThread();
+    void scopeStatsThreadMain();
+    void reloadConfig(const std::string& path);
+    void configWatchThreadMain(std::string path, unsigned pollMilliseconds, long long modifiedTime, unsigned long long size);
+    void writeDeferredLog(ELogLevel eLogLevel, const char* record, size_t size, unsigned threadNumber);
+    void formatLog(CLogLineBuffer& line, const SLogCallSite& callSite, const char* message, size_t messageSize) const;
+    void dispatchLog(ELogLevel eLogLevel, const char* logEntry, size_t size);
+    const char* extractFileName(const char* filePath) const;
+    void writeLog(ELogLevel eLogLevel, const char* logEntry, size_t size, unsigned threadNumber);
+    void deliverLog(SLogEvent& event);
+    std::shared_ptr<SLogConfig> copyConfigLocked() const;
+    void publishConfigLocked(const std::shared_ptr<SLogConfig>& next);
+    void installSinksLocked(const std::vector<std::shared_ptr<CLogSink>>& sinks);
+    void replaceTraceSinkLocked(SLogConfig& config, const std::shared_ptr<CTraceLogSink>& trace);
+    void setSamplingRule(const SLogSampleRule& rule);
+    static SLogStringView logLevelToString(ELogLevel eLogLevel);
+    void enqueueLog(ELogRecordKind eRecordKind, ELogLevel eLogLevel, const char* logEntry, size_t size);
+    CThreadLogBuffer& getThreadBuffer();
+    void writeRecordFromWriter(const SLogRecord& record, unsigned threadNumber);
+    size_t drainThreadBuffers(std::vector<std::shared_ptr<CThreadLogBuffer>>& buffers);
+    void wakeWriter();
+    void writerThreadMain();
+
+    // 현재 설정 스냅샷. 모든 설정 변경은 복사본을 고쳐서 한 번에 교체하고(sinkConfigMutex 로 직렬화),
+    // 아래의 호출 위치별 캐시(레벨, 샘플링, 속도 제한)는 교체 직후 새 스냅샷 하나로 다시 계산한다.
+    // 로그 호출 경로(deliverLog)는 CLogReadSection 안에서 포인터만 읽는다.
+    CLogSnapshot<SLogConfig> activeConfig;
+
+    static std::atomic<int> minLogLevel;    // 스냅샷의 minLevel (호출 위치 없이 레벨만 확인할 때)
+    CLogLevelFilter levelFilter;            // 모듈/파일/함수별 레벨과 호출 위치별 결과
+    static std::atomic<bool> samplingActive;    // 스냅샷에 샘플링 규칙이 있음
 
-    std::string logFilename = "";
-    bool saveToFile = false;
-    std::mutex logMutex;
+    CLogClock logClock;
+    CLogRateLimiter rateLimiter;
+    CLogSampler sampler;
+
+    // LOG_SCOPE 시간 측정과 LOG_SCOPE_STATS 집계/보고 스레드
+    CLogClock scopeClock;
+    CLogScopeStats scopeStats;
+    std::mutex scopeCollectMutex;           // collect 직렬화
+    std::mutex scopeStatsMutex;             // 보고 스레드 제어
+    std::condition_variable scopeStatsWakeup;
+    std::thread scopeStatsThread;
+    unsigned scopeStatsInterval = 0;
+    bool stopScopeStats = false;
+
+    std::mutex configApplyMutex;            // applyConfig 직렬화
+    std::mutex configWatchMutex;            // 감시 스레드 제어
+    std::condition_variable configWatchWakeup;
+    std::thread configWatchThread;
+    bool stopConfigWatch = false;
+
+    // 출력 대상 목록은 설정 스냅샷(SLogConfig::sinks)에 있고, 아래는 그 목록에서 찾아 둔 sink
+    mutable std::mutex sinkConfigMutex;     // 설정 스냅샷 교체 직렬화
+    std::shared_ptr<CFileLogSink> fileSink;
+    std::shared_ptr<CConsoleLogSink> consoleSink;
+    std::shared_ptr<CFlightRecorderSink> flightRecorder;
+    std::shared_ptr<CTraceLogSink> traceSink;
+
+    // configureLogging 전에 설정한 값도 새로 만드는 로그파일 sink 에 적용
+    EFlushPolicy flushPolicy = EFlushPolicy::EVERY_RECORD;
+    unsigned long long flushThreshold = 0;
+    bool flushOnErrorLog = true;
+    ELogFileFormat fileFormat = ELogFileFormat::TEXT;
+    EFileWriteMode fileWriteMode = EFileWriteMode::STREAM;
+    unsigned fileWriteQueueDepth = 8;
+    bool rotationConfigured = false;
+    unsigned long long rotationMaxFileSize = 0;
+    unsigned rotationIntervalSeconds = 0;
+    unsigned rotationRetentionCount = 0;
+    ELogCompression rotationCompression = ELogCompression::NONE;
+
+    // 비동기 모드 상태
+    std::thread writerThread;
+    size_t threadBufferCapacity = 1024;
+    EOverflowPolicy overflowPolicy = EOverflowPolicy::BLOCK;
+    std::atomic<bool> asyncEnabled;
+    std::atomic<bool> stopWriter;
+    std::atomic<bool> writerSleeping;
+    std::atomic<unsigned long long> droppedCount[4];
+
+    // 스레드별 버퍼 목록. 스레드가 처음 로그를 남길 때 등록되고, 종료 후 비워지면 writer 스레드가 제거한다.
+    mutable std::mutex registryMutex;
+    std::vector<std::shared_ptr<CThreadLogBuffer>> threadBuffers;
+    std::atomic<unsigned> registryGeneration;
+    std::mutex asyncControlMutex;   // enable/shutdown 직렬화
+    std::mutex writerMutex;
+    std::condition_variable writerWakeup;
+    std::condition_variable flushDone;
 };
 
-//  ޽ Ŭ
+// 예외 메시지 클래스
 class  CExcep {
 public:
     explicit CExcep(const std::string& msg);
@@ -55,14 +406,94 @@ private:
     std::string message;
 };
 
-// α ũ : 
+// 로그 매크로 : 
+// 호출 위치 정보(SLogCallSite)는 컴파일 시간에 만들어지고, 로그 호출 시에는 그 주소만 넘긴다.
+// 속도 제한/중복 생략 상태(SLogSiteState)도 호출 위치마다 static 으로 하나씩 둔다.
+// 레벨 확인과 샘플링은 message 인자를 계산하기 전에 하므로, 꺼진 로그는 호출 위치에 캐시된 결과를 읽고 비교하는 비용만 든다.
+#define LOG_MESSAGE_AT_CALL_SITE(eLevel, message) \
+    do { \
+        static SLogSiteState logSiteState; \
+        static constexpr SLogCallSite logCallSite = { eLevel, logLevelTag(eLevel), __FUNCTION__, logBaseName(__FILE__), __LINE__, \
+            &logSiteState, __FILE__ }; \
+        if (CLogger::isEnabled(logCallSite)) { \
+            if (CLogger::isSampled(logCallSite)) { \
+                CLogger::getInstance().logMessage(&logCallSite, message); \
+            } \
+        } \
+    } while (0)
+
+// 지연 포맷 로그 매크로 : LOG_INFOF("x={} y={}", x, y)
+// 인자는 정수, 실수, bool, char, 포인터, 문자열(const char*, std::string) 을 사용할 수 있다.
+#define LOG_FORMAT_AT_CALL_SITE(eLevel, ...) \
+    do { \
+        static SLogSiteState logSiteState; \
+        static constexpr SLogCallSite logCallSite = { eLevel, logLevelTag(eLevel), __FUNCTION__, logBaseName(__FILE__), __LINE__, \
+            &logSiteState, __FILE__ }; \
+        if (CLogger::isEnabled(logCallSite)) { \
+            if (CLogger::isSampled(logCallSite)) { \
+                CLogger::getInstance().logFormat(&logCallSite, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// 구조화 로그 매크로 : LOG_INFO_KV("order filled", "id", id, "qty", qty)
+// 텍스트 형식은 "order filled id=1 qty=3", JSON_LINES 형식은 "fields" 객체로 기록된다.
+#define LOG_FIELDS_AT_CALL_SITE(eLevel, ...) \
+    do { \
+        static SLogSiteState logSiteState; \
+        static constexpr SLogCallSite logCallSite = { eLevel, logLevelTag(eLevel), __FUNCTION__, logBaseName(__FILE__), __LINE__, \
+            &logSiteState, __FILE__ }; \
+        if (CLogger::isEnabled(logCallSite)) { \
+            if (CLogger::isSampled(logCallSite)) { \
+                CLogger::getInstance().logFields(&logCallSite, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// 컴파일 시간 최소 로그 레벨 (0: DEBUG, 1: INFO, 2: WARNING)
+// 예) LOG_COMPILE_MIN_LEVEL=2 로 빌드하면 LOG_DEBUG, LOG_INFO 호출 코드가 바이너리에서 완전히 제거된다.
+// LOG_ERROR 는 제거되지 않는다.
+#ifndef LOG_COMPILE_MIN_LEVEL
+#define LOG_COMPILE_MIN_LEVEL 0
+#endif
+
+#define LOG_DISABLED_AT_COMPILE_TIME(...) do { } while (0)
+
+#if LOG_COMPILE_MIN_LEVEL <= 1
+#define LOG_INFO(message) LOG_MESSAGE_AT_CALL_SITE(ELogLevel::LOG_INFO, message)
+#define LOG_INFOF(...) LOG_FORMAT_AT_CALL_SITE(ELogLevel::LOG_INFO, __VA_ARGS__)
+#define LOG_INFO_KV(...) LOG_FIELDS_AT_CALL_SITE(ELogLevel::LOG_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(message) LOG_DISABLED_AT_COMPILE_TIME(message)
+#define LOG_INFOF(...) LOG_DISABLED_AT_COMPILE_TIME(__VA_ARGS__)
+#define LOG_INFO_KV(...) LOG_DISABLED_AT_COMPILE_TIME(__VA_ARGS__)
+#endif
 
-#define LOG_INFO(message) CLogger::getInstance().logMessage(ELogLevel::LOG_INFO,message, __FUNCTION__, __FILE__, __LINE__)
+#if LOG_COMPILE_MIN_LEVEL <= 0
+#define LOG_DEBUG(message) LOG_MESSAGE_AT_CALL_SITE(ELogLevel::LOG_DEBUG, message)
+#define LOG_DEBUGF(...) LOG_FORMAT_AT_CALL_SITE(ELogLevel::LOG_DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_KV(...) LOG_FIELDS_AT_CALL_SITE(ELogLevel::LOG_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(message) LOG_DISABLED_AT_COMPILE_TIME(message)
+#define LOG_DEBUGF(...) LOG_DISABLED_AT_COMPILE_TIME(__VA_ARGS__)
+#define LOG_DEBUG_KV(...) LOG_DISABLED_AT_COMPILE_TIME(__VA_ARGS__)
+#endif
 
-#define LOG_DEBUG(message) CLogger::getInstance().logMessage(ELogLevel::LOG_DEBUG,message, __FUNCTION__, __FILE__, __LINE__)
+#if LOG_COMPILE_MIN_LEVEL <= 2
+#define LOG_WARNING(message) LOG_MESSAGE_AT_CALL_SITE(ELogLevel::LOG_WARNING, message)
+#define LOG_WARNINGF(...) LOG_FORMAT_AT_CALL_SITE(ELogLevel::LOG_WARNING, __VA_ARGS__)
+#define LOG_WARNING_KV(...) LOG_FIELDS_AT_CALL_SITE(ELogLevel::LOG_WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(message) LOG_DISABLED_AT_COMPILE_TIME(message)
+#define LOG_WARNINGF(...) LOG_DISABLED_AT_COMPILE_TIME(__VA_ARGS__)
+#define LOG_WARNING_KV(...) LOG_DISABLED_AT_COMPILE_TIME(__VA_ARGS__)
+#endif
 
-#define LOG_WARNING(message) CLogger::getInstance().logMessage(ELogLevel::LOG_WARNING,message, __FUNCTION__, __FILE__, __LINE__)
+#define LOG_ERROR(message) LOG_MESSAGE_AT_CALL_SITE(ELogLevel::LOG_ERROR, message)
+#define LOG_ERRORF(...) LOG_FORMAT_AT_CALL_SITE(ELogLevel::LOG_ERROR, __VA_ARGS__)
+#define LOG_ERROR_KV(...) LOG_FIELDS_AT_CALL_SITE(ELogLevel::LOG_ERROR, __VA_ARGS__)
 
-#define LOG_ERROR(message) CLogger::getInstance().logMessage(ELogLevel::LOG_ERROR,message, __FUNCTION__, __FILE__, __LINE__)
+// 스코프 시간 측정 매크로 (LOG_SCOPE, LOG_SCOPE_STATS)
+#include "LogScope.h"
 
 #endif // CLogger_H
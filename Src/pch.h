@@ -0,0 +1,13 @@
+﻿// pch.h
+// Src 의 소스를 Visual Studio 프로젝트 밖(CMake 등)에서 빌드할 때 사용하는 미리 컴파일된 헤더
+// Visual Studio 프로젝트는 각 프로젝트 디렉토리의 pch.h 를 사용한다.
+#ifndef PCH_H
+#define PCH_H
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN             // 거의 사용되지 않는 내용을 Windows 헤더에서 제외합니다.
+#endif
+#endif
+
+#endif //PCH_H
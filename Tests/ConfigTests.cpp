@@ -0,0 +1,253 @@
+﻿// ConfigTests.cpp
+// 설정 파일 해석과 설정 스냅샷 교체, 설정 파일 다시 읽기 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogConfig.h"
+#include "LogSink.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace {
+    // 감시 스레드가 비어 있거나 쓰는 중인 파일을 읽지 않도록 옆에 쓴 뒤 이름을 바꾼다.
+    void writeFile(const std::string& path, const std::string& text) {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+            output << text;
+        }
+#ifdef _WIN32
+        std::remove(path.c_str());
+#endif
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            LogTest::fail("rename failed: " + temporary, __FILE__, __LINE__);
+        }
+    }
+
+    std::string parseError(const std::string& text) {
+        try {
+            LogConfig::parse(text);
+        }
+        catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return std::string();
+    }
+
+    // 감시 스레드가 다시 읽을 때까지 기다린다. (최대 5 초)
+    bool waitForMinLevel(ELogLevel eLogLevel) {
+        for (int i = 0; i < 500; ++i) {
+            if (CLogger::getInstance().getConfig()->minLevel == eLogLevel) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+}
+
+LOG_TEST(Config, ParseAllKeys) {
+    SLogConfig config = LogConfig::parse(
+        "# 주석과 빈 줄은 무시\n"
+        "\n"
+        "level = info\n"
+        "level.file@Network.cpp = DEBUG   # 줄 끝 주석\n"
+        "level.module@Storage = ERROR\n"
+        "level.function@Order* = WARNING\n"
+        "console_level = WARNING\n"
+        "file_level = DEBUG\n"
+        "rate_limit = 1000 100\n"
+        "rate_limit.DEBUG = 10\n"
+        "duplicate_suppression = on\n"
+        "sample.DEBUG = probability 0.25\n"
+        "sample.INFO@Network.cpp = every_n 10\n"
+        "trace = Log/trace.json\n");
+
+    LOG_CHECK(config.minLevel == ELogLevel::LOG_INFO);
+    LOG_CHECK_EQUAL(3u, config.levelRules.size());
+    LOG_CHECK(config.levelRules[0] == (SLogLevelRule{ ELogRuleTarget::FILE, "Network.cpp", ELogLevel::LOG_DEBUG }));
+    LOG_CHECK(config.levelRules[1] == (SLogLevelRule{ ELogRuleTarget::MODULE, "Storage", ELogLevel::LOG_ERROR }));
+    LOG_CHECK(config.levelRules[2] == (SLogLevelRule{ ELogRuleTarget::FUNCTION, "Order*", ELogLevel::LOG_WARNING }));
+    LOG_CHECK_EQUAL(static_cast<int>(ELogLevel::LOG_WARNING), config.consoleLevel);
+    LOG_CHECK_EQUAL(static_cast<int>(ELogLevel::LOG_DEBUG), config.fileLevel);
+    LOG_CHECK_EQUAL(10.0, config.rateLimit[0]);
+    LOG_CHECK_EQUAL(0u, config.rateBurst[0]);
+    for (int i = 1; i < SLogConfig::kLevelCount; ++i) {
+        LOG_CHECK_EQUAL(1000.0, config.rateLimit[i]);
+        LOG_CHECK_EQUAL(100u, config.rateBurst[i]);
+    }
+    LOG_CHECK(config.duplicateSuppression);
+    LOG_CHECK_EQUAL(2u, config.sampling.size());
+    LOG_CHECK(config.sampling[0] == (SLogSampleRule{ "", ELogLevel::LOG_DEBUG, ESampleMode::PROBABILITY, 0.25 }));
+    LOG_CHECK(config.sampling[1] == (SLogSampleRule{ "Network.cpp", ELogLevel::LOG_INFO, ESampleMode::EVERY_N, 10.0 }));
+    LOG_CHECK_EQUAL(std::string("Log/trace.json"), config.tracePath);
+
+    // 없는 항목은 기본값
+    SLogConfig empty = LogConfig::parse("");
+    LOG_CHECK(empty.minLevel == ELogLevel::LOG_DEBUG);
+    LOG_CHECK_EQUAL(-1, empty.consoleLevel);
+    LOG_CHECK(!empty.duplicateSuppression);
+    LOG_CHECK(empty.levelRules.empty() && empty.sampling.empty() && empty.tracePath.empty());
+}
+
+// 잘못된 줄은 줄 번호와 원래 줄을 담은 std::runtime_error
+LOG_TEST(Config, ParseErrorReportsLine) {
+    LOG_CHECK_EQUAL(std::string("Invalid log config line 3 (unknown level): level = VERBOSE"),
+        parseError("# header\nconsole_level = ERROR\nlevel = VERBOSE\n"));
+    LOG_CHECK(parseError("level INFO").find("line 1 (missing '=')") != std::string::npos);
+    LOG_CHECK(parseError("\n\nunknown = 1").find("line 3 (unknown setting)") != std::string::npos);
+    LOG_CHECK(parseError("level.thread@main = INFO").find("line 1 (expected level.") != std::string::npos);
+    LOG_CHECK(parseError("sample.DEBUG = probability 2").find("line 1 (expected 'all'") != std::string::npos);
+    LOG_CHECK(parseError("rate_limit = fast").find("line 1 (expected 'records_per_second") != std::string::npos);
+    LOG_CHECK(parseError("duplicate_suppression = maybe").find("line 1 (expected true or false)") != std::string::npos);
+}
+
+// applyConfig 는 새 스냅샷으로 교체한다. 이전 스냅샷은 바뀌지 않고, sink 목록은 이어받는다.
+LOG_TEST(Config, ApplyReplacesSnapshot) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    std::shared_ptr<const SLogConfig> before = logger.getConfig();
+    LOG_CHECK_EQUAL(1u, before->sinks.size());
+    LOG_CHECK(before->sinks[0] == sink);
+
+    SLogConfig config = LogConfig::parse("level = WARNING\nduplicate_suppression = true\nsample.ERROR = every_n 2\n");
+    logger.applyConfig(config);
+    std::shared_ptr<const SLogConfig> after = logger.getConfig();
+    LOG_CHECK(after != before);
+    LOG_CHECK(before->minLevel == ELogLevel::LOG_DEBUG);
+    LOG_CHECK(!before->duplicateSuppression);
+    LOG_CHECK(before->sampling.empty());
+    LOG_CHECK(after->minLevel == ELogLevel::LOG_WARNING);
+    LOG_CHECK(after->duplicateSuppression);
+    LOG_CHECK_EQUAL(1u, after->sampling.size());
+    LOG_CHECK_EQUAL(1u, after->sinks.size());
+    LOG_CHECK(after->sinks[0] == sink);
+
+    // 새 설정이 로그 호출 경로에 적용된다.
+    LOG_INFO("filtered");
+    LOG_WARNING("kept");
+    for (int i = 0; i < 4; ++i) {
+        LOG_ERRORF("sampled {}", i);
+    }
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(3u, lines.size());
+    LOG_CHECK(lines[0].find("** kept (") != std::string::npos);
+    LOG_CHECK(lines[1].find("!! sampled 0 sample_rate=0.5 (") != std::string::npos);
+    LOG_CHECK(lines[2].find("!! sampled 2 sample_rate=0.5 (") != std::string::npos);
+
+    // 개별 설정 함수도 스냅샷을 교체한다.
+    CLogger::setMinLogLevel(ELogLevel::LOG_ERROR);
+    LOG_CHECK(logger.getConfig()->minLevel == ELogLevel::LOG_ERROR);
+    LOG_CHECK(after->minLevel == ELogLevel::LOG_WARNING);
+}
+
+// 다른 스레드가 로그를 남기는 동안 sink 목록을 바꿔도, 교체가 끝나면 빠진 sink 는 이미 놓여 있다.
+LOG_TEST(Config, SwapReleasesRemovedSinks) {
+    auto sink = LogTest::captureLogs(16);
+    CLogger& logger = CLogger::getInstance();
+    std::atomic<bool> stop(false);
+    std::atomic<int> started(0);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&stop, &started] {
+            LOG_INFO("swap start");
+            started.fetch_add(1);
+            for (unsigned i = 0; !stop.load(); ++i) {
+                LOG_INFOF("swap {}", i);
+            }
+        });
+    }
+    while (started.load() < 4) {
+        std::this_thread::yield();
+    }
+    bool released = true;
+    for (int i = 0; i < 100; ++i) {
+        std::weak_ptr<CLogSink> removed;
+        {
+            auto temporary = std::make_shared<CMemoryLogSink>(16);
+            removed = temporary;
+            logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ sink, temporary });
+        }
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ sink });
+        released = released && removed.expired();
+    }
+    stop.store(true);
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    LOG_CHECK(released);
+    LOG_CHECK(!sink->getLines().empty());
+}
+
+// 잘못된 설정 파일은 std::runtime_error 이고 기존 설정을 유지한다.
+LOG_TEST(Config, LoadFile) {
+    std::string directory = LogTest::prepareDirectory("config");
+    LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+
+    writeFile(directory + "/logger.conf", "level = ERROR\nrate_limit.INFO = 5 2\n");
+    logger.loadConfig(directory + "/logger.conf");
+    std::shared_ptr<const SLogConfig> loaded = logger.getConfig();
+    LOG_CHECK(loaded->minLevel == ELogLevel::LOG_ERROR);
+    LOG_CHECK_EQUAL(5.0, loaded->rateLimit[static_cast<int>(ELogLevel::LOG_INFO)]);
+
+    writeFile(directory + "/broken.conf", "level = DEBUG\nlevel = LOUD\n");
+    bool thrown = false;
+    try {
+        logger.loadConfig(directory + "/broken.conf");
+    }
+    catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find("line 2") != std::string::npos;
+    }
+    LOG_CHECK(thrown);
+    LOG_CHECK(logger.getConfig() == loaded);
+
+    thrown = false;
+    try {
+        logger.loadConfig(directory + "/missing.conf");
+    }
+    catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    LOG_CHECK(thrown);
+    LOG_CHECK(logger.getConfig() == loaded);
+}
+
+// 감시 중인 설정 파일이 바뀌면 다시 적용하고, 잘못 바뀌면 WARNING 로그를 남기고 기존 설정을 유지한다.
+LOG_TEST(Config, WatchReloadsChangedFile) {
+    std::string path = LogTest::prepareDirectory("config_watch") + "/logger.conf";
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+
+    writeFile(path, "level = DEBUG\n");
+    logger.watchConfig(path, 10);
+    LOG_CHECK(logger.getConfig()->minLevel == ELogLevel::LOG_DEBUG);
+
+    // 수정 시각이 같은 초여도 크기가 달라지면 다시 읽는다.
+    writeFile(path, "level = INFO   # changed\n");
+    bool reloaded = waitForMinLevel(ELogLevel::LOG_INFO);
+
+    writeFile(path, "level = WARNING\nlevel = NOISY\n");
+    bool reported = false;
+    for (int i = 0; i < 500 && !reported; ++i) {
+        for (const auto& line : sink->getLines()) {
+            reported = reported || line.find("Log config reload failed: Invalid log config line 2") != std::string::npos;
+        }
+        if (!reported) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    ELogLevel eKeptLevel = logger.getConfig()->minLevel;
+    logger.stopWatchingConfig();
+
+    LOG_CHECK(reloaded);
+    LOG_CHECK(reported);
+    LOG_CHECK(eKeptLevel == ELogLevel::LOG_INFO);
+    bool announced = false;
+    for (const auto& line : sink->getLines()) {
+        announced = announced || line.find("--> Log config reloaded: " + path) != std::string::npos;
+    }
+    LOG_CHECK(announced);
+}
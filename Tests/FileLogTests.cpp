@@ -0,0 +1,85 @@
+﻿// FileLogTests.cpp
+// 바이너리 로그파일 -> LogDecoder(CBinaryLogReader) 변환, 로그파일 교체 이름과 보관 개수 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogBinaryFormat.h"
+#include "LogFileSink.h"
+#include "LogSink.h"
+#include <algorithm>
+#include <regex>
+
+// 바이너리로 기록한 로그를 읽어서 텍스트로 바꾸면 텍스트 sink 에 남긴 줄과 같다.
+LOG_TEST(Binary, DecoderRoundTrip) {
+    std::string path = LogTest::prepareDirectory("binary") + "/all.bin";
+    auto text = LogTest::captureLogs();
+    {
+        auto file = std::make_shared<CFileLogSink>(path);
+        file->setFileFormat(ELogFileFormat::BINARY, ETimePrecision::SECONDS);
+        CLogger& logger = CLogger::getInstance();
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ text, file });
+
+        LOG_INFOF("order {} qty {} price {} ok {}", 1234567890123LL, 3u, 1.25, true);
+        LOG_WARNING("plain message");
+        LOG_ERRORF("text argument {}", std::string("copied at call time"));
+        LOG_INFO_KV("filled", "id", 7, "symbol", "ABC");
+        logger.logMessage(ELogLevel::LOG_DEBUG, "assembled line", "caller", "Source.cpp", 3);
+
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ text });
+    }
+
+    std::vector<std::string> expected = text->getLines();
+    LOG_CHECK_EQUAL(5u, expected.size());
+
+    CBinaryLogReader reader;
+    reader.open(path);
+    SBinaryLogEntry entry;
+    CLogLineBuffer line;
+    size_t count = 0;
+    while (reader.next(entry)) {
+        LOG_CHECK(count < expected.size());
+        reader.render(entry, line);
+        LOG_CHECK_EQUAL(expected[count], std::string(line.data(), line.size()));
+        ++count;
+    }
+    LOG_CHECK_EQUAL(expected.size(), count);
+}
+
+// 교체된 파일은 "이름_yyyymmdd-hhmmss_번호.확장자" 이고, 보관 개수를 넘으면 오래된 것부터 지운다.
+LOG_TEST(Rotation, NamingAndRetention) {
+    std::string directory = LogTest::prepareDirectory("rotation");
+    LogTest::captureLogs();
+    SRotationStats stats;
+    {
+        auto file = std::make_shared<CFileLogSink>(directory + "/app.log");
+        file->setRotation(1024, 0, 2);
+        CLogger& logger = CLogger::getInstance();
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ file });
+        for (int i = 0; i < 200; ++i) {
+            LOG_INFOF("rotation test record {} padded to make the file grow quickly", i);
+        }
+        logger.flush();
+        stats = file->getRotationStats();
+        LogTest::captureLogs();
+    }
+
+    LOG_CHECK(stats.rotationCount >= 3);
+    LOG_CHECK_EQUAL(stats.rotationCount - 2, stats.deletedCount);
+
+    std::vector<std::string> files = LogTest::listFiles(directory);
+    LOG_CHECK_EQUAL(3u, files.size());
+    std::regex rotatedName("app_\\d{8}-\\d{6}_(\\d+)\\.log");
+    std::vector<unsigned long long> sequences;
+    for (const auto& name : files) {
+        if (name == "app.log") {
+            continue;
+        }
+        std::smatch match;
+        LOG_CHECK(std::regex_match(name, match, rotatedName));
+        sequences.push_back(std::stoull(match[1].str()));
+    }
+    // 남은 교체 파일은 가장 최근 두 개
+    LOG_CHECK_EQUAL(2u, sequences.size());
+    std::sort(sequences.begin(), sequences.end());
+    LOG_CHECK_EQUAL(stats.rotationCount - 1, sequences[0]);
+    LOG_CHECK_EQUAL(stats.rotationCount, sequences[1]);
+}
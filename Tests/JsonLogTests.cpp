@@ -0,0 +1,75 @@
+﻿// JsonLogTests.cpp
+// JSON Lines 로그파일의 각 줄이 올바른 JSON 객체인지 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogFileSink.h"
+#include "LogJson.h"
+#include "LogSink.h"
+#include "JsonValidator.h"
+#include <limits>
+
+namespace {
+    bool isJsonObject(const std::string& text) {
+        return CJsonValidator(text).isObject();
+    }
+}
+
+LOG_TEST(Json, ValidatorRejectsBrokenLines) {
+    LOG_CHECK(isJsonObject("{\"a\":[1,-2.5e3,true,null,{\"b\":\"\\u0001\\n\"}]}"));
+    LOG_CHECK(!isJsonObject("{\"a\":nan}"));
+    LOG_CHECK(!isJsonObject("{\"a\":\"raw\ttab\"}"));
+    LOG_CHECK(!isJsonObject("{\"a\":1,}"));
+    LOG_CHECK(!isJsonObject("{\"a\":1} trailing"));
+}
+
+// 따옴표, 역슬래시, 제어 문자, 실수의 NaN/Infinity, 구조화 필드가 있어도 줄마다 올바른 JSON 객체
+LOG_TEST(Json, JsonLinesFileIsValid) {
+    std::string path = LogTest::prepareDirectory("json") + "/all.jsonl";
+    LogTest::captureLogs();
+    {
+        auto file = std::make_shared<CFileLogSink>(path);
+        file->setFileFormat(ELogFileFormat::JSON_LINES, ETimePrecision::MILLISECONDS);
+        CLogger& logger = CLogger::getInstance();
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ file });
+
+        LOG_INFO("quote \" backslash \\ newline \n tab \t bell \x07 end");
+        LOG_INFOF("values {} {} {} {} {}", -42, 18446744073709551615ULL, 0.1, 'c', false);
+        LOG_WARNINGF("not finite {} {}", std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity());
+        LOG_ERROR_KV("order \"rejected\"", "id", 7, "reason", "limit\\exceeded\n", "price", 1.5, "pointer", static_cast<void*>(nullptr));
+        LOG_DEBUG("utf-8 \xed\x95\x9c\xea\xb8\x80");
+        logger.logMessage(ELogLevel::LOG_INFO, "assembled \"line\"", "caller", "Source.cpp", 3);
+
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{});
+    }
+
+    std::vector<std::string> lines = LogTest::splitLines(LogTest::readFile(path));
+    LOG_CHECK_EQUAL(6u, lines.size());
+    for (const auto& line : lines) {
+        if (!isJsonObject(line)) {
+            LogTest::fail("invalid JSON line: " + line, __FILE__, __LINE__);
+        }
+        LOG_CHECK(line.find("\"time\":\"") != std::string::npos);
+        LOG_CHECK(line.find("\"level\":\"") != std::string::npos);
+    }
+    LOG_CHECK(lines[0].find("\"message\":\"quote \\\" backslash \\\\ newline \\n tab \\t bell \\u0007 end\"") != std::string::npos);
+    LOG_CHECK(lines[1].find("\"message\":\"values -42 18446744073709551615 0.1 c false\"") != std::string::npos);
+    LOG_CHECK(lines[2].find("\"level\":\"WARNING\"") != std::string::npos);
+    LOG_CHECK(lines[3].find("\"fields\":{\"id\":7,\"reason\":\"limit\\\\exceeded\\n\",\"price\":1.5,") != std::string::npos);
+    // 호출 위치 없이 조립된 로그는 조립된 한 줄 전체가 message
+    LOG_CHECK(lines[5].find("--> assembled \\\"line\\\" (Log from caller at Source.cpp:3)\"}") != std::string::npos);
+}
+
+// sink 의 형식으로 LogJson::render 를 지정해도 같은 JSON 객체
+LOG_TEST(Json, FormatterOnMemorySink) {
+    auto sink = LogTest::captureLogs();
+    sink->setFormatter(&LogJson::render);
+    LOG_INFOF("formatter {}", 1);
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(1u, lines.size());
+    std::string line = lines[0];
+    while (!line.empty() && line.back() == '\n') {
+        line.pop_back();
+    }
+    LOG_CHECK(isJsonObject(line));
+    LOG_CHECK(line.find("\"function\":\"logTest_Json_FormatterOnMemorySink\"") != std::string::npos);
+}
@@ -0,0 +1,175 @@
+﻿// JsonValidator.h
+// JSON 출력(JSON Lines, trace 파일)을 확인하는 테스트용 문법 검사기
+#ifndef JsonValidator_H
+#define JsonValidator_H
+
+#include <cctype>
+#include <cstring>
+#include <string>
+
+// RFC 8259 문법만 확인하는 JSON 파서 (값은 만들지 않음)
+class CJsonValidator {
+public:
+    explicit CJsonValidator(const std::string& text)
+        : p(text.c_str()), end(text.c_str() + text.size())
+    {
+    }
+
+    // 문서 전체가 객체 하나인지
+    bool isObject() {
+        return isDocument('{');
+    }
+
+    // 문서 전체가 배열 하나인지
+    bool isArray() {
+        return isDocument('[');
+    }
+
+private:
+    bool isDocument(char open) {
+        skipSpace();
+        if (p == end || *p != open || !parseValue()) {
+            return false;
+        }
+        skipSpace();
+        return p == end;
+    }
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+            ++p;
+        }
+    }
+
+    bool consume(char ch) {
+        skipSpace();
+        if (p < end && *p == ch) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseLiteral(const char* literal) {
+        size_t size = std::strlen(literal);
+        if (static_cast<size_t>(end - p) < size || std::strncmp(p, literal, size) != 0) {
+            return false;
+        }
+        p += size;
+        return true;
+    }
+
+    bool parseString() {
+        if (!consume('"')) {
+            return false;
+        }
+        while (p < end && *p != '"') {
+            unsigned char ch = static_cast<unsigned char>(*p++);
+            if (ch < 0x20) {
+                return false;
+            }
+            if (ch != '\\') {
+                continue;
+            }
+            if (p == end) {
+                return false;
+            }
+            char escape = *p++;
+            if (escape == 'u') {
+                for (int i = 0; i < 4; ++i, ++p) {
+                    if (p == end || !std::isxdigit(static_cast<unsigned char>(*p))) {
+                        return false;
+                    }
+                }
+            }
+            else if (std::strchr("\"\\/bfnrt", escape) == nullptr) {
+                return false;
+            }
+        }
+        return consume('"');
+    }
+
+    bool parseDigits() {
+        const char* start = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            ++p;
+        }
+        return p > start;
+    }
+
+    bool parseNumber() {
+        if (p < end && *p == '-') {
+            ++p;
+        }
+        if (p < end && *p == '0') {
+            ++p;
+        }
+        else if (!parseDigits()) {
+            return false;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            if (!parseDigits()) {
+                return false;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (!parseDigits()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseValue() {
+        skipSpace();
+        if (p == end) {
+            return false;
+        }
+        switch (*p) {
+        case '{': {
+            ++p;
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                if (!parseString() || !consume(':') || !parseValue()) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+        case '[': {
+            ++p;
+            if (consume(']')) {
+                return true;
+            }
+            do {
+                if (!parseValue()) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        }
+        case '"':
+            return parseString();
+        case 't':
+            return parseLiteral("true");
+        case 'f':
+            return parseLiteral("false");
+        case 'n':
+            return parseLiteral("null");
+        default:
+            return parseNumber();
+        }
+    }
+
+    const char* p;
+    const char* end;
+};
+
+#endif // JsonValidator_H
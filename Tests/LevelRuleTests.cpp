@@ -0,0 +1,134 @@
+﻿// LevelRuleTests.cpp
+// 모듈/파일/함수별 최소 레벨 규칙의 우선순위와 호출 위치 캐시 갱신 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogConfig.h"
+#include "LogSink.h"
+
+namespace {
+    // 레벨마다 호출 위치 하나씩 : 규칙이 바뀐 뒤에도 같은 호출 위치(캐시된 결과)를 다시 사용한다.
+    void logEachLevel() {
+        LOG_DEBUG("level rule");
+        LOG_INFO("level rule");
+        LOG_WARNING("level rule");
+        LOG_ERROR("level rule");
+    }
+
+    // logEachLevel 로 새로 기록된 로그의 레벨 머리글자 (예: "IWE")
+    std::string enabledLevels(const CMemoryLogSink& sink) {
+        size_t before = sink.getLines().size();
+        logEachLevel();
+        std::vector<std::string> lines = sink.getLines();
+        const char* tags[] = { "[DEBUG]", "[INFO]", "[WARNING]", "[ERROR]" };
+        std::string levels;
+        for (size_t i = before; i < lines.size(); ++i) {
+            for (const char* tag : tags) {
+                if (lines[i].find(tag) != std::string::npos) {
+                    levels += tag[1];
+                }
+            }
+        }
+        return levels;
+    }
+}
+
+// FUNCTION > FILE > MODULE > 기본 레벨. 규칙 순서와 상관없이 대상 종류로 우선한다.
+LOG_TEST(LevelRule, TargetPriority) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    CLogger::setMinLogLevel(ELogLevel::LOG_ERROR);
+    LOG_CHECK_EQUAL(std::string("E"), enabledLevels(*sink));
+
+    // 이 파일은 .../Tests/LevelRuleTests.cpp 이므로 모듈 "Tests"
+    logger.setLogLevel(ELogRuleTarget::MODULE, "Tests", ELogLevel::LOG_DEBUG);
+    LOG_CHECK_EQUAL(std::string("DIWE"), enabledLevels(*sink));
+    logger.setLogLevel(ELogRuleTarget::FILE, "LevelRuleTests.cpp", ELogLevel::LOG_WARNING);
+    LOG_CHECK_EQUAL(std::string("WE"), enabledLevels(*sink));
+    logger.setLogLevel(ELogRuleTarget::FUNCTION, "logEachLevel", ELogLevel::LOG_INFO);
+    LOG_CHECK_EQUAL(std::string("IWE"), enabledLevels(*sink));
+
+    logger.setLogLevels({
+        SLogLevelRule{ ELogRuleTarget::FUNCTION, "logEachLevel", ELogLevel::LOG_INFO },
+        SLogLevelRule{ ELogRuleTarget::FILE, "LevelRuleTests.cpp", ELogLevel::LOG_WARNING },
+        SLogLevelRule{ ELogRuleTarget::MODULE, "Tests", ELogLevel::LOG_DEBUG } });
+    LOG_CHECK_EQUAL(std::string("IWE"), enabledLevels(*sink));
+
+    // 맞지 않는 함수 규칙은 파일 규칙을 가리지 않는다.
+    logger.setLogLevels({
+        SLogLevelRule{ ELogRuleTarget::FUNCTION, "otherFunction", ELogLevel::LOG_DEBUG },
+        SLogLevelRule{ ELogRuleTarget::FILE, "LevelRuleTests.cpp", ELogLevel::LOG_WARNING } });
+    LOG_CHECK_EQUAL(std::string("WE"), enabledLevels(*sink));
+}
+
+// 같은 대상 종류끼리는 나중 규칙이 우선하고, 같은 대상/패턴을 다시 설정하면 레벨만 바뀐다.
+LOG_TEST(LevelRule, LaterRuleWinsWithinTarget) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    logger.setLogLevels({
+        SLogLevelRule{ ELogRuleTarget::FILE, "*.cpp", ELogLevel::LOG_ERROR },
+        SLogLevelRule{ ELogRuleTarget::FILE, "LevelRule*", ELogLevel::LOG_INFO } });
+    LOG_CHECK_EQUAL(std::string("IWE"), enabledLevels(*sink));
+    logger.setLogLevels({
+        SLogLevelRule{ ELogRuleTarget::FILE, "LevelRule*", ELogLevel::LOG_INFO },
+        SLogLevelRule{ ELogRuleTarget::FILE, "*.cpp", ELogLevel::LOG_ERROR } });
+    LOG_CHECK_EQUAL(std::string("E"), enabledLevels(*sink));
+
+    logger.setLogLevel(ELogRuleTarget::FILE, "*.cpp", ELogLevel::LOG_WARNING);
+    LOG_CHECK_EQUAL(2u, logger.getConfig()->levelRules.size());
+    LOG_CHECK_EQUAL(std::string("WE"), enabledLevels(*sink));
+}
+
+// '*' 는 임의의 문자열, '*' 가 없으면 이름 전체가 같아야 한다. 모듈은 디렉토리 이름만 비교한다.
+LOG_TEST(LevelRule, Wildcards) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    CLogger::setMinLogLevel(ELogLevel::LOG_ERROR);
+
+    const struct {
+        ELogRuleTarget eTarget;
+        const char* pattern;
+        const char* expected;
+    } cases[] = {
+        { ELogRuleTarget::FUNCTION, "log*Level", "DIWE" },
+        { ELogRuleTarget::FUNCTION, "*Each*", "DIWE" },
+        { ELogRuleTarget::FUNCTION, "*", "DIWE" },
+        { ELogRuleTarget::FUNCTION, "logEach", "E" },
+        { ELogRuleTarget::FUNCTION, "*Levels", "E" },
+        { ELogRuleTarget::FILE, "*Tests.cpp", "DIWE" },
+        { ELogRuleTarget::FILE, "LevelRuleTests", "E" },
+        { ELogRuleTarget::MODULE, "Te*s", "DIWE" },
+        { ELogRuleTarget::MODULE, "LevelRuleTests.cpp", "E" },
+    };
+    for (const auto& ruleCase : cases) {
+        logger.setLogLevels({ SLogLevelRule{ ruleCase.eTarget, ruleCase.pattern, ELogLevel::LOG_DEBUG } });
+        std::string levels = enabledLevels(*sink);
+        if (levels != ruleCase.expected) {
+            LogTest::fail(std::string("pattern ") + ruleCase.pattern + " : expected [" + ruleCase.expected
+                + "], actual [" + levels + "]", __FILE__, __LINE__);
+        }
+    }
+}
+
+// 규칙을 바꾸면 이미 결과가 캐시된 호출 위치도 다시 계산하고, 처음 실행되는 호출 위치는 새 규칙으로 계산한다.
+LOG_TEST(LevelRule, CachedSitesFollowChanges) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    LOG_CHECK_EQUAL(std::string("DIWE"), enabledLevels(*sink));
+
+    SLogConfig config;
+    config.minLevel = ELogLevel::LOG_INFO;
+    config.levelRules.push_back(SLogLevelRule{ ELogRuleTarget::FUNCTION, "logEachLevel", ELogLevel::LOG_WARNING });
+    logger.applyConfig(config);
+    LOG_CHECK_EQUAL(std::string("WE"), enabledLevels(*sink));
+
+    // 이 함수의 호출 위치는 처음 실행되므로 기본 레벨(INFO)로 계산
+    size_t before = sink->getLines().size();
+    LOG_DEBUG("new site");
+    LOG_INFO("new site");
+    LOG_CHECK_EQUAL(before + 1, sink->getLines().size());
+
+    logger.clearLogLevels();
+    LOG_CHECK_EQUAL(std::string("IWE"), enabledLevels(*sink));
+    CLogger::setMinLogLevel(ELogLevel::LOG_DEBUG);
+    LOG_CHECK_EQUAL(std::string("DIWE"), enabledLevels(*sink));
+}
@@ -0,0 +1,128 @@
+﻿// LogTest.cpp
+// LoggerTests 실행 파일 : 등록된 테스트를 실행하고 실패한 테스트가 있으면 1 을 돌려준다.
+//
+// 사용법 : LoggerTests [그룹]      그룹을 주지 않으면 모든 테스트를 실행
+#include "pch.h"
+#include "LogTest.h"
+#include "LogConfig.h"
+#include "LogPlatform.h"
+#include "LogSink.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace LogTest {
+    std::vector<SLogTestCase>& registry() {
+        static std::vector<SLogTestCase> cases;
+        return cases;
+    }
+
+    void fail(const std::string& message, const char* file, int line) {
+        std::ostringstream text;
+        text << logBaseName(file) << ":" << line << " " << message;
+        throw std::runtime_error(text.str());
+    }
+
+    std::string prepareDirectory(const std::string& name) {
+        std::string root = LogPlatform::currentDirectory() + "/TestOutput";
+        LogPlatform::createDirectory(root);
+        std::string directory = root + "/" + name;
+        LogPlatform::createDirectory(directory);
+        for (const auto& file : listFiles(directory)) {
+            std::remove((directory + "/" + file).c_str());
+        }
+        return directory;
+    }
+
+    std::vector<std::string> listFiles(const std::string& directory) {
+        std::vector<std::string> files;
+#ifdef _WIN32
+        _finddata_t data;
+        intptr_t handle = _findfirst((directory + "/*").c_str(), &data);
+        if (handle != -1) {
+            do {
+                if (!(data.attrib & _A_SUBDIR)) {
+                    files.push_back(data.name);
+                }
+            } while (_findnext(handle, &data) == 0);
+            _findclose(handle);
+        }
+#else
+        DIR* dir = opendir(directory.c_str());
+        if (dir != nullptr) {
+            while (dirent* entry = readdir(dir)) {
+                if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                    files.push_back(entry->d_name);
+                }
+            }
+            closedir(dir);
+        }
+#endif
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream text;
+        text << file.rdbuf();
+        return text.str();
+    }
+
+    std::vector<std::string> splitLines(const std::string& text) {
+        std::vector<std::string> lines;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            lines.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        return lines;
+    }
+
+    std::shared_ptr<CMemoryLogSink> captureLogs(size_t capacity) {
+        CLogger& logger = CLogger::getInstance();
+        logger.applyConfig(SLogConfig());
+        auto sink = std::make_shared<CMemoryLogSink>(capacity);
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ sink });
+        return sink;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* group = argc > 1 ? argv[1] : nullptr;
+    int runCount = 0;
+    int failedCount = 0;
+    for (const auto& testCase : LogTest::registry()) {
+        if (group != nullptr && std::strcmp(group, testCase.group) != 0) {
+            continue;
+        }
+        ++runCount;
+        try {
+            testCase.function();
+            std::cerr << "[  OK  ] " << testCase.group << "." << testCase.name << std::endl;
+        }
+        catch (const std::exception& e) {
+            ++failedCount;
+            std::cerr << "[ FAIL ] " << testCase.group << "." << testCase.name << " : " << e.what() << std::endl;
+        }
+    }
+    if (runCount == 0) {
+        std::cerr << "No tests in group " << (group != nullptr ? group : "(all)") << std::endl;
+        return 1;
+    }
+    std::cerr << runCount - failedCount << " / " << runCount << " passed" << std::endl;
+    return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+﻿// LogTest.h
+// LoggerTests 의 테스트 등록/확인 매크로와 공용 도구
+// LOG_TEST(그룹, 이름) 으로 등록하고, LoggerTests <그룹> 으로 실행하면 그 그룹만 실행한다.
+// CMake 는 그룹마다 CTest 테스트를 하나씩 등록하므로, 그룹끼리는 CLogger 싱글톤 상태를 공유하지 않는다.
+#ifndef LogTest_H
+#define LogTest_H
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+class CMemoryLogSink;
+
+// 등록된 테스트 하나
+struct SLogTestCase {
+    const char* group;
+    const char* name;
+    void (*function)();
+};
+
+namespace LogTest {
+    std::vector<SLogTestCase>& registry();
+
+    struct SRegistrar {
+        SRegistrar(const char* group, const char* name, void (*function)()) {
+            registry().push_back(SLogTestCase{ group, name, function });
+        }
+    };
+
+    // 확인 실패 : 위치와 조건을 담은 std::runtime_error
+    [[noreturn]] void fail(const std::string& message, const char* file, int line);
+
+    inline void check(bool condition, const char* expression, const char* file, int line) {
+        if (!condition) {
+            fail(std::string("check failed: ") + expression, file, line);
+        }
+    }
+
+    template <typename Expected, typename Actual>
+    void checkEqual(const Expected& expected, const Actual& actual, const char* expression, const char* file, int line) {
+        if (!(expected == actual)) {
+            std::ostringstream message;
+            message << expression << " : expected [" << expected << "], actual [" << actual << "]";
+            fail(message.str(), file, line);
+        }
+    }
+
+    // 빌드 디렉토리의 TestOutput/name 을 비우고 경로를 돌려준다.
+    std::string prepareDirectory(const std::string& name);
+    // 디렉토리 안의 파일 이름 (정렬)
+    std::vector<std::string> listFiles(const std::string& directory);
+    std::string readFile(const std::string& path);
+    // 줄 단위로 나눈다. (줄바꿈 제외, 마지막 빈 줄 제외)
+    std::vector<std::string> splitLines(const std::string& text);
+
+    // 기본 로거의 설정을 기본값으로 되돌리고, 출력 대상을 메모리 sink 하나로 바꾼다.
+    std::shared_ptr<CMemoryLogSink> captureLogs(size_t capacity = 1024);
+}
+
+#define LOG_TEST(group, name) \
+    static void logTest_##group##_##name(); \
+    static LogTest::SRegistrar logTestRegistrar_##group##_##name(#group, #name, &logTest_##group##_##name); \
+    static void logTest_##group##_##name()
+
+#define LOG_CHECK(condition) LogTest::check((condition), #condition, __FILE__, __LINE__)
+#define LOG_CHECK_EQUAL(expected, actual) LogTest::checkEqual((expected), (actual), #actual, __FILE__, __LINE__)
+
+#endif // LogTest_H
@@ -0,0 +1,166 @@
+﻿// NamedLoggerTests.cpp
+// 이름 있는 로거가 상위 로거의 sink/레벨을 물려받고, 끝까지 없으면 기본 로거를 사용하는지 확인
+// 이름 있는 로거는 프로세스가 끝날 때까지 남으므로 테스트마다 다른 이름을 사용한다.
+#include "pch.h"
+#include "LogTest.h"
+#include "LogNamedLogger.h"
+#include "LogSink.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+    size_t countContaining(const std::vector<std::string>& lines, const std::string& text) {
+        size_t count = 0;
+        for (const auto& line : lines) {
+            if (line.find(text) != std::string::npos) {
+                ++count;
+            }
+        }
+        return count;
+    }
+}
+
+// "inherit.b.c" 는 "inherit.b" -> "inherit" -> "" 순으로 물려받는다.
+LOG_TEST(NamedLogger, InheritsFromAncestor) {
+    auto defaultSink = LogTest::captureLogs();
+    CNamedLogger& top = CNamedLogger::get("inherit");
+    CNamedLogger& leaf = CNamedLogger::get("inherit.b.c");
+    LOG_CHECK(&CNamedLogger::get("inherit.b.c") == &leaf);
+    LOG_CHECK(leaf.getParent() != nullptr);
+    LOG_CHECK_EQUAL(std::string("inherit.b"), leaf.getParent()->getName());
+    LOG_CHECK(leaf.getParent()->getParent() == &top);
+    LOG_CHECK(top.getParent() == &CNamedLogger::get(""));
+
+    auto topSink = std::make_shared<CMemoryLogSink>(64);
+    top.setSinks({ topSink });
+    top.setLevel(ELogLevel::LOG_WARNING);
+
+    LOGGER_INFO(leaf, "leaf info");
+    LOGGER_WARNINGF(leaf, "leaf warning {}", 1);
+    LOGGER_ERROR(top, "top error");
+    std::vector<std::string> lines = topSink->getLines();
+    LOG_CHECK_EQUAL(2u, lines.size());
+    LOG_CHECK(lines[0].find("** [inherit.b.c] leaf warning 1 (Log from logTest_NamedLogger_InheritsFromAncestor at NamedLoggerTests.cpp:")
+        != std::string::npos);
+    LOG_CHECK(lines[1].find("!! [inherit] top error (") != std::string::npos);
+    LOG_CHECK_EQUAL(0u, defaultSink->getLines().size());
+
+    // 나중에 만든 하위 로거도 물려받는다.
+    CNamedLogger& late = CNamedLogger::get("inherit.b.late");
+    LOGGER_DEBUG(late, "late debug");
+    LOGGER_WARNING(late, "late warning");
+    LOG_CHECK_EQUAL(1u, countContaining(topSink->getLines(), "[inherit.b.late] late warning ("));
+    LOG_CHECK_EQUAL(3u, topSink->getLines().size());
+}
+
+// 중간 로거가 직접 설정하면 그 아래는 중간 로거를 따르고, clearSinks/clearLevel 하면 다시 상위 로거를 따른다.
+LOG_TEST(NamedLogger, ClearFallsBackToParent) {
+    auto defaultSink = LogTest::captureLogs();
+    CNamedLogger& top = CNamedLogger::get("override");
+    CNamedLogger& middle = CNamedLogger::get("override.b");
+    CNamedLogger& leaf = CNamedLogger::get("override.b.c");
+    auto topSink = std::make_shared<CMemoryLogSink>(64);
+    auto middleSink = std::make_shared<CMemoryLogSink>(64);
+    top.setSinks({ topSink });
+    top.setLevel(ELogLevel::LOG_ERROR);
+
+    middle.setSinks({ middleSink });
+    middle.setLevel(ELogLevel::LOG_DEBUG);
+    LOGGER_DEBUG(leaf, "to middle");
+    LOGGER_WARNING(top, "top warning");
+    LOG_CHECK_EQUAL(1u, middleSink->getLines().size());
+    LOG_CHECK_EQUAL(1u, countContaining(middleSink->getLines(), "==> [override.b.c] to middle ("));
+    LOG_CHECK_EQUAL(0u, topSink->getLines().size());
+
+    middle.clearSinks();
+    LOGGER_DEBUG(leaf, "to top");
+    LOG_CHECK_EQUAL(1u, countContaining(topSink->getLines(), "==> [override.b.c] to top ("));
+    LOG_CHECK_EQUAL(1u, middleSink->getLines().size());
+
+    middle.clearLevel();
+    LOGGER_DEBUG(leaf, "filtered by top");
+    LOGGER_ERROR(leaf, "error to top");
+    std::vector<std::string> lines = topSink->getLines();
+    LOG_CHECK_EQUAL(2u, lines.size());
+    LOG_CHECK(lines[1].find("!! [override.b.c] error to top (") != std::string::npos);
+
+    // 빈 목록은 clearSinks 와 같다.
+    middle.setSinks(CNamedLogger::LogSinkList());
+    LOGGER_ERROR(leaf, "still top");
+    LOG_CHECK_EQUAL(3u, topSink->getLines().size());
+    LOG_CHECK_EQUAL(0u, defaultSink->getLines().size());
+}
+
+// 위로 끝까지 sink 가 없으면 기본 로거의 sink 로, 레벨이 없으면 기본 로거의 레벨/규칙으로 기록한다.
+LOG_TEST(NamedLogger, FallsBackToDefaultLogger) {
+    auto defaultSink = LogTest::captureLogs();
+    CNamedLogger& top = CNamedLogger::get("fallback");
+    CNamedLogger& leaf = CNamedLogger::get("fallback.x.y");
+
+    CLogger::setMinLogLevel(ELogLevel::LOG_WARNING);
+    LOGGER_INFO(leaf, "default level filters");
+    LOGGER_WARNING(leaf, "to default sink");
+    std::vector<std::string> lines = defaultSink->getLines();
+    LOG_CHECK_EQUAL(1u, lines.size());
+    LOG_CHECK(lines[0].find("** to default sink (Log from logTest_NamedLogger_FallsBackToDefaultLogger") != std::string::npos);
+
+    // 레벨만 설정하면 sink 는 여전히 기본 로거
+    top.setLevel(ELogLevel::LOG_DEBUG);
+    LOGGER_DEBUG(leaf, "own level, default sink");
+    LOG_CHECK_EQUAL(1u, countContaining(defaultSink->getLines(), "==> own level, default sink ("));
+
+    // sink 를 설정했다가 지우면 다시 기본 로거
+    auto topSink = std::make_shared<CMemoryLogSink>(64);
+    top.addSink(topSink);
+    LOGGER_INFO(leaf, "own sink");
+    top.clearSinks();
+    top.clearLevel();
+    LOGGER_INFO(leaf, "filtered again");
+    LOGGER_ERROR(leaf, "back to default");
+    LOG_CHECK_EQUAL(1u, topSink->getLines().size());
+    lines = defaultSink->getLines();
+    LOG_CHECK_EQUAL(3u, lines.size());
+    LOG_CHECK(lines[2].find("!! back to default (") != std::string::npos);
+}
+
+// 다른 스레드가 하위 로거로 로그를 남기는 동안 상위 로거의 sink 를 바꿔도, 바꾼 뒤에는 빠진 sink 가 놓여 있다.
+LOG_TEST(NamedLogger, SwapReleasesRemovedSinks) {
+    LogTest::captureLogs();
+    CNamedLogger& top = CNamedLogger::get("swap");
+    CNamedLogger& leaf = CNamedLogger::get("swap.leaf");
+    auto keptSink = std::make_shared<CMemoryLogSink>(16);
+    top.setSinks({ keptSink });
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> started(0);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&leaf, &stop, &started] {
+            LOGGER_INFO(leaf, "swap start");
+            started.fetch_add(1);
+            for (unsigned i = 0; !stop.load(); ++i) {
+                LOGGER_INFOF(leaf, "swap {}", i);
+            }
+        });
+    }
+    while (started.load() < 4) {
+        std::this_thread::yield();
+    }
+    bool released = true;
+    for (int i = 0; i < 50; ++i) {
+        std::weak_ptr<CLogSink> removed;
+        {
+            auto temporary = std::make_shared<CMemoryLogSink>(16);
+            removed = temporary;
+            top.setSinks({ keptSink, temporary });
+        }
+        top.setSinks({ keptSink });
+        released = released && removed.expired();
+    }
+    stop.store(true);
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    LOG_CHECK(released);
+    LOG_CHECK(countContaining(keptSink->getLines(), "[swap.leaf] swap ") != 0);
+}
@@ -0,0 +1,101 @@
+﻿// RateLimitTests.cpp
+// 호출 위치별 속도 제한과 연속 중복 메시지 생략 개수 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogSink.h"
+
+namespace {
+    size_t countContaining(const std::vector<std::string>& lines, const std::string& text) {
+        size_t count = 0;
+        for (const auto& line : lines) {
+            if (line.find(text) != std::string::npos) {
+                ++count;
+            }
+        }
+        return count;
+    }
+}
+
+// 초당 1 개, burst 5 : 빠르게 100 번 호출하면 5 개만 남고, 나머지 95 개는 flush 때 요약 한 줄로 남는다.
+LOG_TEST(RateLimit, BurstThenSuppressed) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    logger.setRateLimit(ELogLevel::LOG_INFO, 1.0, 5);
+    unsigned long long suppressedBefore = logger.getRateLimitedCount();
+
+    for (int i = 0; i < 100; ++i) {
+        LOG_INFOF("tick {}", i);
+    }
+    // 다른 레벨은 제한하지 않는다.
+    for (int i = 0; i < 20; ++i) {
+        LOG_WARNINGF("warning {}", i);
+    }
+    LOG_CHECK_EQUAL(95ull, logger.getRateLimitedCount() - suppressedBefore);
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(5u, countContaining(lines, "--> tick "));
+    LOG_CHECK_EQUAL(20u, countContaining(lines, "** warning "));
+    LOG_CHECK_EQUAL(0u, countContaining(lines, "suppressed"));
+
+    logger.flush();
+    lines = sink->getLines();
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "--> 95 messages suppressed by rate limit (Log from logTest_RateLimit_BurstThenSuppressed"));
+}
+
+// 같은 메시지가 이어지면 첫 번째만 남기고, 다른 메시지가 오면 그 앞에 반복 횟수를 남긴다.
+LOG_TEST(RateLimit, DuplicateSuppression) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    logger.setDuplicateSuppression(true);
+    unsigned long long repeatedBefore = logger.getRepeatedCount();
+
+    for (int i = 0; i < 10; ++i) {
+        LOG_INFO(i < 9 ? "same message" : "different message");
+    }
+    LOG_CHECK_EQUAL(8ull, logger.getRepeatedCount() - repeatedBefore);
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(3u, lines.size());
+    LOG_CHECK(lines[0].find("--> same message (") != std::string::npos);
+    LOG_CHECK(lines[1].find("--> last message repeated 8 times (") != std::string::npos);
+    LOG_CHECK(lines[2].find("--> different message (") != std::string::npos);
+
+    // 인자가 다르면 같은 포맷이라도 다른 메시지
+    for (int i = 0; i < 5; ++i) {
+        LOG_INFOF("value {}", i);
+    }
+    LOG_CHECK_EQUAL(8u, sink->getLines().size());
+}
+
+// hash 가 같아도 인자 byte 가 다르면 다른 메시지로 남긴다.
+LOG_TEST(RateLimit, HashCollisionIsNotRepeat) {
+    static SLogSiteState state;
+    const SLogCallSite callSite = { ELogLevel::LOG_INFO, logLevelTag(ELogLevel::LOG_INFO), "caller", "Source.cpp", 1,
+        &state, "Source.cpp" };
+    static const char format[] = "value {}";
+    CLogLineBuffer first;
+    CLogLineBuffer second;
+    LogArgs::encodeAll(first, 1);
+    LogArgs::encodeAll(second, 2);
+
+    CLogRateLimiter limiter;
+    limiter.setDuplicateSuppression(true);
+    SLogSiteSummary summary;
+    LOG_CHECK(limiter.admit(state, &callSite, format, first.data(), first.size(), summary));
+    LOG_CHECK(!limiter.admit(state, &callSite, format, first.data(), first.size(), summary));
+
+    // 두 번째 메시지의 hash 가 첫 번째와 충돌한 것처럼 만든다.
+    state.lastMessageHash = CLogRateLimiter::hashMessage(format, second.data(), second.size());
+    LOG_CHECK(limiter.admit(state, &callSite, format, second.data(), second.size(), summary));
+    LOG_CHECK_EQUAL(1ull, summary.repeatedCount);
+    LOG_CHECK(!limiter.admit(state, &callSite, format, second.data(), second.size(), summary));
+    LOG_CHECK(limiter.admit(state, &callSite, format, first.data(), first.size(), summary));
+    LOG_CHECK_EQUAL(2ull, limiter.getRepeatedCount());
+}
+
+// 설정을 기본값으로 되돌리면 제한 없이 모두 남는다.
+LOG_TEST(RateLimit, DisabledByDefault) {
+    auto sink = LogTest::captureLogs();
+    for (int i = 0; i < 50; ++i) {
+        LOG_INFO("unlimited");
+    }
+    LOG_CHECK_EQUAL(50u, sink->getLines().size());
+}
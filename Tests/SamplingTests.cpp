@@ -0,0 +1,114 @@
+﻿// SamplingTests.cpp
+// 레벨별/소스 파일별 샘플링으로 남는 로그 개수 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogSink.h"
+#include <atomic>
+
+namespace {
+    // 남은 로그 개수만 세는 sink
+    struct SCountingSink {
+        std::shared_ptr<CCallbackLogSink> sink;
+        std::shared_ptr<std::atomic<unsigned>> count;
+        std::shared_ptr<std::atomic<unsigned>> sampledCount;     // sample_rate 가 붙은 로그
+    };
+
+    SCountingSink captureCount() {
+        LogTest::captureLogs();
+        SCountingSink counting;
+        counting.count = std::make_shared<std::atomic<unsigned>>(0);
+        counting.sampledCount = std::make_shared<std::atomic<unsigned>>(0);
+        auto count = counting.count;
+        auto sampledCount = counting.sampledCount;
+        counting.sink = std::make_shared<CCallbackLogSink>([count, sampledCount](const SLogEvent& event, const char*, size_t) {
+            count->fetch_add(1);
+            if (event.sampleRate < 1.0f) {
+                sampledCount->fetch_add(1);
+            }
+        });
+        CLogger::getInstance().configureLogging(std::vector<std::shared_ptr<CLogSink>>{ counting.sink });
+        return counting;
+    }
+}
+
+// EVERY_N 은 호출 위치마다 N 번에 한 번, 기록된 로그에는 sample_rate=1/N 이 붙는다.
+LOG_TEST(Sampling, EveryN) {
+    auto sink = LogTest::captureLogs();
+    CLogger::getInstance().setSampling(ELogLevel::LOG_DEBUG, ESampleMode::EVERY_N, 10);
+    for (int i = 0; i < 100; ++i) {
+        LOG_DEBUGF("debug {}", i);
+    }
+    // 샘플링하지 않은 레벨은 모두 남는다.
+    for (int i = 0; i < 7; ++i) {
+        LOG_INFO("info");
+    }
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(17u, lines.size());
+    for (size_t i = 0; i < 10; ++i) {
+        LOG_CHECK(lines[i].find("==> debug " + std::to_string(i * 10) + " sample_rate=0.1 (") != std::string::npos);
+    }
+    LOG_CHECK(lines[10].find("sample_rate") == std::string::npos);
+}
+
+// 파일 규칙이 같은 레벨의 레벨 전체 규칙보다 우선한다.
+LOG_TEST(Sampling, FileRuleOverridesLevelRule) {
+    SCountingSink counting = captureCount();
+    CLogger& logger = CLogger::getInstance();
+    logger.setSampling(ELogLevel::LOG_INFO, ESampleMode::EVERY_N, 10);
+    logger.setSampling(__FILE__, ELogLevel::LOG_INFO, ESampleMode::EVERY_N, 4);
+    for (int i = 0; i < 100; ++i) {
+        LOG_INFO("file rule");
+    }
+    LOG_CHECK_EQUAL(25u, counting.count->load());
+
+    // 다른 파일 이름의 규칙은 이 파일에 적용되지 않는다.
+    logger.clearSampling();
+    logger.setSampling("Other.cpp", ELogLevel::LOG_INFO, ESampleMode::EVERY_N, 4);
+    for (int i = 0; i < 100; ++i) {
+        LOG_INFO("other file rule");
+    }
+    LOG_CHECK_EQUAL(125u, counting.count->load());
+}
+
+// PROBABILITY 0 은 모두 버리고, 1 이상은 샘플링 해제, 0.5 는 대략 절반
+LOG_TEST(Sampling, Probability) {
+    SCountingSink counting = captureCount();
+    CLogger& logger = CLogger::getInstance();
+    logger.setSampling(ELogLevel::LOG_DEBUG, ESampleMode::PROBABILITY, 0.0);
+    for (int i = 0; i < 1000; ++i) {
+        LOG_DEBUG("never");
+    }
+    LOG_CHECK_EQUAL(0u, counting.count->load());
+
+    logger.setSampling(ELogLevel::LOG_DEBUG, ESampleMode::PROBABILITY, 1.0);
+    for (int i = 0; i < 1000; ++i) {
+        LOG_DEBUG("always");
+    }
+    LOG_CHECK_EQUAL(1000u, counting.count->load());
+    LOG_CHECK_EQUAL(0u, counting.sampledCount->load());
+
+    // 10000 번 중 기록 개수의 표준편차는 50 이므로 +-500 (10 표준편차) 안에 들어야 한다.
+    logger.setSampling(ELogLevel::LOG_DEBUG, ESampleMode::PROBABILITY, 0.5);
+    for (int i = 0; i < 10000; ++i) {
+        LOG_DEBUG("half");
+    }
+    unsigned half = counting.count->load() - 1000;
+    LOG_CHECK(half >= 4500 && half <= 5500);
+    LOG_CHECK_EQUAL(half, counting.sampledCount->load());
+}
+
+// 해제하면 모두 남는다.
+LOG_TEST(Sampling, ClearSampling) {
+    SCountingSink counting = captureCount();
+    CLogger& logger = CLogger::getInstance();
+    logger.setSampling(ELogLevel::LOG_WARNING, ESampleMode::EVERY_N, 5);
+    for (int i = 0; i < 50; ++i) {
+        LOG_WARNING("sampled");
+    }
+    LOG_CHECK_EQUAL(10u, counting.count->load());
+    logger.clearSampling();
+    for (int i = 0; i < 50; ++i) {
+        LOG_WARNING("not sampled");
+    }
+    LOG_CHECK_EQUAL(60u, counting.count->load());
+}
@@ -0,0 +1,102 @@
+﻿// ScopeTests.cpp
+// LOG_SCOPE 실행 시간/중첩 깊이 기록과 LOG_SCOPE_STATS 집계 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogSink.h"
+#include <chrono>
+#include <regex>
+#include <thread>
+
+namespace {
+    // "이름 elapsed_us=값 depth=값" 에서 elapsed_us
+    double elapsedMicroseconds(const std::string& line) {
+        std::smatch match;
+        if (!std::regex_search(line, match, std::regex(" elapsed_us=([0-9.e+-]+) depth="))) {
+            return -1.0;
+        }
+        return std::stod(match[1].str());
+    }
+}
+
+// 스코프가 끝날 때 안쪽부터 DEBUG 로그 하나씩, 실행 시간과 중첩 깊이를 붙인다.
+LOG_TEST(Scope, NestedScopeLines) {
+    auto sink = LogTest::captureLogs();
+    {
+        LOG_SCOPE("outer");
+        {
+            LOG_SCOPE("inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(2u, lines.size());
+    LOG_CHECK(lines[0].find("]\t [DEBUG]\t==> inner elapsed_us=") != std::string::npos);
+    LOG_CHECK(lines[0].find(" depth=2 (Log from logTest_Scope_NestedScopeLines at ScopeTests.cpp:") != std::string::npos);
+    LOG_CHECK(lines[1].find("==> outer elapsed_us=") != std::string::npos);
+    LOG_CHECK(lines[1].find(" depth=1 (") != std::string::npos);
+    double inner = elapsedMicroseconds(lines[0]);
+    double outer = elapsedMicroseconds(lines[1]);
+    LOG_CHECK(inner >= 2000.0);
+    LOG_CHECK(outer >= inner);
+    LOG_CHECK_EQUAL(0u, CLogScope::currentDepth());
+}
+
+// DEBUG 가 꺼져 있으면 시간을 재지 않고 아무것도 기록하지 않는다.
+LOG_TEST(Scope, DisabledWithDebugLevel) {
+    auto sink = LogTest::captureLogs();
+    CLogger::setMinLogLevel(ELogLevel::LOG_INFO);
+    {
+        LOG_SCOPE("skipped");
+        LOG_CHECK_EQUAL(0u, CLogScope::currentDepth());
+    }
+    CLogger::getInstance().flushScopeStats();
+    LOG_CHECK_EQUAL(0u, sink->getLines().size());
+}
+
+// LOG_SCOPE_STATS 는 호출마다 기록하지 않고, flushScopeStats 때 스코프마다 집계 한 줄을 남긴다.
+LOG_TEST(Scope, StatsSummary) {
+    auto sink = LogTest::captureLogs();
+    for (int i = 0; i < 10; ++i) {
+        LOG_SCOPE_STATS("loop");
+    }
+    LOG_CHECK_EQUAL(0u, sink->getLines().size());
+
+    CLogger::getInstance().flushScopeStats();
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(1u, lines.size());
+    LOG_CHECK(std::regex_search(lines[0], std::regex("==> loop count=10 min_us=[0-9.e+-]+ mean_us=[0-9.e+-]+ max_us=[0-9.e+-]+ "
+        "p50_us=[0-9.e+-]+ p99_us=[0-9.e+-]+ histogram=[^ ]+:[0-9]+ \\(Log from logTest_Scope_StatsSummary at ScopeTests\\.cpp:")));
+
+    // 기록한 집계는 비워진다.
+    CLogger::getInstance().flushScopeStats();
+    LOG_CHECK_EQUAL(1u, sink->getLines().size());
+}
+
+// LOG_SCOPE 기록과 LOG_SCOPE_STATS 집계는 속도 제한/중복 생략을 켜도 빠지거나 합쳐지지 않는다.
+LOG_TEST(Scope, IgnoresRateLimit) {
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    logger.setRateLimit(ELogLevel::LOG_DEBUG, 1.0, 1);
+    logger.setDuplicateSuppression(true);
+    unsigned long long suppressed = logger.getRateLimitedCount();
+    unsigned long long repeated = logger.getRepeatedCount();
+    for (int i = 0; i < 5; ++i) {
+        LOG_SCOPE("limited");
+    }
+    for (int i = 0; i < 3; ++i) {
+        LOG_SCOPE_STATS("limited stats");
+        logger.flushScopeStats();
+    }
+    logger.flush();
+
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(8u, lines.size());
+    for (int i = 0; i < 5; ++i) {
+        LOG_CHECK(lines[i].find("==> limited elapsed_us=") != std::string::npos);
+    }
+    for (int i = 5; i < 8; ++i) {
+        LOG_CHECK(lines[i].find("==> limited stats count=1 ") != std::string::npos);
+    }
+    LOG_CHECK_EQUAL(suppressed, logger.getRateLimitedCount());
+    LOG_CHECK_EQUAL(repeated, logger.getRepeatedCount());
+}
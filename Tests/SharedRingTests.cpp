@@ -0,0 +1,270 @@
+﻿// SharedRingTests.cpp
+// 공유 메모리 링에 여러 프로세스가 넣은 로그를 수집 프로세스가 꺼내서 기록하는지 확인 (POSIX 전용)
+#include "pch.h"
+#include "LogTest.h"
+#include "LogCollector.h"
+#include "LogPlatform.h"
+#include "LogSharedRing.h"
+#include "LogSharedSink.h"
+#include "LogSink.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+    // 테스트 프로세스마다 다른 링 이름
+    std::string ringName(const char* name) {
+        return std::string("/LoggerTests_") + name + "_" + std::to_string(LogPlatform::processId());
+    }
+
+    // 끝나면 공유 메모리 이름을 지운다.
+    struct SRingNameGuard {
+        std::string name;
+        ~SRingNameGuard() {
+            CSharedLogRing::remove(name);
+        }
+    };
+
+    const std::chrono::milliseconds kNoWait(0);
+
+    // 슬롯을 예약한 채 멈추는 자식 프로세스
+    // 텍스트를 읽을 수 없는 페이지에서 복사하게 해서, write 가 슬롯을 예약한 뒤 SIGSEGV 처리 함수 안에서 멈춘다.
+    // 처리 함수는 부모에게 알리고 부모의 신호를 기다린 뒤, 계속이면 페이지를 읽을 수 있게 바꿔 복사를 이어서 하고 종료면 바로 끝낸다.
+    struct SStalledWriter {
+        char* page;
+        size_t pageSize;
+        int stalledPipe[2];     // 자식 -> 부모 : 예약하고 멈춤
+        int resumePipe[2];      // 부모 -> 자식 : 'c' 계속, 'x' 종료
+    };
+    SStalledWriter stalledWriter;
+
+    void stalledWriterHandler(int) {
+        char signal = 's';
+        if (::write(stalledWriter.stalledPipe[1], &signal, 1) != 1 || ::read(stalledWriter.resumePipe[0], &signal, 1) != 1
+            || signal != 'c') {
+            _exit(4);
+        }
+        mprotect(stalledWriter.page, stalledWriter.pageSize, PROT_READ);
+    }
+
+    pid_t startStalledWriter(const std::string& ringName, const char* text) {
+        stalledWriter.pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        void* page = mmap(nullptr, stalledWriter.pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        LOG_CHECK(page != MAP_FAILED);
+        stalledWriter.page = static_cast<char*>(page);
+        std::strcpy(stalledWriter.page, text);
+        LOG_CHECK_EQUAL(0, pipe(stalledWriter.stalledPipe));
+        LOG_CHECK_EQUAL(0, pipe(stalledWriter.resumePipe));
+
+        pid_t child = fork();
+        if (child == 0) {
+            int status = 0;
+            try {
+                std::unique_ptr<CSharedLogRing> producer = CSharedLogRing::open(ringName);
+                struct sigaction action;
+                std::memset(&action, 0, sizeof(action));
+                action.sa_handler = stalledWriterHandler;
+                sigaction(SIGSEGV, &action, nullptr);
+                mprotect(stalledWriter.page, stalledWriter.pageSize, PROT_NONE);
+                if (!producer->write(ELogLevel::LOG_WARNING, 10, 9, stalledWriter.page, std::strlen(text))) {
+                    status = 2;
+                }
+            }
+            catch (...) {
+                status = 3;
+            }
+            _exit(status);
+        }
+        LOG_CHECK(child > 0);
+        char signal = 0;
+        LOG_CHECK_EQUAL(1, static_cast<int>(::read(stalledWriter.stalledPipe[0], &signal, 1)));
+        return child;
+    }
+
+    void resumeStalledWriter(char signal) {
+        LOG_CHECK_EQUAL(1, static_cast<int>(::write(stalledWriter.resumePipe[1], &signal, 1)));
+        for (int fileDescriptor : { stalledWriter.stalledPipe[0], stalledWriter.stalledPipe[1],
+            stalledWriter.resumePipe[0], stalledWriter.resumePipe[1] }) {
+            ::close(fileDescriptor);
+        }
+        munmap(stalledWriter.page, stalledWriter.pageSize);
+    }
+}
+
+// 넣은 순서대로 꺼내고, 슬롯보다 긴 줄은 잘리며, 가득 차면 기다리지 않고 버린다.
+LOG_TEST(SharedRing, WriteReadAndDrop) {
+    SRingNameGuard guard{ ringName("ring") };
+    std::unique_ptr<CSharedLogRing> collector = CSharedLogRing::create(guard.name, 3, 128);
+    std::unique_ptr<CSharedLogRing> producer = CSharedLogRing::open(guard.name);
+    LOG_CHECK_EQUAL(4u, collector->getSlotCount());
+    LOG_CHECK_EQUAL(4u, producer->getSlotCount());
+
+    CSharedLogRing::SRecord record;
+    LOG_CHECK(!collector->read(record, kNoWait));
+    LOG_CHECK(producer->write(ELogLevel::LOG_INFO, 100, 1, "first", 5));
+    LOG_CHECK(producer->write(ELogLevel::LOG_ERROR, 200, 2, "second", 6));
+    std::string longText(collector->getTextCapacity() + 10, 'x');
+    LOG_CHECK(producer->write(ELogLevel::LOG_DEBUG, 300, 3, longText.data(), longText.size()));
+    LOG_CHECK(producer->write(ELogLevel::LOG_WARNING, 400, 4, "fourth", 6));
+    LOG_CHECK(!producer->write(ELogLevel::LOG_WARNING, 500, 5, "dropped", 7));
+    LOG_CHECK_EQUAL(1ull, collector->getDroppedCount());
+
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(100ll, record.wallNanoseconds);
+    LOG_CHECK_EQUAL(LogPlatform::processId(), record.processId);
+    LOG_CHECK_EQUAL(1u, record.threadNumber);
+    LOG_CHECK(record.eLogLevel == ELogLevel::LOG_INFO);
+    LOG_CHECK_EQUAL(std::string("first"), std::string(record.text, record.textSize));
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK(record.eLogLevel == ELogLevel::LOG_ERROR);
+    LOG_CHECK_EQUAL(std::string("second"), std::string(record.text, record.textSize));
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(collector->getTextCapacity(), record.textSize);
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(std::string("fourth"), std::string(record.text, record.textSize));
+    LOG_CHECK(!collector->read(record, kNoWait));
+
+    // 꺼낸 슬롯은 다시 사용한다.
+    LOG_CHECK(producer->write(ELogLevel::LOG_INFO, 600, 6, "reused", 6));
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(std::string("reused"), std::string(record.text, record.textSize));
+}
+
+// 자식 프로세스가 연 링에 넣은 로그를 부모(수집 프로세스)가 자식의 프로세스 id 와 함께 꺼낸다.
+LOG_TEST(SharedRing, OtherProcessWrites) {
+    SRingNameGuard guard{ ringName("process") };
+    std::unique_ptr<CSharedLogRing> collector = CSharedLogRing::create(guard.name, 16, 256);
+
+    pid_t child = fork();
+    if (child == 0) {
+        // 자식 : 공유 메모리 링만 사용하고 바로 종료 (부모의 스레드/락은 건드리지 않음)
+        int status = 0;
+        try {
+            std::unique_ptr<CSharedLogRing> producer = CSharedLogRing::open(guard.name);
+            for (unsigned i = 0; i < 3; ++i) {
+                std::string text = "child " + std::to_string(i);
+                if (!producer->write(ELogLevel::LOG_INFO, 1000 + i, i, text.data(), text.size())) {
+                    status = 2;
+                }
+            }
+        }
+        catch (...) {
+            status = 3;
+        }
+        _exit(status);
+    }
+    LOG_CHECK(child > 0);
+    int status = -1;
+    LOG_CHECK_EQUAL(child, waitpid(child, &status, 0));
+    LOG_CHECK(WIFEXITED(status));
+    LOG_CHECK_EQUAL(0, WEXITSTATUS(status));
+
+    CSharedLogRing::SRecord record;
+    for (unsigned i = 0; i < 3; ++i) {
+        LOG_CHECK(collector->read(record, kNoWait));
+        LOG_CHECK_EQUAL(static_cast<unsigned long>(child), record.processId);
+        LOG_CHECK_EQUAL(i, record.threadNumber);
+        LOG_CHECK_EQUAL("child " + std::to_string(i), std::string(record.text, record.textSize));
+    }
+    LOG_CHECK(!collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(0ull, collector->getAbandonedCount());
+}
+
+// 슬롯을 예약한 프로세스가 살아 있으면 오래 멈춰 있어도 건너뛰지 않는다.
+// 건너뛰면 다음 바퀴에서 그 슬롯에 넣은 로그를 멈췄던 쓰기가 덮어쓴다.
+LOG_TEST(SharedRing, StalledWriterIsNotSkipped) {
+    SRingNameGuard guard{ ringName("stalled") };
+    std::unique_ptr<CSharedLogRing> collector = CSharedLogRing::create(guard.name, 2, 128);
+    std::unique_ptr<CSharedLogRing> producer = CSharedLogRing::open(guard.name);
+    pid_t child = startStalledWriter(guard.name, "stalled");
+
+    // 자식이 0 번 슬롯을 예약한 채 멈춰 있다.
+    CSharedLogRing::SRecord record;
+    for (int i = 0; i < 3; ++i) {
+        LOG_CHECK(!collector->read(record, kNoWait));
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    LOG_CHECK(producer->write(ELogLevel::LOG_INFO, 20, 1, "second", 6));
+    // 다음 바퀴의 0 번 슬롯은 아직 비지 않았으므로 버린다.
+    LOG_CHECK(!producer->write(ELogLevel::LOG_INFO, 30, 1, "third", 5));
+    LOG_CHECK(!collector->read(record, kNoWait));
+
+    resumeStalledWriter('c');
+    int status = -1;
+    LOG_CHECK_EQUAL(child, waitpid(child, &status, 0));
+    LOG_CHECK(WIFEXITED(status));
+    LOG_CHECK_EQUAL(0, WEXITSTATUS(status));
+
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(static_cast<unsigned long>(child), record.processId);
+    LOG_CHECK_EQUAL(std::string("stalled"), std::string(record.text, record.textSize));
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(std::string("second"), std::string(record.text, record.textSize));
+    LOG_CHECK(!collector->read(record, kNoWait));
+
+    // 멈췄던 슬롯을 다시 사용해도 내용이 그대로다.
+    LOG_CHECK(producer->write(ELogLevel::LOG_INFO, 40, 1, "fourth", 6));
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(std::string("fourth"), std::string(record.text, record.textSize));
+    LOG_CHECK_EQUAL(0ull, collector->getAbandonedCount());
+    LOG_CHECK_EQUAL(1ull, collector->getDroppedCount());
+}
+
+// 슬롯을 예약한 채 종료된 프로세스의 슬롯은 건너뛰고, 다음 로그부터 이어서 꺼낸다.
+LOG_TEST(SharedRing, ExitedWriterIsSkipped) {
+    SRingNameGuard guard{ ringName("exited") };
+    std::unique_ptr<CSharedLogRing> collector = CSharedLogRing::create(guard.name, 4, 128);
+    std::unique_ptr<CSharedLogRing> producer = CSharedLogRing::open(guard.name);
+    pid_t child = startStalledWriter(guard.name, "lost");
+    LOG_CHECK(producer->write(ELogLevel::LOG_INFO, 20, 1, "after", 5));
+
+    resumeStalledWriter('x');
+    int status = -1;
+    LOG_CHECK_EQUAL(child, waitpid(child, &status, 0));
+    LOG_CHECK(WIFEXITED(status));
+    LOG_CHECK_EQUAL(4, WEXITSTATUS(status));
+
+    CSharedLogRing::SRecord record;
+    LOG_CHECK(collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(std::string("after"), std::string(record.text, record.textSize));
+    LOG_CHECK(!collector->read(record, kNoWait));
+    LOG_CHECK_EQUAL(1ull, collector->getAbandonedCount());
+}
+
+// CSharedLogSink 로 남긴 로그를 CLogCollector 가 "[pid N] " 을 붙인 한 줄로 sink 에 기록한다.
+LOG_TEST(SharedRing, CollectorWritesSharedSinkLogs) {
+    SRingNameGuard guard{ ringName("collector") };
+    auto collected = std::make_shared<CMemoryLogSink>(64);
+    CLogCollector collector(guard.name, 64, 512);
+    collector.setReorderWindow(std::chrono::milliseconds(1));
+    collector.start({ collected });
+
+    LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+    logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ std::make_shared<CSharedLogSink>(guard.name) });
+    for (int i = 0; i < 5; ++i) {
+        LOG_INFOF("shared {}", i);
+    }
+    LOG_ERROR("shared error");
+    logger.flush();
+    collector.stop();
+    logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{});
+
+    std::vector<std::string> lines = collected->getLines();
+    LOG_CHECK_EQUAL(6u, lines.size());
+    std::string pidTag = "[pid " + std::to_string(LogPlatform::processId()) + "] ";
+    for (int i = 0; i < 5; ++i) {
+        LOG_CHECK(lines[i].find("]\t [INFO]\t\t--> " + pidTag + "shared " + std::to_string(i) + " (Log from ") != std::string::npos);
+    }
+    LOG_CHECK(lines[5].find("]\t [ERROR]\t!! " + pidTag + "shared error (") != std::string::npos);
+    SLogCollectorStats stats = collector.getStats();
+    LOG_CHECK_EQUAL(6ull, stats.collectedCount);
+    LOG_CHECK_EQUAL(0ull, stats.droppedCount);
+}
+#endif
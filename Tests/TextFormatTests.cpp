@@ -0,0 +1,96 @@
+﻿// TextFormatTests.cpp
+// 기본 텍스트 형식과 LOG_*F 지연 포맷(LogArgs) 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogSink.h"
+#include <regex>
+
+namespace {
+    std::string renderArgs(const char* format, const CLogLineBuffer& args, unsigned argCount) {
+        CLogLineBuffer line;
+        LogArgs::render(line, format, args.data(), args.size(), argCount);
+        return std::string(line.data(), line.size());
+    }
+
+    template <typename... Args>
+    std::string renderFormat(const char* format, const Args&... args) {
+        CLogLineBuffer buffer;
+        LogArgs::encodeAll(buffer, args...);
+        return renderArgs(format, buffer, static_cast<unsigned>(sizeof...(Args)));
+    }
+}
+
+// [시간]\t [종류]\t표시 메시지 (Log from 함수 at 파일:줄) : 처음 버전의 한 줄 형식
+LOG_TEST(Text, DefaultLineFormat) {
+    auto sink = LogTest::captureLogs();
+    int line = __LINE__ + 1;
+    LOG_INFO("hello world");
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(1u, lines.size());
+    std::regex expected("\\[\\d{4}-\\d{2}-\\d{2} \\d{2}:\\d{2}:\\d{2}\\]\t \\[INFO\\]\t\t--> hello world "
+        "\\(Log from logTest_Text_DefaultLineFormat at TextFormatTests\\.cpp:" + std::to_string(line) + "\\)\n");
+    LOG_CHECK(std::regex_match(lines[0], expected));
+}
+
+LOG_TEST(Text, LevelTags) {
+    auto sink = LogTest::captureLogs();
+    LOG_DEBUG("d");
+    LOG_INFO("i");
+    LOG_WARNING("w");
+    LOG_ERROR("e");
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(4u, lines.size());
+    const char* tags[] = { "]\t [DEBUG]\t==> d (", "]\t [INFO]\t\t--> i (", "]\t [WARNING]\t** w (", "]\t [ERROR]\t!! e (" };
+    for (size_t i = 0; i < lines.size(); ++i) {
+        LOG_CHECK(lines[i].find(tags[i]) != std::string::npos);
+    }
+}
+
+// LOG_*F 는 writer 쪽에서 포맷해도 LOG_* 와 같은 한 줄이 된다.
+LOG_TEST(Text, DeferredFormatLine) {
+    auto sink = LogTest::captureLogs();
+    int line = __LINE__ + 1;
+    LOG_WARNINGF("retry {} of {} for {}", 2, 5u, "orders");
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(1u, lines.size());
+    std::string suffix = "]\t [WARNING]\t** retry 2 of 5 for orders (Log from logTest_Text_DeferredFormatLine at TextFormatTests.cpp:"
+        + std::to_string(line) + ")\n";
+    LOG_CHECK(lines[0].size() > suffix.size());
+    LOG_CHECK_EQUAL(suffix, lines[0].substr(lines[0].size() - suffix.size()));
+}
+
+// 매크로를 거치지 않은 logMessage 는 경로에서 파일 이름만 남긴다.
+LOG_TEST(Text, DirectLogMessage) {
+    auto sink = LogTest::captureLogs();
+    CLogger::getInstance().logMessage(ELogLevel::LOG_ERROR, std::string("direct"), "caller", "/src/module/Source.cpp", 7);
+    std::vector<std::string> lines = sink->getLines();
+    LOG_CHECK_EQUAL(1u, lines.size());
+    LOG_CHECK(std::regex_match(lines[0], std::regex("\\[[^\\]]+\\]\t \\[ERROR\\]\t!! direct \\(Log from caller at Source\\.cpp:7\\)\n")));
+}
+
+LOG_TEST(Args, Placeholders) {
+    LOG_CHECK_EQUAL(std::string("int -3 uint 7 text abc char x bool true"),
+        renderFormat("int {} uint {} text {} char {} bool {}", -3, 7u, "abc", 'x', true));
+    LOG_CHECK_EQUAL(std::string("std::string kept"), renderFormat("{} kept", std::string("std::string")));
+    LOG_CHECK_EQUAL(std::string("1.5"), renderFormat("{}", 1.5));
+}
+
+LOG_TEST(Args, BraceEscapes) {
+    LOG_CHECK_EQUAL(std::string("{}"), renderFormat("{{}}"));
+    LOG_CHECK_EQUAL(std::string("{5}"), renderFormat("{{{}}}", 5));
+    LOG_CHECK_EQUAL(std::string("} and {"), renderFormat("}} and {{"));
+    LOG_CHECK_EQUAL(std::string("set {a} = 1"), renderFormat("set {{a}} = {}", 1));
+}
+
+// 인자가 모자라면 "{}" 를 그대로 두고, 남는 인자는 무시한다.
+LOG_TEST(Args, ArgumentCountMismatch) {
+    LOG_CHECK_EQUAL(std::string("1 {}"), renderFormat("{} {}", 1));
+    LOG_CHECK_EQUAL(std::string("1"), renderFormat("{}", 1, 2, 3));
+}
+
+// 구조화 필드는 메시지 뒤에 " 이름=값" 으로 붙는다.
+LOG_TEST(Args, Fields) {
+    CLogLineBuffer buffer;
+    LogArgs::encodeFields(buffer, "id", 1, "symbol", "ABC");
+    LOG_CHECK_EQUAL(std::string("order filled id=1 symbol=ABC"), renderArgs("order filled", buffer, 4));
+}
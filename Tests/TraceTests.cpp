@@ -0,0 +1,107 @@
+﻿// TraceTests.cpp
+// Chrome Trace Event 출력 파일이 올바른 JSON 배열이고, 로그와 LOG_SCOPE 가 시점/구간 이벤트가 되는지 확인
+#include "pch.h"
+#include "LogTest.h"
+#include "LogConfig.h"
+#include "LogSink.h"
+#include "LogTraceSink.h"
+#include "JsonValidator.h"
+
+namespace {
+    size_t countContaining(const std::vector<std::string>& lines, const std::string& text) {
+        size_t count = 0;
+        for (const auto& line : lines) {
+            if (line.find(text) != std::string::npos) {
+                ++count;
+            }
+        }
+        return count;
+    }
+}
+
+// 로그는 "ph":"i", LOG_SCOPE 는 dur 가 있는 "ph":"X", 스레드마다 thread_name 메타데이터 하나
+LOG_TEST(Trace, EventsFormValidArray) {
+    std::string path = LogTest::prepareDirectory("trace") + "/trace.json";
+    LogTest::captureLogs();
+    {
+        auto trace = std::make_shared<CTraceLogSink>(path);
+        CLogger& logger = CLogger::getInstance();
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ trace });
+        LOG_INFO("plain \"quoted\" message");
+        LOG_WARNING_KV("order rejected", "id", 7, "reason", "limit");
+        {
+            LOG_SCOPE("parse");
+        }
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{});
+    }
+
+    std::string text = LogTest::readFile(path);
+    LOG_CHECK(CJsonValidator(text).isArray());
+    std::vector<std::string> lines = LogTest::splitLines(text);
+    LOG_CHECK_EQUAL(std::string("["), lines.front());
+    LOG_CHECK_EQUAL(std::string("]"), lines.back());
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"name\":\"thread_name\",\"ph\":\"M\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"name\":\"process_name\",\"ph\":\"M\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "{\"name\":\"plain \\\"quoted\\\" message\",\"cat\":\"INFO\",\"ph\":\"i\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"cat\":\"WARNING\",\"ph\":\"i\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"id\":7,\"reason\":\"limit\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "{\"name\":\"parse\",\"cat\":\"scope\",\"ph\":\"X\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"dur\":"));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"depth\":1"));
+}
+
+// enableTrace/disableTrace 와 설정의 trace 항목은 현재 sink 옆에 trace sink 를 더하거나 뺀다.
+LOG_TEST(Trace, EnableAndConfigure) {
+    std::string directory = LogTest::prepareDirectory("trace_config");
+    auto sink = LogTest::captureLogs();
+    CLogger& logger = CLogger::getInstance();
+
+    logger.enableTrace(directory + "/enabled.json");
+    LOG_CHECK_EQUAL(2u, logger.getConfig()->sinks.size());
+    LOG_CHECK_EQUAL(directory + "/enabled.json", logger.getConfig()->tracePath);
+    LOG_INFO("to both");
+    logger.disableTrace();
+    LOG_CHECK_EQUAL(1u, logger.getConfig()->sinks.size());
+    LOG_CHECK(logger.getConfig()->tracePath.empty());
+    LOG_CHECK_EQUAL(1u, sink->getLines().size());
+
+    SLogConfig config;
+    config.tracePath = directory + "/configured.json";
+    logger.applyConfig(config);
+    LOG_CHECK_EQUAL(2u, logger.getConfig()->sinks.size());
+    LOG_INFO("configured trace");
+    logger.applyConfig(SLogConfig());
+    LOG_CHECK_EQUAL(1u, logger.getConfig()->sinks.size());
+
+    std::string enabled = LogTest::readFile(directory + "/enabled.json");
+    std::string configured = LogTest::readFile(directory + "/configured.json");
+    LOG_CHECK(CJsonValidator(enabled).isArray());
+    LOG_CHECK(CJsonValidator(configured).isArray());
+    LOG_CHECK(enabled.find("{\"name\":\"to both\",") != std::string::npos);
+    LOG_CHECK(configured.find("{\"name\":\"configured trace\",") != std::string::npos);
+    LOG_CHECK(configured.find("to both") == std::string::npos);
+}
+
+// LOG_SCOPE 가 아닌 로그는 첫 필드 이름이 elapsed_us 여도 시점 이벤트로 남는다.
+LOG_TEST(Trace, ElapsedFieldIsNotScope) {
+    std::string path = LogTest::prepareDirectory("trace_fields") + "/trace.json";
+    LogTest::captureLogs();
+    {
+        auto trace = std::make_shared<CTraceLogSink>(path);
+        CLogger& logger = CLogger::getInstance();
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{ trace });
+        LOG_INFO_KV("req", "elapsed_us", 12.5, "depth", 1);
+        {
+            LOG_SCOPE("handler");
+        }
+        logger.configureLogging(std::vector<std::shared_ptr<CLogSink>>{});
+    }
+
+    std::string text = LogTest::readFile(path);
+    LOG_CHECK(CJsonValidator(text).isArray());
+    std::vector<std::string> lines = LogTest::splitLines(text);
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "{\"name\":\"req\",\"cat\":\"INFO\",\"ph\":\"i\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"elapsed_us\":12.5"));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "{\"name\":\"handler\",\"cat\":\"scope\",\"ph\":\"X\""));
+    LOG_CHECK_EQUAL(1u, countContaining(lines, "\"ph\":\"X\""));
+}
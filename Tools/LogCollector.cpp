@@ -0,0 +1,114 @@
+﻿// LogCollector.cpp
+// 여러 프로세스가 CLogger::configureSharedLogging(링 이름) 으로 남긴 로그를 공유 메모리 링에서 모아 하나의 로그파일에 시간순으로 기록한다.
+// SIGINT/SIGTERM 을 받으면 링에 남은 로그를 기록하고 종료한다.
+//
+// 사용법 : LogCollector [옵션] <링 이름> <로그파일>
+//   --slots=N               링에 대기할 수 있는 로그 개수 (기본 16384)
+//   --slot-size=N           한 줄의 최대 크기 byte (기본 512)
+//   --max-size=N            로그파일이 N MB 를 넘으면 교체 (기본 0 : 교체하지 않음)
+//   --retention=N           보관할 교체된 로그파일 개수 (기본 5)
+//   --reorder-ms=N          시간순 정렬을 위해 모으는 시간 (기본 100)
+#include "pch.h"
+#include "LogCollector.h"
+#include "LogFileSink.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+    std::atomic<bool> stopRequested(false);
+
+    void stopSignalHandler(int) {
+        stopRequested.store(true);
+    }
+
+    bool startsWith(const char* text, const char* prefix, const char*& value) {
+        size_t size = std::strlen(prefix);
+        if (std::strncmp(text, prefix, size) != 0) {
+            return false;
+        }
+        value = text + size;
+        return true;
+    }
+
+    void printUsage() {
+        std::cerr << "usage: LogCollector [--slots=N] [--slot-size=N] [--max-size=MB] [--retention=N] [--reorder-ms=N]"
+            " <ring name> <log file>\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        size_t slotCount = 16384;
+        size_t slotSize = 512;
+        unsigned long long maxFileSize = 0;
+        unsigned retentionCount = 5;
+        long long reorderMilliseconds = 100;
+        std::string ringName;
+        std::string path;
+        for (int i = 1; i < argc; ++i) {
+            const char* value = nullptr;
+            if (startsWith(argv[i], "--slots=", value)) {
+                slotCount = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+            }
+            else if (startsWith(argv[i], "--slot-size=", value)) {
+                slotSize = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+            }
+            else if (startsWith(argv[i], "--max-size=", value)) {
+                maxFileSize = std::strtoull(value, nullptr, 10) * 1024 * 1024;
+            }
+            else if (startsWith(argv[i], "--retention=", value)) {
+                retentionCount = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+            }
+            else if (startsWith(argv[i], "--reorder-ms=", value)) {
+                reorderMilliseconds = std::atoll(value);
+            }
+            else if (argv[i][0] == '-' || !path.empty()) {
+                printUsage();
+                return 2;
+            }
+            else if (ringName.empty()) {
+                ringName = argv[i];
+            }
+            else {
+                path = argv[i];
+            }
+        }
+        if (path.empty()) {
+            printUsage();
+            return 2;
+        }
+
+        // 로그파일은 기존 내용 뒤에 잇지 않고 새로 만든다. (CFileLogSink)
+        auto fileSink = std::make_shared<CFileLogSink>(path);
+        fileSink->setFlushPolicy(EFlushPolicy::INTERVAL, 1000, true);
+        if (maxFileSize != 0) {
+            fileSink->setRotation(maxFileSize, 0, retentionCount);
+        }
+
+        CLogCollector collector(ringName, slotCount, slotSize);
+        collector.setReorderWindow(std::chrono::milliseconds(reorderMilliseconds));
+        std::signal(SIGINT, stopSignalHandler);
+        std::signal(SIGTERM, stopSignalHandler);
+        collector.start({ fileSink });
+        while (!stopRequested.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        collector.stop();
+
+        SLogCollectorStats stats = collector.getStats();
+        std::cerr << "collected " << stats.collectedCount << ", dropped " << stats.droppedCount
+            << ", abandoned " << stats.abandonedCount << "\n";
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,170 @@
+﻿// LogDecoder.cpp
+// 바이너리 로그파일(ELogFileFormat::BINARY)을 기존 텍스트 로그 형태로 변환하여 표준 출력으로 내보낸다.
+//
+// 사용법 : LogDecoder [옵션] <바이너리 로그파일>
+//   --level=DEBUG|INFO|WARNING|ERROR    이 레벨 이상만 출력
+//   --from="yyyy-mm-dd hh:mm:ss"        이 시각 이후 로그만 출력 (로컬 시간)
+//   --to="yyyy-mm-dd hh:mm:ss"          이 시각 이전 로그만 출력 (로컬 시간)
+//   --file=Source.cpp                   이 소스 파일에서 남긴 로그만 출력
+//   --thread=N                          이 스레드 번호의 로그만 출력
+//   --json                              JSON Lines 형식으로 출력 (LogJson)
+#include "pch.h"
+#include "LogBinaryFormat.h"
+#include "LogJson.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    const long long kNanosecondsPerSecond = 1000000000LL;
+
+    struct SDecodeFilter {
+        int minLevel = 0;
+        long long fromTime = 0;
+        long long toTime = 0;       // 0 이면 제한 없음
+        std::string fileName;
+        long long threadNumber = -1;
+    };
+
+    // 바이너리 로그 하나를 JSON 한 줄로 변환
+    void renderJson(const SBinaryLogEntry& entry, const CLogClock& clock, CLogLineBuffer& line) {
+        line.clear();
+        char timeText[32];
+        size_t timeSize = clock.format(entry.wallNanoseconds, timeText, sizeof(timeText));
+        SLogStringView time = { timeText, timeSize };
+        if (entry.callSite == nullptr) {
+            LogJson::appendText(line, time, entry.eLogLevel, entry.threadNumber, entry.data.data(), entry.data.size());
+            return;
+        }
+        LogJson::appendRecord(line, time, entry.eLogLevel, entry.threadNumber, entry.callSite->functionName.c_str(),
+            entry.callSite->fileName.c_str(), entry.callSite->lineNumber, entry.callSite->format.c_str(),
+            entry.data.data(), entry.data.size(), entry.argCount, entry.sampleRate);
+    }
+
+    bool startsWith(const char* text, const char* prefix, const char*& value) {
+        size_t size = std::strlen(prefix);
+        if (std::strncmp(text, prefix, size) != 0) {
+            return false;
+        }
+        value = text + size;
+        return true;
+    }
+
+    int parseLevel(const std::string& name) {
+        const char* names[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+        for (int level = 0; level < 4; ++level) {
+            if (name == names[level]) {
+                return level;
+            }
+        }
+        throw std::runtime_error("Unknown log level: " + name);
+    }
+
+    // "yyyy-mm-dd hh:mm:ss" (로컬 시간) -> 1970-01-01 기준 nanoseconds
+    long long parseLocalTime(const char* text) {
+        std::tm localTime = {};
+        if (std::sscanf(text, "%d-%d-%d %d:%d:%d", &localTime.tm_year, &localTime.tm_mon, &localTime.tm_mday,
+            &localTime.tm_hour, &localTime.tm_min, &localTime.tm_sec) != 6) {
+            throw std::runtime_error(std::string("Invalid time (yyyy-mm-dd hh:mm:ss): ") + text);
+        }
+        localTime.tm_year -= 1900;
+        localTime.tm_mon -= 1;
+        localTime.tm_isdst = -1;
+        return static_cast<long long>(std::mktime(&localTime)) * kNanosecondsPerSecond;
+    }
+
+    bool matches(const SBinaryLogEntry& entry, const SDecodeFilter& filter) {
+        if (static_cast<int>(entry.eLogLevel) < filter.minLevel) {
+            return false;
+        }
+        if (entry.wallNanoseconds < filter.fromTime || (filter.toTime != 0 && entry.wallNanoseconds > filter.toTime)) {
+            return false;
+        }
+        if (filter.threadNumber >= 0 && entry.threadNumber != static_cast<unsigned long long>(filter.threadNumber)) {
+            return false;
+        }
+        if (!filter.fileName.empty()) {
+            if (entry.callSite != nullptr) {
+                return entry.callSite->fileName == filter.fileName;
+            }
+            // 호출 위치 정보가 없는 로그는 " at 파일:줄)" 부분으로 확인
+            return entry.data.find(" at " + filter.fileName + ":") != std::string::npos;
+        }
+        return true;
+    }
+
+    void printUsage() {
+        std::cerr << "usage: LogDecoder [--level=DEBUG|INFO|WARNING|ERROR] [--from=\"yyyy-mm-dd hh:mm:ss\"]"
+            " [--to=\"yyyy-mm-dd hh:mm:ss\"] [--file=Source.cpp] [--thread=N] [--json] <binary log file>\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        SDecodeFilter filter;
+        std::string path;
+        bool json = false;
+        for (int i = 1; i < argc; ++i) {
+            const char* value = nullptr;
+            if (startsWith(argv[i], "--level=", value)) {
+                filter.minLevel = parseLevel(value);
+            }
+            else if (startsWith(argv[i], "--from=", value)) {
+                filter.fromTime = parseLocalTime(value);
+            }
+            else if (startsWith(argv[i], "--to=", value)) {
+                // 지정한 초의 끝까지 포함
+                filter.toTime = parseLocalTime(value) + kNanosecondsPerSecond - 1;
+            }
+            else if (startsWith(argv[i], "--file=", value)) {
+                filter.fileName = value;
+            }
+            else if (startsWith(argv[i], "--thread=", value)) {
+                filter.threadNumber = std::atoll(value);
+            }
+            else if (std::strcmp(argv[i], "--json") == 0) {
+                json = true;
+            }
+            else if (argv[i][0] == '-' || !path.empty()) {
+                printUsage();
+                return 2;
+            }
+            else {
+                path = argv[i];
+            }
+        }
+        if (path.empty()) {
+            printUsage();
+            return 2;
+        }
+
+        CBinaryLogReader reader;
+        reader.open(path);
+        CLogClock clock;
+        clock.configure(reader.getPrecision(), ETimeSource::SYSTEM_CLOCK);
+
+        SBinaryLogEntry entry;
+        CLogLineBuffer line;
+        while (reader.next(entry)) {
+            if (!matches(entry, filter)) {
+                continue;
+            }
+            if (json) {
+                renderJson(entry, clock, line);
+            }
+            else {
+                reader.render(entry, line);
+            }
+            std::fwrite(line.data(), 1, line.size(), stdout);
+        }
+        return 0;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}